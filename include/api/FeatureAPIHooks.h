@@ -146,6 +146,13 @@ FeatureAPIHooks<ID, N>::has_hooks() const
   return m_hooks_p;
 }
 
+template <typename ID, int N>
+bool
+FeatureAPIHooks<ID, N>::has_hooks_for(ID id) const
+{
+  return m_hooks_p && likely(is_valid(id)) && !m_hooks[id].is_empty();
+}
+
 template <typename ID, int N>
 bool
 FeatureAPIHooks<ID, N>::is_valid(ID id)
@@ -167,6 +167,10 @@ public:
   /// The order in terms of @a ScopeTag is GLOBAL, SESSION, TRANSACTION.
   void init(TSHttpHookID id, HttpAPIHooks const *global, HttpAPIHooks const *ssn = nullptr, HttpAPIHooks const *txn = nullptr);
 
+  /// Check whether any of the sources has a hook for @a id, without tracking them.
+  static bool has_hooks(TSHttpHookID id, HttpAPIHooks const *global, HttpAPIHooks const *ssn = nullptr,
+                        HttpAPIHooks const *txn = nullptr);
+
   /// Select a hook for invocation and advance the state to the next valid hook
   /// @return nullptr if no current hook.
   APIHook const *getNext();
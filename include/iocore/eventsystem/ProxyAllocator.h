@@ -57,6 +57,7 @@ thread_alloc(CAlloc &a, ProxyAllocator &l, Args &&...args)
     void *v    = l.freelist;
     l.freelist = *reinterpret_cast<void **>(l.freelist);
     --(l.allocated);
+    ++ink_thread_alloc_count;
 #if TS_USE_ALLOCATOR_METRICS
     a.increment_for_alloc();
 #endif
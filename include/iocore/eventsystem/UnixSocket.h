@@ -89,6 +89,9 @@ public:
   int send(void const *buf, int size, int flags) const;
   int sendto(void const *buf, int size, int flags, struct sockaddr const *to, int tolen) const;
   int sendmsg(struct msghdr const *m, int flags) const;
+#ifdef HAVE_SENDMMSG
+  int sendmmsg(struct mmsghdr *msgvec, int vlen, int flags) const;
+#endif
 
   static int poll(struct pollfd *fds, unsigned long nfds, int timeout);
 
@@ -251,6 +254,20 @@ UnixSocket::sendmsg(struct msghdr const *m, int flags) const
   return r;
 }
 
+#ifdef HAVE_SENDMMSG
+inline int
+UnixSocket::sendmmsg(struct mmsghdr *msgvec, int vlen, int flags) const
+{
+  int r;
+  do {
+    if (unlikely((r = ::sendmmsg(this->fd, msgvec, vlen, flags)) < 0)) {
+      r = -errno;
+    }
+  } while (r == -EINTR);
+  return r;
+}
+#endif
+
 inline int
 UnixSocket::poll(struct pollfd *fds, unsigned long nfds, int timeout)
 {
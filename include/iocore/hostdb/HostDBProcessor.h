@@ -79,7 +79,9 @@ extern unsigned int hostdb_ip_stale_interval;
 extern unsigned int hostdb_ip_timeout_interval;
 extern unsigned int hostdb_ip_fail_timeout_interval;
 extern unsigned int hostdb_serve_stale_but_revalidate;
+extern unsigned int hostdb_refresh_ahead;
 extern unsigned int hostdb_round_robin_max_count;
+extern unsigned int hostdb_snapshot_max_stale;
 
 extern int hostdb_max_iobuf_index;
 
@@ -293,6 +295,7 @@ HostDBInfo::migrate_from(HostDBInfo::self_type const &that)
 class HostDBRecord : public RefCountObj
 {
   friend struct HostDBContinuation;
+  friend struct HostDBCache;
   using self_type = HostDBRecord;
 
   /// Size of the IO buffer block owned by @a this.
@@ -333,6 +336,16 @@ public:
   /// Timing data for switch records in the RR.
   std::atomic<ts_time> rr_ctime{TS_TIME_ZERO};
 
+  /// Set once a refresh ahead of expiry has been started for this record.
+  std::atomic<bool> refresh_started{false};
+
+  /// Set while this is the record in the cache for its key, cleared when it is replaced or removed.
+  std::atomic<bool> cached{false};
+
+  /// Loaded from a HostDB snapshot at startup, which is served while stale until it is refreshed.
+  /// @see proxy.config.hostdb.snapshot.max_stale
+  bool restored = false;
+
   /// Hash key.
   uint64_t key{0};
 
@@ -446,6 +459,10 @@ public:
    * response is stale). */
   bool is_ip_timeout() const;
 
+  /** Whether the DNS response is in the last part of its TTL where a lookup starts a refresh, per
+   * proxy.config.hostdb.refresh_ahead, so names that are in use do not expire. */
+  bool is_ip_refresh_due() const;
+
   bool is_ip_fail_timeout() const;
 
   void refresh_ip();
@@ -460,6 +477,13 @@ public:
    */
   bool serve_stale_but_revalidate() const;
 
+  /** Whether to keep serving this record when the lookup that refreshes it fails.
+   *
+   * A record that has not expired is still good, so a failed refresh ahead of expiry must not replace it. An expired
+   * record is kept as long as @c serve_stale_but_revalidate allows.
+   */
+  bool keep_on_failed_lookup() const;
+
   /// Deallocate @a this.
   void free() override;
 
@@ -769,6 +793,19 @@ HostDBRecord::is_ip_timeout() const
   return ip_age() >= ip_timeout_interval;
 }
 
+inline bool
+HostDBRecord::keep_on_failed_lookup() const
+{
+  return !is_ip_timeout() || serve_stale_but_revalidate();
+}
+
+inline bool
+HostDBRecord::is_ip_refresh_due() const
+{
+  return hostdb_refresh_ahead > 0 && record_type != HostDBType::HOST && !is_failed() && !is_ip_timeout() &&
+         ip_time_remaining().count() * 100 <= ip_timeout_interval.count() * std::min(hostdb_refresh_ahead, 100u);
+}
+
 inline bool
 HostDBRecord::is_ip_fail_timeout() const
 {
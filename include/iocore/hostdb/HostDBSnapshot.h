@@ -0,0 +1,65 @@
+/** @file
+
+  Snapshots of HostDB records, for a warm HostDB after a restart.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "swoc/swoc_file.h"
+
+#include "iocore/hostdb/HostDBProcessor.h"
+
+/** A compact binary image of HostDB address records.
+ *
+ * Only address records are kept, with their addresses, TTL and the up / down state of each address.
+ * The image is a header of magic, version and record count followed by the records, all in host
+ * byte order as a snapshot is only read by the host that wrote it.
+ */
+struct HostDBSnapshot {
+  static constexpr uint32_t MAGIC   = 0x48444253; ///< "HDBS"
+  static constexpr uint32_t VERSION = 1;
+
+  /** Write the snapshot of @a records to @a out.
+   *
+   * @return The number of records written.
+   */
+  static size_t write(std::string &out, std::vector<HostDBRecord::Handle> const &records);
+
+  /** Read the records of the snapshot in @a data.
+   *
+   * @param data The snapshot.
+   * @param records The records, marked as restored.
+   * @param max_rr Records with more addresses than this are skipped.
+   * @return @c false if @a data is not a complete snapshot of this version, in which case @a records is empty.
+   */
+  static bool read(std::string_view data, std::vector<HostDBRecord::Handle> &records, unsigned max_rr);
+
+  /** Replace the file at @a path with @a data.
+   *
+   * The data is written to a temporary file which is then renamed, so readers never see a partial snapshot.
+   */
+  static std::error_code save(swoc::file::path const &path, std::string_view data);
+};
@@ -29,6 +29,8 @@ using ts::Metrics;
 
 struct QuicStatsBlock {
   Metrics::Counter::AtomicType *total_packets_sent;
+  Metrics::Counter::AtomicType *total_packets_received;
+  Metrics::Counter::AtomicType *total_packets_forwarded;
 };
 
 extern QuicStatsBlock quic_rsb;
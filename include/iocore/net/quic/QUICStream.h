@@ -55,6 +55,7 @@ public:
   bool                              has_no_more_data() const;
 
   QUICOffset final_offset() const;
+  uint64_t   sent_bytes() const;
 
   void stop_sending(QUICStreamErrorUPtr error);
   void reset(QUICStreamErrorUPtr error);
@@ -27,7 +27,10 @@
 #include "iocore/net/quic/QUICApplicationMap.h"
 #include "iocore/net/quic/QUICContext.h"
 
+#include <vector>
+
 class QUICTransportParameters;
+typedef struct quiche_conn quiche_conn;
 
 class QUICStreamManager : public QUICStreamStateListener
 {
@@ -48,11 +51,19 @@ public:
 
   QUICStream *create_stream(QUICStreamId stream_id, QUICConnectionError &err);
 
-  QUICConnectionErrorUPtr create_uni_stream(QUICStreamId new_stream_id);
-  QUICConnectionErrorUPtr create_bidi_stream(QUICStreamId new_stream_id);
+  /// Open a stream of our own, @a new_stream_id is set to its id.
+  QUICConnectionErrorUPtr create_uni_stream(QUICStreamId &new_stream_id);
+  QUICConnectionErrorUPtr create_bidi_stream(QUICStreamId &new_stream_id);
   QUICConnectionErrorUPtr delete_stream(QUICStreamId new_stream_id);
   void                    reset_stream(QUICStreamId stream_id, QUICStreamErrorUPtr error);
 
+  /** Send the first data of the streams we opened.
+   *
+   * quiche only reports the streams it knows about as writable, and it learns about a stream we opened when its first bytes
+   * are sent.
+   */
+  void send_new_streams(quiche_conn *quiche_con);
+
   void set_default_application(QUICApplication *app);
 
   // QUICStreamStateListener
@@ -63,4 +74,11 @@ public:
 protected:
   QUICContext        *_context = nullptr;
   QUICApplicationMap *_app_map = nullptr;
+
+private:
+  QUICConnectionErrorUPtr _create_local_stream(QUICStreamId &new_stream_id, bool uni);
+
+  uint64_t                  _local_uni_stream_count  = 0;
+  uint64_t                  _local_bidi_stream_count = 0;
+  std::vector<QUICStreamId> _new_streams;
 };
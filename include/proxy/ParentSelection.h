@@ -50,6 +50,7 @@
 struct RequestData;
 struct matcher_line;
 struct ParentResult;
+struct HostRecord;
 struct OverridableHttpConfigParams;
 class ParentRecord;
 class ParentSelectionStrategy;
@@ -321,6 +322,9 @@ private:
   // state for consistent hash.
   int                   last_lookup;
   ATSConsistentHashIter chashIter[MAX_GROUP_RINGS];
+  bool                  maglev_init[MAX_GROUP_RINGS];
+  // next hop counted as in flight for this transaction.
+  HostRecord *inflight_host;
 
   friend class NextHopSelectionStrategy;
   friend class NextHopRoundRobin;
@@ -87,8 +87,9 @@ public:
   void set_private(bool new_private = true);
   bool is_private() const;
 
-  virtual void set_netvc(NetVConnection *newvc);
-  virtual bool is_multiplexing() const;
+  virtual void     set_netvc(NetVConnection *newvc);
+  virtual bool     is_multiplexing() const;
+  virtual uint32_t get_active_stream_count() const;
 
   // Keep track of connection limiting and a pointer to the
   // singleton that keeps track of the connection counts.
@@ -242,3 +243,9 @@ PoolableSession::is_multiplexing() const
 {
   return false;
 }
+
+inline uint32_t
+PoolableSession::get_active_stream_count() const
+{
+  return 0;
+}
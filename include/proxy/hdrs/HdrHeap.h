@@ -37,6 +37,8 @@
 #include "swoc/Scalar.h"
 #include "proxy/hdrs/HdrToken.h"
 
+#include <bit>
+
 // Objects in the heap must currently be aligned to 8 byte boundaries,
 // so their (address & HDR_PTR_ALIGNMENT_MASK) == 0
 
@@ -118,7 +120,19 @@ obj_init_header(HdrHeapObjImpl *obj, HdrHeapObjType type, uint32_t nbytes, uint3
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
-enum class HdrBufMagic : uint32_t { ALIVE = 0xabcdfeed, MARSHALED = 0xdcbafeed, DEAD = 0xabcddead, CORRUPT = 0xbadbadcc };
+/** Heap state.
+
+    A MARSHALED heap has its pointers replaced by offsets, each object type swizzles its own back. A MARSHALED_V2 heap is
+    followed by a bitmap with a bit for each pointer sized word of the objects that holds an offset, so unmarshalling adds
+    the heap address to the marked words without looking at the objects. Both are read, only MARSHALED_V2 is written.
+ */
+enum class HdrBufMagic : uint32_t {
+  ALIVE        = 0xabcdfeed,
+  MARSHALED    = 0xdcbafeed,
+  MARSHALED_V2 = 0xdcba2eed,
+  DEAD         = 0xabcddead,
+  CORRUPT      = 0xbadbadcc
+};
 
 class HdrStrHeap : public RefCountObj
 {
@@ -199,6 +213,16 @@ public:
   int unmarshal_size() const; // TBD - change this name, it's confusing.
   // One option - overload marshal_length to return this value if @a magic is HdrBufMagic::MARSHALED.
 
+  /// Offset of the relocation bitmap of a HdrBufMagic::MARSHALED_V2 heap, it follows the strings.
+  int marshal_reloc_offset() const;
+  /// Size of the relocation bitmap for @a obj_size bytes of objects.
+  static int marshal_reloc_size(int obj_size);
+  /// Add @a offset to the words marked in the relocation bitmap of a HdrBufMagic::MARSHALED_V2 heap.
+  void unmarshal_relocs(intptr_t offset);
+
+  /// Bytes used by objects in this heap and the ones chained to it, the size a single heap needs to hold copies of them.
+  int obj_size() const;
+
   void inherit_string_heaps(const HdrHeap *inherit_from);
   int  attach_block(IOBufferBlock *b, const char *use_start);
   void set_ronly_str_heap_end(int slot, const char *end);
@@ -339,12 +363,59 @@ HdrHeap::free_string(const char *s, int len)
   }
 }
 
+inline int
+HdrHeap::marshal_reloc_offset() const
+{
+  return HdrHeapMarshalBlocks(swoc::round_up(m_size + m_ronly_heap[0].m_heap_len));
+}
+
+inline int
+HdrHeap::marshal_reloc_size(int obj_size)
+{
+  int nbits = obj_size / HDR_PTR_SIZE;
+  return (nbits + 63) / 64 * sizeof(uint64_t);
+}
+
+inline void
+HdrHeap::unmarshal_relocs(intptr_t offset)
+{
+  char           *objs   = reinterpret_cast<char *>(this) + HDR_HEAP_HDR_SIZE;
+  uint64_t const *bits   = reinterpret_cast<uint64_t const *>(reinterpret_cast<char *>(this) + marshal_reloc_offset());
+  size_t          nbits  = (m_size - HDR_HEAP_HDR_SIZE.value()) / HDR_PTR_SIZE;
+  size_t          nwords = (nbits + 63) / 64;
+
+  for (size_t i = 0; i < nwords; ++i) {
+    uint64_t w = bits[i];
+    // Ignore bits past the objects in case the bitmap is damaged
+    if (i == nwords - 1 && nbits % 64) {
+      w &= (uint64_t{1} << (nbits % 64)) - 1;
+    }
+    for (; w; w &= w - 1) {
+      auto word  = reinterpret_cast<intptr_t *>(objs + (i * 64 + std::countr_zero(w)) * HDR_PTR_SIZE);
+      *word     += offset;
+    }
+  }
+}
+
 inline int
 HdrHeap::unmarshal_size() const
 {
+  if (m_magic == HdrBufMagic::MARSHALED_V2) {
+    return marshal_reloc_offset() + marshal_reloc_size(m_size - HDR_HEAP_HDR_SIZE.value());
+  }
   return m_size + m_ronly_heap[0].m_heap_len;
 }
 
+inline int
+HdrHeap::obj_size() const
+{
+  int size = 0;
+  for (const HdrHeap *h = this; h; h = h->m_next) {
+    size += h->m_free_start - h->m_data_start;
+  }
+  return size;
+}
+
 //
 struct MarshalXlate {
   char const *start  = nullptr;
@@ -353,6 +424,27 @@ struct MarshalXlate {
   MarshalXlate() {}
 };
 
+/** Relocation bitmap of the heap being marshalled by HdrHeap::marshal.
+
+    The marshal macros mark every pointer they turn into an offset. Nothing is marked if @a bits is not set.
+ */
+struct MarshalRelocs {
+  char     *base = nullptr; ///< First marshalled object.
+  uint64_t *bits = nullptr;
+
+  void
+  mark(void const *ptr)
+  {
+    if (bits) {
+      size_t word = (static_cast<char const *>(ptr) - base) / HDR_PTR_SIZE;
+      ink_assert((reinterpret_cast<uintptr_t>(ptr) & HDR_PTR_ALIGNMENT_MASK) == 0);
+      bits[word / 64] |= uint64_t{1} << (word % 64);
+    }
+  }
+};
+
+extern thread_local MarshalRelocs hdr_marshal_relocs;
+
 struct HeapCheck {
   char const *start;
   char const *end;
@@ -373,6 +465,7 @@ struct HeapCheck {
     if (found == 0) {                                         \
       return -1;                                              \
     }                                                         \
+    hdr_marshal_relocs.mark(&(ptr));                          \
   }
 
 // Nasty macro to do string marshalling
@@ -387,6 +480,7 @@ struct HeapCheck {
     if (found == 0) {                                       \
       return -1;                                            \
     }                                                       \
+    hdr_marshal_relocs.mark(&(ptr));                        \
   }
 
 #define HDR_MARSHAL_PTR(ptr, type, table, nentries)                       \
@@ -403,6 +497,7 @@ struct HeapCheck {
     if (found == 0) {                                                     \
       return -1;                                                          \
     }                                                                     \
+    hdr_marshal_relocs.mark(&(ptr));                                      \
   }
 
 #define HDR_MARSHAL_PTR_1(ptr, type, table)                             \
@@ -416,6 +511,7 @@ struct HeapCheck {
     if (found == 0) {                                                   \
       return -1;                                                        \
     }                                                                   \
+    hdr_marshal_relocs.mark(&(ptr));                                    \
   }
 
 #define HDR_UNMARSHAL_STR(ptr, offset) \
@@ -509,4 +605,18 @@ HdrHeapSDKHandle::set(const HdrHeapSDKHandle *from)
 
 HdrHeap *new_HdrHeap(int size = HdrHeap::DEFAULT_SIZE);
 
+/** Bytes moved by the header copy functions on this thread.
+
+    Copying a header copies its heap objects. The strings are referenced through the read-only string heap slots of the
+    destination and only copied if those run out and the string heaps have to be coalesced. The counters only grow, take
+    the difference around a copy to see what it cost.
+ */
+struct HdrCopyStats {
+  uint64_t obj_bytes    = 0; ///< Heap object bytes copied.
+  uint64_t str_bytes    = 0; ///< String bytes copied or allocated in a read-write string heap.
+  uint64_t shared_bytes = 0; ///< String bytes referenced through a read-only string heap instead of being copied.
+};
+
+extern thread_local HdrCopyStats hdr_copy_stats;
+
 void hdr_heap_test();
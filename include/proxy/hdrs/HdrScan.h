@@ -0,0 +1,77 @@
+/** @file
+
+  Vectorized character class scanning for the HTTP/MIME parsers
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+/** Implementation used by the hdr_scan functions.
+
+    AUTO picks the widest one the CPU supports. Every mode gives the same results as the ParseRules character classes, the
+    vector modes only look at 16 (SSE4.2) or 32 (AVX2) bytes at a time.
+ */
+enum class HdrScanMode {
+  AUTO,
+  SCALAR,
+  SSE42,
+  AVX2,
+};
+
+struct HdrScanFuncs {
+  const char *(*find_lf)(const char *s, const char *e, bool &nul_seen);
+  bool (*has_control)(const char *s, const char *e);
+  bool (*is_field_name)(const char *s, const char *e);
+};
+
+extern HdrScanFuncs hdr_scan_funcs;
+
+/** Select the scanning implementation. Called by mime_init(), the scalar one is used until then.
+
+    @return @c false if the CPU does not support @a mode, the current mode is kept in that case.
+ */
+bool        hdr_scan_init(HdrScanMode mode = HdrScanMode::AUTO);
+HdrScanMode hdr_scan_mode();
+const char *hdr_scan_mode_name(HdrScanMode mode);
+
+/** Find the first LF in [s, e).
+
+    @a nul_seen is set if there is a NUL before it. @a nul_seen is never cleared so a line can be scanned in pieces.
+    @return The LF or @a e if there is none.
+ */
+inline const char *
+hdr_scan_find_lf(const char *s, const char *e, bool &nul_seen)
+{
+  return hdr_scan_funcs.find_lf(s, e, nul_seen);
+}
+
+/// @return @c true if any of [s, e) is a control character, see ParseRules::is_control.
+inline bool
+hdr_scan_has_control(const char *s, const char *e)
+{
+  return hdr_scan_funcs.has_control(s, e);
+}
+
+/// @return @c true if all of [s, e) are valid in a field name, see ParseRules::is_http_field_name.
+inline bool
+hdr_scan_is_field_name(const char *s, const char *e)
+{
+  return hdr_scan_funcs.is_field_name(s, e);
+}
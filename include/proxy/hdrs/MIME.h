@@ -304,7 +304,11 @@ struct MIMEHdrImpl : public HdrHeapObjImpl {
     friend struct MIMEHdrImpl;
   };
 
-  // HdrHeapObjImpl is 4 bytes, so this will result in 4 bytes padding
+  // HdrHeapObjImpl is 4 bytes, so this fills what would be 4 bytes of padding.
+  // One bit per dup head name hash, see mime_field_name_filter_mask(). Deleting a field does not clear its bit, so a set
+  // bit only means the name may be present. It is not part of the marshalled format, older versions leave padding here,
+  // so it is rebuilt when the header is unmarshalled.
+  uint32_t m_name_filter;
   uint64_t m_presence_bits;
   uint32_t m_slot_accelerators[4];
 
@@ -327,6 +331,7 @@ struct MIMEHdrImpl : public HdrHeapObjImpl {
   // Cooked values
   void recompute_cooked_stuff(MIMEField *changing_field_or_null = nullptr);
   void recompute_accelerators_and_presence_bits();
+  void recompute_name_filter();
 
   // Utility
   /// Iterator for first field.
@@ -715,6 +720,7 @@ void     mime_hdr_presence_set(MIMEHdrImpl *h, const char *well_known_str);
 void     mime_hdr_presence_set(MIMEHdrImpl *h, int well_known_str_index);
 void     mime_hdr_presence_unset(MIMEHdrImpl *h, const char *well_known_str);
 void     mime_hdr_presence_unset(MIMEHdrImpl *h, int well_known_str_index);
+uint32_t mime_field_name_filter_mask(std::string_view name);
 
 void mime_hdr_sanity_check(MIMEHdrImpl *mh);
 
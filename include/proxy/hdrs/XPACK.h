@@ -25,6 +25,7 @@
 
 #include <cstdint>
 #include <string_view>
+#include <unordered_map>
 #include "tscore/Arena.h"
 
 const static int XPACK_ERROR_COMPRESSION_ERROR   = -1;
@@ -225,6 +226,7 @@ public:
   void                    unref_entry(uint32_t index);
   bool                    is_empty() const;
   uint32_t                largest_index() const;
+  uint32_t                insert_count() const;
   uint32_t                count() const;
 
 private:
@@ -269,4 +271,33 @@ private:
    * offset references the first entry in the buffer.
    */
   uint32_t _calc_index(uint32_t base, int64_t offset) const;
+
+  /** Grow @a _entries so that it can hold up to @a new_max_entries entries.
+   *
+   * The circular buffer is linearized while being copied, so the absolute
+   * indices of the existing entries are preserved.
+   */
+  void _expand_entries(uint32_t new_max_entries);
+
+  /** Hash index over the live entries.
+   *
+   * Both maps point at the absolute index of the newest entry that has the
+   * hashed name (or name and value). A hit is always verified against
+   * @a _storage, so hash collisions cost a missed match but never a wrong one.
+   */
+  using Index = std::unordered_map<uint64_t, uint32_t>;
+  Index _name_index;
+  Index _field_index;
+
+  static uint64_t _hash_name(std::string_view name);
+  static uint64_t _hash_field(std::string_view name, std::string_view value);
+
+  /** Add the entry at @a pos to the hash index. */
+  void _index_entry(uint32_t pos);
+
+  /** Remove the entry at @a pos from the hash index if it is still the indexed one. */
+  void _unindex_entry(uint32_t pos);
+
+  /** Verify the entry for @a absolute_index is live and has the given name (and value). */
+  bool _entry_matches(uint32_t absolute_index, std::string_view name, const std::string_view *value) const;
 };
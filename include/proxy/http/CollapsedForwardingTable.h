@@ -0,0 +1,168 @@
+/** @file
+
+  The cache writes that other transactions wait on for collapsed forwarding.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/CryptoHash.h"
+#include "tscore/ink_assert.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/** The leaders of cache writes and the transactions waiting on them, by cache key.
+
+    A transaction that gets the write lock for an object becomes its leader. The transactions that would otherwise poll the
+    cache until the write goes away wait on the leader instead, and the leader wakes them when it releases the key.
+
+    The keys are spread over partitions with a lock each, so transactions on different objects rarely contend. The callbacks
+    of @c wait, @c leave and @c release are called with the lock of the key held, the state they change in a transaction is
+    protected by it.
+
+    @a T is the transaction type, the table only keeps pointers to it.
+ */
+template <typename T> class CollapsedForwardingTable
+{
+public:
+  static constexpr int PARTITIONS = 64;
+
+  /// The result of @c wait.
+  enum class Wait {
+    WAITING,   ///< Added to the waiters of the leader.
+    NO_LEADER, ///< The key has no leader, or @a waiter is the leader.
+    FULL,      ///< The leader already has the maximum number of waiters.
+  };
+
+  /// Make @a leader the leader of @a key. @return @c false if the key already has a leader.
+  bool
+  lead(CryptoHash const &key, T *leader)
+  {
+    Partition      &part = _partition(key);
+    std::lock_guard lock(part.mutex);
+    Entry          &entry = part.entries[key];
+    if (entry.leader != nullptr) {
+      return false;
+    }
+    entry.leader = leader;
+    return true;
+  }
+
+  /** Wait on the leader of @a key, unless it has @a max_waiters already.
+
+      @a on_wait is called with the leader when @a waiter is added.
+   */
+  template <typename F>
+  Wait
+  wait(CryptoHash const &key, T *waiter, size_t max_waiters, F &&on_wait)
+  {
+    Partition      &part = _partition(key);
+    std::lock_guard lock(part.mutex);
+    auto            spot = part.entries.find(key);
+    if (spot == part.entries.end() || spot->second.leader == waiter) {
+      return Wait::NO_LEADER;
+    }
+    if (spot->second.waiters.size() >= max_waiters) {
+      return Wait::FULL;
+    }
+    spot->second.waiters.push_back(waiter);
+    on_wait(spot->second.leader);
+    return Wait::WAITING;
+  }
+
+  /** Stop waiting on the leader of @a key.
+
+      @a on_leave is called with @c true if @a waiter was still waiting, @c false if the leader already woke it.
+   */
+  template <typename F>
+  void
+  leave(CryptoHash const &key, T *waiter, F &&on_leave)
+  {
+    Partition      &part = _partition(key);
+    std::lock_guard lock(part.mutex);
+    bool            removed = false;
+    if (auto spot = part.entries.find(key); spot != part.entries.end()) {
+      auto &waiters = spot->second.waiters;
+      if (auto w = std::find(waiters.begin(), waiters.end(), waiter); w != waiters.end()) {
+        waiters.erase(w);
+        removed = true;
+      }
+    }
+    on_leave(removed);
+  }
+
+  /** Remove @a leader from @a key and wake its waiters, @a wake is called for each.
+
+      @return The number of waiters woken.
+   */
+  template <typename F>
+  size_t
+  release(CryptoHash const &key, T *leader, F &&wake)
+  {
+    Partition      &part = _partition(key);
+    std::lock_guard lock(part.mutex);
+    auto            spot = part.entries.find(key);
+    ink_assert(spot != part.entries.end() && spot->second.leader == leader);
+    if (spot == part.entries.end() || spot->second.leader != leader) {
+      return 0;
+    }
+
+    size_t n = spot->second.waiters.size();
+    for (T *waiter : spot->second.waiters) {
+      wake(waiter);
+    }
+    part.entries.erase(spot);
+    return n;
+  }
+
+private:
+  struct Entry {
+    T               *leader = nullptr;
+    std::vector<T *> waiters;
+  };
+
+  struct Hasher {
+    size_t
+    operator()(CryptoHash const &hash) const
+    {
+      return hash.fold();
+    }
+  };
+
+  struct Partition {
+    std::mutex                                    mutex;
+    std::unordered_map<CryptoHash, Entry, Hasher> entries;
+  };
+
+  Partition &
+  _partition(CryptoHash const &key)
+  {
+    // The map hashes all the words of the key, the partition only one of them.
+    return _partitions[key.u64[0] % PARTITIONS];
+  }
+
+  std::array<Partition, PARTITIONS> _partitions;
+};
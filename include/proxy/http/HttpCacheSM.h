@@ -88,6 +88,13 @@ public:
   void reset();
   void cancel_pending_action();
 
+  /** Wake the transactions waiting on our cache write.
+
+      Called once the response header is handed to the cache write, from then on the waiters can read while we write, and when the
+      write goes away.
+   */
+  void collapse_release();
+
   Action *open_read(const HttpCacheKey *key, URL *url, HTTPHdr *hdr, const OverridableHttpConfigParams *params,
                     time_t pin_in_cache);
 
@@ -190,6 +197,7 @@ public:
   void
   abort_write()
   {
+    collapse_release();
     if (cache_write_vc) {
       Metrics::Gauge::decrement(http_rsb.current_cache_connections);
       cache_write_vc->do_io_close(0); // passing zero as aborting write is not an error
@@ -200,6 +208,7 @@ public:
   void
   close_write()
   {
+    collapse_release();
     if (cache_write_vc) {
       Metrics::Gauge::decrement(http_rsb.current_cache_connections);
       cache_write_vc->do_io_close();
@@ -275,6 +284,16 @@ private:
   void   _schedule_read_retry();
   Event *_read_retry_event = nullptr;
 
+  // Collapsed forwarding, a transaction that would retry the read of an object being written waits on the writer instead.
+  void _collapse_lead();
+  bool _collapse_wait();
+  void _collapse_leave(Event *e);
+
+  bool       _collapse_leader = false;
+  EThread   *_collapse_thread = nullptr; // set while waiting or woken
+  Event     *_collapse_event  = nullptr; // protected by the collapsed forwarding table lock
+  CryptoHash _collapse_key;
+
   Action *do_cache_open_read(const HttpCacheKey &);
 
   bool write_retry_done() const;
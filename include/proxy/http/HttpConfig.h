@@ -99,8 +99,16 @@ struct HttpStatsBlock {
   Metrics::Gauge::AtomicType   *background_fill_current_count;
   Metrics::Counter::AtomicType *background_fill_total_count;
   Metrics::Counter::AtomicType *broken_server_connections;
+  Metrics::Counter::AtomicType *cache_collapsed_leaders;
+  Metrics::Counter::AtomicType *cache_collapsed_overflows;
+  Metrics::Counter::AtomicType *cache_collapsed_timeouts;
+  Metrics::Counter::AtomicType *cache_collapsed_waits;
+  Metrics::Counter::AtomicType *cache_collapsed_wakeups;
   Metrics::Counter::AtomicType *cache_deletes;
   Metrics::Counter::AtomicType *cache_hit_fresh;
+  Metrics::Counter::AtomicType *cache_hit_fresh_fast_path;
+  Metrics::Counter::AtomicType *cache_hit_hdr_copied_bytes;
+  Metrics::Counter::AtomicType *cache_hit_hdr_shared_bytes;
   Metrics::Counter::AtomicType *cache_hit_ims;
   Metrics::Counter::AtomicType *cache_hit_mem_fresh;
   Metrics::Counter::AtomicType *cache_hit_reval;
@@ -301,6 +309,9 @@ struct HttpStatsBlock {
   Metrics::Counter::AtomicType *total_transactions_time;
   Metrics::Counter::AtomicType *total_x_redirect;
   Metrics::Counter::AtomicType *trace_requests;
+  Metrics::Counter::AtomicType *transaction_allocator_allocations;
+  Metrics::Counter::AtomicType *transaction_arena_allocations;
+  Metrics::Counter::AtomicType *transaction_arena_heap_blocks;
   Metrics::Gauge::AtomicType   *tunnel_current_active_connections;
   Metrics::Counter::AtomicType *tunnels;
   Metrics::Counter::AtomicType *ua_begin_time;
@@ -778,6 +789,12 @@ public:
 
   MgmtInt accept_no_activity_timeout = 120;
 
+  MgmtInt collapsed_forwarding_max_waiters = 0;
+  MgmtInt collapsed_forwarding_timeout     = 1000; // time in mseconds
+
+  MgmtByte state_timing       = 0;
+  MgmtInt  state_trace_sample = 0;
+
   ///////////////////////////////////////////////////////////////////
   // Privacy: fields which are removed from the user agent request //
   ///////////////////////////////////////////////////////////////////
@@ -38,6 +38,7 @@
 #include "iocore/eventsystem/EventSystem.h"
 #include "proxy/http/HttpCacheSM.h"
 #include "proxy/http/HttpTransact.h"
+#include "proxy/http/HttpStateTrace.h"
 #include "proxy/http/HttpUserAgent.h"
 #include "proxy/http/HttpVCTable.h"
 #include "proxy/http/remap/UrlRewrite.h"
@@ -266,6 +267,8 @@ public:
   // Functions for manipulating api hooks
   void     txn_hook_add(TSHttpHookID id, INKContInternal *cont);
   APIHook *txn_hook_get(TSHttpHookID id);
+  // Whether there is any global, session or transaction hook for @a id
+  bool has_api_hooks(TSHttpHookID id) const;
 
   bool is_private() const;
   bool is_redirect_required();
@@ -531,6 +534,7 @@ public:
 
   TransactionMilestones milestones;
   ink_hrtime            api_timer = 0;
+  HttpStateTrace        state_trace;
   // The next two enable plugins to tag the state machine for
   // the purposes of logging so the instances can be correlated
   // with the source plugin.
@@ -571,6 +575,9 @@ private:
   int            cur_hooks        = 0;
   HttpApiState_t callout_state    = HttpApiState_t::NO_CALLOUT;
 
+  // Allocator blocks taken while handling events, see main_handler()
+  uint64_t allocator_allocs = 0;
+
   // api_hooks must not be changed directly
   //  Use txn_hook_{ap,pre}pend so hooks_set is
   //  updated
@@ -738,6 +745,13 @@ HttpSM::txn_hook_get(TSHttpHookID id)
   return api_hooks.get(id);
 }
 
+inline bool
+HttpSM::has_api_hooks(TSHttpHookID id) const
+{
+  return hooks_set &&
+         HttpHookState::has_hooks(id, http_global_hooks, _ua.get_txn() ? _ua.get_txn()->feature_hooks() : nullptr, &api_hooks);
+}
+
 inline bool
 HttpSM::is_transparent_passthrough_allowed()
 {
@@ -88,7 +88,8 @@ public:
   /** Get a session from the pool.
 
       The session is selected based on @a match_style equivalently to @a match. If found the session
-      is removed from the pool.
+      is removed from the pool, unless it is multiplexing. Among matching multiplexing sessions the one
+      with the fewest active streams is selected.
 
       @return A pointer to the session or @c NULL if not matching session was found.
   */
@@ -0,0 +1,89 @@
+/** @file
+
+  Per state timing of the HTTP state machine
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_hrtime.h"
+#include "proxy/http/HttpTransact.h"
+
+/** Time spent in each HttpTransact decision and in the state it chose.
+
+    A state starts when an HttpTransact call returns its next action and ends when the state machine calls HttpTransact
+    again, or when the transaction finishes. With proxy.config.http.state_timing.enabled the state times go to a histogram
+    per state and the decision times to a counter per state. One transaction in
+    proxy.config.http.state_timing.trace_sample also keeps the sequence of states for the @c ctst log field.
+ */
+class HttpStateTrace
+{
+public:
+  using Action = HttpTransact::StateMachineAction_t;
+
+  /// Number of state actions, StateMachineAction_t::REDIRECT_READ is the last one.
+  static constexpr int ACTIONS = static_cast<int>(Action::REDIRECT_READ) + 1;
+  /// State time buckets, the first one is under 10us and each of the others starts ten times higher than the one before.
+  static constexpr int BUCKETS = 7;
+  /// States kept for the log field, later ones are only counted in the metrics.
+  static constexpr int ENTRIES = 32;
+
+  /// Create the metrics if @a enabled, called once by HttpConfig::startup.
+  static void startup(bool enabled);
+
+  /// Start tracing the transaction @a sm_id.
+  void start(int64_t sm_id, const HttpConfigParams *params);
+
+  /// The HttpTransact call from @a decide_start to @a decide_end chose @a action, which ends the current state.
+  void enter(Action action, ink_hrtime decide_start, ink_hrtime decide_end);
+
+  /// End the current state at @a now.
+  void finish(ink_hrtime now);
+
+  /** Print the kept states as "name:decision_ns:state_us" separated by commas.
+
+      @return The length of the trace, 0 if the transaction is not sampled. The output is truncated to @a len - 1 bytes
+      and is always terminated.
+   */
+  int print(char *buf, int len) const;
+
+  bool
+  is_enabled() const
+  {
+    return _timing || _sampled;
+  }
+
+private:
+  void _end_state(ink_hrtime now);
+
+  struct Entry {
+    Action   action;
+    uint32_t decision_ns;
+    uint32_t state_us;
+  };
+
+  bool       _timing  = false;
+  bool       _sampled = false;
+  Action     _current = Action::UNDEFINED;
+  ink_hrtime _start   = 0;
+  int        _count   = 0;  ///< Entries used.
+  int        _entry   = -1; ///< Entry of the current state, -1 if it is not kept.
+  Entry      _entries[ENTRIES];
+};
@@ -667,7 +667,12 @@ public:
     std::string         http_return_code_setter_name;
     CacheAuth_t         www_auth_content = CacheAuth_t::NONE;
 
-    Arena arena;
+    // Storage for the arena. A transaction stores the request and server host names, maybe a parent name, and the
+    // handles of the cached headers given to plugins. With names of up to 64 bytes that is at most 228 bytes, including
+    // the 24 byte block header. Anything more goes to a heap block, see proxy.process.http.transaction_arena_heap_blocks.
+    static constexpr size_t ARENA_INLINE_SIZE = 256;
+    alignas(double) char    arena_buffer[ARENA_INLINE_SIZE];
+    Arena                   arena{arena_buffer, sizeof(arena_buffer)};
 
     bool force_dns                    = false;
     bool is_upgrade_request           = false;
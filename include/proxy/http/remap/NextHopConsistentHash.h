@@ -26,6 +26,7 @@
 #include <map>
 #include <vector>
 #include "tscore/HashSip.h"
+#include "tsutil/Metrics.h"
 #include "proxy/http/remap/NextHopSelectionStrategy.h"
 
 enum class NHHashKeyType {
@@ -39,19 +40,35 @@ enum class NHHashKeyType {
 
 enum class NHHashUrlType { REQUEST = 0, CACHE, PARENT };
 
+enum class NHHashSelection {
+  RING = 0,     // default, the host after the hash on the ring.
+  BOUNDED_LOAD, // the ring, skipping hosts with more than their share of the in flight transactions.
+  MAGLEV        // a lookup table for the first choice, the ring for retries.
+};
+
 class NextHopConsistentHash : public NextHopSelectionStrategy
 {
   std::vector<std::shared_ptr<ATSConsistentHash>> rings;
+  std::vector<std::vector<uint32_t>>              maglev_tables; // host index for each slot, one table per group.
+  std::vector<float>                              group_weights; // sum of the host weights in each group.
+  ts::Metrics::Gauge::AtomicType                 *load_skew = nullptr;
 
   uint64_t getHashKey(uint64_t sm_id, const HttpRequestData &hrdata, ATSHash64 *h);
+  void     buildMaglevTable(uint32_t group, ATSHash64 *h);
+  float    hostShare(const HostRecord &host) const;
+  bool     isOverloaded(const HostRecord &host) const;
+  void     updateLoadSkew();
 
 public:
-  NHHashKeyType hash_key       = NHHashKeyType::PATH_HASH_KEY;
-  NHHashUrlType hash_url       = NHHashUrlType::REQUEST;
-  std::string   hash_algorithm = "siphash24"; // Default hash algorithm name
-  uint64_t      hash_seed0     = 0;           // First 64 bits of hash seed
-  uint64_t      hash_seed1     = 0;           // Second 64 bits of hash seed
-  int           hash_replicas  = 1024;        // Number of virtual nodes per host (int to match ATSConsistentHash constructor)
+  NHHashKeyType   hash_key          = NHHashKeyType::PATH_HASH_KEY;
+  NHHashUrlType   hash_url          = NHHashUrlType::REQUEST;
+  std::string     hash_algorithm    = "siphash24"; // Default hash algorithm name
+  uint64_t        hash_seed0        = 0;           // First 64 bits of hash seed
+  uint64_t        hash_seed1        = 0;           // Second 64 bits of hash seed
+  int             hash_replicas     = 1024; // Number of virtual nodes per host (int to match ATSConsistentHash constructor)
+  NHHashSelection hash_selection    = NHHashSelection::RING;
+  double          load_factor       = 1.25;  // bounded_load, how far above its share of the load a host may go.
+  uint32_t        maglev_table_size = 65537; // maglev, slots in each table, a prime.
 
   NextHopConsistentHash() = delete;
   NextHopConsistentHash(const std::string_view name, const NHPolicyType &policy, ts::Yaml::Map &n);
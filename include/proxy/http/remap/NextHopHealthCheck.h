@@ -0,0 +1,218 @@
+/** @file
+
+  Built in active health checks of next hop hosts.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "iocore/eventsystem/Continuation.h"
+#include "proxy/http/remap/NextHopSelectionStrategy.h"
+
+class Action;
+class HostDBRecord;
+class IOBufferReader;
+class MIOBuffer;
+class NetVConnection;
+class NextHopStrategyFactory;
+
+// Where and how one next hop host is checked.
+struct NHHealthCheckTarget {
+  NHHealthCheckType type = NHHealthCheckType::NONE;
+  std::string       host;
+  int               port = 0;
+  std::string       path = "/";
+  bool              tls  = false; // handshake before an HTTP check, always for TLS checks.
+
+  // Set up the check of @a host_rec, from the protocol for @a scheme or else the first protocol, using the
+  // host and port of its health_check_url when there is one.  @return false if there is nothing to check.
+  bool
+  init(const HostRecord &host_rec, NHSchemeType scheme, NHHealthCheckType check_type)
+  {
+    if (host_rec.protocols.empty() || check_type == NHHealthCheckType::NONE) {
+      return false;
+    }
+    const NHProtocol *proto = host_rec.protocols[0].get();
+    for (auto const &p : host_rec.protocols) {
+      if (p->scheme == scheme) {
+        proto = p.get();
+        break;
+      }
+    }
+    type = check_type;
+    host = host_rec.hostname;
+    port = proto->port;
+    tls  = proto->scheme == NHSchemeType::HTTPS;
+    if (!proto->health_check_url.empty() && !parse_url(proto->health_check_url)) {
+      return false;
+    }
+    if (type == NHHealthCheckType::TLS) {
+      tls = true;
+    } else if (type == NHHealthCheckType::TCP) {
+      tls = false;
+    }
+    return !host.empty() && port > 0 && port <= 65535;
+  }
+
+  // Take the host, port and path from @a url, scheme://host[:port][/path].  @return false if it is malformed.
+  bool
+  parse_url(std::string_view url)
+  {
+    if (auto sep = url.find("://"); sep != std::string_view::npos) {
+      std::string_view scheme = url.substr(0, sep);
+      if (scheme == "https" || scheme == "tls") {
+        tls  = true;
+        port = 443;
+      } else if (scheme == "http" || scheme == "tcp") {
+        tls  = false;
+        port = 80;
+      } else {
+        return false;
+      }
+      url.remove_prefix(sep + 3);
+    }
+
+    auto             slash     = url.find('/');
+    std::string_view authority = url.substr(0, slash);
+    path                       = slash == std::string_view::npos ? "/" : std::string{url.substr(slash)};
+
+    if (!authority.empty() && authority.front() == '[') {
+      auto close = authority.find(']');
+      if (close == std::string_view::npos) {
+        return false;
+      }
+      host = authority.substr(1, close - 1);
+      authority.remove_prefix(close + 1);
+    } else {
+      auto colon = authority.rfind(':');
+      host       = authority.substr(0, colon);
+      authority.remove_prefix(colon == std::string_view::npos ? authority.size() : colon);
+    }
+    if (!authority.empty()) {
+      if (authority.front() != ':') {
+        return false;
+      }
+      authority.remove_prefix(1);
+      auto [ptr, ec] = std::from_chars(authority.data(), authority.data() + authority.size(), port);
+      if (ec != std::errc() || ptr != authority.data() + authority.size()) {
+        return false;
+      }
+    }
+    return !host.empty();
+  }
+
+  // Hosts with the same key share one check.
+  std::string
+  key() const
+  {
+    return std::to_string(static_cast<int>(type)) + (tls ? "s:" : ":") + host + ":" + std::to_string(port) + path;
+  }
+};
+
+// Consecutive check results, which set the state of a host once they reach a threshold.  Until then the
+// state is unknown, which leaves the host as it is; a reload may have left it marked down by earlier checks.
+class NHHealthCheckCounter
+{
+public:
+  enum class State { UNKNOWN, UP, DOWN };
+
+  NHHealthCheckCounter(int healthy_threshold, int unhealthy_threshold)
+    : _healthy_threshold(healthy_threshold), _unhealthy_threshold(unhealthy_threshold)
+  {
+  }
+
+  // Count the result of a check, @return true if the host state was just set.
+  bool
+  record(bool passed)
+  {
+    if (passed) {
+      _failed = 0;
+      if (_state != State::UP && ++_passed >= _healthy_threshold) {
+        _state  = State::UP;
+        _passed = 0;
+        return true;
+      }
+    } else {
+      _passed = 0;
+      if (_state != State::DOWN && ++_failed >= _unhealthy_threshold) {
+        _state  = State::DOWN;
+        _failed = 0;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  State
+  state() const
+  {
+    return _state;
+  }
+
+private:
+  int   _healthy_threshold;
+  int   _unhealthy_threshold;
+  int   _passed = 0;
+  int   _failed = 0;
+  State _state  = State::UNKNOWN;
+};
+
+// Periodic check of one target, which marks its hosts up and down in HostStatus and the strategies' host records.
+// A check runs on ET_NET threads without blocking: the host is looked up in HostDB, the connection, handshake and
+// request go through the net processor, and the timeout is an event.
+class NextHopHealthCheck : public Continuation
+{
+public:
+  NextHopHealthCheck(const NHHealthCheckTarget &target, const HealthChecks &cfg, std::shared_ptr<std::atomic<bool>> running);
+
+  // Schedule a check for each distinct target of the strategies in @a factory with active health checks.  The
+  // checks end once NextHopStrategyFactory::stopActiveHealthChecks() is called.
+  static void start(NextHopStrategyFactory &factory);
+
+private:
+  int  check_event(int event, void *data);
+  void start_check();
+  void connect(HostDBRecord *record);
+  void connect(IpEndpoint &addr);
+  void send_request();
+  void finish(bool passed);
+  void reset();
+  void mark(bool up, bool changed);
+
+  NHHealthCheckTarget                      _target;
+  NHHealthCheckCounter                     _counter;
+  int                                      _timeout;
+  std::vector<std::shared_ptr<HostRecord>> _hosts;
+  std::shared_ptr<std::atomic<bool>>       _running;
+
+  // The check in progress, which is running as long as its timeout is scheduled.
+  Event          *_timeout_event  = nullptr;
+  Action         *_pending_action = nullptr;
+  NetVConnection *_netvc          = nullptr;
+  MIOBuffer      *_buf            = nullptr; // the request, then the response
+  IOBufferReader *_reader         = nullptr;
+};
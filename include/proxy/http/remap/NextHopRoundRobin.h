@@ -24,19 +24,26 @@
 #pragma once
 
 #include <mutex>
+#include <vector>
+#include "tsutil/Metrics.h"
 #include "proxy/http/remap/NextHopSelectionStrategy.h"
 
 class NextHopRoundRobin : public NextHopSelectionStrategy
 {
   std::mutex _mutex;
   uint32_t   latched_index = 0;
+  // least_latency, the score of each host, by group and host index.
+  std::vector<std::vector<ts::Metrics::Gauge::AtomicType *>> scores;
+
+  uint32_t leastLatencyIndex(uint32_t group);
+  int64_t  updateScore(const HostRecord &host);
 
 public:
+  double ewma_weight = 0.3; // least_latency, the weight of the latest response time in the moving average.
+
   NextHopRoundRobin() = delete;
-  NextHopRoundRobin(const std::string_view &name, const NHPolicyType &policy, ts::Yaml::Map &n)
-    : NextHopSelectionStrategy(name, policy, n)
-  {
-  }
+  NextHopRoundRobin(const std::string_view &name, const NHPolicyType &policy, ts::Yaml::Map &n);
   ~NextHopRoundRobin();
   void findNextHop(TSHttpTxn txnp, void *ih = nullptr, time_t now = 0) override;
+  void recordResponseTime(TSHttpTxn txnp, ink_hrtime elapsed) override;
 };
@@ -60,17 +60,20 @@ struct NHHealthStatus {
 
 enum class NHPolicyType {
   UNDEFINED = 0,
-  FIRST_LIVE,     // first available nexthop
-  RR_STRICT,      // strict round robin
-  RR_IP,          // round robin by client ip.
-  RR_LATCHED,     // latched to available next hop.
-  CONSISTENT_HASH // consistent hashing strategy.
+  FIRST_LIVE,      // first available nexthop
+  RR_STRICT,       // strict round robin
+  RR_IP,           // round robin by client ip.
+  RR_LATCHED,      // latched to available next hop.
+  CONSISTENT_HASH, // consistent hashing strategy.
+  LEAST_LATENCY    // the better of two random next hops by response time and load.
 };
 
 enum class NHSchemeType { NONE = 0, HTTP, HTTPS };
 
 enum class NHRingMode { ALTERNATE_RING = 0, EXHAUST_RING, PEERING_RING };
 
+enum class NHHealthCheckType { NONE = 0, HTTP, TCP, TLS };
+
 // response codes container
 struct ResponseCodes {
   ResponseCodes(){};
@@ -95,6 +98,12 @@ struct ResponseCodes {
 struct HealthChecks {
   bool active  = false;
   bool passive = false;
+  // built in active checks, with NONE hosts are only marked down by external tools.
+  NHHealthCheckType type                = NHHealthCheckType::NONE;
+  int               interval            = 5; // seconds between checks of a host.
+  int               timeout             = 2; // seconds to wait for each step of a check.
+  int               healthy_threshold   = 2; // consecutive passed checks to mark a host up.
+  int               unhealthy_threshold = 3; // consecutive failed checks to mark a host down.
 };
 
 struct NHProtocol {
@@ -115,6 +124,8 @@ struct HostRecord : public ATSConsistentHashNode, public HostRecordCfg {
   std::atomic<time_t>   failedAt{0};
   std::atomic<uint32_t> failCount{0};
   std::atomic<time_t>   upAt{0};
+  std::atomic<int32_t>  inflight{0}; // transactions that selected this host and have not finished.
+  std::atomic<int64_t>  latency{0};  // moving average of the response time in microseconds, 0 until measured.
   int                   host_index{-1};
   int                   group_index{-1};
   bool                  self{false};
@@ -205,6 +216,31 @@ public:
 
   void retryComplete(TSHttpTxn txn, const char *hostname, const int port);
 
+  // A response, or a failure, from the next hop in the transaction's parent result after @a elapsed.
+  virtual void
+  recordResponseTime(TSHttpTxn /* txnp ATS_UNUSED */, ink_hrtime /* elapsed ATS_UNUSED */)
+  {
+  }
+
+  // Count @a host in flight for the transaction in @a result until releaseNextHop().
+  static void
+  holdNextHop(ParentResult &result, HostRecord *host)
+  {
+    releaseNextHop(result);
+    result.inflight_host = host;
+    ++host->inflight;
+  }
+
+  // Drop the in flight count taken when the next hop in @a result was selected.
+  static void
+  releaseNextHop(ParentResult &result)
+  {
+    if (result.inflight_host != nullptr) {
+      --result.inflight_host->inflight;
+      result.inflight_host = nullptr;
+    }
+  }
+
   std::string                                           strategy_name;
   bool                                                  go_direct          = true;
   bool                                                  parent_is_proxy    = true;
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <sstream>
 #include <unordered_map>
@@ -50,6 +51,25 @@ public:
   // counted and attached to an HttpSM.
   NextHopSelectionStrategy *strategyInstance(const char *name) const;
 
+  const std::unordered_map<std::string, NextHopSelectionStrategy *> &
+  strategies() const
+  {
+    return _strategies;
+  }
+
+  // Cleared to end the active health checks of these strategies, see NextHopHealthCheck.
+  std::shared_ptr<std::atomic<bool>>
+  activeHealthChecksRunning() const
+  {
+    return _health_checks_running;
+  }
+
+  void
+  stopActiveHealthChecks()
+  {
+    *_health_checks_running = false;
+  }
+
   bool strategies_loaded;
 
 private:
@@ -57,4 +77,5 @@ private:
   void        loadConfigFile(const std::string &file, std::stringstream &doc, std::unordered_set<std::string> &include_once);
   void        createStrategy(const std::string &name, const NHPolicyType policy_type, ts::Yaml::Map &node);
   std::unordered_map<std::string, NextHopSelectionStrategy *> _strategies;
+  std::shared_ptr<std::atomic<bool>>                          _health_checks_running = std::make_shared<std::atomic<bool>>(true);
 };
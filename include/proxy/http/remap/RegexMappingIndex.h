@@ -0,0 +1,94 @@
+/** @file
+
+    Literal prefilter for the host expressions of regex_map rules
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/** Find the regex_map rules that can match a host without running their expressions.
+
+    Most host expressions contain a literal that every host they match has to contain, such as ".example.com" in
+    "^(.*)\.example\.com$". The literals of all the rules are put in one Aho-Corasick automaton, so a single pass over the
+    request host finds every rule whose literal it contains. Only those rules, and the rules without a literal, have to run
+    their expression. They are returned in rule order so the first one that matches is still the one that wins.
+ */
+class RegexMappingIndex
+{
+public:
+  /// Rule numbers.
+  using Candidates = std::vector<int>;
+
+  /// Add the host expression of the next rule. Rules are numbered from 0 in the order they are added.
+  void add(std::string_view pattern);
+
+  /// Build the automaton, after the last rule is added.
+  void build();
+
+  /** Find the rules that can match @a host.
+
+      @return @c false if the index is not built, in which case every rule has to be tried. Otherwise @a candidates has the
+      rules that can match, in increasing order. It is cleared first, keeping its capacity, so it can be reused across lookups
+      to avoid allocating.
+   */
+  bool lookup(std::string_view host, Candidates &candidates) const;
+
+  /// @return The number of rules added.
+  int
+  size() const
+  {
+    return _rules;
+  }
+
+  /// @return The number of rules without a literal, that are tried for every host.
+  int
+  unindexed() const
+  {
+    return static_cast<int>(_unindexed.size());
+  }
+
+  /** The longest string that every match of @a pattern contains.
+
+      Only the top level of the expression is examined. Groups, classes and escapes end a literal, and an expression that
+      has a top level alternation or uses a construct that is not understood has none.
+
+      @return The literal, empty if there is none.
+   */
+  static std::string required_literal(std::string_view pattern);
+
+private:
+  struct Node {
+    std::vector<std::pair<char, int>> next;      ///< Child nodes by byte.
+    std::vector<int>                  rules;     ///< Rules with the literal that ends here.
+    int                               fail = 0;  ///< Longest proper suffix that is also in the automaton.
+    int                               dict = -1; ///< Closest node on the fail chain with rules, -1 if none.
+  };
+
+  int _child(int node, char c) const;
+
+  std::vector<Node> _nodes{1};
+  std::vector<int>  _unindexed; ///< Rules without a literal.
+  int               _rules = 0;
+  bool              _built = false;
+};
@@ -27,13 +27,16 @@
 #include "iocore/eventsystem/Freer.h"
 #include "proxy/http/remap/UrlMapping.h"
 #include "proxy/http/remap/UrlMappingPathIndex.h"
+#include "proxy/http/remap/RegexMappingIndex.h"
 #include "proxy/http/HttpTransact.h"
 #include "tsutil/Regex.h"
 #include "proxy/http/remap/PluginFactory.h"
 #include "proxy/http/remap/NextHopStrategyFactory.h"
 #include "proxy/http/remap/RemapConfig.h"
 
+#include <functional>
 #include <memory>
+#include <vector>
 
 #define URL_REMAP_FILTER_NONE         0x00000000
 #define URL_REMAP_FILTER_REFERER      0x00000001 /* enable "referer" header validation */
@@ -117,6 +120,23 @@ public:
     return _valid;
   };
 
+  /** Call @a cb once the table is deleted, after the last lease is released.
+
+      The table is deleted on an @c ET_TASK thread, and the callback is called there.
+   */
+  void
+  on_delete(std::function<void()> &&cb)
+  {
+    _on_delete = std::move(cb);
+  }
+
+  /** Start or stop the active health checks of the next hop strategies.
+
+      Only the table in use checks its hosts, a table that is still referenced by transactions after a reload does not.
+   */
+  void start_health_checks();
+  void stop_health_checks();
+
   /// @return  Number of rules defined.
   int
   rule_count() const
@@ -152,8 +172,10 @@ public:
   using RegexMappingList = Queue<RegexMapping>;
 
   struct MappingsStore {
-    std::unique_ptr<URLTable> hash_lookup;
-    RegexMappingList          regex_list;
+    std::unique_ptr<URLTable>   hash_lookup;
+    RegexMappingList            regex_list;
+    RegexMappingIndex           regex_index; ///< Rules of @a regex_list that can match a host.
+    std::vector<RegexMapping *> regex_rules; ///< @a regex_list by the rule numbers of @a regex_index.
     bool
     empty()
     {
@@ -171,6 +193,8 @@ public:
   {
     _destroyTable(store.hash_lookup);
     _destroyList(store.regex_list);
+    store.regex_index = RegexMappingIndex{};
+    store.regex_rules.clear();
   }
 
   bool InsertForwardMapping(mapping_type maptype, url_mapping *mapping, const char *src_host);
@@ -233,14 +257,15 @@ public:
   NextHopStrategyFactory *strategyFactory = nullptr;
 
 private:
-  bool              _valid               = false;
-  ACLBehaviorPolicy _acl_behavior_policy = ACLBehaviorPolicy::ACL_BEHAVIOR_LEGACY;
+  bool                  _valid               = false;
+  ACLBehaviorPolicy     _acl_behavior_policy = ACLBehaviorPolicy::ACL_BEHAVIOR_LEGACY;
+  std::function<void()> _on_delete;
 
   bool _mappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host, int request_host_len,
                       UrlMappingContainer &mapping_container);
   url_mapping *_tableLookup(std::unique_ptr<URLTable> &h_table, URL *request_url, int request_port, char *request_host,
                             int request_host_len);
-  bool         _regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
+  bool         _regexMappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host,
                                    int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container);
   int          _expandSubstitutions(size_t *matches_info, const RegexMapping *reg_map, const char *matched_string, char *dest_buf,
                                     int dest_buf_size);
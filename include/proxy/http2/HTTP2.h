@@ -76,6 +76,8 @@ const uint32_t HTTP2_PRIORITY_DEFAULT_STREAM_DEPENDENCY = 0;
 const uint8_t  HTTP2_PRIORITY_DEFAULT_WEIGHT            = 15;
 
 // Statistics
+constexpr int HTTP2_SERVER_STREAMS_PER_CONNECTION_BUCKETS = 8;
+
 struct Http2StatsBlock {
   Metrics::Gauge::AtomicType   *current_client_session_count;
   Metrics::Gauge::AtomicType   *current_server_session_count;
@@ -119,6 +121,7 @@ struct Http2StatsBlock {
   Metrics::Counter::AtomicType *window_update_frames_in;
   Metrics::Counter::AtomicType *continuation_frames_in;
   Metrics::Counter::AtomicType *unknown_frames_in;
+  Metrics::Counter::AtomicType *server_streams_per_connection[HTTP2_SERVER_STREAMS_PER_CONNECTION_BUCKETS];
 };
 
 extern Http2StatsBlock http2_rsb;
@@ -381,6 +384,9 @@ ParseResult http2_convert_header_from_2_to_1_1(HTTPHdr *);
 ParseResult http2_convert_header_from_1_1_to_2(HTTPHdr *);
 void        http2_init();
 
+/// Count an origin connection in the histogram of its peak number of concurrent streams.
+void http2_record_server_streams_per_connection(uint32_t streams);
+
 /** Each of these values correspond to the flow control policy described in or
  * records.yaml documentation for proxy.config.http2.flow_control.policy_in.
  */
@@ -121,6 +121,12 @@ public:
   virtual void add_session();
   virtual bool is_outbound() const;
 
+  /** Start the transaction of the request whose headers were received on @a stream.
+
+      By default the request is handed to a new HttpSM.
+   */
+  virtual void start_transaction(Http2Stream &stream, bool from_early_data);
+
   virtual void set_no_activity_timeout() = 0;
 
   void interrupt_reading_frames();
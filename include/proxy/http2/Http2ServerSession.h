@@ -87,8 +87,9 @@ public:
   Http2ServerSession(Http2ServerSession &)                  = delete;
   Http2ServerSession &operator=(const Http2ServerSession &) = delete;
 
-  bool is_multiplexing() const override;
-  bool is_outbound() const override;
+  bool     is_multiplexing() const override;
+  uint32_t get_active_stream_count() const override;
+  bool     is_outbound() const override;
 
   void set_netvc(NetVConnection *netvc) override;
 
@@ -101,6 +102,9 @@ private:
   IpEndpoint cached_local_addr;
 
   bool in_session_table = false;
+
+  // The most streams that were open at the same time on this connection
+  uint32_t _peak_stream_count = 0;
 };
 
 extern ClassAllocator<Http2ServerSession, false> http2ServerSessionAllocator;
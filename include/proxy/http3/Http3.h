@@ -53,6 +53,10 @@ struct Http3StatsBlock {
   Metrics::Counter::AtomicType *goaway_frames_in;
   Metrics::Counter::AtomicType *max_push_id;
   Metrics::Counter::AtomicType *unknown_frames_in;
+  Metrics::Counter::AtomicType *qpack_encoder_header_bytes_uncompressed;
+  Metrics::Counter::AtomicType *qpack_encoder_header_bytes_compressed;
+  Metrics::Counter::AtomicType *qpack_decoder_blocked_streams;
+  Metrics::Counter::AtomicType *qpack_decoder_blocked_time;
 };
 
 extern Http3StatsBlock               http3_rsb; // Container for statistics.
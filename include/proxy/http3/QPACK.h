@@ -24,6 +24,8 @@
 #pragma once
 
 #include <map>
+#include <set>
+#include <vector>
 
 #include "swoc/IntrusiveDList.h"
 
@@ -72,6 +74,9 @@ public:
 
   int cancel(uint64_t stream_id);
 
+  /*
+   * The QPACK that encodes writes the encoder stream and reads the decoder stream, the QPACK that decodes does the opposite.
+   */
   void set_encoder_stream(QUICStreamId id);
   void set_decoder_stream(QUICStreamId id);
 
@@ -107,6 +112,7 @@ private:
     DecodeRequest(uint16_t largest_reference, EThread *thread, Continuation *continuation, uint64_t stream_id,
                   const uint8_t *header_block, size_t header_block_len, HTTPHdr &hdr)
       : _largest_reference(largest_reference),
+        _blocked_at(ink_get_hrtime()),
         _thread(thread),
         _continuation(continuation),
         _stream_id(stream_id),
@@ -116,12 +122,19 @@ private:
     {
     }
 
+    /** The Required Insert Count of the header block. */
     uint16_t
     largest_reference() const
     {
       return this->_largest_reference;
     }
 
+    ink_hrtime
+    blocked_at() const
+    {
+      return this->_blocked_at;
+    }
+
     EThread *
     thread()
     {
@@ -175,6 +188,7 @@ private:
 
   private:
     uint16_t       _largest_reference;
+    ink_hrtime     _blocked_at;
     EThread       *_thread;
     Continuation  *_continuation;
     uint64_t       _stream_id;
@@ -187,11 +201,15 @@ private:
     DecodeRequest *_prev = nullptr;
   };
 
+  /** Dynamic table entries referred by the header blocks sent on a stream. */
   struct EntryReference {
-    uint16_t smallest;
-    uint16_t largest;
+    uint16_t              required_insert_count = 0;
+    std::vector<uint16_t> indices;
   };
 
+  /** Entries at least this many times smaller than the table capacity are worth inserting. */
+  static constexpr uint32_t ENTRY_SIZE_RATIO_TO_INSERT = 2;
+
   XpackDynamicTable                         _dynamic_table;
   std::map<uint64_t, struct EntryReference> _references;
   uint32_t                                  _max_field_section_size = 0;
@@ -207,9 +225,17 @@ private:
   swoc::IntrusiveDList<DecodeRequest::Linkage> _blocked_list;
   bool                                         _add_to_blocked_list(DecodeRequest *decode_request);
 
-  uint16_t _largest_known_received_index = 0;
-  void     _update_largest_known_received_index_by_insert_count(uint16_t insert_count);
-  void     _update_largest_known_received_index_by_stream_id(uint64_t stream_id);
+  // Encoder side: the number of inserts the decoder has acknowledged, and the streams whose header blocks may be blocked on the
+  // decoder because they refer entries that have not been acknowledged yet.
+  uint16_t           _known_received_count     = 0;
+  uint16_t           _announced_table_capacity = 0;
+  std::set<uint64_t> _blocking_streams;
+  void               _update_known_received_count_by_insert_count(uint16_t insert_count);
+  void               _update_known_received_count_by_stream_id(uint64_t stream_id);
+  void               _prune_blocking_streams();
+  bool               _can_block(uint64_t stream_id) const;
+  bool               _should_insert(size_t name_len, size_t value_len) const;
+  void               _update_encoder_table_capacity();
 
   void _update_reference_counts(uint64_t stream_id);
 
@@ -234,8 +260,9 @@ private:
   int _write_stream_cancellation(uint64_t stream_id);
 
   // Request and Push Streams
-  int _encode_prefix(uint16_t largest_reference, uint16_t base_index, IOBufferBlock *prefix);
-  int _encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock *compressed_header, uint16_t &referred_index);
+  int _encode_prefix(uint16_t required_insert_count, uint16_t base_index, IOBufferBlock *prefix);
+  int _encode_header(const MIMEField &field, uint16_t base_index, bool may_block, IOBufferBlock *compressed_header,
+                     uint16_t &required_insert_count);
   int _encode_indexed_header_field(uint16_t index, uint16_t base_index, bool dynamic_table, IOBufferBlock *compressed_header);
   int _encode_indexed_header_field_with_postbase_index(uint16_t index, uint16_t base_index, bool never_index,
                                                        IOBufferBlock *compressed_header);
@@ -246,16 +273,17 @@ private:
   int _encode_literal_header_field_with_postbase_name_ref(uint16_t index, uint16_t base_index, const char *value, int value_len,
                                                           bool never_index, IOBufferBlock *compressed_header);
 
-  void _decode(EThread *ethread, Continuation *cont, uint64_t stream_id, const uint8_t *header_block, size_t header_block_len,
-               HTTPHdr &hdr);
-  int  _decode_header(const uint8_t *header_block, size_t header_block_len, HTTPHdr &hdr);
-  int  _decode_indexed_header_field(int16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr, uint32_t &header_len);
-  int  _decode_indexed_header_field_with_postbase_index(int16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
+  void _decode(EThread *ethread, Continuation *cont, uint64_t stream_id, uint16_t required_insert_count,
+               const uint8_t *header_block, size_t header_block_len, HTTPHdr &hdr);
+  int  _decode_header(uint16_t required_insert_count, const uint8_t *header_block, size_t header_block_len, HTTPHdr &hdr);
+  int  _decode_required_insert_count(uint64_t encoded_insert_count, uint16_t &required_insert_count) const;
+  int  _decode_indexed_header_field(uint16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr, uint32_t &header_len);
+  int  _decode_indexed_header_field_with_postbase_index(uint16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
                                                         uint32_t &header_len);
-  int  _decode_literal_header_field_with_name_ref(int16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
+  int  _decode_literal_header_field_with_name_ref(uint16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
                                                   uint32_t &header_len);
   int  _decode_literal_header_field_without_name_ref(const uint8_t *buf, size_t buf_len, HTTPHdr &hdr, uint32_t &header_len);
-  int  _decode_literal_header_field_with_postbase_name_ref(int16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
+  int  _decode_literal_header_field_with_postbase_name_ref(uint16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
                                                            uint32_t &header_len);
 
   // Utilities
@@ -275,8 +303,9 @@ private:
 
   // Stream numbers
   // FIXME How are these stream ids negotiated? In interop, encoder stream id have to be 0 and decoder stream id must not be used.
-  uint64_t _encoder_stream_id = 0;
-  uint64_t _decoder_stream_id = 9999;
+  uint64_t _encoder_stream_id  = 0;
+  uint64_t _decoder_stream_id  = 9999;
+  bool     _has_encoder_stream = false;
 
   // Chain of sending instructions
   MIOBuffer      *_encoder_stream_sending_instructions;
@@ -255,6 +255,7 @@ public:
   int marshal_process_sfid(char *);                                // STR
   int marshal_client_http_connection_id(char *);                   // INT
   int marshal_client_http_transaction_id(char *);                  // INT
+  int marshal_transaction_state_trace(char *);                     // STR
   int marshal_client_http_transaction_priority_weight(char *);     // INT
   int marshal_client_http_transaction_priority_dependence(char *); // INT
   int marshal_cache_lookup_url_canon(char *);                      // STR
@@ -136,6 +136,7 @@ public:
   alloc_void()
   {
     void *ptr = nullptr;
+    ++ink_thread_alloc_count;
     if (alignment) {
       ptr = aligned_alloc(alignment, element_size);
     } else {
@@ -38,6 +38,11 @@ class Arena
 {
 public:
   Arena() {}
+  /** Allocate from the @a size bytes at @a buffer before going to the heap.
+
+      @a buffer belongs to the caller, it must outlive the arena and is reused after reset().
+   */
+  Arena(void *buffer, size_t size);
   ~Arena() { reset(); }
   void  *alloc(size_t size, size_t alignment = sizeof(double));
   void   free(void *mem, size_t size);
@@ -48,8 +53,25 @@ public:
 
   void reset();
 
+  /// Number of allocations since construction or the last reset.
+  unsigned
+  alloc_count() const
+  {
+    return m_alloc_count;
+  }
+
+  /// Number of blocks taken from the heap since construction or the last reset.
+  unsigned
+  block_count() const
+  {
+    return m_block_count;
+  }
+
 private:
-  ArenaBlock *m_blocks = nullptr;
+  ArenaBlock *m_blocks      = nullptr;
+  ArenaBlock *m_inline      = nullptr; ///< Caller provided block, always the last one.
+  unsigned    m_alloc_count = 0;
+  unsigned    m_block_count = 0;
 };
 
 /*-------------------------------------------------------------------------
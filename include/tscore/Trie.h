@@ -26,6 +26,9 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "tscore/List.h"
 #include "tscore/Diags.h"
@@ -39,6 +42,10 @@ protected:
 
 // Note that you should provide the class to use here, but we'll store
 // pointers to such objects internally.
+//
+// The trie is path compressed, each node holds the run of key bytes that leads to it from its parent
+// so a chain of nodes with a single child is a single node. The children of a node are found by
+// their first byte, which are kept together so a lookup is one scan of a short array.
 template <typename T> class Trie : private TrieImpl
 {
 public:
@@ -73,14 +80,13 @@ public:
   }
 
 private:
-  static const int N_NODE_CHILDREN = 256;
-
   class Node
   {
   public:
-    T   *value;
-    bool occupied;
-    int  rank;
+    T          *value;
+    bool        occupied;
+    int         rank;
+    std::string label; // Key bytes from the parent to this node.
 
     void
     Clear()
@@ -88,34 +94,62 @@ private:
       value    = nullptr;
       occupied = false;
       rank     = 0;
-      ink_zero(children);
+      label.clear();
+      first_bytes.clear();
+      children.clear();
     }
 
     void Print(const DbgCtl &dbg_ctl) const;
     inline Node *
     GetChild(char index) const
     {
-      return children[static_cast<unsigned char>(index)];
+      auto spot = static_cast<const char *>(memchr(first_bytes.data(), index, first_bytes.size()));
+      return spot ? children[spot - first_bytes.data()] : nullptr;
     }
     inline Node *
-    AllocateChild(char index)
+    AllocateChild(std::string_view key)
     {
-      Node *&child = children[static_cast<unsigned char>(index)];
-      ink_assert(child == nullptr);
-      child = static_cast<Node *>(ats_malloc(sizeof(Node)));
+      ink_assert(GetChild(key[0]) == nullptr);
+      Node *child = new Node;
       child->Clear();
+      child->label.assign(key);
+      first_bytes.push_back(key[0]);
+      children.push_back(child);
       return child;
     }
+    // Put a new node for the first @a len bytes of the label of @a child between it and this node.
+    Node *
+    SplitChild(Node *child, size_t len)
+    {
+      Node *mid = new Node;
+      mid->Clear();
+      mid->label.assign(child->label, 0, len);
+      child->label.erase(0, len);
+      mid->first_bytes.push_back(child->label[0]);
+      mid->children.push_back(child);
+      children[static_cast<const char *>(memchr(first_bytes.data(), mid->label[0], first_bytes.size())) - first_bytes.data()] = mid;
+      return mid;
+    }
+    void
+    DeleteChildren()
+    {
+      for (Node *child : children) {
+        child->DeleteChildren();
+        delete child;
+      }
+      first_bytes.clear();
+      children.clear();
+    }
 
   private:
-    Node *children[N_NODE_CHILDREN];
+    std::string         first_bytes; // First byte of the label of each child.
+    std::vector<Node *> children;
   };
 
   Node     m_root;
   Queue<T> m_value_list;
 
   void _CheckArgs(const char *key, int &key_len) const;
-  void _Clear(Node *node);
 
   // make copy-constructor and assignment operator private
   // till we properly implement them
@@ -144,9 +178,9 @@ Trie<T>::Insert(const char *key, T *value, int rank, int key_len /* = -1 */)
 {
   _CheckArgs(key, key_len);
 
-  Node *next_node;
-  Node *curr_node = &m_root;
-  int   i         = 0;
+  std::string_view rest{key, static_cast<size_t>(key_len)};
+  Node            *next_node;
+  Node            *curr_node = &m_root;
 
   while (true) {
     if (dbg_ctl_insert.on()) {
@@ -154,21 +188,27 @@ Trie<T>::Insert(const char *key, T *value, int rank, int key_len /* = -1 */)
       curr_node->Print(dbg_ctl_insert);
     }
 
-    if (i == key_len) {
+    if (rest.empty()) {
       break;
     }
 
-    next_node = curr_node->GetChild(key[i]);
+    next_node = curr_node->GetChild(rest[0]);
     if (!next_node) {
-      while (i < key_len) {
-        Dbg(dbg_ctl_insert, "Creating child node for char %c (%d)", key[i], key[i]);
-        curr_node = curr_node->AllocateChild(key[i]);
-        ++i;
-      }
+      Dbg(dbg_ctl_insert, "Creating child node for %.*s", static_cast<int>(rest.size()), rest.data());
+      curr_node = curr_node->AllocateChild(rest);
       break;
     }
+
+    // The key can leave the label of the child part way, in which case the child is split there.
+    size_t len = 1;
+    while (len < next_node->label.size() && len < rest.size() && next_node->label[len] == rest[len]) {
+      ++len;
+    }
+    if (len < next_node->label.size()) {
+      next_node = curr_node->SplitChild(next_node, len);
+    }
     curr_node = next_node;
-    ++i;
+    rest.remove_prefix(len);
   }
 
   if (curr_node->occupied) {
@@ -190,9 +230,9 @@ Trie<T>::Search(const char *key, int key_len /* = -1 */) const
 {
   _CheckArgs(key, key_len);
 
-  const Node *found_node = nullptr;
-  const Node *curr_node  = &m_root;
-  int         i          = 0;
+  std::string_view rest{key, static_cast<size_t>(key_len)};
+  const Node      *found_node = nullptr;
+  const Node      *curr_node  = &m_root;
 
   while (curr_node) {
     if (dbg_ctl_search.on()) {
@@ -204,11 +244,16 @@ Trie<T>::Search(const char *key, int key_len /* = -1 */) const
         found_node = curr_node;
       }
     }
-    if (i == key_len) {
+    if (rest.empty()) {
       break;
     }
-    curr_node = curr_node->GetChild(key[i]);
-    ++i;
+    curr_node = curr_node->GetChild(rest[0]);
+    if (curr_node) {
+      if (!rest.starts_with(curr_node->label)) {
+        break;
+      }
+      rest.remove_prefix(curr_node->label.size());
+    }
   }
 
   if (found_node) {
@@ -219,21 +264,6 @@ Trie<T>::Search(const char *key, int key_len /* = -1 */) const
   return nullptr;
 }
 
-template <typename T>
-void
-Trie<T>::_Clear(Node *node)
-{
-  Node *child;
-
-  for (int i = 0; i < N_NODE_CHILDREN; ++i) {
-    child = node->GetChild(i);
-    if (child) {
-      _Clear(child);
-      ats_free(child);
-    }
-  }
-}
-
 template <typename T>
 void
 Trie<T>::Clear()
@@ -243,7 +273,7 @@ Trie<T>::Clear()
     delete iter;
   }
 
-  _Clear(&m_root);
+  m_root.DeleteChildren();
   m_root.Clear();
 }
 
@@ -266,9 +296,7 @@ Trie<T>::Node::Print(const DbgCtl &dbg_ctl) const
     Dbg(dbg_ctl, "Node is not occupied");
   }
 
-  for (int i = 0; i < N_NODE_CHILDREN; ++i) {
-    if (GetChild(i)) {
-      Dbg(dbg_ctl, "Node has child for char %c", static_cast<char>(i));
-    }
+  for (Node const *child : children) {
+    Dbg(dbg_ctl, "Node has child for %s", child->label.c_str());
   }
 }
@@ -205,6 +205,9 @@ void  ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size,
 void  ink_freelist_madvise_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32_t chunk_size, uint32_t alignment,
                                 bool use_hugepages, int advice);
 void *ink_freelist_new(InkFreeList *f);
+
+/// Number of blocks allocated by this thread, counting ink_freelist_new(), MallocAllocator and the per thread freelists.
+extern thread_local uint64_t ink_thread_alloc_count;
 void  ink_freelist_free(InkFreeList *f, void *item);
 void  ink_freelist_free_bulk(InkFreeList *f, void *head, void *tail, size_t num_item);
 void  ink_freelists_dump(FILE *f);
@@ -512,6 +512,18 @@ public:
       return reinterpret_cast<AtomicType *>(instance.lookup(instance._create(tmpname, MetricType::COUNTER)));
     }
 
+    /** Create the counter for one bucket of a histogram.
+
+        Histograms are exported as one counter per bucket, named after the lower bound of the bucket: @a prefix, a dot,
+        @a bound and @a unit, e.g. "proxy.process.udp.pacing_delay.500us". Durations are in microseconds with the unit
+        "us", counts have no unit. The last bucket counts everything from its bound up.
+     */
+    static AtomicType *
+    createBucketPtr(const std::string_view prefix, int64_t bound, const std::string_view unit = {})
+    {
+      return createPtr(std::string(prefix) + "." + std::to_string(bound) + std::string(unit));
+    }
+
     static Metrics::Counter::SpanType
     createSpan(size_t size, IdType *id = nullptr)
     {
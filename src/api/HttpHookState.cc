@@ -54,6 +54,12 @@ HttpHookState::init(TSHttpHookID id, HttpAPIHooks const *global, HttpAPIHooks co
   }
 }
 
+bool
+HttpHookState::has_hooks(TSHttpHookID id, HttpAPIHooks const *global, HttpAPIHooks const *ssn, HttpAPIHooks const *txn)
+{
+  return (global && global->has_hooks_for(id)) || (ssn && ssn->has_hooks_for(id)) || (txn && txn->has_hooks_for(id));
+}
+
 APIHook const *
 HttpHookState::getNext()
 {
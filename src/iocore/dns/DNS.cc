@@ -38,6 +38,13 @@
 #include "tscore/Regression.h"
 #endif
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 #define SRV_COST    (RRFIXEDSZ + 0)
 #define SRV_WEIGHT  (RRFIXEDSZ + 2)
 #define SRV_PORT    (RRFIXEDSZ + 4)
@@ -65,6 +72,7 @@ char         *dns_ns_list                     = nullptr;
 char         *dns_resolv_conf                 = nullptr;
 char         *dns_local_ipv6                  = nullptr;
 char         *dns_local_ipv4                  = nullptr;
+char         *dns_tls_name                    = nullptr;
 int           dns_thread                      = 0;
 int           dns_prefer_ipv6                 = 0;
 DNS_CONN_MODE dns_conn_mode                   = DNS_CONN_MODE::UDP_ONLY;
@@ -77,6 +85,9 @@ DbgCtl dbg_ctl_dns_srv{"dns_srv"};
 
 const int tcp_data_length_offset = 2;
 
+// Lower bounds in milliseconds of the nameserver response time buckets, the last bucket has the rest.
+constexpr int rtt_bucket_bounds[DNS_RTT_BUCKETS] = {0, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000};
+
 // Currently only used for A and AAAA.
 inline const char *
 QtypeName(int qtype)
@@ -247,6 +258,9 @@ DNSProcessor::start(int, size_t stacksize)
   if (auto rec_str{RecGetRecordStringAlloc("proxy.config.dns.resolv_conf")}; rec_str) {
     dns_resolv_conf = ats_stringdup(rec_str);
   }
+  if (auto rec_str{RecGetRecordStringAlloc("proxy.config.dns.tls_name")}; rec_str) {
+    dns_tls_name = ats_stringdup(rec_str);
+  }
   RecEstablishStaticConfigInt32(dns_thread, "proxy.config.dns.dedicated_thread");
   int dns_conn_mode_i = 0;
   RecEstablishStaticConfigInt32(dns_conn_mode_i, "proxy.config.dns.connection_mode");
@@ -469,16 +483,16 @@ DNSEntry::init(DNSQueryData target, int qtype_arg, Continuation *acont, DNSProce
 }
 
 /**
- Open UDP and/or TCP connections based on dns_conn_mode
+ Open UDP and/or TCP connections based on the connection mode of the handler
  */
 
 void
 DNSHandler::open_cons(sockaddr const *target, bool failed, int icon)
 {
-  if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
+  if (uses_udp()) {
     open_con(target, failed, icon, false);
   }
-  if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
+  if (uses_stream()) {
     open_con(target, failed, icon, true);
   }
 }
@@ -523,8 +537,18 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
     target = &ip.sa;
   }
   DNSConnection &cur_con = over_tcp ? tcpcon[icon] : udpcon[icon];
+  bool           over_tls = over_tcp && conn_mode == DNS_CONN_MODE::TLS_ONLY;
+
+  // A nameserver on the plain DNS port is contacted on the DNS over TLS port.
+  IpEndpoint tls_target;
+  if (over_tls && ats_ip_port_host_order(target) == NAMESERVER_PORT) {
+    ats_ip_copy(&tls_target.sa, target);
+    tls_target.network_order_port() = htons(DNS_OVER_TLS_PORT);
+    target                          = &tls_target.sa;
+  }
+  ns_stats[icon] = DNSNameserverStats::get(target);
 
-  Dbg(dbg_ctl_dns, "open_con: opening connection %s", ats_ip_nptop(target, ip_text, sizeof ip_text));
+  Dbg(dbg_ctl_dns, "open_con: opening connection %s%s", ats_ip_nptop(target, ip_text, sizeof ip_text), over_tls ? " over TLS" : "");
 
   if (!cur_con.sock.is_ok()) { // Remove old FD from epoll fd
     cur_con.close();
@@ -534,6 +558,8 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
                                 .setNonBlockingConnect(true)
                                 .setNonBlockingIo(true)
                                 .setUseTcp(over_tcp)
+                                .setUseTls(over_tls)
+                                .setTlsName(tls_name.empty() ? nullptr : tls_name.c_str())
                                 .setBindRandomPort(true)
                                 .setLocalIpv6(&local_ipv6.sa)
                                 .setLocalIpv4(&local_ipv4.sa)) < 0) {
@@ -547,7 +573,8 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
     }
     return false;
   } else {
-    if (cur_con.eio.start(pd, cur_con.sock.get_fd(), EVENTIO_READ) < 0) {
+    // A TLS connection also needs to know when it can write, to go on with the handshake and the queued queries.
+    if (cur_con.eio.start(pd, cur_con.sock.get_fd(), over_tls ? EVENTIO_READ | EVENTIO_WRITE : EVENTIO_READ) < 0) {
       Error("[iocore_dns] open_con: Failed to add %d server to epoll list\n", icon);
     } else {
       cur_con.num   = icon;
@@ -687,23 +714,23 @@ DNSHandler::retry_named(int ndx, ink_hrtime t, bool reopen)
   if (reopen && ((t - last_primary_reopen) > DNS_PRIMARY_REOPEN_PERIOD)) {
     Dbg(dbg_ctl_dns, "retry_named: reopening DNS connection for index %d", ndx);
     last_primary_reopen = t;
-    if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
+    if (uses_udp()) {
       udpcon[ndx].close();
     }
-    if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
+    if (uses_stream()) {
       tcpcon[ndx].close();
     }
     open_cons(&m_res->nsaddr_list[ndx].sa, true, ndx);
   }
-  bool          over_tcp = dns_conn_mode == DNS_CONN_MODE::TCP_ONLY;
-  UnixSocket    con_sock = over_tcp ? tcpcon[ndx].sock : udpcon[ndx].sock;
-  unsigned char buffer[MAX_DNS_REQUEST_LEN];
+  bool           over_tcp = stream_only();
+  DNSConnection &con      = over_tcp ? tcpcon[ndx] : udpcon[ndx];
+  unsigned char  buffer[MAX_DNS_REQUEST_LEN];
   Dbg(dbg_ctl_dns, "trying to resolve '%s' from DNS connection, ndx %d", try_server_names[try_servers], ndx);
   int r       = _ink_res_mkquery(m_res, try_server_names[try_servers], T_A, buffer, over_tcp);
   try_servers = (try_servers + 1) % countof(try_server_names);
   ink_assert(r >= 0);
   if (r >= 0) { // looking for a bounce
-    int res = con_sock.send(buffer, r, 0);
+    int res = con.send(buffer, r);
     Dbg(dbg_ctl_dns, "ping result = %d", res);
   }
 }
@@ -718,10 +745,10 @@ DNSHandler::try_primary_named(bool reopen)
     open_cons(nullptr, true, 0);
   }
   if ((t - last_primary_retry) > DNS_PRIMARY_RETRY_PERIOD) {
-    unsigned char buffer[MAX_DNS_REQUEST_LEN];
-    bool          over_tcp = dns_conn_mode == DNS_CONN_MODE::TCP_ONLY;
-    UnixSocket    con_sock = over_tcp ? tcpcon[0].sock : udpcon[0].sock;
-    last_primary_retry     = t;
+    unsigned char  buffer[MAX_DNS_REQUEST_LEN];
+    bool           over_tcp = stream_only();
+    DNSConnection &con      = over_tcp ? tcpcon[0] : udpcon[0];
+    last_primary_retry      = t;
     Dbg(dbg_ctl_dns, "trying to resolve '%s' from primary DNS connection", try_server_names[try_servers]);
     int r = _ink_res_mkquery(m_res, try_server_names[try_servers], T_A, buffer, over_tcp);
     // if try_server_names[] is not full, round-robin within the
@@ -733,7 +760,7 @@ DNSHandler::try_primary_named(bool reopen)
     }
     ink_assert(r >= 0);
     if (r >= 0) { // looking for a bounce
-      int res = con_sock.send(buffer, r, 0);
+      int res = con.send(buffer, r);
       Dbg(dbg_ctl_dns, "ping result = %d", res);
     }
   }
@@ -743,7 +770,9 @@ void
 DNSHandler::switch_named(int ndx)
 {
   for (DNSEntry *e = entries.head; e; e = static_cast<DNSEntry *>(e->link.next)) {
-    e->written_flag = false;
+    if (e->written_flag) {
+      not_in_flight(e);
+    }
     if (e->retries < dns_retries) {
       ++(e->retries); // give them another chance
     }
@@ -794,10 +823,10 @@ DNSHandler::failover()
     }
     switch_named(name_server);
   } else {
-    if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
+    if (uses_udp()) {
       udpcon[0].close();
     }
-    if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
+    if (uses_stream()) {
       tcpcon[0].close();
     }
     ip_text_buffer buff;
@@ -838,23 +867,21 @@ DNSHandler::rr_failure(int ndx)
     // actual retries will be done in retry_named called from mainEvent
     // mark any outstanding requests as not sent for later retry
     for (DNSEntry *e = entries.head; e; e = static_cast<DNSEntry *>(e->link.next)) {
-      e->written_flag = false;
+      if (e->written_flag) {
+        not_in_flight(e);
+      }
       if (e->retries < dns_retries) {
         ++(e->retries); // give them another chance
       }
-      --in_flight;
-      Metrics::Gauge::decrement(dns_rsb.in_flight);
     }
   } else {
     // move outstanding requests that were sent to this nameserver to another
     for (DNSEntry *e = entries.head; e; e = static_cast<DNSEntry *>(e->link.next)) {
-      if (e->which_ns == ndx) {
-        e->written_flag = false;
+      if (e->which_ns == ndx && e->written_flag) {
+        not_in_flight(e);
         if (e->retries < dns_retries) {
           ++(e->retries); // give them another chance
         }
-        --in_flight;
-        Metrics::Gauge::decrement(dns_rsb.in_flight);
       }
     }
   }
@@ -867,6 +894,40 @@ good_rcode(char *buff)
   return NOERROR == r || NXDOMAIN == r;
 }
 
+/** Handle a response from the nameserver of @a dnsc. */
+void
+DNSHandler::received(DNSConnection *dnsc, Ptr<HostEnt> &buf, int len)
+{
+  ip_text_buffer ipbuff;
+
+  if (dns_ns_rr) {
+    Dbg(dbg_ctl_dns, "round-robin: nameserver %d DNS response code = %d", dnsc->num, get_rcode(buf->buf));
+    if (good_rcode(buf->buf)) {
+      received_one(dnsc->num);
+      if (ns_down[dnsc->num]) {
+        Warning("connection to DNS server %s restored", ats_ip_ntop(&m_res->nsaddr_list[dnsc->num].sa, ipbuff, sizeof ipbuff));
+        ns_down[dnsc->num] = 0;
+      }
+    }
+  } else {
+    if (!dnsc->num) {
+      Dbg(dbg_ctl_dns, "primary DNS response code = %d", get_rcode(buf->buf));
+      if (good_rcode(buf->buf)) {
+        if (name_server) {
+          recover();
+        } else {
+          received_one(name_server);
+        }
+      }
+    }
+  }
+  if (dns_process(this, buf.get(), len)) {
+    if (dnsc->num == name_server) {
+      received_one(name_server);
+    }
+  }
+}
+
 void
 DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
@@ -875,9 +936,7 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   Ptr<HostEnt>   buf;
   while ((dnsc = static_cast<DNSConnection *>(triggered.dequeue()))) {
     while (true) {
-      int        res;
-      IpEndpoint from_ip;
-      socklen_t  from_length = sizeof(from_ip);
+      int res;
       if (dnsc->opt._use_tcp) {
         if (dnsc->tcp_data.buf_ptr == nullptr) {
           dnsc->tcp_data.buf_ptr = make_ptr(dnsBufAllocator.alloc());
@@ -885,7 +944,7 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
         if (dnsc->tcp_data.total_length == 0) {
           // see if TS gets a two-byte size
           uint16_t tmp = 0;
-          res          = dnsc->sock.recv(&tmp, sizeof(tmp), MSG_PEEK);
+          res          = dnsc->recv(&tmp, sizeof(tmp), MSG_PEEK);
           if (res == -EAGAIN || res == 1) {
             break;
           }
@@ -893,7 +952,7 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
             goto Lerror;
           }
           // reading total size
-          res = dnsc->sock.recv(&(dnsc->tcp_data.total_length), sizeof(dnsc->tcp_data.total_length), 0);
+          res = dnsc->recv(&(dnsc->tcp_data.total_length), sizeof(dnsc->tcp_data.total_length), 0);
           if (res == -EAGAIN) {
             break;
           }
@@ -907,7 +966,7 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
         }
         // continue reading data
         void *buf_start = dnsc->tcp_data.buf_ptr->buf + dnsc->tcp_data.done_reading;
-        res             = dnsc->sock.recv(buf_start, dnsc->tcp_data.total_length - dnsc->tcp_data.done_reading, 0);
+        res             = dnsc->recv(buf_start, dnsc->tcp_data.total_length - dnsc->tcp_data.done_reading, 0);
         if (res == -EAGAIN) {
           break;
         }
@@ -917,72 +976,100 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
         Dbg(dbg_ctl_dns, "received packet size = %d over TCP", res);
         dnsc->tcp_data.done_reading += res;
         if (dnsc->tcp_data.done_reading < dnsc->tcp_data.total_length) {
-          break;
+          // TLS hands over one record at a time, read on until there is nothing more.
+          continue;
         }
         buf = dnsc->tcp_data.buf_ptr;
         res = dnsc->tcp_data.total_length;
         dnsc->tcp_data.reset();
-        goto Lsuccess;
+        received(dnsc, buf, res);
+        continue;
       }
 
-      if (!hostent_cache) {
-        hostent_cache = dnsBufAllocator.alloc();
+#ifdef HAVE_RECVMMSG
+      {
+        // Receive the responses that are waiting with one system call.
+        mmsghdr    msgs[DNS_UDP_RECV_BATCH];
+        iovec      iov[DNS_UDP_RECV_BATCH];
+        IpEndpoint from_ip[DNS_UDP_RECV_BATCH];
+        for (int i = 0; i < DNS_UDP_RECV_BATCH; ++i) {
+          if (!hostent_cache[i]) {
+            hostent_cache[i] = dnsBufAllocator.alloc();
+          }
+          iov[i]                      = {hostent_cache[i]->buf, MAX_DNS_RESPONSE_LEN};
+          msgs[i]                     = {};
+          msgs[i].msg_hdr.msg_name    = &from_ip[i].sa;
+          msgs[i].msg_hdr.msg_namelen = sizeof(from_ip[i]);
+          msgs[i].msg_hdr.msg_iov     = &iov[i];
+          msgs[i].msg_hdr.msg_iovlen  = 1;
+        }
+        res = dnsc->sock.recvmmsg(msgs, DNS_UDP_RECV_BATCH, 0, nullptr);
+        Dbg(dbg_ctl_dns, "DNSHandler::recv_dns res = [%d]", res);
+        if (res == -EAGAIN) {
+          break;
+        }
+        if (res <= 0) {
+          goto Lerror;
+        }
+        for (int i = 0; i < res; ++i) {
+          // verify that this response came from the correct server
+          if (!ats_ip_addr_eq(&dnsc->ip.sa, &from_ip[i].sa)) {
+            Warning("unexpected DNS response from %s (expected %s)", ats_ip_ntop(&from_ip[i].sa, ipbuff1, sizeof ipbuff1),
+                    ats_ip_ntop(&dnsc->ip.sa, ipbuff2, sizeof ipbuff2));
+            continue;
+          }
+          buf              = hostent_cache[i];
+          hostent_cache[i] = nullptr;
+          buf->packet_size = msgs[i].msg_len;
+          Dbg(dbg_ctl_dns, "received packet size = %u", msgs[i].msg_len);
+          received(dnsc, buf, msgs[i].msg_len);
+        }
+        if (res < DNS_UDP_RECV_BATCH) {
+          break; // nothing more to read
+        }
+        continue;
       }
+#else
+      {
+        IpEndpoint from_ip;
+        socklen_t  from_length = sizeof(from_ip);
 
-      res = dnsc->sock.recvfrom(hostent_cache->buf, MAX_DNS_RESPONSE_LEN, 0, &from_ip.sa, &from_length);
-      Dbg(dbg_ctl_dns, "DNSHandler::recv_dns res = [%d]", res);
-      if (res == -EAGAIN) {
-        break;
-      }
-      if (res <= 0) {
-      Lerror:
-        Dbg(dbg_ctl_dns, "named error: %d", res);
-        if (dns_ns_rr) {
-          rr_failure(dnsc->num);
-        } else if (dnsc->num == name_server) {
-          failover();
+        if (!hostent_cache[0]) {
+          hostent_cache[0] = dnsBufAllocator.alloc();
         }
-        break;
-      }
 
-      // verify that this response came from the correct server
-      if (!ats_ip_addr_eq(&dnsc->ip.sa, &from_ip.sa)) {
-        Warning("unexpected DNS response from %s (expected %s)", ats_ip_ntop(&from_ip.sa, ipbuff1, sizeof ipbuff1),
-                ats_ip_ntop(&dnsc->ip.sa, ipbuff2, sizeof ipbuff2));
-        continue;
-      }
-      buf              = hostent_cache;
-      hostent_cache    = nullptr;
-      buf->packet_size = res;
-      Dbg(dbg_ctl_dns, "received packet size = %d", res);
-    Lsuccess:
-      if (dns_ns_rr) {
-        Dbg(dbg_ctl_dns, "round-robin: nameserver %d DNS response code = %d", dnsc->num, get_rcode(buf->buf));
-        if (good_rcode(buf->buf)) {
-          received_one(dnsc->num);
-          if (ns_down[dnsc->num]) {
-            Warning("connection to DNS server %s restored",
-                    ats_ip_ntop(&m_res->nsaddr_list[dnsc->num].sa, ipbuff1, sizeof ipbuff1));
-            ns_down[dnsc->num] = 0;
-          }
+        res = dnsc->sock.recvfrom(hostent_cache[0]->buf, MAX_DNS_RESPONSE_LEN, 0, &from_ip.sa, &from_length);
+        Dbg(dbg_ctl_dns, "DNSHandler::recv_dns res = [%d]", res);
+        if (res == -EAGAIN) {
+          break;
         }
-      } else {
-        if (!dnsc->num) {
-          Dbg(dbg_ctl_dns, "primary DNS response code = %d", get_rcode(buf->buf));
-          if (good_rcode(buf->buf)) {
-            if (name_server) {
-              recover();
-            } else {
-              received_one(name_server);
-            }
-          }
+        if (res <= 0) {
+          goto Lerror;
         }
-      }
-      if (dns_process(this, buf.get(), res)) {
-        if (dnsc->num == name_server) {
-          received_one(name_server);
+
+        // verify that this response came from the correct server
+        if (!ats_ip_addr_eq(&dnsc->ip.sa, &from_ip.sa)) {
+          Warning("unexpected DNS response from %s (expected %s)", ats_ip_ntop(&from_ip.sa, ipbuff1, sizeof ipbuff1),
+                  ats_ip_ntop(&dnsc->ip.sa, ipbuff2, sizeof ipbuff2));
+          continue;
         }
+        buf              = hostent_cache[0];
+        hostent_cache[0] = nullptr;
+        buf->packet_size = res;
+        Dbg(dbg_ctl_dns, "received packet size = %d", res);
+        received(dnsc, buf, res);
+        continue;
+      }
+#endif
+
+    Lerror:
+      Dbg(dbg_ctl_dns, "named error: %d", res);
+      if (dns_ns_rr) {
+        rr_failure(dnsc->num);
+      } else if (dnsc->num == name_server) {
+        failover();
       }
+      break;
     }
   }
 }
@@ -1010,7 +1097,7 @@ DNSHandler::mainEvent(int event, Event *e)
 {
   recv_dns(event, e);
   if (dns_ns_rr) {
-    if (DNS_CONN_MODE::TCP_RETRY == dns_conn_mode) {
+    if (DNS_CONN_MODE::TCP_RETRY == conn_mode) {
       check_and_reset_tcp_conn();
     }
     ink_hrtime t = ink_get_hrtime();
@@ -1115,7 +1202,7 @@ write_dns(DNSHandler *h, bool tcp_retry)
     return;
   }
   h->in_write_dns = true;
-  bool over_tcp   = (dns_conn_mode == DNS_CONN_MODE::TCP_ONLY) || ((dns_conn_mode == DNS_CONN_MODE::TCP_RETRY) && tcp_retry);
+  bool over_tcp   = h->stream_only() || ((h->conn_mode == DNS_CONN_MODE::TCP_RETRY) && tcp_retry);
   if (h->in_flight < dns_max_dns_in_flight) {
     DNSEntry *e = h->entries.head;
     while (e) {
@@ -1137,9 +1224,83 @@ write_dns(DNSHandler *h, bool tcp_retry)
       e = n;
     }
   }
+  h->flush_udp_batch();
   h->in_write_dns = false;
 }
 
+/**
+  Send the queries batched by write_dns_event(), with one system call for
+  the queries to each nameserver.
+
+  @return false if a nameserver failed.
+
+*/
+bool
+DNSHandler::flush_udp_batch()
+{
+  static_assert(DNS_UDP_SEND_BATCH <= 64, "the queries left to send are a 64 bit mask");
+
+  bool     ok = true;
+  mmsghdr  msgs[DNS_UDP_SEND_BATCH];
+  iovec    iov[DNS_UDP_SEND_BATCH];
+  int      which[DNS_UDP_SEND_BATCH];
+  uint64_t pending = udp_batch.count < 64 ? (1ULL << udp_batch.count) - 1 : ~0ULL;
+
+  while (pending) {
+    int ndx = udp_batch.ns[__builtin_ctzll(pending)];
+    int n   = 0;
+    for (int i = 0; i < udp_batch.count; ++i) {
+      if ((pending & (1ULL << i)) && udp_batch.ns[i] == ndx) {
+        iov[n]                      = {udp_batch.buf[i], static_cast<size_t>(udp_batch.len[i])};
+        msgs[n]                     = {};
+        msgs[n].msg_hdr.msg_iov     = &iov[n];
+        msgs[n].msg_hdr.msg_iovlen  = 1;
+        which[n++]                  = i;
+        pending                   &= ~(1ULL << i);
+      }
+    }
+
+#ifdef HAVE_SENDMMSG
+    int sent = udpcon[ndx].sock.sendmmsg(msgs, n, 0);
+#else
+    int sent = 0;
+    int res  = 0;
+    while (sent < n && (res = udpcon[ndx].sock.send(iov[sent].iov_base, iov[sent].iov_len, 0)) >= 0) {
+      ++sent;
+    }
+    if (sent == 0) {
+      sent = res;
+    }
+#endif
+    Dbg(dbg_ctl_dns, "sent %d of %d queries to nameserver %d in one call", sent, n, ndx);
+    if (sent == n) {
+      continue;
+    }
+
+    // The queries that were not sent wait for the next write_dns() like any other unwritten query.
+    for (int k = std::max(sent, 0); k < n; ++k) {
+      DNSEntry *e = udp_batch.entry[which[k]];
+      Dbg(dbg_ctl_dns, "send() failed: qname = %s, nameserver= %d", e->qname, ndx);
+      not_in_flight(e);
+      e->which_ns = NO_NAMESERVER_SELECTED;
+      if (e->timeout) {
+        e->timeout->cancel();
+        e->timeout = nullptr;
+      }
+    }
+    if (sent < 0) {
+      ok = false;
+      if (dns_ns_rr) {
+        rr_failure(ndx);
+      } else {
+        failover();
+      }
+    }
+  }
+  udp_batch.count = 0;
+  return ok;
+}
+
 uint16_t
 DNSHandler::get_query_id()
 {
@@ -1174,7 +1335,8 @@ DNSHandler::get_query_id()
 }
 
 /**
-  Construct and Write the request for a single entry (using send(3N)).
+  Construct and Write the request for a single entry (using send(3N)), or
+  add it to the UDP batch of the handler.
 
   @return true = keep going, false = give up for now.
 
@@ -1182,10 +1344,13 @@ DNSHandler::get_query_id()
 static bool
 write_dns_event(DNSHandler *h, DNSEntry *e, bool over_tcp)
 {
-  unsigned char buffer[MAX_DNS_REQUEST_LEN];
-  int           offset = over_tcp ? tcp_data_length_offset : 0;
-  HEADER       *header = reinterpret_cast<HEADER *>(buffer + offset);
-  int           r      = 0;
+  // Queries over UDP are built in place in the batch and sent together by DNSHandler::flush_udp_batch().
+  DNSHandler::UDPBatch &batch = h->udp_batch;
+  unsigned char         tcp_buffer[MAX_DNS_REQUEST_LEN];
+  unsigned char        *buffer = over_tcp ? tcp_buffer : batch.buf[batch.count];
+  int                   offset = over_tcp ? tcp_data_length_offset : 0;
+  HEADER               *header = reinterpret_cast<HEADER *>(buffer + offset);
+  int                   r      = 0;
 
   if ((r = _ink_res_mkquery(h->m_res, e->qname, e->qtype, buffer, over_tcp)) <= 0) {
     Dbg(dbg_ctl_dns, "cannot build query: %s", e->qname);
@@ -1200,43 +1365,46 @@ write_dns_event(DNSHandler *h, DNSEntry *e, bool over_tcp)
     h->release_query_id(e->id[dns_retries - e->retries]);
   }
   e->id[dns_retries - e->retries] = i;
-  UnixSocket con_sock             = over_tcp ? h->tcpcon[h->name_server].sock : h->udpcon[h->name_server].sock;
-  Dbg(dbg_ctl_dns, "send query (qtype=%d) for %s to fd %d", e->qtype, e->qname, con_sock.get_fd());
 
-  int s = con_sock.send(buffer, r, 0);
-  if (s != r) {
-    Dbg(dbg_ctl_dns, "send() failed: qname = %s, %d != %d, nameserver= %d", e->qname, s, r, h->name_server);
+  if (over_tcp) {
+    DNSConnection &con = h->tcpcon[h->name_server];
+    Dbg(dbg_ctl_dns, "send query (qtype=%d) for %s to fd %d", e->qtype, e->qname, con.sock.get_fd());
+
+    int s = con.send(buffer, r);
+    if (s != r) {
+      Dbg(dbg_ctl_dns, "send() failed: qname = %s, %d != %d, nameserver= %d", e->qname, s, r, h->name_server);
 
-    if (over_tcp) {
       // add the counter for tcp connection failed
       Dbg(dbg_ctl_dns, "tcp query failed: name_server = %d, tcp_continuous_failures = %d", h->name_server,
           h->tcp_continuous_failures[h->name_server]);
       ++h->tcp_continuous_failures[h->name_server];
-    }
 
-    // changed if condition from 'r < 0' to 's < 0' - 8/2001 pas
-    if (s < 0) {
-      if (dns_ns_rr) {
-        h->rr_failure(h->name_server);
-      } else {
-        h->failover();
+      // changed if condition from 'r < 0' to 's < 0' - 8/2001 pas
+      if (s < 0) {
+        if (dns_ns_rr) {
+          h->rr_failure(h->name_server);
+        } else {
+          h->failover();
+        }
       }
+      return false;
     }
-    return false;
-  }
 
-  if (over_tcp && h->tcp_continuous_failures[h->name_server] > 0) {
-    // reset the counter for any tcp connection succeed
-    Dbg(dbg_ctl_dns, "reset tcp_continuous_failures: name_server = %d, tcp_continuous_failures = %d", h->name_server,
-        h->tcp_continuous_failures[h->name_server]);
-    h->tcp_continuous_failures[h->name_server] = 0;
+    if (h->tcp_continuous_failures[h->name_server] > 0) {
+      // reset the counter for any tcp connection succeed
+      Dbg(dbg_ctl_dns, "reset tcp_continuous_failures: name_server = %d, tcp_continuous_failures = %d", h->name_server,
+          h->tcp_continuous_failures[h->name_server]);
+      h->tcp_continuous_failures[h->name_server] = 0;
+    }
+  } else {
+    Dbg(dbg_ctl_dns, "batch query (qtype=%d) for %s to fd %d", e->qtype, e->qname, h->udpcon[h->name_server].sock.get_fd());
+    batch.ns[batch.count]    = h->name_server;
+    batch.len[batch.count]   = r;
+    batch.entry[batch.count] = e;
+    ++batch.count;
   }
 
-  e->written_flag      = true;
-  e->which_ns          = h->name_server;
-  e->once_written_flag = true;
-  ++h->in_flight;
-  Metrics::Gauge::increment(dns_rsb.in_flight);
+  h->now_in_flight(e, h->name_server);
 
   e->send_time = ink_get_hrtime();
 
@@ -1252,6 +1420,10 @@ write_dns_event(DNSHandler *h, DNSEntry *e, bool over_tcp)
 
   Dbg(dbg_ctl_dns, "sent qname = %s, id = %u, nameserver = %d", e->qname, e->id[dns_retries - e->retries], h->name_server);
   h->sent_one();
+
+  if (batch.count == DNS_UDP_SEND_BATCH) {
+    return h->flush_udp_batch();
+  }
   return true;
 }
 
@@ -1319,9 +1491,7 @@ DNSEntry::mainEvent(int event, Event *e)
     }
     if (written_flag) {
       Dbg(dbg_ctl_dns, "marking %s as not-written", qname);
-      written_flag = false;
-      --(dnsH->in_flight);
-      Metrics::Gauge::decrement(dns_rsb.in_flight);
+      dnsH->not_in_flight(this);
     }
     timeout = nullptr;
     dns_result(dnsH, this, result_ent.get(), true);
@@ -1576,16 +1746,18 @@ dns_process(DNSHandler *handler, HostEnt *buf, int len)
   //
   // It is no longer in flight
   //
-  e->written_flag = false;
-  --(handler->in_flight);
-  Metrics::Gauge::decrement(dns_rsb.in_flight);
+  handler->not_in_flight(e);
+  ink_hrtime rtt = ink_get_hrtime() - e->send_time;
+  if (e->ns_stats) {
+    e->ns_stats->record_rtt(rtt);
+  }
   // These are rolling averages
-  ink_hrtime diff = (ink_get_hrtime() - e->send_time) / HRTIME_MSECOND;
+  ink_hrtime diff = rtt / HRTIME_MSECOND;
 
   Metrics::Counter::increment(dns_rsb.response_time, diff);
 
   // retrying over TCP when truncated is set
-  if (dns_conn_mode == DNS_CONN_MODE::TCP_RETRY && h->tc == 1) {
+  if (handler->conn_mode == DNS_CONN_MODE::TCP_RETRY && h->tc == 1) {
     Dbg(dbg_ctl_dns, "Retrying DNS query over TCP for [%s]", e->qname);
     tcp_retry = true;
     Metrics::Counter::increment(dns_rsb.tcp_retries);
@@ -1909,6 +2081,36 @@ Lerror:;
 
 DNSStatsBlock dns_rsb;
 
+DNSNameserverStats *
+DNSNameserverStats::get(sockaddr const *addr)
+{
+  static std::mutex                                                          mutex;
+  static std::unordered_map<std::string, std::unique_ptr<DNSNameserverStats>> all;
+
+  ip_port_text_buffer buff;
+  std::string         name = ats_ip_nptop(addr, buff, sizeof(buff));
+  std::lock_guard     lock(mutex);
+  auto               &stats = all[name];
+
+  if (!stats) {
+    std::string prefix = "proxy.process.dns.nameserver." + name + ".";
+    stats              = std::make_unique<DNSNameserverStats>();
+    stats->in_flight   = Metrics::Gauge::createPtr(prefix + "in_flight");
+    for (int i = 0; i < DNS_RTT_BUCKETS; ++i) {
+      stats->rtt[i] = Metrics::Counter::createBucketPtr(prefix + "rtt", rtt_bucket_bounds[i] * 1000, "us");
+    }
+  }
+  return stats.get();
+}
+
+void
+DNSNameserverStats::record_rtt(ink_hrtime t)
+{
+  int i = std::upper_bound(std::begin(rtt_bucket_bounds), std::end(rtt_bucket_bounds), t / HRTIME_MSECOND) -
+          std::begin(rtt_bucket_bounds) - 1;
+  Metrics::Counter::increment(rtt[i]);
+}
+
 void
 ink_dns_init(ts::ModuleVersion v)
 {
@@ -33,6 +33,8 @@
 
 #include "iocore/eventsystem/UnixSocket.h"
 
+#include <openssl/err.h>
+
 #define SET_TCP_NO_DELAY
 #define SET_NO_LINGER
 #define SET_SO_KEEPALIVE
@@ -46,6 +48,35 @@ namespace
 
 DbgCtl dbg_ctl_dns{"dns"};
 
+// Client context shared by the DNS over TLS connections.
+SSL_CTX *
+dns_tls_ctx()
+{
+  static SSL_CTX *ctx = []() {
+    SSL_CTX *c = SSL_CTX_new(TLS_client_method());
+    if (c != nullptr) {
+      SSL_CTX_set_min_proto_version(c, TLS1_2_VERSION);
+      SSL_CTX_set_default_verify_paths(c);
+      SSL_CTX_set_mode(c, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    }
+    return c;
+  }();
+  return ctx;
+}
+
+// Have the certificate of the nameserver at @a addr verified against its address.
+bool
+dns_tls_verify_ip(SSL *ssl, sockaddr const *addr)
+{
+  X509_VERIFY_PARAM *param = SSL_get0_param(ssl);
+  if (ats_is_ip4(addr)) {
+    return X509_VERIFY_PARAM_set1_ip(param, reinterpret_cast<unsigned char const *>(&ats_ip4_addr_cast(addr)), sizeof(in_addr_t));
+  } else if (ats_is_ip6(addr)) {
+    return X509_VERIFY_PARAM_set1_ip(param, reinterpret_cast<unsigned char const *>(&ats_ip6_addr_cast(addr)), sizeof(in6_addr));
+  }
+  return false;
+}
+
 } // end anonymous namespace
 
 //
@@ -67,6 +98,12 @@ int
 DNSConnection::close()
 {
   eio.stop();
+  if (ssl != nullptr) {
+    SSL_free(ssl);
+    ssl = nullptr;
+  }
+  tls_ready = false;
+  tls_out.clear();
   return this->sock.close();
 }
 
@@ -187,6 +224,33 @@ DNSConnection::connect(sockaddr const *addr, Options const &opt)
     goto Lerror;
   }
 
+  if (opt._use_tls) {
+    SSL_CTX *ctx = dns_tls_ctx();
+    if (ctx == nullptr || (ssl = SSL_new(ctx)) == nullptr) {
+      res = -ENOMEM;
+      goto Lerror;
+    }
+    SSL_set_fd(ssl, this->sock.get_fd());
+    SSL_set_connect_state(ssl);
+    // The certificate is always verified, against the name if there is one and against the address of the nameserver
+    // otherwise.
+    if (opt._tls_name != nullptr && *opt._tls_name != '\0') {
+      if (!SSL_set_tlsext_host_name(ssl, opt._tls_name) || !SSL_set1_host(ssl, opt._tls_name)) {
+        Warning("DNS over TLS name '%s' cannot be used", opt._tls_name);
+        res = -EINVAL;
+        goto Lerror;
+      }
+    } else if (!dns_tls_verify_ip(ssl, addr)) {
+      res = -EINVAL;
+      goto Lerror;
+    }
+    SSL_set_verify(ssl, SSL_VERIFY_PEER, nullptr);
+    // Start the handshake, it goes on as the connection becomes readable or writable.
+    if ((res = tls_handshake()) < 0 && res != -EAGAIN) {
+      goto Lerror;
+    }
+  }
+
   return 0;
 
 Lerror:
@@ -195,3 +259,91 @@ Lerror:
   }
   return res;
 }
+
+int
+DNSConnection::send(void const *buf, int len)
+{
+  if (ssl == nullptr) {
+    return this->sock.send(buf, len, 0);
+  }
+  tls_out.append(static_cast<char const *>(buf), len);
+  if (tls_ready) {
+    if (int res = tls_flush(); res < 0) {
+      return res;
+    }
+  }
+  return len;
+}
+
+int
+DNSConnection::recv(void *buf, int len, int flags)
+{
+  if (ssl == nullptr) {
+    return this->sock.recv(buf, len, flags);
+  }
+  if (int res = tls_handshake(); res < 0) {
+    return res;
+  }
+  if (int res = tls_flush(); res < 0) {
+    return res;
+  }
+
+  ERR_clear_error();
+  int res = (flags & MSG_PEEK) ? SSL_peek(ssl, buf, len) : SSL_read(ssl, buf, len);
+  if (res > 0) {
+    return res;
+  }
+  switch (SSL_get_error(ssl, res)) {
+  case SSL_ERROR_WANT_READ:
+  case SSL_ERROR_WANT_WRITE:
+    return -EAGAIN;
+  case SSL_ERROR_ZERO_RETURN:
+    return 0;
+  default:
+    return -EIO;
+  }
+}
+
+int
+DNSConnection::tls_handshake()
+{
+  if (tls_ready) {
+    return 0;
+  }
+
+  ERR_clear_error();
+  int res = SSL_do_handshake(ssl);
+  if (res == 1) {
+    tls_ready = true;
+    Dbg(dbg_ctl_dns, "TLS handshake done on fd %d, %zu bytes queued", this->sock.get_fd(), tls_out.size());
+    return tls_flush();
+  }
+
+  switch (SSL_get_error(ssl, res)) {
+  case SSL_ERROR_WANT_READ:
+  case SSL_ERROR_WANT_WRITE:
+    return -EAGAIN;
+  default: {
+    ip_port_text_buffer b;
+    char                err[256] = {0};
+    ERR_error_string_n(ERR_peek_last_error(), err, sizeof(err));
+    Warning("DNS over TLS handshake with %s failed: %s", ats_ip_nptop(&ip.sa, b, sizeof b), err);
+    return -EIO;
+  }
+  }
+}
+
+int
+DNSConnection::tls_flush()
+{
+  while (tls_ready && !tls_out.empty()) {
+    ERR_clear_error();
+    int res = SSL_write(ssl, tls_out.data(), tls_out.size());
+    if (res <= 0) {
+      int err = SSL_get_error(ssl, res);
+      return err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE ? 0 : -EIO;
+    }
+    tls_out.erase(0, res);
+  }
+  return 0;
+}
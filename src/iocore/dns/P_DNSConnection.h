@@ -41,11 +41,18 @@
 
 #include <swoc/IPEndpoint.h>
 
+#include <openssl/ssl.h>
+
+#include <string>
+
 //
 // Connection
 //
 struct DNSHandler;
-enum class DNS_CONN_MODE { UDP_ONLY, TCP_RETRY, TCP_ONLY };
+enum class DNS_CONN_MODE { UDP_ONLY, TCP_RETRY, TCP_ONLY, TLS_ONLY };
+
+// Nameservers configured on the plain DNS port are contacted on this port for DNS over TLS, RFC 7858.
+#define DNS_OVER_TLS_PORT 853
 
 struct DNSConnection {
   /// Options for connecting.
@@ -61,6 +68,12 @@ struct DNSConnection {
     /// Use TCP if @c true, use UDP if @c false.
     /// Default: @c false.
     bool _use_tcp = false;
+    /// Run TLS over the TCP connection.
+    /// Default: @c false.
+    bool _use_tls = false;
+    /// Name the TLS certificate of the nameserver must match, also sent as SNI.
+    /// Default: unset, the certificate must match the address of the nameserver.
+    char const *_tls_name = nullptr;
     /// Bind to a random port.
     /// Default: @c true.
     bool _bind_random_port = true;
@@ -74,6 +87,8 @@ struct DNSConnection {
     Options();
 
     self &setUseTcp(bool p);
+    self &setUseTls(bool p);
+    self &setTlsName(char const *name);
     self &setNonBlockingConnect(bool p);
     self &setNonBlockingIo(bool p);
     self &setBindRandomPort(bool p);
@@ -104,10 +119,43 @@ struct DNSConnection {
     }
   } tcp_data;
 
+  /// TLS session of a DNS over TLS connection.
+  SSL *ssl = nullptr;
+  /// The TLS handshake is done.
+  bool tls_ready = false;
+  /// Queries written before the handshake was done or while the socket was full.
+  std::string tls_out;
+
   int  connect(sockaddr const *addr, Options const &opt = DEFAULT_OPTIONS);
   int  close();
   void trigger();
 
+  /** Send a query, over TLS for a DNS over TLS connection.
+
+      Over TLS the query is queued until the handshake is done or the socket can take it.
+
+      @return The number of bytes sent or queued, or -errno.
+   */
+  int send(void const *buf, int len);
+
+  /** Receive from the connection, over TLS for a DNS over TLS connection.
+
+      @a flags may be @c MSG_PEEK.
+
+      @return The number of bytes received, 0 at the end of the connection, or -errno (-EAGAIN if there is nothing more
+      to read yet).
+   */
+  int recv(void *buf, int len, int flags);
+
+  /** Advance the TLS handshake and send the queued queries once it is done.
+
+      @return 0 if the handshake is done, -EAGAIN while it is in progress, or another -errno if it failed.
+   */
+  int tls_handshake();
+
+  /// Send as much of the queued queries as the TLS connection takes, @return 0 or -errno.
+  int tls_flush();
+
   virtual ~DNSConnection();
   DNSConnection();
 
@@ -135,6 +183,18 @@ DNSConnection::Options::setUseTcp(bool p)
   return *this;
 }
 inline DNSConnection::Options &
+DNSConnection::Options::setUseTls(bool p)
+{
+  _use_tls = p;
+  return *this;
+}
+inline DNSConnection::Options &
+DNSConnection::Options::setTlsName(char const *name)
+{
+  _tls_name = name;
+  return *this;
+}
+inline DNSConnection::Options &
 DNSConnection::Options::setBindRandomPort(bool p)
 {
   _bind_random_port = p;
@@ -25,6 +25,7 @@
 
 #include <cstdint>
 #include <cstring>
+#include <string>
 
 #include "iocore/dns/DNSProcessor.h"
 #include "P_DNSConnection.h"
@@ -65,19 +66,26 @@ using ts::Metrics;
 #define DEFAULT_DNS_SEARCH          1
 #define FAILOVER_SOON_RETRY         5
 #define NO_NAMESERVER_SELECTED      -1
+// queries sent and responses received per system call on the UDP connections
+#define DNS_UDP_SEND_BATCH 64
+#define DNS_UDP_RECV_BATCH 8
+// buckets of the nameserver response times, see DNSNameserverStats
+#define DNS_RTT_BUCKETS 12
 
 //
 // Config
 //
-extern int          dns_timeout;
-extern int          dns_retries;
-extern int          dns_search;
-extern int          dns_failover_number;
-extern int          dns_failover_period;
-extern int          dns_failover_try_period;
-extern int          dns_max_dns_in_flight;
-extern int          dns_max_tcp_continuous_failures;
-extern unsigned int dns_sequence_number;
+extern int           dns_timeout;
+extern int           dns_retries;
+extern int           dns_search;
+extern int           dns_failover_number;
+extern int           dns_failover_period;
+extern int           dns_failover_try_period;
+extern int           dns_max_dns_in_flight;
+extern int           dns_max_tcp_continuous_failures;
+extern unsigned int  dns_sequence_number;
+extern DNS_CONN_MODE dns_conn_mode;
+extern char         *dns_tls_name;
 
 //
 // Constants
@@ -119,6 +127,21 @@ struct DNSHandler;
 
 extern DNSStatsBlock dns_rsb;
 
+/** Stats of one nameserver, shared by the handlers that send to it.
+
+    The stats of a nameserver are never freed, a query keeps counting against the nameserver it was sent to even after its
+    handler connects that slot to another one.
+ */
+struct DNSNameserverStats {
+  Metrics::Gauge::AtomicType   *in_flight = nullptr;
+  Metrics::Counter::AtomicType *rtt[DNS_RTT_BUCKETS]{};
+
+  /// Create or find the stats of the nameserver at @a addr.
+  static DNSNameserverStats *get(sockaddr const *addr);
+  /// Count a response that took @a rtt.
+  void record_rtt(ink_hrtime rtt);
+};
+
 /**
   One DNSEntry is allocated per outstanding request. This continuation
   handles TIMEOUT events for the request as well as storing all
@@ -126,25 +149,26 @@ extern DNSStatsBlock dns_rsb;
 
 */
 struct DNSEntry : public Continuation {
-  int          id[MAX_DNS_RETRIES];
-  int          qtype          = 0;             ///< Type of query to send.
-  HostResStyle host_res_style = HOST_RES_NONE; ///< Preferred IP address family.
-  int          retries        = DEFAULT_DNS_RETRIES;
-  int          which_ns       = NO_NAMESERVER_SELECTED;
-  ink_hrtime   submit_time    = 0;
-  ink_hrtime   send_time      = 0;
-  char         qname[MAXDNAME + 1];
-  int          qname_len      = 0;
-  int          orig_qname_len = 0;
-  char       **domains        = nullptr;
-  EThread     *submit_thread  = nullptr;
-  Action       action;
-  Event       *timeout = nullptr;
-  Ptr<HostEnt> result_ent;
-  DNSHandler  *dnsH              = nullptr;
-  bool         written_flag      = false;
-  bool         once_written_flag = false;
-  bool         last              = false;
+  int                 id[MAX_DNS_RETRIES];
+  int                 qtype          = 0;             ///< Type of query to send.
+  HostResStyle        host_res_style = HOST_RES_NONE; ///< Preferred IP address family.
+  int                 retries        = DEFAULT_DNS_RETRIES;
+  int                 which_ns       = NO_NAMESERVER_SELECTED;
+  DNSNameserverStats *ns_stats       = nullptr; ///< Stats of the nameserver the query was sent to.
+  ink_hrtime          submit_time    = 0;
+  ink_hrtime          send_time      = 0;
+  char                qname[MAXDNAME + 1];
+  int                 qname_len      = 0;
+  int                 orig_qname_len = 0;
+  char              **domains        = nullptr;
+  EThread            *submit_thread  = nullptr;
+  Action              action;
+  Event              *timeout = nullptr;
+  Ptr<HostEnt>        result_ent;
+  DNSHandler         *dnsH              = nullptr;
+  bool                written_flag      = false;
+  bool                once_written_flag = false;
+  bool                last              = false;
   LINK(DNSEntry, dup_link);
   Que(DNSEntry, dup_link) dups;
 
@@ -188,7 +212,20 @@ struct DNSHandler : public Continuation {
   int                  name_server  = 0;
   int                  in_write_dns = 0;
 
-  HostEnt *hostent_cache = nullptr;
+  DNS_CONN_MODE conn_mode = DNS_CONN_MODE::UDP_ONLY;
+  std::string   tls_name; ///< Name the DNS over TLS nameservers must have certificates for.
+
+  HostEnt            *hostent_cache[DNS_UDP_RECV_BATCH] = {nullptr};
+  DNSNameserverStats *ns_stats[MAX_NAMED]                = {};
+
+  /// Queries for the UDP connections written since the last flush, sent with one system call per nameserver.
+  struct UDPBatch {
+    int           count = 0;
+    int           ns[DNS_UDP_SEND_BATCH];
+    int           len[DNS_UDP_SEND_BATCH];
+    DNSEntry     *entry[DNS_UDP_SEND_BATCH];
+    unsigned char buf[DNS_UDP_SEND_BATCH][MAX_DNS_REQUEST_LEN];
+  } udp_batch;
 
   int        ns_down[MAX_NAMED];
   int        failover_number[MAX_NAMED];
@@ -241,6 +278,56 @@ struct DNSHandler : public Continuation {
                            (HRTIME_SECONDS(dns_failover_try_period + failover_soon_number[i] * FAILOVER_SOON_RETRY))));
   }
 
+  /// Queries go over UDP, at least at first.
+  bool
+  uses_udp() const
+  {
+    return conn_mode == DNS_CONN_MODE::UDP_ONLY || conn_mode == DNS_CONN_MODE::TCP_RETRY;
+  }
+
+  /// Queries go over TCP or TLS, at least for retries.
+  bool
+  uses_stream() const
+  {
+    return conn_mode != DNS_CONN_MODE::UDP_ONLY;
+  }
+
+  /// Every query goes over TCP or TLS.
+  bool
+  stream_only() const
+  {
+    return conn_mode == DNS_CONN_MODE::TCP_ONLY || conn_mode == DNS_CONN_MODE::TLS_ONLY;
+  }
+
+  /// @a e was sent to nameserver @a ndx.
+  void
+  now_in_flight(DNSEntry *e, int ndx)
+  {
+    e->written_flag      = true;
+    e->which_ns          = ndx;
+    e->ns_stats          = ns_stats[ndx];
+    e->once_written_flag = true;
+    ++in_flight;
+    Metrics::Gauge::increment(dns_rsb.in_flight);
+    if (e->ns_stats) {
+      Metrics::Gauge::increment(e->ns_stats->in_flight);
+    }
+  }
+
+  /// @a e is no longer waiting for a response.
+  void
+  not_in_flight(DNSEntry *e)
+  {
+    e->written_flag = false;
+    --in_flight;
+    Metrics::Gauge::decrement(dns_rsb.in_flight);
+    if (e->ns_stats) {
+      Metrics::Gauge::decrement(e->ns_stats->in_flight);
+    }
+  }
+
+  bool flush_udp_batch();
+  void received(DNSConnection *dnsc, Ptr<HostEnt> &buf, int len);
   void recv_dns(int event, Event *e);
   int  startEvent(int event, Event *e);
   int  startEvent_sdns(int event, Event *e);
@@ -303,6 +390,9 @@ struct DNSServer {
   char x_def_domain[MAXDNAME];
   char x_domain_srch_list[MAXDNAME];
 
+  DNS_CONN_MODE x_conn_mode = dns_conn_mode;
+  char          x_tls_name[MAXDNAME];
+
   DNSHandler *x_dnsH = nullptr;
 
   DNSServer()
@@ -312,6 +402,7 @@ struct DNSServer {
     memset(x_def_domain, 0, MAXDNAME);
     memset(x_domain_srch_list, 0, MAXDNAME);
     memset(x_dns_ip_line, 0, MAXDNAME * 2);
+    memset(x_tls_name, 0, MAXDNAME);
   }
 };
 
@@ -333,6 +424,10 @@ DNSHandler::DNSHandler()
     udpcon[i].handler          = this;
   }
   memset(&qid_in_flight, 0, sizeof(qid_in_flight));
+  conn_mode = dns_conn_mode;
+  if (dns_tls_name != nullptr) {
+    tls_name = dns_tls_name;
+  }
   SET_HANDLER(&DNSHandler::startEvent);
   Dbg(_dbg_ctl_net_epoll, "inline DNSHandler::DNSHandler()");
 }
@@ -187,6 +187,8 @@ public:
   const char *ProcessDNSHosts(char *val);
   const char *ProcessDomainSrchList(char *val);
   const char *ProcessDefDomain(char *val);
+  const char *ProcessTransport(char *val);
+  const char *ProcessTlsName(char *val);
 
   void UpdateMatch(SplitDNSResult *result, RequestData *rdata);
   void Print() const;
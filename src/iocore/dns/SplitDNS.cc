@@ -424,6 +424,44 @@ SplitDNSRecord::ProcessDomainSrchList(char *val)
   return nullptr;
 }
 
+/* --------------------------------------------------------------
+   SplitDNSRecord::ProcessTransport()
+   -------------------------------------------------------------- */
+const char *
+SplitDNSRecord::ProcessTransport(char *val)
+{
+  if (strcasecmp(val, "udp") == 0) {
+    m_servers.x_conn_mode = DNS_CONN_MODE::UDP_ONLY;
+  } else if (strcasecmp(val, "tcp_retry") == 0) {
+    m_servers.x_conn_mode = DNS_CONN_MODE::TCP_RETRY;
+  } else if (strcasecmp(val, "tcp") == 0) {
+    m_servers.x_conn_mode = DNS_CONN_MODE::TCP_ONLY;
+  } else if (strcasecmp(val, "tls") == 0) {
+    m_servers.x_conn_mode = DNS_CONN_MODE::TLS_ONLY;
+  } else {
+    return "invalid transport, must be one of udp, tcp_retry, tcp or tls";
+  }
+
+  return nullptr;
+}
+
+/* --------------------------------------------------------------
+   SplitDNSRecord::ProcessTlsName()
+   -------------------------------------------------------------- */
+const char *
+SplitDNSRecord::ProcessTlsName(char *val)
+{
+  if (val == nullptr || *val == '\0') {
+    return "no TLS name specified";
+  }
+  if (strlen(val) > MAXDNAME - 1) {
+    return "TLS name is too long";
+  }
+  ink_strlcpy(m_servers.x_tls_name, val, MAXDNAME);
+
+  return nullptr;
+}
+
 /* --------------------------------------------------------------
    SplitDNSRecord::Init()
 
@@ -470,6 +508,24 @@ SplitDNSRecord::Init(matcher_line *line_info)
       line_info->num_el--;
       continue;
     }
+
+    if (strcasecmp(label, "transport") == 0) {
+      if (nullptr != (errPtr = ProcessTransport(val))) {
+        return Result::failure("%s %s at line %d", modulePrefix, errPtr, line_num);
+      }
+      line_info->line[0][i] = nullptr;
+      line_info->num_el--;
+      continue;
+    }
+
+    if (strcasecmp(label, "tls_name") == 0) {
+      if (nullptr != (errPtr = ProcessTlsName(val))) {
+        return Result::failure("%s %s at line %d", modulePrefix, errPtr, line_num);
+      }
+      line_info->line[0][i] = nullptr;
+      line_info->num_el--;
+      continue;
+    }
   }
 
   if (!ats_is_ip(&m_servers.x_server_ip[0].sa)) {
@@ -487,8 +543,12 @@ SplitDNSRecord::Init(matcher_line *line_info)
                            ats_ip_ntop(&m_servers.x_server_ip[0].sa, ab, sizeof ab));
   }
 
-  dnsH->m_res = res;
-  dnsH->mutex = SplitDNSConfig::dnsHandler_mutex;
+  dnsH->m_res     = res;
+  dnsH->mutex     = SplitDNSConfig::dnsHandler_mutex;
+  dnsH->conn_mode = m_servers.x_conn_mode;
+  if (m_servers.x_tls_name[0] != '\0') {
+    dnsH->tls_name = m_servers.x_tls_name;
+  }
   ats_ip_invalidate(&dnsH->ip.sa); // Mark to use default DNS.
 
   m_servers.x_dnsH = dnsH;
@@ -0,0 +1,363 @@
+/** @file
+
+  Catch based unit tests for the DNS connections, over UDP and over TLS
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../P_DNSProcessor.h"
+
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+extern int dns_ns_rr;
+
+namespace
+{
+IpEndpoint
+loopback(in_port_t port = 0)
+{
+  IpEndpoint ep;
+  ep.setToLoopback(AF_INET);
+  ep.network_order_port() = htons(port);
+  return ep;
+}
+
+/// A socket on the loopback address, @return its address in @a ep.
+int
+bound_socket(int type, IpEndpoint &ep)
+{
+  int       fd = socket(AF_INET, type, 0);
+  socklen_t sz = sizeof(ep);
+  ep           = loopback();
+  REQUIRE(fd >= 0);
+  REQUIRE(bind(fd, &ep.sa, ats_ip_size(&ep.sa)) == 0);
+  REQUIRE(getsockname(fd, &ep.sa, &sz) == 0);
+  return fd;
+}
+
+/// A TLS server context with a self signed certificate for @a san, e.g. "IP:127.0.0.1" or "DNS:dns.example".
+SSL_CTX *
+server_ctx(char const *san, X509 *&cert)
+{
+  EVP_PKEY     *pkey = nullptr;
+  EVP_PKEY_CTX *kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+  REQUIRE(EVP_PKEY_keygen_init(kctx) == 1);
+  REQUIRE(EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1) == 1);
+  REQUIRE(EVP_PKEY_keygen(kctx, &pkey) == 1);
+  EVP_PKEY_CTX_free(kctx);
+
+  cert = X509_new();
+  X509_set_version(cert, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert), -60);
+  X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+  // The certificates of all the tests end up in the same store, each needs its own subject.
+  static int  serial = 0;
+  std::string cn     = "nameserver " + std::to_string(++serial);
+  X509_NAME_add_entry_by_txt(X509_get_subject_name(cert), "CN", MBSTRING_ASC, reinterpret_cast<unsigned char const *>(cn.c_str()),
+                             -1, -1, 0);
+  X509_set_issuer_name(cert, X509_get_subject_name(cert));
+  X509_set_pubkey(cert, pkey);
+  X509_EXTENSION *ext = X509V3_EXT_conf_nid(nullptr, nullptr, NID_subject_alt_name, const_cast<char *>(san));
+  REQUIRE(ext != nullptr);
+  X509_add_ext(cert, ext, -1);
+  X509_EXTENSION_free(ext);
+  REQUIRE(X509_sign(cert, pkey, EVP_sha256()) > 0);
+
+  SSL_CTX *ctx = SSL_CTX_new(TLS_server_method());
+  REQUIRE(SSL_CTX_use_certificate(ctx, cert) == 1);
+  REQUIRE(SSL_CTX_use_PrivateKey(ctx, pkey) == 1);
+  EVP_PKEY_free(pkey);
+  return ctx;
+}
+
+/** A DNS over TLS nameserver taking one connection.
+
+    It reads one length prefixed query and answers with @a answers, written at once.
+ */
+struct TLSNameserver {
+  IpEndpoint  addr;
+  int         fd   = -1;
+  X509       *cert = nullptr;
+  SSL_CTX    *ctx  = nullptr;
+  std::string query;
+  std::thread thread;
+
+  /// The handshake starts once the client trusts the certificate.
+  std::atomic<bool> trusted{false};
+
+  TLSNameserver(char const *san, std::string answers)
+  {
+    ctx = server_ctx(san, cert);
+    fd  = bound_socket(SOCK_STREAM, addr);
+    REQUIRE(listen(fd, 1) == 0);
+    thread = std::thread([this, answers]() {
+      while (!trusted) {
+        std::this_thread::yield();
+      }
+      int  con = accept(fd, nullptr, nullptr);
+      SSL *ssl = SSL_new(ctx);
+      SSL_set_fd(ssl, con);
+      if (SSL_accept(ssl) == 1) {
+        unsigned char len[2];
+        if (SSL_read(ssl, len, 2) == 2) {
+          query.resize(len[0] << 8 | len[1]);
+          if (SSL_read(ssl, query.data(), query.size()) == static_cast<int>(query.size())) {
+            SSL_write(ssl, answers.data(), answers.size());
+          }
+        }
+        SSL_shutdown(ssl);
+      }
+      SSL_free(ssl);
+      ::close(con);
+    });
+  }
+
+  ~TLSNameserver()
+  {
+    thread.join();
+    ::close(fd);
+    SSL_CTX_free(ctx);
+    X509_free(cert);
+  }
+};
+
+/// Connect @a con over TLS to @a ns, trusting the certificate of @a ns. @return the result of the connect.
+int
+connect_tls(DNSConnection &con, TLSNameserver &ns, char const *tls_name = nullptr)
+{
+  int res = con.connect(
+    &ns.addr.sa, DNSConnection::Options{}.setUseTcp(true).setUseTls(true).setTlsName(tls_name).setBindRandomPort(false));
+  if (res == 0) {
+    // The handshake waits for the nameserver, the certificate is checked once it arrives.
+    X509_STORE_add_cert(SSL_CTX_get_cert_store(SSL_get_SSL_CTX(con.ssl)), ns.cert);
+  }
+  ns.trusted = true;
+  return res;
+}
+
+/// Read from @a con until @a len bytes arrived or the connection failed. @return The bytes read or -errno.
+int
+recv_all(DNSConnection &con, char *buf, int len)
+{
+  int done = 0;
+  while (done < len) {
+    pollfd pfd{con.sock.get_fd(), POLLIN | POLLOUT, 0};
+    poll(&pfd, 1, 1000);
+    int res = con.recv(buf + done, len - done, 0);
+    if (res == -EAGAIN) {
+      continue;
+    } else if (res <= 0) {
+      return done ? done : res;
+    }
+    done += res;
+  }
+  return done;
+}
+
+/// A TCP DNS message: a length prefix, then @a text.
+std::string
+framed(std::string const &text)
+{
+  std::string msg{static_cast<char>(text.size() >> 8), static_cast<char>(text.size() & 0xff)};
+  return msg + text;
+}
+} // namespace
+
+TEST_CASE("DNS over TLS", "[dns][tls]")
+{
+  SECTION("queries sent before the handshake and answers in one record")
+  {
+    std::string   answers = framed("first answer") + framed("second answer");
+    TLSNameserver ns{"IP:127.0.0.1", answers};
+    DNSConnection con;
+
+    REQUIRE(connect_tls(con, ns) == 0);
+    std::string query = framed("query");
+    REQUIRE(con.send(query.data(), query.size()) == static_cast<int>(query.size()));
+
+    std::string got(answers.size(), '\0');
+    REQUIRE(recv_all(con, got.data(), got.size()) == static_cast<int>(answers.size()));
+    CHECK(got == answers);
+    CHECK(con.tls_ready);
+    CHECK(con.tls_out.empty());
+    con.close();
+    CHECK(ns.query == "query");
+  }
+
+  SECTION("the certificate matches the name")
+  {
+    std::string   answers = framed("answer");
+    TLSNameserver ns{"DNS:dns.example", answers};
+    DNSConnection con;
+
+    REQUIRE(connect_tls(con, ns, "dns.example") == 0);
+    std::string query = framed("query");
+    con.send(query.data(), query.size());
+    std::string got(answers.size(), '\0');
+    CHECK(recv_all(con, got.data(), got.size()) == static_cast<int>(answers.size()));
+    con.close();
+  }
+
+  SECTION("the certificate does not match the name")
+  {
+    TLSNameserver ns{"DNS:dns.example", framed("answer")};
+    DNSConnection con;
+
+    REQUIRE(connect_tls(con, ns, "other.example") == 0);
+    char buf[16];
+    CHECK(recv_all(con, buf, sizeof(buf)) == -EIO);
+    CHECK_FALSE(con.tls_ready);
+    con.close();
+  }
+
+  SECTION("without a name the certificate must match the address")
+  {
+    TLSNameserver ns{"IP:127.0.0.2", framed("answer")};
+    DNSConnection con;
+
+    REQUIRE(connect_tls(con, ns) == 0);
+    char buf[16];
+    CHECK(recv_all(con, buf, sizeof(buf)) == -EIO);
+    CHECK_FALSE(con.tls_ready);
+    con.close();
+  }
+}
+
+TEST_CASE("DNS UDP batch failure", "[dns][udp]")
+{
+  ts_imp_res_state res;
+  DNSHandler       h;
+  DNSEntry         entries[2];
+  IpEndpoint       ns_addr;
+  int              ns_fd = bound_socket(SOCK_DGRAM, ns_addr);
+
+  memset(&res, 0, sizeof(res));
+  res.nscount = 2;
+  ats_ip_copy(&res.nsaddr_list[0].sa, &ns_addr.sa);
+  ats_ip_copy(&res.nsaddr_list[1].sa, &ns_addr.sa);
+  h.m_res = &res;
+
+  // The connection to nameserver 0 is not open, sending to it fails.
+  REQUIRE(h.udpcon[1].connect(&ns_addr.sa, DNSConnection::Options{}.setBindRandomPort(false)) == 0);
+  for (int i = 0; i < 2; ++i) {
+    h.ns_down[i] = 0;
+    snprintf(entries[i].qname, sizeof(entries[i].qname), "q%d.example", i);
+    h.now_in_flight(&entries[i], i);
+    h.udp_batch.ns[i]    = i;
+    h.udp_batch.entry[i] = &entries[i];
+    h.udp_batch.len[i]   = snprintf(reinterpret_cast<char *>(h.udp_batch.buf[i]), MAX_DNS_REQUEST_LEN, "query %d", i);
+  }
+  h.udp_batch.count = 2;
+
+  SECTION("round robin nameservers")
+  {
+    dns_ns_rr = 1;
+    CHECK_FALSE(h.flush_udp_batch());
+    dns_ns_rr = 0;
+
+    CHECK(h.ns_down[0] == 1);
+    CHECK(h.ns_down[1] == 0);
+    CHECK(h.name_server == 0);
+  }
+
+  SECTION("only one primary nameserver")
+  {
+    // With nowhere to fail over to, the nameserver is marked down and retried later.
+    res.nscount = 1;
+    CHECK_FALSE(h.flush_udp_batch());
+
+    CHECK(h.ns_down[0] == 1);
+    CHECK(h.name_server == 0);
+  }
+
+  // The query that was not sent waits to be written again, the other one reached its nameserver.
+  CHECK(h.udp_batch.count == 0);
+  CHECK_FALSE(entries[0].written_flag);
+  CHECK(entries[0].which_ns == NO_NAMESERVER_SELECTED);
+  CHECK(entries[1].written_flag);
+  CHECK(entries[1].which_ns == 1);
+  CHECK(h.in_flight == 1);
+
+  char buf[64];
+  int  n = recv(ns_fd, buf, sizeof(buf), MSG_DONTWAIT);
+  CHECK(std::string(buf, std::max(n, 0)) == "query 1");
+
+  h.m_res = nullptr;
+  ::close(ns_fd);
+}
+
+TEST_CASE("DNS nameserver response times", "[dns][stats]")
+{
+  IpEndpoint          ns    = loopback(5353);
+  DNSNameserverStats &stats = *DNSNameserverStats::get(&ns.sa);
+
+  auto count = [](char const *bucket) {
+    auto *metric = Metrics::instance().lookup(std::string{"proxy.process.dns.nameserver.127.0.0.1:5353.rtt."} + bucket, nullptr);
+    REQUIRE(metric != nullptr);
+    return metric->load();
+  };
+
+  // Each bucket counts the responses from its bound up to the next one.
+  stats.record_rtt(HRTIME_USECONDS(300));
+  stats.record_rtt(HRTIME_MSECONDS(1));
+  stats.record_rtt(HRTIME_USECONDS(1999));
+  stats.record_rtt(HRTIME_MSECONDS(2));
+  stats.record_rtt(HRTIME_SECONDS(5));
+  CHECK(count("0us") == 1);
+  CHECK(count("1000us") == 2);
+  CHECK(count("2000us") == 1);
+  CHECK(count("5000us") == 0);
+  CHECK(count("2000000us") == 1);
+}
+
+TEST_CASE("DNS nameserver in flight", "[dns][stats]")
+{
+  DNSHandler h;
+  DNSEntry   entry;
+  IpEndpoint first  = loopback(5354);
+  IpEndpoint second = loopback(5355);
+
+  auto in_flight = [](char const *ns) {
+    auto *metric = Metrics::instance().lookup(std::string{"proxy.process.dns.nameserver."} + ns + ".in_flight", nullptr);
+    REQUIRE(metric != nullptr);
+    return metric->load();
+  };
+
+  h.ns_stats[0] = DNSNameserverStats::get(&first.sa);
+  CHECK(DNSNameserverStats::get(&first.sa) == h.ns_stats[0]);
+  h.now_in_flight(&entry, 0);
+  CHECK(in_flight("127.0.0.1:5354") == 1);
+
+  // The slot is connected to another nameserver while the query waits, the response is counted against the first one.
+  h.ns_stats[0] = DNSNameserverStats::get(&second.sa);
+  h.not_in_flight(&entry);
+  CHECK(in_flight("127.0.0.1:5354") == 0);
+  CHECK(in_flight("127.0.0.1:5355") == 0);
+}
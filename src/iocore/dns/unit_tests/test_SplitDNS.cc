@@ -0,0 +1,91 @@
+/** @file
+
+  Catch based unit tests for the splitdns.config parsing
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../P_SplitDNSProcessor.h"
+
+#include "tscore/MatcherUtils.h"
+
+#include <string>
+
+TEST_CASE("SplitDNS transport", "[dns][splitdns]")
+{
+  SplitDNSRecord rec;
+  char           udp[]       = "udp";
+  char           tcp_retry[] = "tcp_retry";
+  char           tcp[]       = "TCP";
+  char           tls[]       = "tls";
+  char           bogus[]     = "quic";
+
+  REQUIRE(rec.ProcessTransport(udp) == nullptr);
+  CHECK(rec.m_servers.x_conn_mode == DNS_CONN_MODE::UDP_ONLY);
+  REQUIRE(rec.ProcessTransport(tcp_retry) == nullptr);
+  CHECK(rec.m_servers.x_conn_mode == DNS_CONN_MODE::TCP_RETRY);
+  REQUIRE(rec.ProcessTransport(tcp) == nullptr);
+  CHECK(rec.m_servers.x_conn_mode == DNS_CONN_MODE::TCP_ONLY);
+  REQUIRE(rec.ProcessTransport(tls) == nullptr);
+  CHECK(rec.m_servers.x_conn_mode == DNS_CONN_MODE::TLS_ONLY);
+
+  CHECK(rec.ProcessTransport(bogus) != nullptr);
+  CHECK(rec.m_servers.x_conn_mode == DNS_CONN_MODE::TLS_ONLY);
+}
+
+TEST_CASE("SplitDNS TLS name", "[dns][splitdns]")
+{
+  SplitDNSRecord rec;
+  char           name[]  = "dns.example.com";
+  char           empty[] = "";
+  std::string    longer(MAXDNAME, 'a');
+
+  REQUIRE(rec.ProcessTlsName(name) == nullptr);
+  CHECK(std::string{rec.m_servers.x_tls_name} == "dns.example.com");
+
+  CHECK(rec.ProcessTlsName(empty) != nullptr);
+  CHECK(rec.ProcessTlsName(nullptr) != nullptr);
+  CHECK(rec.ProcessTlsName(longer.data()) != nullptr);
+  CHECK(std::string{rec.m_servers.x_tls_name} == "dns.example.com");
+}
+
+TEST_CASE("SplitDNS line", "[dns][splitdns]")
+{
+  SECTION("bad transport")
+  {
+    SplitDNSRecord rec;
+    matcher_line   line;
+    char           text[] = "dest_domain=example.com named=127.0.0.1 transport=quic";
+
+    REQUIRE(parseConfigLine(text, &line, &http_dest_tags) == nullptr);
+    CHECK(rec.Init(&line).failed());
+  }
+
+  SECTION("empty TLS name")
+  {
+    SplitDNSRecord rec;
+    matcher_line   line;
+    char           text[] = "dest_domain=example.com named=127.0.0.1 transport=tls tls_name=\"\"";
+
+    REQUIRE(parseConfigLine(text, &line, &http_dest_tags) == nullptr);
+    CHECK(rec.Init(&line).failed());
+  }
+}
@@ -0,0 +1,56 @@
+/** @file
+
+  Catch based unit tests for libinkdns
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "../P_DNSProcessor.h"
+
+#include "tscore/BaseLogFile.h"
+#include "tscore/Diags.h"
+#include "tscore/Layout.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/reporters/catch_reporter_event_listener.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <catch2/interfaces/catch_interfaces_config.hpp>
+
+class DiagsListener final : public Catch::EventListenerBase
+{
+public:
+  using EventListenerBase::EventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    BaseLogFile *base_log_file = new BaseLogFile("stderr");
+    DiagsPtr::set(new Diags(std::string_view{testRunInfo.name.data(), testRunInfo.name.size()}, "" /* tags */, "" /* actions */,
+                            base_log_file));
+
+    diags()->activate_taglist("dns", DiagsTagType_Debug);
+    diags()->config.enabled(DiagsTagType_Debug, 0); // set 1 if you want to see debug log
+    diags()->show_location = SHOW_LOCATION_DEBUG;
+
+    dns_rsb.in_flight = Metrics::Gauge::createPtr("proxy.process.dns.in_flight");
+  }
+};
+
+CATCH_REGISTER_LISTENER(DiagsListener);
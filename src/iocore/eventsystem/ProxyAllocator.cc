@@ -34,6 +34,7 @@ thread_alloc(Allocator &a, ProxyAllocator &l)
     void *v    = l.freelist;
     l.freelist = *static_cast<void **>(l.freelist);
     --(l.allocated);
+    ++ink_thread_alloc_count;
     return v;
   }
   return a.alloc_void();
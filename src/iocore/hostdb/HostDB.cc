@@ -31,6 +31,7 @@
 #include "../dns/P_SplitDNSProcessor.h"
 #include "tscore/MgmtDefs.h" // MgmtInt, MgmtFloat, etc
 #include "iocore/hostdb/HostFile.h"
+#include "iocore/hostdb/HostDBSnapshot.h"
 
 #include <utility>
 #include <vector>
@@ -59,6 +60,8 @@ unsigned int                      hostdb_ip_stale_interval          = HOST_DB_IP
 unsigned int                      hostdb_ip_timeout_interval        = HOST_DB_IP_TIMEOUT;
 unsigned int                      hostdb_ip_fail_timeout_interval   = HOST_DB_IP_FAIL_TIMEOUT;
 unsigned int                      hostdb_serve_stale_but_revalidate = 0;
+unsigned int                      hostdb_refresh_ahead              = 0;
+unsigned int                      hostdb_snapshot_max_stale         = 3600;
 static ts_seconds                 hostdb_hostfile_check_interval{std::chrono::hours(24)};
 // Epoch timestamp of the current hosts file check. This also functions as a
 // cached version of ts_clock::now().
@@ -69,6 +72,7 @@ static ts_time hostdb_last_timestamp{TS_TIME_ZERO};
 static ts_time          hostdb_hostfile_update_timestamp{TS_TIME_ZERO};
 int                     hostdb_max_count = DEFAULT_HOST_DB_SIZE;
 static swoc::file::path hostdb_hostfile_path;
+static swoc::file::path hostdb_snapshot_path;
 int                     hostdb_disable_reverse_lookup = 0;
 int                     hostdb_max_iobuf_index        = BUFFER_SIZE_INDEX_32K;
 
@@ -99,6 +103,42 @@ HOSTDB_CLIENT_IP_HASH(sockaddr const *lhs, IpAddr const &rhs)
   return zret & 0xFFFF;
 }
 
+/** Records found by the lookups of this thread, so that hits do not take the partition lock.
+
+    A slot is current while its record is still the one in the cache for the key, so a change to one name leaves the
+    slots of the other names alone. The slots hold a reference to their records, which is not released at thread exit
+    because the record allocator may already be gone by then.
+ */
+struct ThreadRecords {
+  static constexpr size_t SLOTS = 1024;
+
+  struct Slot {
+    uint64_t      key    = 0;
+    HostDBRecord *record = nullptr;
+  };
+  Slot slots[SLOTS];
+
+  HostDBRecord *
+  find(uint64_t key) const
+  {
+    Slot const &slot = slots[key % SLOTS];
+    return slot.record != nullptr && slot.key == key && slot.record->cached.load(std::memory_order_acquire) ? slot.record : nullptr;
+  }
+
+  void
+  fill(uint64_t key, HostDBRecord *record)
+  {
+    Slot &slot = slots[key % SLOTS];
+    record->refcount_inc();
+    if (slot.record != nullptr && slot.record->refcount_dec() == 0) {
+      slot.record->free();
+    }
+    slot = {key, record};
+  }
+};
+
+thread_local ThreadRecords thread_records;
+
 } // namespace
 
 // Static configuration information
@@ -287,6 +327,81 @@ HostDBCache::start(int flags)
   return 0;
 }
 
+void
+HostDBCache::load_snapshot(swoc::file::path const &path)
+{
+  ink_hrtime      start = ink_get_hrtime();
+  std::error_code ec;
+  std::string     data = swoc::file::load(path, ec);
+  if (ec) {
+    if (ec.value() != ENOENT) {
+      Warning("failed to read the HostDB snapshot %s - %s", path.c_str(), ec.message().c_str());
+    }
+    return;
+  }
+
+  std::vector<HostDBRecord::Handle> records;
+  if (!HostDBSnapshot::read(data, records, hostdb_round_robin_max_count)) {
+    Warning("ignoring the HostDB snapshot %s, it is not a complete snapshot of this version", path.c_str());
+    return;
+  }
+
+  // Records that expired too long ago would not be served, leave them out.
+  unsigned loaded = 0;
+  for (auto const &r : records) {
+    if (r->ip_age() > r->ip_timeout_interval + ts_seconds(hostdb_snapshot_max_stale)) {
+      continue;
+    }
+    ts::shared_mutex                  &bucket_lock = refcountcache->lock_for_key(r->key);
+    std::unique_lock<ts::shared_mutex> lock{bucket_lock};
+    refcountcache->put(r->key, r.get(), r->_record_size, duration_cast<ts_seconds>(r->expiry_time().time_since_epoch()).count());
+    ++loaded;
+  }
+
+  auto msec = ink_hrtime_to_msec(ink_get_hrtime() - start);
+  Metrics::Gauge::store(hostdb_rsb.snapshot_loaded_records, loaded);
+  Metrics::Gauge::store(hostdb_rsb.snapshot_load_time, msec);
+  Note("loaded %u of %zu records from the HostDB snapshot %s in %" PRId64 " ms", loaded, records.size(), path.c_str(), msec);
+}
+
+void
+HostDBCache::write_snapshot(swoc::file::path const &path)
+{
+  // Only hold each partition lock long enough to take references to its records.
+  std::vector<HostDBRecord::Handle> records;
+  records.reserve(refcountcache->count());
+  for (size_t i = 0; i < refcountcache->partition_count(); ++i) {
+    auto                              &partition = refcountcache->get_partition(i);
+    std::shared_lock<ts::shared_mutex> lock{partition.lock};
+    for (auto const &entry : partition.get_map()) {
+      records.emplace_back(static_cast<HostDBRecord *>(entry.item.get()));
+    }
+  }
+
+  std::string data;
+  size_t      count = HostDBSnapshot::write(data, records);
+  records.clear();
+  if (auto ec = HostDBSnapshot::save(path, data); ec) {
+    Warning("failed to write the HostDB snapshot %s - %s", path.c_str(), ec.message().c_str());
+    return;
+  }
+  Metrics::Gauge::store(hostdb_rsb.snapshot_records, count);
+  Metrics::Gauge::store(hostdb_rsb.snapshot_bytes, data.size());
+  Dbg(dbg_ctl_hostdb, "wrote %zu records, %zu bytes to the HostDB snapshot %s", count, data.size(), path.c_str());
+}
+
+// Periodically writes the HostDB snapshot, on a task thread as it blocks on the file.
+struct HostDBSnapshotContinuation : public Continuation {
+  HostDBSnapshotContinuation() : Continuation(new_ProxyMutex()) { SET_HANDLER(&HostDBSnapshotContinuation::snapshotEvent); }
+
+  int
+  snapshotEvent(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    hostDB.write_snapshot(hostdb_snapshot_path);
+    return EVENT_CONT;
+  }
+};
+
 // Start up the Host Database processor.
 // Load configuration, register configuration and statistics and
 // open the cache. This doesn't create any threads, so those
@@ -319,7 +434,9 @@ HostDBProcessor::init()
   RecEstablishStaticConfigUInt32(hostdb_ip_stale_interval, "proxy.config.hostdb.verify_after");
   RecEstablishStaticConfigUInt32(hostdb_ip_fail_timeout_interval, "proxy.config.hostdb.fail.timeout");
   RecEstablishStaticConfigUInt32(hostdb_serve_stale_but_revalidate, "proxy.config.hostdb.serve_stale_for");
+  RecEstablishStaticConfigUInt32(hostdb_refresh_ahead, "proxy.config.hostdb.refresh_ahead");
   RecEstablishStaticConfigUInt32(hostdb_round_robin_max_count, "proxy.config.hostdb.round_robin_max_count");
+  RecEstablishStaticConfigUInt32(hostdb_snapshot_max_stale, "proxy.config.hostdb.snapshot.max_stale");
   const char *interval_config = "proxy.config.hostdb.host_file.interval";
   {
     RecInt tmp_interval{};
@@ -347,6 +464,21 @@ HostDBProcessor::init()
   b->mutex = new_ProxyMutex();
   eventProcessor.schedule_every(b, HRTIME_SECONDS(1), ET_DNS);
 
+  //
+  // Warm up from the last snapshot, this is done before the proxy accepts
+  // any traffic. Then keep the snapshot current.
+  //
+  if (auto snapshot_interval = RecGetRecordInt("proxy.config.hostdb.snapshot.interval").value_or(0);
+      hostdb_enable && snapshot_interval > 0) {
+    auto path            = RecGetRecordStringAlloc("proxy.config.hostdb.snapshot.path");
+    hostdb_snapshot_path = path && !path->empty() ? path->c_str() : "hostdb.snapshot";
+    if (hostdb_snapshot_path.is_relative()) {
+      hostdb_snapshot_path = swoc::file::path(RecConfigReadRuntimeDir()) / hostdb_snapshot_path;
+    }
+    hostDB.load_snapshot(hostdb_snapshot_path);
+    eventProcessor.schedule_every(new HostDBSnapshotContinuation, HRTIME_SECONDS(snapshot_interval), ET_TASK);
+  }
+
   return 0;
 }
 
@@ -457,6 +589,18 @@ probe_hostfile(HostDBHash const &hash)
   return result;
 }
 
+// Look up @a hash again in the background while @a record is still served.
+static void
+refresh(HostDBHash const &hash, HostDBRecord const *record)
+{
+  HostDBContinuation         *c = hostDBContAllocator.alloc();
+  HostDBContinuation::Options copt;
+  copt.host_res_style = record->af_family == AF_INET6 ? HOST_RES_IPV6_ONLY : HOST_RES_IPV4_ONLY;
+  c->init(hash, copt);
+  SCOPED_MUTEX_LOCK(lock, c->mutex, this_ethread());
+  c->do_dns();
+}
+
 HostDBRecord::Handle
 probe(HostDBHash const &hash, bool ignore_timeout)
 {
@@ -468,11 +612,13 @@ probe(HostDBHash const &hash, bool ignore_timeout)
   }
 
   // Otherwise HostDB is enabled, so we'll do our thing
-  uint64_t          folded_hash = hash.hash.fold();
-  ts::shared_mutex &bucket_lock = hostDB.refcountcache->lock_for_key(folded_hash);
+  uint64_t folded_hash = hash.hash.fold();
 
-  Ptr<HostDBRecord> record;
-  {
+  Ptr<HostDBRecord> record{thread_records.find(folded_hash)};
+  if (record) {
+    Metrics::Counter::increment(hostdb_rsb.thread_cache_hits);
+  } else {
+    ts::shared_mutex                  &bucket_lock = hostDB.refcountcache->lock_for_key(folded_hash);
     std::shared_lock<ts::shared_mutex> lock{bucket_lock};
 
     // get the record from cache
@@ -485,15 +631,16 @@ probe(HostDBHash const &hash, bool ignore_timeout)
       }
       return record;
     }
+    thread_records.fill(folded_hash, record.get());
+  }
 
-    // If the dns response was failed, and we've hit the failed timeout, lets stop returning it
-    if (record->is_failed() && record->is_ip_fail_timeout()) {
-      return NO_RECORD;
-      // if we aren't ignoring timeouts, and we are past it-- then remove the record
-    } else if (!ignore_timeout && record->is_ip_timeout() && !record->serve_stale_but_revalidate()) {
-      Metrics::Counter::increment(hostdb_rsb.ttl_expires);
-      return NO_RECORD;
-    }
+  // If the dns response was failed, and we've hit the failed timeout, lets stop returning it
+  if (record->is_failed() && record->is_ip_fail_timeout()) {
+    return NO_RECORD;
+    // if we aren't ignoring timeouts, and we are past it-- then remove the record
+  } else if (!ignore_timeout && record->is_ip_timeout() && !record->serve_stale_but_revalidate()) {
+    Metrics::Counter::increment(hostdb_rsb.ttl_expires);
+    return NO_RECORD;
   }
 
   // If the record is stale, but we want to revalidate-- lets start that up
@@ -511,12 +658,15 @@ probe(HostDBHash const &hash, bool ignore_timeout)
         swoc::bwprint(ts::bw_dbg, "stale {} {} {}, using while refresh", record->ip_age(), record->ip_timestamp.time_since_epoch(),
                       record->ip_timeout_interval)
           .c_str());
-    HostDBContinuation         *c = hostDBContAllocator.alloc();
-    HostDBContinuation::Options copt;
-    copt.host_res_style = record->af_family == AF_INET6 ? HOST_RES_IPV6_ONLY : HOST_RES_IPV4_ONLY;
-    c->init(hash, copt);
-    SCOPED_MUTEX_LOCK(lock, c->mutex, this_ethread());
-    c->do_dns();
+    refresh(hash, record.get());
+  } else if (!ignore_timeout && record->is_ip_refresh_due() && !record->refresh_started.load(std::memory_order_relaxed) &&
+             !record->refresh_started.exchange(true) && !hostDB.is_pending_dns_for_hash(hash.hash)) {
+    // A name that is still in use near the end of its TTL, refresh it now so lookups do not wait for DNS once it expires.
+    Metrics::Counter::increment(hostdb_rsb.total_refresh_ahead);
+    Dbg(dbg_ctl_hostdb, "%s",
+        swoc::bwprint(ts::bw_dbg, "refresh ahead {} remaining of {}", record->ip_time_remaining(), record->ip_timeout_interval)
+          .c_str());
+    refresh(hash, record.get());
   }
   return record;
 }
@@ -566,12 +716,8 @@ HostDBProcessor::getby(Continuation *cont, cb_process_result_pfn cb_process_resu
     bool loop = lock.is_locked();
     while (loop) {
       loop = false; // Only loop on explicit set for retry.
-      // find the partition lock
-      ts::shared_mutex &bucket_lock = hostDB.refcountcache->lock_for_key(hash.hash.fold());
-
-      // If we can get the lock and a level 1 probe succeeds, return
-      HostDBRecord::Handle               r = probe(hash, false);
-      std::shared_lock<ts::shared_mutex> lock{bucket_lock};
+      // If a level 1 probe succeeds, return. The record is held by the handle, so the partition lock is not needed.
+      HostDBRecord::Handle r = probe(hash, false);
       if (r) {
         // fail, see if we should retry with alternate
         if (hash.db_mark != HOSTDB_MARK_SRV && r->is_failed() && hash.host_name) {
@@ -925,10 +1071,10 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
     r->flags.f.failed_p = failed;
 
     // If the DNS lookup failed (errors such as SERVFAIL, etc.) but we have an old record
-    // which is okay with being served stale-- lets continue to serve the stale record as long as
-    // the record is willing to be served.
+    // which has not expired yet (a refresh ahead) or is okay with being served stale-- lets
+    // continue to serve the old record as long as the record is willing to be served.
     bool serve_stale = false;
-    if (failed && old_r && old_r->serve_stale_but_revalidate()) {
+    if (failed && old_r && old_r->keep_on_failed_lookup()) {
       r           = old_r;
       serve_stale = true;
     } else if (hash.is_byname()) {
@@ -995,7 +1141,7 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
       auto const                         seconds_till_revalidate  = duration_cast<ts_seconds>(duration_till_revalidate).count();
       hostDB.refcountcache->put(r->key, r.get(), r->_record_size, seconds_till_revalidate);
     } else {
-      Warning("Fallback to serving stale record, skip re-update of hostdb for %.*s", int(query_name.size()), query_name.data());
+      Warning("Fallback to serving the old record, skip re-update of hostdb for %.*s", int(query_name.size()), query_name.data());
     }
 
     // try to callback the user
@@ -1406,10 +1552,16 @@ ink_hostdb_init(ts::ModuleVersion v)
   hostdb_rsb.total_lookups                   = Metrics::Counter::createPtr("proxy.process.hostdb.total_lookups");
   hostdb_rsb.total_hits                      = Metrics::Counter::createPtr("proxy.process.hostdb.total_hits");
   hostdb_rsb.total_serve_stale               = Metrics::Counter::createPtr("proxy.process.hostdb.total_serve_stale");
+  hostdb_rsb.total_refresh_ahead             = Metrics::Counter::createPtr("proxy.process.hostdb.total_refresh_ahead");
+  hostdb_rsb.thread_cache_hits               = Metrics::Counter::createPtr("proxy.process.hostdb.thread_cache_hits");
   hostdb_rsb.ttl                             = Metrics::Counter::createPtr("proxy.process.hostdb.ttl");
   hostdb_rsb.ttl_expires                     = Metrics::Counter::createPtr("proxy.process.hostdb.ttl_expires");
   hostdb_rsb.re_dns_on_reload                = Metrics::Counter::createPtr("proxy.process.hostdb.re_dns_on_reload");
   hostdb_rsb.insert_duplicate_to_pending_dns = Metrics::Counter::createPtr("proxy.process.hostdb.insert_duplicate_to_pending_dns");
+  hostdb_rsb.snapshot_records                = Metrics::Gauge::createPtr("proxy.process.hostdb.snapshot.records");
+  hostdb_rsb.snapshot_bytes                  = Metrics::Gauge::createPtr("proxy.process.hostdb.snapshot.bytes");
+  hostdb_rsb.snapshot_loaded_records         = Metrics::Gauge::createPtr("proxy.process.hostdb.snapshot.loaded_records");
+  hostdb_rsb.snapshot_load_time              = Metrics::Gauge::createPtr("proxy.process.hostdb.snapshot.load_time_ms");
 
   ts_host_res_global_init();
 }
@@ -1575,6 +1727,11 @@ HostDBRecord::alloc(TextView query_name, unsigned int rr_count, size_t srv_name_
 bool
 HostDBRecord::serve_stale_but_revalidate() const
 {
+  // records from a snapshot are served until they are refreshed after a restart
+  if (restored && (ip_timeout_interval + ts_seconds(hostdb_snapshot_max_stale)) > ip_age()) {
+    return true;
+  }
+
   // the option is disabled
   if (hostdb_serve_stale_but_revalidate <= 0) {
     return false;
@@ -0,0 +1,238 @@
+/** @file
+
+  Snapshots of HostDB records, for a warm HostDB after a restart.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <arpa/nameser.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "iocore/hostdb/HostDBSnapshot.h"
+
+/* Each record is
+ *   key (8), family (1), response time (8), TTL (4), name size (2), name, address count (2)
+ * followed by each address as
+ *   family (1), address (4 or 16), last failure (8), failure count (1)
+ * Families are 4 or 6 and times are seconds since the epoch, zero for no failure.
+ */
+
+namespace
+{
+// Smallest address entry, for a sanity check of the address count before reading them.
+constexpr size_t MIN_RR_SIZE = 1 + 4 + 8 + 1;
+
+struct SnapshotRR {
+  IpAddr  ip;
+  int64_t last_failure = 0;
+  uint8_t fail_count   = 0;
+};
+
+template <typename T>
+void
+put(std::string &out, T value)
+{
+  out.append(reinterpret_cast<char const *>(&value), sizeof(value));
+}
+
+template <typename T>
+bool
+take(std::string_view &in, T &value)
+{
+  if (in.size() < sizeof(value)) {
+    return false;
+  }
+  memcpy(&value, in.data(), sizeof(value));
+  in.remove_prefix(sizeof(value));
+  return true;
+}
+
+int64_t
+epoch_seconds(ts_time t)
+{
+  return std::chrono::duration_cast<ts_seconds>(t.time_since_epoch()).count();
+}
+
+uint8_t
+family_code(int af)
+{
+  return af == AF_INET6 ? 6 : 4;
+}
+} // namespace
+
+size_t
+HostDBSnapshot::write(std::string &out, std::vector<HostDBRecord::Handle> const &records)
+{
+  size_t   count_offset = out.size() + sizeof(MAGIC) + sizeof(VERSION);
+  uint32_t count        = 0;
+
+  put(out, MAGIC);
+  put(out, VERSION);
+  put(out, count);
+  for (auto const &r : records) {
+    auto rr_info = r->rr_info();
+    if (r->record_type != HostDBType::ADDR || r->is_failed() || rr_info.empty() ||
+        std::any_of(rr_info.begin(), rr_info.end(), [](HostDBInfo const &info) { return !info.data.ip.isValid(); })) {
+      continue;
+    }
+    auto name = r->name_view();
+    put(out, r->key);
+    put(out, family_code(r->af_family));
+    put(out, epoch_seconds(r->ip_timestamp));
+    put(out, static_cast<uint32_t>(r->ip_timeout_interval.count()));
+    put(out, static_cast<uint16_t>(name.size()));
+    out.append(name.data(), name.size());
+    put(out, static_cast<uint16_t>(rr_info.count()));
+    for (auto const &info : rr_info) {
+      IpAddr const &ip       = info.data.ip;
+      auto          last_bad = info.last_fail_time();
+      put(out, family_code(ip.family()));
+      if (ip.isIp6()) {
+        put(out, ip._addr._ip6);
+      } else {
+        put(out, ip._addr._ip4);
+      }
+      put(out, last_bad == TS_TIME_ZERO ? int64_t{0} : epoch_seconds(last_bad));
+      put(out, info.fail_count.load());
+    }
+    ++count;
+  }
+  memcpy(out.data() + count_offset, &count, sizeof(count));
+  return count;
+}
+
+bool
+HostDBSnapshot::read(std::string_view data, std::vector<HostDBRecord::Handle> &records, unsigned max_rr)
+{
+  uint32_t magic   = 0;
+  uint32_t version = 0;
+  uint32_t count   = 0;
+
+  records.clear();
+  if (!take(data, magic) || !take(data, version) || !take(data, count) || magic != MAGIC || version != VERSION) {
+    return false;
+  }
+
+  std::vector<SnapshotRR> rrs;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint64_t key       = 0;
+    uint8_t  af        = 0;
+    int64_t  timestamp = 0;
+    uint32_t ttl       = 0;
+    uint16_t name_size = 0;
+    uint16_t rr_count  = 0;
+
+    if (!take(data, key) || !take(data, af) || !take(data, timestamp) || !take(data, ttl) || !take(data, name_size) ||
+        name_size == 0 || name_size > MAXDNAME || data.size() < name_size) {
+      records.clear();
+      return false;
+    }
+    std::string_view name = data.substr(0, name_size);
+    data.remove_prefix(name_size);
+    if (!take(data, rr_count) || rr_count == 0 || data.size() < rr_count * MIN_RR_SIZE) {
+      records.clear();
+      return false;
+    }
+
+    rrs.resize(rr_count);
+    for (auto &rr : rrs) {
+      uint8_t family = 0;
+      if (!take(data, family)) {
+        records.clear();
+        return false;
+      }
+      bool valid = false;
+      if (family == 6) {
+        in6_addr addr;
+        valid = take(data, addr);
+        rr.ip = IpAddr{addr};
+      } else if (family == 4) {
+        in_addr_t addr;
+        valid = take(data, addr);
+        rr.ip = IpAddr{addr};
+      }
+      if (!valid || !take(data, rr.last_failure) || !take(data, rr.fail_count)) {
+        records.clear();
+        return false;
+      }
+    }
+    if (rr_count > max_rr) {
+      continue;
+    }
+
+    HostDBRecord::Handle r{HostDBRecord::alloc(name, rr_count)};
+    r->key                 = key;
+    r->record_type         = HostDBType::ADDR;
+    r->af_family           = af == 6 ? AF_INET6 : AF_INET;
+    r->ip_timestamp        = ts_time{ts_seconds{timestamp}};
+    r->ip_timeout_interval = ts_seconds{ttl};
+    r->restored            = true;
+    auto rr                = rrs.begin();
+    for (auto &info : r->rr_info()) {
+      info.assign(rr->ip);
+      info.last_failure = rr->last_failure ? ts_time{ts_seconds{rr->last_failure}} : TS_TIME_ZERO;
+      info.fail_count   = rr->fail_count;
+      ++rr;
+    }
+    records.push_back(std::move(r));
+  }
+  if (!data.empty()) {
+    records.clear();
+    return false;
+  }
+  return true;
+}
+
+std::error_code
+HostDBSnapshot::save(swoc::file::path const &path, std::string_view data)
+{
+  std::string tmp{path.string() + ".tmp"};
+  int         fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+  if (fd < 0) {
+    return {errno, std::system_category()};
+  }
+
+  std::error_code ec;
+  for (size_t n = 0; n < data.size();) {
+    ssize_t r = ::write(fd, data.data() + n, data.size() - n);
+    if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ec = {errno, std::system_category()};
+      break;
+    }
+    n += r;
+  }
+  if (!ec && ::fsync(fd) < 0) {
+    ec = {errno, std::system_category()};
+  }
+  ::close(fd);
+  if (!ec && ::rename(tmp.c_str(), path.c_str()) < 0) {
+    ec = {errno, std::system_category()};
+  }
+  if (ec) {
+    ::unlink(tmp.c_str());
+  }
+  return ec;
+}
@@ -30,6 +30,7 @@
 #include <tsutil/TsSharedMutex.h>
 
 #include "iocore/hostdb/HostDBProcessor.h"
+#include "swoc/swoc_file.h"
 #include "P_RefCountCache.h"
 #include "tscore/PendingAction.h"
 #include "tsutil/Metrics.h"
@@ -118,10 +119,16 @@ struct HostDBStatsBlock {
   Metrics::Counter::AtomicType *total_lookups;
   Metrics::Counter::AtomicType *total_hits;
   Metrics::Counter::AtomicType *total_serve_stale;
+  Metrics::Counter::AtomicType *total_refresh_ahead;
+  Metrics::Counter::AtomicType *thread_cache_hits;
   Metrics::Counter::AtomicType *ttl;
   Metrics::Counter::AtomicType *ttl_expires;
   Metrics::Counter::AtomicType *re_dns_on_reload;
   Metrics::Counter::AtomicType *insert_duplicate_to_pending_dns;
+  Metrics::Gauge::AtomicType   *snapshot_records;
+  Metrics::Gauge::AtomicType   *snapshot_bytes;
+  Metrics::Gauge::AtomicType   *snapshot_loaded_records;
+  Metrics::Gauge::AtomicType   *snapshot_load_time;
 };
 
 extern HostDBStatsBlock hostdb_rsb;
@@ -149,6 +156,11 @@ struct HostDBCache {
 
   std::shared_ptr<HostFile> acquire_host_file();
   bool                      remove_from_pending_dns_for_hash(const CryptoHash &hash, HostDBContinuation *c);
+
+  /// Put the records of the snapshot at @a path into the cache.
+  void load_snapshot(swoc::file::path const &path);
+  /// Write a snapshot of the cache to @a path.
+  void write_snapshot(swoc::file::path const &path);
 };
 
 //
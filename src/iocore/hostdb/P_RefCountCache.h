@@ -34,6 +34,7 @@
 #include "tsutil/Metrics.h"
 
 #include "swoc/IntrusiveHashMap.h"
+#include <atomic>
 #include <cstdint>
 #include <unistd.h>
 
@@ -154,6 +155,17 @@ protected:
   inline static DbgCtl dbg_ctl{"refcountcache"};
 };
 
+// Items with a `cached` flag have it set while they are in the cache, so that code holding an item can tell it is still
+// the current one for its key without a lookup. It is cleared once the item is erased, replaced or evicted.
+template <class C>
+inline void
+refcountcache_set_cached(C *item, bool cached)
+{
+  if constexpr (requires { item->cached; }) {
+    item->cached.store(cached, std::memory_order_release);
+  }
+}
+
 // The RefCountCachePartition is simply a map of key -> Ptr<YourClass>
 // We partition the cache to reduce lock contention
 template <class C> class RefCountCachePartition : private RefCountCacheBase
@@ -247,6 +259,7 @@ RefCountCachePartition<C>::put(uint64_t key, C *item, int size, time_t expire_ti
   this->items++;
   Metrics::Gauge::increment(this->rsb->refcountcache_current_size, static_cast<int64_t>(val->meta.size));
   Metrics::Gauge::increment(this->rsb->refcountcache_current_items);
+  refcountcache_set_cached(item, true);
 }
 
 template <class C>
@@ -283,6 +296,7 @@ RefCountCachePartition<C>::dealloc_entry(hash_type::iterator ptr)
     ptr->expiry_entry = nullptr; // To avoid the destruction of `l` calling the destructor again-- and causing issues
   }
 
+  refcountcache_set_cached(static_cast<C *>(ptr->item.get()), false);
   RefCountCacheHashEntry::free<C>(ptr);
 }
 
@@ -217,6 +217,56 @@ struct StartDNS : Continuation {
   }
 };
 
+// Lookups of names that are already in HostDB, repeated @a rounds times over the host list, which is the common case
+// for a busy proxy.
+struct HotLookup : Continuation {
+  using Clock = std::chrono::high_resolution_clock;
+
+  const StartDNS::HostList &hostlist;
+  latch                    &done_latch;
+  int                       rounds;
+  int                       round     = 0;
+  size_t                    next      = 0;
+  int                       immediate = 0;
+  int                       lookups   = 0;
+  Clock::time_point         start_time;
+  Clock::duration           elapsed{};
+
+  HotLookup(const StartDNS::HostList &hlist, int rounds, latch &l)
+    : Continuation(new_ProxyMutex()), hostlist(hlist), done_latch(l), rounds(rounds)
+  {
+    SET_HANDLER(&HotLookup::lookup);
+  }
+
+  void
+  handle_hostdb(HostDBRecord * /* r ATS_UNUSED */)
+  {
+  }
+
+  int
+  lookup(int e, void * /* ep ATS_UNUSED */)
+  {
+    if (e != EVENT_HOST_DB_LOOKUP) {
+      start_time = Clock::now();
+    }
+    while (round < rounds) {
+      char const *name = hostlist[next].c_str();
+      if (++next == hostlist.size()) {
+        next = 0;
+        ++round;
+      }
+      ++lookups;
+      if (hdb.getbyname_imm(this, static_cast<cb_process_result_pfn>(&HotLookup::handle_hostdb), name, 0) != ACTION_RESULT_DONE) {
+        return 0;
+      }
+      ++immediate;
+    }
+    elapsed = Clock::now() - start_time;
+    done_latch.count_down();
+    return 0;
+  }
+};
+
 StartDNS::HostList
 lines(const std::string &fname)
 {
@@ -252,6 +302,10 @@ main(int argc, char **argv)
   if (argc > 2) {
     dbg = 1;
   }
+  int rounds = 10000;
+  if (argc > 3) {
+    rounds = atoi(argv[3]);
+  }
 
   init_ts("hostdb_test", dbg);
 
@@ -297,6 +351,29 @@ main(int argc, char **argv)
   printf("dns min/max: %2.6f/%2.6f\n", min_d.count(), max_d.count());
   printf("imm min/max: %2.6f/%2.6f\n", min_i.count(), max_i.count());
   printf("Total results: %d average lookup %f\n", results_count, total_duration.count() / results_count);
+
+  latch                                   hot_latch{count};
+  std::vector<std::unique_ptr<HotLookup>> hot;
+
+  for (auto &t : eventProcessor.active_group_threads(ET_CALL)) {
+    auto lookup = std::make_unique<HotLookup>(hosts, rounds, hot_latch);
+    t->schedule_imm(lookup.get());
+    hot.push_back(std::move(lookup));
+  }
+
+  hot_latch.wait();
+
+  int                                      hot_lookups{};
+  int                                      hot_immediate{};
+  std::chrono::duration<double, std::nano> hot_elapsed{};
+  for (auto &lookup : hot) {
+    hot_lookups   += lookup->lookups;
+    hot_immediate += lookup->immediate;
+    hot_elapsed    = std::max<std::chrono::duration<double, std::nano>>(hot_elapsed, lookup->elapsed);
+  }
+  printf("Hot lookups: %d immediate: %d threads: %d\n", hot_lookups, hot_immediate, count);
+  printf("Hot lookup %.1f ns per lookup per thread, %.0f lookups/s\n", hot_elapsed.count() * count / hot_lookups,
+         hot_lookups / (hot_elapsed.count() / 1e9));
   hdb.shutdown();
 }
 
@@ -32,6 +32,7 @@
 #include "swoc/bwf_base.h"
 
 #include "iocore/hostdb/HostFile.h"
+#include "iocore/hostdb/HostDBSnapshot.h"
 #include "P_HostDBProcessor.h"
 #include "iocore/eventsystem/EventSystem.h"
 #include "tscore/Layout.h"
@@ -162,9 +163,136 @@ TEST_CASE("HostFile", "[hostdb]")
   }
 }
 
+TEST_CASE("HostDBSnapshot", "[hostdb]")
+{
+  ts_time                           now{ts_seconds{1700000000}};
+  std::vector<HostDBRecord::Handle> records;
+
+  HostDBRecord::Handle up_down{HostDBRecord::alloc("origin.example.com"sv, 2)};
+  up_down->key                 = 0x1234;
+  up_down->record_type         = HostDBType::ADDR;
+  up_down->af_family           = AF_INET6;
+  up_down->ip_timestamp        = now;
+  up_down->ip_timeout_interval = ts_seconds{300};
+  IpAddr addr;
+  addr.load("2001:db8::1");
+  up_down->rr_info()[0].assign(addr);
+  addr.load("2001:db8::2");
+  up_down->rr_info()[1].assign(addr);
+  up_down->rr_info()[1].mark_down(now - ts_seconds{10});
+  up_down->rr_info()[1].fail_count = 3;
+  records.push_back(up_down);
+
+  HostDBRecord::Handle failed{HostDBRecord::alloc("nx.example.com"sv, 0)};
+  failed->key         = 0x5678;
+  failed->record_type = HostDBType::ADDR;
+  failed->set_failed();
+  records.push_back(failed);
+
+  std::string data;
+  REQUIRE(HostDBSnapshot::write(data, records) == 1);
+
+  SECTION("round trip")
+  {
+    std::vector<HostDBRecord::Handle> loaded;
+    REQUIRE(HostDBSnapshot::read(data, loaded, 16));
+    REQUIRE(loaded.size() == 1);
+
+    auto const &r = loaded[0];
+    CHECK(r->restored);
+    CHECK(r->key == 0x1234);
+    CHECK(r->record_type == HostDBType::ADDR);
+    CHECK(r->af_family == AF_INET6);
+    CHECK(r->name_view() == "origin.example.com"sv);
+    CHECK(r->ip_timestamp == now);
+    CHECK(r->ip_timeout_interval == ts_seconds{300});
+    REQUIRE(r->rr_count == 2);
+    CHECK(r->rr_info()[0].data.ip == up_down->rr_info()[0].data.ip);
+    CHECK(r->rr_info()[0].is_alive());
+    CHECK(r->rr_info()[1].data.ip == up_down->rr_info()[1].data.ip);
+    CHECK(r->rr_info()[1].last_fail_time() == now - ts_seconds{10});
+    CHECK(r->rr_info()[1].fail_count == 3);
+  }
+
+  SECTION("too many addresses")
+  {
+    std::vector<HostDBRecord::Handle> loaded;
+    REQUIRE(HostDBSnapshot::read(data, loaded, 1));
+    CHECK(loaded.empty());
+  }
+
+  SECTION("damaged")
+  {
+    std::vector<HostDBRecord::Handle> loaded;
+    CHECK_FALSE(HostDBSnapshot::read(std::string_view{data}.substr(0, data.size() - 1), loaded, 16));
+    CHECK(loaded.empty());
+    CHECK_FALSE(HostDBSnapshot::read(data + "x", loaded, 16));
+    CHECK_FALSE(HostDBSnapshot::read("HDBS"sv, loaded, 16));
+    std::string other_version{data};
+    other_version[sizeof(uint32_t)] += 1;
+    CHECK_FALSE(HostDBSnapshot::read(other_version, loaded, 16));
+    CHECK(loaded.empty());
+  }
+
+  SECTION("save")
+  {
+    swoc::LocalBufferWriter<1024> w;
+    w.print("{}/hostdb.snapshot.{}", swoc::file::temp_directory_path(), ::getpid());
+    swoc::file::path path{w.view()};
+
+    REQUIRE_FALSE(HostDBSnapshot::save(path, data));
+    std::error_code ec;
+    CHECK(swoc::file::load(path, ec) == data);
+    CHECK_FALSE(ec);
+    CHECK_FALSE(swoc::file::exists(swoc::file::path{path.string() + ".tmp"}));
+    swoc::file::remove(path, ec);
+  }
+}
+
+TEST_CASE("HostDBRecord kept on a failed lookup", "[hostdb]")
+{
+  ts_time now{ts_seconds{1700000000}};
+  hostdb_current_timestamp = now;
+
+  HostDBRecord::Handle r{HostDBRecord::alloc("origin.example.com"sv, 1)};
+  r->record_type         = HostDBType::ADDR;
+  r->af_family           = AF_INET;
+  r->ip_timeout_interval = ts_seconds{300};
+
+  SECTION("refresh ahead of expiry")
+  {
+    r->ip_timestamp = now - ts_seconds{290};
+    CHECK_FALSE(r->is_ip_timeout());
+    CHECK(r->keep_on_failed_lookup());
+  }
+
+  SECTION("expired")
+  {
+    r->ip_timestamp = now - ts_seconds{300};
+    CHECK(r->is_ip_timeout());
+    CHECK_FALSE(r->keep_on_failed_lookup());
+  }
+
+  SECTION("expired, served while stale")
+  {
+    r->ip_timestamp = now - ts_seconds{400};
+    r->restored     = true;
+    CHECK(r->keep_on_failed_lookup());
+  }
+}
+
 // NOTE(cmcfarlen): need this destructor defined so we don't have to link in the entire project for this test
 HostDBHash::~HostDBHash() {}
 
+// The parts of HostDB.cc the records use, proxy.config.hostdb.serve_stale_for is not set here.
+std::atomic<ts_time> hostdb_current_timestamp{TS_TIME_ZERO};
+
+bool
+HostDBRecord::serve_stale_but_revalidate() const
+{
+  return restored;
+}
+
 #include "swoc/Scalar.h"
 
 HostDBRecord *
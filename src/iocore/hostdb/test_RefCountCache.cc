@@ -34,6 +34,7 @@ class ExampleStruct : public RefCountObj
 public:
   int                              idx;
   int                              name_offset; // pointer addr to name
+  std::atomic<bool>                cached{false};
   static std::set<ExampleStruct *> items_freed;
 
   // Return the char* to the name (TODO: cleaner interface??)
@@ -180,6 +181,42 @@ testclear()
   return ret;
 }
 
+// An item is flagged while it is in the cache, and changes to other keys do not touch the flag.
+int
+testCached()
+{
+  int ret = 0;
+
+  auto cache = std::make_unique<RefCountCache<ExampleStruct>>(1);
+
+  ExampleStruct     *first = ExampleStruct::alloc();
+  ExampleStruct     *other = ExampleStruct::alloc();
+  Ptr<ExampleStruct> first_ptr{first};
+  Ptr<ExampleStruct> other_ptr{other};
+  ret |= first->cached;
+
+  cache->put(1, first);
+  cache->put(2, other);
+  ret |= !first->cached;
+
+  // Replacing the item for a key only unflags that item, even in the same partition.
+  ExampleStruct     *second = ExampleStruct::alloc();
+  Ptr<ExampleStruct> second_ptr{second};
+  cache->put(1, second);
+  ret |= first->cached;
+  ret |= !second->cached;
+  ret |= !other->cached;
+
+  cache->erase(1);
+  ret |= second->cached;
+  ret |= !other->cached;
+
+  cache->clear();
+  ret |= other->cached;
+
+  return ret;
+}
+
 int
 test()
 {
@@ -197,6 +234,10 @@ test()
   ret |= testRefcounting();
   printf("refcount ret %d\n", ret);
 
+  printf("Testing cached flags\n");
+  ret |= testCached();
+  printf("cached ret %d\n", ret);
+
   // Initialize our cache
   int  cachePartitions = 4;
   auto cache           = std::make_unique<RefCountCache<ExampleStruct>>(cachePartitions);
@@ -126,6 +126,16 @@ register_net_stats()
   net_rsb.write_bytes                      = Metrics::Counter::createPtr("proxy.process.net.write_bytes");
   net_rsb.write_bytes_count                = Metrics::Counter::createPtr("proxy.process.net.write_bytes_count");
   net_rsb.connection_tracker_table_size    = Metrics::Gauge::createPtr("proxy.process.net.connection_tracker_table_size");
+  net_rsb.udp_send_calls                   = Metrics::Counter::createPtr("proxy.process.udp.send_calls");
+  net_rsb.udp_gso_failures                 = Metrics::Counter::createPtr("proxy.process.udp.gso_failures");
+
+  for (int i = 0; i < UDP_SEND_BATCH_BUCKETS; ++i) {
+    net_rsb.udp_send_batch[i] = Metrics::Counter::createBucketPtr("proxy.process.udp.send_batch", 1 << i);
+  }
+  for (int i = 0; i < UDP_PACING_DELAY_BUCKETS; ++i) {
+    int bound                   = i == 0 ? 0 : UDP_PACING_DELAY_BUCKET_BASE_USEC << (i - 1);
+    net_rsb.udp_pacing_delay[i] = Metrics::Counter::createBucketPtr("proxy.process.udp.pacing_delay", bound, "us");
+  }
 }
 
 void
@@ -34,6 +34,12 @@
 // Net Stats
 using ts::Metrics;
 
+/// Buckets for the number of UDP datagrams sent by a single syscall: 1, 2-3, 4-7, ..., 64 and more.
+constexpr int UDP_SEND_BATCH_BUCKETS = 7;
+/// Buckets for how far ahead a UDP datagram is scheduled by its pacing timestamp: 0, 125us-, 250us-, ..., 8ms and more.
+constexpr int UDP_PACING_DELAY_BUCKETS          = 8;
+constexpr int UDP_PACING_DELAY_BUCKET_BASE_USEC = 125;
+
 struct NetStatsBlock {
   Metrics::Gauge::AtomicType   *accepts_currently_open;
   Metrics::Counter::AtomicType *calls_to_read_nodata;
@@ -80,6 +86,10 @@ struct NetStatsBlock {
   Metrics::Counter::AtomicType *write_bytes;
   Metrics::Counter::AtomicType *write_bytes_count;
   Metrics::Gauge::AtomicType   *connection_tracker_table_size;
+  Metrics::Counter::AtomicType *udp_send_calls;
+  Metrics::Counter::AtomicType *udp_gso_failures;
+  Metrics::Counter::AtomicType *udp_send_batch[UDP_SEND_BATCH_BUCKETS];
+  Metrics::Counter::AtomicType *udp_pacing_delay[UDP_PACING_DELAY_BUCKETS];
 };
 
 extern NetStatsBlock net_rsb;
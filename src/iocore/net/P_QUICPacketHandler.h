@@ -28,6 +28,7 @@
 #include "iocore/net/UDPConnection.h"
 
 #include <quiche.h>
+#include <vector>
 
 class QUICNetVConnection;
 class QUICConnectionTable;
@@ -71,6 +72,22 @@ private:
   QUICConnectionTable &_ctable;
   quiche_config       &_quiche_config;
 
+  // Index of the ET_UDP thread (and its REUSEPORT socket) this handler reads packets from
+  int  _udp_thread_index = 0;
+  bool _cid_routing      = false;
+
+  // ET_NET threads that own the connections accepted on this socket, new connections take them in turn
+  std::vector<EThread *> _owner_threads;
+  size_t                 _next_owner = 0;
+
+  // ET_NET threads that received packets in the current read batch and still need a wake up
+  std::vector<EThread *> _threads_to_signal;
+
+  EThread *_next_owner_thread();
+  bool     _is_owner_thread(EThread *eth) const;
+  void     _forward_packet(EThread *eth, QUICConnection *qc, UDPPacket *udp_packet);
+  void     _signal_threads();
+
   void _recv_packet(int event, UDPPacket *udpPacket) override;
 };
 
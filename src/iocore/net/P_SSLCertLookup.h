@@ -27,6 +27,7 @@
 #include "iocore/net/SSLTypes.h"
 #include "records/RecCore.h"
 
+#include <atomic>
 #include <set>
 #include <openssl/ssl.h>
 #include <mutex>
@@ -91,11 +92,16 @@ using shared_ssl_ticket_key_block = std::shared_ptr<ssl_ticket_key_block>;
     Instances of this class are stored on a list and then referenced via index in that list so that
     there is exactly one place we can find all the @c SSL_CTX instances exactly once.
 
+    The @c SSL_CTX can be replaced at any time with @c setCtx, which publishes it with a new version.
+    @c getCtx returns the copy each thread keeps for the current version and only locks to update it.
 */
 struct SSLCertContext {
 private:
-  mutable std::mutex ctx_mutex;
-  shared_SSL_CTX     ctx;
+  mutable std::mutex    ctx_mutex;
+  shared_SSL_CTX        ctx;
+  std::atomic<uint64_t> ctx_version{new_version()}; ///< Unique over all instances, changed with @a ctx.
+
+  static uint64_t new_version();
 
 public:
   SSLCertContext() : ctx_mutex(), ctx(nullptr), opt(SSLCertContextOption::OPT_NONE), userconfig(nullptr), keyblock(nullptr) {}
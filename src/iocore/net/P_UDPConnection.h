@@ -48,6 +48,7 @@ public:
   bool       binding_valid     = false;
   int        tobedestroyed     = 0;
   int        sendGenerationNum = 0;
+  bool       txtime_enabled    = false; ///< SO_TXTIME is set, so packets can carry pacing timestamps.
 };
 
 TS_INLINE
@@ -294,9 +294,16 @@ class UDPQueue
   int         packets      = 0;
   int         added        = 0;
 #ifdef SOL_UDP
-  bool use_udp_gso = false;
+  bool use_udp_gso  = false;
+  int  gso_failures = 0; ///< Consecutive GSO send failures.
 #endif
 
+  /// GSO is turned off only after this many sends in a row fail with it, as a failure can be specific to a route.
+  static constexpr int UDP_GSO_MAX_CONSECUTIVE_FAILURES = 3;
+
+  /// Record a GSO send failure. Returns @c true if GSO got disabled.
+  bool _on_gso_failure();
+
 public:
   // Outgoing UDP Packet Queue
   ASLL(UDPPacket, alink) outQueue;
@@ -305,7 +312,7 @@ public:
 
   void SendPackets();
   void SendUDPPacket(UDPPacket *p);
-  int  SendMultipleUDPPackets(UDPPacket **p, uint16_t n);
+  int  SendMultipleUDPPackets(UDPPacket **p, uint16_t n, bool allow_gso = true);
 
   // Interface exported to the outside world
   void send(UDPPacket *p);
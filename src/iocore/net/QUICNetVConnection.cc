@@ -390,8 +390,19 @@ QUICNetVConnection::stream_manager()
 }
 
 void
-QUICNetVConnection::close_quic_connection(QUICConnectionErrorUPtr /* error ATS_UNUSED */)
+QUICNetVConnection::close_quic_connection(QUICConnectionErrorUPtr error)
 {
+  if (!this->_quiche_con || error == nullptr) {
+    return;
+  }
+
+  const char *reason = error->msg ? error->msg : "";
+  QUICConDebug("closing connection: is_app=%d error_code=%hu reason=%s", error->cls == QUICErrorClass::APPLICATION, error->code,
+               reason);
+  // The CONNECTION_CLOSE frame goes out with the next write, the closing event follows once quiche is done with it.
+  quiche_conn_close(this->_quiche_con, error->cls == QUICErrorClass::APPLICATION, error->code,
+                    reinterpret_cast<const uint8_t *>(reason), strlen(reason));
+  this->_schedule_packet_write_ready();
 }
 
 void
@@ -661,6 +672,8 @@ void
 QUICNetVConnection::_handle_write_ready()
 {
   if (quiche_conn_is_established(this->_quiche_con)) {
+    this->_stream_manager->send_new_streams(this->_quiche_con);
+
     quiche_stream_iter *writable = quiche_conn_writable(this->_quiche_con);
     uint64_t            s        = 0;
     while (quiche_stream_iter_next(writable, &s)) {
@@ -676,7 +689,7 @@ QUICNetVConnection::_handle_write_ready()
 
   Ptr<IOBufferBlock> udp_payload;
   quiche_send_info   send_info;
-  struct timespec    send_at_hint;
+  struct timespec    send_at_hint = {0, 0};
   ssize_t            res;
   ssize_t            written = 0;
 
@@ -29,11 +29,13 @@
 #include "P_UnixNet.h"
 #include "P_UnixUDPConnection.h"
 #include "iocore/net/quic/QUICConnectionTable.h"
+#include "iocore/net/quic/QUICStats.h"
 #include "iocore/net/QUICMultiCertConfigLoader.h"
 #include "tscore/Layout.h"
 #include "tscore/ink_atomic.h"
 
 #include "swoc/BufferWriter.h"
+#include <algorithm>
 #include <quiche.h>
 
 namespace
@@ -152,6 +154,7 @@ QUICPacketHandlerIn::acceptEvent(int event, void *data)
     while ((packet_r = queue->dequeue())) {
       this->_recv_packet(event, packet_r);
     }
+    this->_signal_threads();
     return EVENT_CONT;
   } else if (event == EVENT_IMMEDIATE) {
     this->setThreadAffinity(this_ethread());
@@ -176,15 +179,67 @@ QUICPacketHandlerIn::init_accept(EThread * /* t  ATS_UNUSED */ = nullptr)
 
   SET_HANDLER(&QUICPacketHandlerIn::acceptEvent);
 
-  n = eventProcessor.thread_group[ET_UDP]._count;
+  QUICConfig::scoped_config params;
+  this->_cid_routing = params->cid_routing_enabled();
+
+  // Each ET_UDP thread binds its own REUSEPORT socket, so the kernel keeps a 4-tuple on the same thread.
+  auto &net_group = eventProcessor.thread_group[ET_NET];
+  n               = eventProcessor.thread_group[ET_UDP]._count;
   for (i = 0; i < n; i++) {
-    NetAccept *a = (i < n - 1) ? clone() : this;
-    EThread   *t = eventProcessor.thread_group[ET_UDP]._thread[i];
-    a->mutex     = get_NetHandler(t)->mutex;
+    QUICPacketHandlerIn *a = (i < n - 1) ? static_cast<QUICPacketHandlerIn *>(clone()) : this;
+    EThread             *t = eventProcessor.thread_group[ET_UDP]._thread[i];
+    a->_udp_thread_index   = i;
+    a->mutex               = get_NetHandler(t)->mutex;
+
+    // Deal the ET_NET threads out to the sockets, so every one of them owns connections even if there are fewer sockets.
+    // With more sockets than ET_NET threads, sockets share a thread.
+    a->_owner_threads.clear();
+    a->_next_owner = 0;
+    for (int j = i % net_group._count; j < net_group._count; j += n) {
+      a->_owner_threads.push_back(net_group._thread[j]);
+    }
     t->schedule_imm(a);
   }
 }
 
+EThread *
+QUICPacketHandlerIn::_next_owner_thread()
+{
+  return this->_owner_threads[this->_next_owner++ % this->_owner_threads.size()];
+}
+
+bool
+QUICPacketHandlerIn::_is_owner_thread(EThread *eth) const
+{
+  return std::find(this->_owner_threads.begin(), this->_owner_threads.end(), eth) != this->_owner_threads.end();
+}
+
+void
+QUICPacketHandlerIn::_forward_packet(EThread *eth, QUICConnection *qc, UDPPacket *udp_packet)
+{
+  Metrics::Counter::increment(quic_rsb.total_packets_received);
+  if (!this->_is_owner_thread(eth)) {
+    Metrics::Counter::increment(quic_rsb.total_packets_forwarded);
+  }
+
+  QUICPollEvent *qe = quicPollEventAllocator.alloc();
+  qe->init(qc, udp_packet);
+  // Push the packet into QUICPollCont, the owner is woken up once the whole read batch is queued
+  get_QUICPollCont(eth)->inQueue.push(qe);
+  if (std::find(this->_threads_to_signal.begin(), this->_threads_to_signal.end(), eth) == this->_threads_to_signal.end()) {
+    this->_threads_to_signal.push_back(eth);
+  }
+}
+
+void
+QUICPacketHandlerIn::_signal_threads()
+{
+  for (EThread *eth : this->_threads_to_signal) {
+    get_NetHandler(eth)->signalActivity();
+  }
+  this->_threads_to_signal.clear();
+}
+
 Continuation *
 QUICPacketHandlerIn::_get_continuation()
 {
@@ -263,7 +318,9 @@ QUICPacketHandlerIn::_recv_packet(int /* event ATS_UNUSED */, UDPPacket *udp_pac
     Connection con;
     con.setRemote(&udp_packet->from.sa);
 
-    eth                           = eventProcessor.assign_thread(ET_NET);
+    // With CID routing a connection stays on an ET_NET thread of the socket it arrived on, so packets of a 4-tuple are only
+    // forwarded to another socket's thread after the peer migrates.
+    eth                           = this->_cid_routing ? this->_next_owner_thread() : eventProcessor.assign_thread(ET_NET);
     QUICConnectionId original_cid = {dcid, static_cast<uint8_t>(dcid_len)};
     QUICConnectionId peer_cid     = {scid, static_cast<uint8_t>(scid_len)};
 
@@ -278,6 +335,7 @@ QUICPacketHandlerIn::_recv_packet(int /* event ATS_UNUSED */, UDPPacket *udp_pac
       return;
     }
 
+    // The owner of a connection is found through the connection table, so the connection ID stays fully random.
     QUICConnectionId new_cid;
 
     QUICCertConfig::scoped_config server_cert;
@@ -326,11 +384,10 @@ QUICPacketHandlerIn::_recv_packet(int /* event ATS_UNUSED */, UDPPacket *udp_pac
   }
   eth = vc->thread;
 
-  QUICPollEvent *qe = quicPollEventAllocator.alloc();
-  qe->init(qc, static_cast<UDPPacket *>(udp_packet));
-  // Push the packet into QUICPollCont
-  get_QUICPollCont(eth)->inQueue.push(qe);
-  get_NetHandler(eth)->signalActivity();
+  if (this->_cid_routing && !this->_is_owner_thread(eth)) {
+    QUICVPHDebug(QUICConnectionId(scid, scid_len), QUICConnectionId(dcid, dcid_len), "forward packet to the owner thread");
+  }
+  this->_forward_packet(eth, qc, udp_packet);
 
   return;
 }
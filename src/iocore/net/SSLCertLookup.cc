@@ -33,6 +33,7 @@
 
 #include "P_SSLUtils.h"
 
+#include <atomic>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -42,6 +43,31 @@ namespace
 {
 DbgCtl dbg_ctl_ssl{"ssl"};
 
+/** Contexts recently gotten by this thread, so that handshakes do not lock the certificate context.
+
+    A slot is current while the version of its certificate context is the one it was filled with. Versions are never
+    reused, so a slot is not current for a later certificate context at the same address. The slots are not released
+    at thread exit because OpenSSL may already be shut down by then.
+ */
+struct ThreadContexts {
+  static constexpr size_t SLOTS = 256;
+
+  struct Slot {
+    SSLCertContext const *cc      = nullptr;
+    uint64_t              version = 0;
+    shared_SSL_CTX        ctx;
+  };
+  Slot slots[SLOTS];
+
+  Slot &
+  slot_for(SSLCertContext const *cc)
+  {
+    return slots[(reinterpret_cast<uintptr_t>(cc) / sizeof(SSLCertContext)) % SLOTS];
+  }
+};
+
+thread_local ThreadContexts *thread_contexts = nullptr;
+
 } // end anonymous namespace
 
 struct SSLAddressLookupKey {
@@ -231,6 +257,13 @@ fail:
 #endif /* TS_HAS_TLS_SESSION_TICKET */
 }
 
+uint64_t
+SSLCertContext::new_version()
+{
+  static std::atomic<uint64_t> next{1};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
 SSLCertContext::SSLCertContext(SSLCertContext const &other)
 {
   opt        = other.opt;
@@ -249,8 +282,12 @@ SSLCertContext::operator=(SSLCertContext const &other)
     this->userconfig = other.userconfig;
     this->keyblock   = other.keyblock;
     this->ctx_type   = other.ctx_type;
-    std::lock_guard<std::mutex> lock(other.ctx_mutex);
-    this->ctx = other.ctx;
+    shared_SSL_CTX sc;
+    {
+      std::lock_guard<std::mutex> lock(other.ctx_mutex);
+      sc = other.ctx;
+    }
+    this->setCtx(std::move(sc));
   }
   return *this;
 }
@@ -258,7 +295,16 @@ SSLCertContext::operator=(SSLCertContext const &other)
 shared_SSL_CTX
 SSLCertContext::getCtx()
 {
+  if (thread_contexts == nullptr) {
+    thread_contexts = new ThreadContexts;
+  }
+  auto &slot = thread_contexts->slot_for(this);
+  if (slot.cc == this && slot.version == ctx_version.load(std::memory_order_acquire)) {
+    return slot.ctx;
+  }
+
   std::lock_guard<std::mutex> lock(ctx_mutex);
+  slot = {this, ctx_version.load(std::memory_order_relaxed), ctx};
   return ctx;
 }
 
@@ -267,6 +313,7 @@ SSLCertContext::setCtx(shared_SSL_CTX sc)
 {
   std::lock_guard<std::mutex> lock(ctx_mutex);
   ctx = std::move(sc);
+  ctx_version.store(new_version(), std::memory_order_release);
 }
 
 SSLCertLookup::SSLCertLookup()
@@ -49,6 +49,8 @@
 #include "tscore/ink_inet.h"
 #include "tscore/ink_sock.h"
 #include <netinet/udp.h>
+#include <algorithm>
+#include <bit>
 #ifdef HAVE_SO_TXTIME
 #include <linux/net_tstamp.h>
 #endif
@@ -103,6 +105,8 @@ UDPPacket::new_UDPPacket(struct sockaddr const *to, ink_hrtime when, Ptr<IOBuffe
 #ifdef HAVE_SO_TXTIME
   if (send_at_hint) {
     memcpy(&p->p.send_at, send_at_hint, sizeof(struct timespec));
+  } else {
+    p->p.send_at = {0, 0};
   }
 #endif
   return p;
@@ -1159,10 +1163,11 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
 {
   UnixUDPConnection *n = nullptr;
   IpEndpoint         myaddr;
-  socklen_t          myaddr_len = sizeof(myaddr);
-  PollCont          *pc         = nullptr;
-  PollDescriptor    *pd         = nullptr;
-  bool               need_bind  = true;
+  socklen_t          myaddr_len     = sizeof(myaddr);
+  PollCont          *pc             = nullptr;
+  PollDescriptor    *pd             = nullptr;
+  bool               need_bind      = true;
+  bool               txtime_enabled = false;
   UnixSocket         sock{fd};
 
   if (!sock.is_ok()) {
@@ -1237,8 +1242,10 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
 
   sk_txtime.clockid = CLOCK_MONOTONIC;
   sk_txtime.flags   = 0;
+  txtime_enabled = true;
   if (setsockopt(sock.get_fd(), SOL_SOCKET, SO_TXTIME, &sk_txtime, sizeof(sk_txtime)) == -1) {
     Dbg(dbg_ctl_udpnet, "Failed to setsockopt SO_TXTIME. errno=%d", errno);
+    txtime_enabled = false;
   }
 #endif
   // If this is a class D address (i.e. multicast address), use REUSEADDR.
@@ -1283,7 +1290,8 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
   if (sock.getsockname(&myaddr.sa, &myaddr_len) < 0) {
     goto Lerror;
   }
-  n = new UnixUDPConnection(sock.get_fd());
+  n                 = new UnixUDPConnection(sock.get_fd());
+  n->txtime_enabled = txtime_enabled;
 
   Dbg(dbg_ctl_udpnet, "UDPNetProcessor::UDPBind: %p fd=%d", n, sock.get_fd());
   n->setBinding(&myaddr.sa);
@@ -1390,6 +1398,7 @@ UDPQueue::SendPackets()
   UDPPacket *packets[N_MAX_PACKETS];
   int        nsent;
   int        npackets;
+  bool       blocked = false;
 
 sendPackets:
   nsent         = 0;
@@ -1417,15 +1426,28 @@ sendPackets:
   }
 
   if (npackets > 0) {
-    nsent = SendMultipleUDPPackets(packets, npackets);
-  }
-  for (int i = 0; i < nsent; ++i) {
-    packets[i]->free();
+    // A sendmmsg call takes a single socket. Group the packets from all the connections by socket so that each socket gets one
+    // batch, keeping the order of the packets for each socket.
+    std::stable_sort(packets, packets + npackets, [](UDPPacket *a, UDPPacket *b) { return a->p.conn->getFd() < b->p.conn->getFd(); });
+    for (int start = 0, end = 0; start < npackets; start = end) {
+      int fd = packets[start]->p.conn->getFd();
+      for (end = start + 1; end < npackets && packets[end]->p.conn->getFd() == fd; ++end) {}
+      int done = SendMultipleUDPPackets(packets + start, end - start);
+      for (int i = start; i < start + done; ++i) {
+        packets[i]->free();
+      }
+      // The socket buffer is full. Keep the rest queued for the next pass instead of spinning on the socket.
+      for (int i = start + done; i < end; ++i) {
+        pipeInfo.addPacket(packets[i], now);
+      }
+      nsent   += done;
+      blocked  = blocked || done < end - start;
+    }
   }
 
   bytesThisSlot -= bytesUsed;
 
-  if ((bytesThisSlot > 0) && nsent) {
+  if ((bytesThisSlot > 0) && nsent && !blocked) {
     // redistribute the slack...
     now = ink_get_hrtime();
     if (pipeInfo.firstPacket(now) == nullptr) {
@@ -1470,7 +1492,7 @@ UDPQueue::SendUDPPacket(UDPPacket *p)
 #endif // defined(SOL_UDP) || defined(HAVE_SO_TXTIME)
 
 #ifdef HAVE_SO_TXTIME
-  if (p->p.send_at.tv_sec > 0) {
+  if (p->p.send_at.tv_sec > 0 && static_cast<UDPConnectionInternal *>(p->p.conn)->txtime_enabled) {
     msg.msg_control    = msg_ctrl;
     msg.msg_controllen = CMSG_SPACE(sizeof(uint64_t));
     cm                 = CMSG_FIRSTHDR(&msg);
@@ -1520,9 +1542,11 @@ UDPQueue::SendUDPPacket(UDPPacket *p)
           break;
         }
         if (errno == EIO && use_udp_gso) {
-          Warning("Disabling UDP GSO due to an error");
+          // Send the segments separately this time
+          bool gso = use_udp_gso;
           use_udp_gso = false;
           SendUDPPacket(p);
+          use_udp_gso = gso && !_on_gso_failure();
           return;
         }
         if (errno == EAGAIN) {
@@ -1614,210 +1638,261 @@ UDPQueue::send(UDPPacket *p)
   outQueue.push(p);
 }
 
-int
-UDPQueue::SendMultipleUDPPackets(UDPPacket **p, uint16_t n)
+bool
+UDPQueue::_on_gso_failure()
 {
-#ifdef HAVE_SENDMMSG
-  struct mmsghdr *msgvec;
-  int             msgvec_size;
-
+  Metrics::Counter::increment(net_rsb.udp_gso_failures);
 #ifdef SOL_UDP
-  union udp_segment_hdr {
-    char           buf[CMSG_SPACE(sizeof(uint16_t))];
-    struct cmsghdr align;
-  };
-  if (use_udp_gso) {
-    msgvec_size = sizeof(struct mmsghdr) * n;
-  } else {
-    msgvec_size = sizeof(struct mmsghdr) * n * 64;
+  if (++gso_failures >= UDP_GSO_MAX_CONSECUTIVE_FAILURES) {
+    Warning("Disabling UDP GSO due to %d consecutive errors", gso_failures);
+    use_udp_gso = false;
+    return true;
   }
-
-#else
-  msgvec_size = sizeof(struct mmsghdr) * n * 64;
 #endif
+  return false;
+}
 
-#if defined(SOL_UDP) || defined(HAVE_SO_TXTIME) // to avoid unused variables compiler warning.
-  uint8_t msg_ctrl[0
+namespace
+{
+/// Control data for a message: a pacing timestamp and a GSO segment size.
+union udp_msg_control {
+  char           buf[CMSG_SPACE(sizeof(uint64_t)) + CMSG_SPACE(sizeof(uint16_t))];
+  struct cmsghdr align;
+};
+
+void
+record_send_batch(int n_datagrams)
+{
+  int bucket = std::min(static_cast<int>(std::bit_width(static_cast<unsigned>(n_datagrams))) - 1, UDP_SEND_BATCH_BUCKETS - 1);
+  Metrics::Counter::increment(net_rsb.udp_send_calls);
+  Metrics::Counter::increment(net_rsb.udp_send_batch[std::max(bucket, 0)]);
+}
+
+[[maybe_unused]] void
+record_pacing_delay(int64_t delay_nsec)
+{
+  uint64_t units  = delay_nsec > 0 ? delay_nsec / (UDP_PACING_DELAY_BUCKET_BASE_USEC * 1000) : 0;
+  int      bucket = std::min(static_cast<int>(std::bit_width(units)), UDP_PACING_DELAY_BUCKETS - 1);
+  Metrics::Counter::increment(net_rsb.udp_pacing_delay[bucket]);
+}
+
+} // end anonymous namespace
+
+/*
+ * Send packets for a socket with as few sendmmsg calls as possible. A packet that carries a GSO super buffer is sent as a single
+ * message if GSO is enabled, or split into a message per segment otherwise. Returns the number of packets processed, which is
+ * less than @a n if the socket buffer filled up.
+ */
+int
+UDPQueue::SendMultipleUDPPackets(UDPPacket **p, uint16_t n, bool allow_gso)
+{
+#ifdef HAVE_SENDMMSG
+  bool use_gso = false;
 #ifdef SOL_UDP
-                   + CMSG_SPACE(sizeof(uint16_t))
-#endif
-#ifdef HAVE_SO_TXTIME
-                   + CMSG_SPACE(sizeof(uint64_t))
+  use_gso = allow_gso && use_udp_gso;
+#else
+  (void)allow_gso;
 #endif
-  ];
-  memset(msg_ctrl, 0, sizeof(msg_ctrl));
-#endif // defined(SOL_UDP) || defined(HAVE_SO_TXTIME)
 
-  // The sizeof(struct msghdr) is 56 bytes or so. It can be too big to stack (alloca).
-  IOBufferBlock *tmp = new_IOBufferBlock();
-  tmp->alloc(iobuffer_size_to_index(msgvec_size, BUFFER_SIZE_INDEX_1M));
-  msgvec = reinterpret_cast<struct mmsghdr *>(tmp->buf());
-  memset(msgvec, 0, msgvec_size);
-
-  // The sizeof(struct iove) is 16 bytes or so. It can be too big to stack (alloca).
-  int            iovec_size = sizeof(struct iovec) * n * 64;
-  IOBufferBlock *tmp2       = new_IOBufferBlock();
-  tmp2->alloc(iobuffer_size_to_index(iovec_size, BUFFER_SIZE_INDEX_1M));
-  struct iovec *iovec = reinterpret_cast<struct iovec *>(tmp2->buf());
-  memset(iovec, 0, iovec_size);
-  int iovec_used = 0;
-
-  int vlen = 0;
-  int fd   = p[0]->p.conn->getFd();
+  // Count the messages and the iovecs needed
+  int n_msgs = 0;
+  int n_iovs = 0;
   for (int i = 0; i < n; ++i) {
-    UDPPacket     *packet;
-    struct msghdr *msg;
-    struct iovec  *iov;
-    int            iov_len;
+    UDPPacket *packet = p[i];
+    if (packet->p.segment_size > 0 && !use_gso) {
+      // Presumes one big super buffer is given
+      ink_assert(packet->p.chain->next == nullptr);
+      int size  = packet->p.chain.get()->size();
+      int segs  = (size + packet->p.segment_size - 1) / packet->p.segment_size;
+      n_msgs   += segs;
+      n_iovs   += segs;
+    } else {
+      n_msgs += 1;
+      for (IOBufferBlock *b = packet->p.chain.get(); b != nullptr; b = b->next.get()) {
+        ++n_iovs;
+      }
+    }
+  }
+  if (n_msgs == 0) {
+    return 0;
+  }
+
+  // The headers can be too big to stack (alloca), so carve them out of a single block.
+  int msgvec_size  = sizeof(struct mmsghdr) * n_msgs;
+  int control_size = sizeof(union udp_msg_control) * n_msgs;
+  int iovec_size   = sizeof(struct iovec) * n_iovs;
+  int info_size    = sizeof(uint16_t) * n_msgs * 2;
+  int total_size   = msgvec_size + control_size + iovec_size + info_size;
+  if (total_size > BUFFER_SIZE_FOR_INDEX(MAX_BUFFER_SIZE_INDEX) && n > 1) {
+    int half = n / 2;
+    int done = SendMultipleUDPPackets(p, half, allow_gso);
+    return done < half ? done : done + SendMultipleUDPPackets(p + half, n - half, allow_gso);
+  }
+
+  IOBufferBlock *tmp = new_IOBufferBlock();
+  tmp->alloc(iobuffer_size_to_index(total_size, MAX_BUFFER_SIZE_INDEX));
+  memset(tmp->buf(), 0, total_size);
+
+  struct mmsghdr        *msgvec     = reinterpret_cast<struct mmsghdr *>(tmp->buf());
+  union udp_msg_control *controls   = reinterpret_cast<union udp_msg_control *>(tmp->buf() + msgvec_size);
+  struct iovec          *iovec      = reinterpret_cast<struct iovec *>(tmp->buf() + msgvec_size + control_size);
+  uint16_t              *msg_packet = reinterpret_cast<uint16_t *>(tmp->buf() + msgvec_size + control_size + iovec_size);
+  uint16_t              *msg_dgrams = msg_packet + n_msgs; // The number of datagrams on the wire for each message
+  int                    iovec_used = 0;
+  int                    vlen       = 0;
+  int                    fd         = p[0]->p.conn->getFd();
+
+  [[maybe_unused]] bool    txtime   = static_cast<UDPConnectionInternal *>(p[0]->p.conn)->txtime_enabled;
+  [[maybe_unused]] int64_t now_nsec = 0;
 
-    packet                               = p[i];
-    packet->p.conn->lastSentPktStartTime = packet->p.delivery_time;
-    ink_assert(packet->p.conn->getFd() == fd);
-#if defined(SOL_UDP) || defined(HAVE_SO_TXTIME)
-    struct cmsghdr *cm = nullptr;
-#endif
 #ifdef HAVE_SO_TXTIME
-    if (packet->p.send_at.tv_sec > 0) { // if set?
-      msg                 = &msgvec[vlen].msg_hdr;
-      msg->msg_controllen = CMSG_SPACE(sizeof(uint64_t));
-      msg->msg_control    = msg_ctrl;
-      cm                  = CMSG_FIRSTHDR(msg);
+  if (txtime) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    now_nsec = now.tv_sec * (1000LL * 1000 * 1000) + now.tv_nsec;
+  }
+#endif
 
-      cm->cmsg_level = SOL_SOCKET;
-      cm->cmsg_type  = SCM_TXTIME;
-      cm->cmsg_len   = CMSG_LEN(sizeof(uint64_t));
+  // Add the control messages for a message, which may be the only message for a packet or one of the segments of it.
+  auto set_control = [&]([[maybe_unused]] UDPPacket *packet, struct msghdr *msg, [[maybe_unused]] bool gso) {
+    [[maybe_unused]] struct cmsghdr *cm = nullptr;
+    msg->msg_control                    = controls[vlen].buf;
+    msg->msg_controllen                 = 0;
+#ifdef HAVE_SO_TXTIME
+    if (txtime && packet->p.send_at.tv_sec > 0) {
+      msg->msg_controllen += CMSG_SPACE(sizeof(uint64_t));
+      cm                   = CMSG_FIRSTHDR(msg);
+      cm->cmsg_level       = SOL_SOCKET;
+      cm->cmsg_type        = SCM_TXTIME;
+      cm->cmsg_len         = CMSG_LEN(sizeof(uint64_t));
 
       // Convert struct timespec to nanoseconds.
-      *(reinterpret_cast<uint64_t *>(CMSG_DATA(cm))) =
-        packet->p.send_at.tv_sec * (1000ULL * 1000 * 1000) + packet->p.send_at.tv_nsec;
-      ;
+      int64_t send_at                                = packet->p.send_at.tv_sec * (1000LL * 1000 * 1000) + packet->p.send_at.tv_nsec;
+      *(reinterpret_cast<uint64_t *>(CMSG_DATA(cm))) = send_at;
     }
 #endif
-
-    if (packet->p.segment_size > 0) {
-      // Presumes one big super buffer is given
-      ink_assert(packet->p.chain->next == nullptr);
 #ifdef SOL_UDP
-      if (use_udp_gso) {
-        msg              = &msgvec[vlen].msg_hdr;
-        msg->msg_name    = reinterpret_cast<caddr_t>(&packet->to.sa);
-        msg->msg_namelen = ats_ip_size(packet->to);
-
-        union udp_segment_hdr *u;
-        u = static_cast<union udp_segment_hdr *>(alloca(sizeof(union udp_segment_hdr)));
-
-        iov             = &iovec[iovec_used++];
-        iov_len         = 1;
-        iov->iov_base   = packet->p.chain.get()->start();
-        iov->iov_len    = packet->p.chain.get()->size();
-        msg->msg_iov    = iov;
-        msg->msg_iovlen = iov_len;
-
-        if (cm == nullptr) {
-          msg->msg_control    = u->buf;
-          msg->msg_controllen = sizeof(u->buf);
-          cm                  = CMSG_FIRSTHDR(msg);
-        } else {
-          msg->msg_controllen += sizeof(u->buf);
-          cm                   = CMSG_NXTHDR(msg, cm);
-        }
+    if (gso) {
+      msg->msg_controllen += CMSG_SPACE(sizeof(uint16_t));
+      cm                   = cm == nullptr ? CMSG_FIRSTHDR(msg) : CMSG_NXTHDR(msg, cm);
+      cm->cmsg_level       = SOL_UDP;
+      cm->cmsg_type        = UDP_SEGMENT;
+      cm->cmsg_len         = CMSG_LEN(sizeof(uint16_t));
+      *(reinterpret_cast<uint16_t *>(CMSG_DATA(cm))) = packet->p.segment_size;
+    }
+#endif
+    if (msg->msg_controllen == 0) {
+      msg->msg_control = nullptr;
+    }
+  };
 
-        cm->cmsg_level                                 = SOL_UDP;
-        cm->cmsg_type                                  = UDP_SEGMENT;
-        cm->cmsg_len                                   = CMSG_LEN(sizeof(uint16_t));
-        *(reinterpret_cast<uint16_t *>(CMSG_DATA(cm))) = packet->p.segment_size;
-        vlen++;
-      } else {
+  for (int i = 0; i < n; ++i) {
+    UDPPacket *packet = p[i];
+
+    packet->p.conn->lastSentPktStartTime = packet->p.delivery_time;
+    ink_assert(packet->p.conn->getFd() == fd);
+
+#ifdef HAVE_SO_TXTIME
+    if (txtime && packet->p.send_at.tv_sec > 0) {
+      record_pacing_delay(packet->p.send_at.tv_sec * (1000LL * 1000 * 1000) + packet->p.send_at.tv_nsec - now_nsec);
+    }
 #endif
-        // UDP_SEGMENT is unavailable
-        // Send the given data as multiple messages
-        int offset = 0;
-        while (offset < packet->p.chain.get()->size()) {
-          msg               = &msgvec[vlen].msg_hdr;
-          msg->msg_name     = reinterpret_cast<caddr_t>(&packet->to.sa);
-          msg->msg_namelen  = ats_ip_size(packet->to);
-          iov               = &iovec[iovec_used++];
-          iov_len           = 1;
-          iov->iov_base     = packet->p.chain.get()->start() + offset;
-          iov->iov_len      = std::min(packet->p.segment_size,
+
+    if (packet->p.segment_size > 0 && !use_gso) {
+      // UDP_SEGMENT is unavailable
+      // Send the given data as multiple messages
+      int offset = 0;
+      while (offset < packet->p.chain.get()->size()) {
+        struct msghdr *msg  = &msgvec[vlen].msg_hdr;
+        struct iovec  *iov  = &iovec[iovec_used++];
+        msg->msg_name       = reinterpret_cast<caddr_t>(&packet->to.sa);
+        msg->msg_namelen    = ats_ip_size(packet->to);
+        iov->iov_base       = packet->p.chain.get()->start() + offset;
+        iov->iov_len        = std::min(packet->p.segment_size,
                                        static_cast<uint16_t>(packet->p.chain.get()->end() - static_cast<char *>(iov->iov_base)));
-          msg->msg_iov      = iov;
-          msg->msg_iovlen   = iov_len;
-          offset           += iov->iov_len;
-          vlen++;
-        }
-        ink_assert(offset == packet->p.chain.get()->size());
-#ifdef SOL_UDP
-      } // use_udp_gso
-#endif
+        msg->msg_iov        = iov;
+        msg->msg_iovlen     = 1;
+        offset             += iov->iov_len;
+        set_control(packet, msg, false);
+        msg_packet[vlen] = i;
+        msg_dgrams[vlen] = 1;
+        vlen++;
+      }
+      ink_assert(offset == packet->p.chain.get()->size());
     } else {
-      // Nothing is special
-      msg              = &msgvec[vlen].msg_hdr;
-      msg->msg_name    = reinterpret_cast<caddr_t>(&packet->to.sa);
-      msg->msg_namelen = ats_ip_size(packet->to);
-      iov              = &iovec[iovec_used++];
-      iov_len          = 0;
+      struct msghdr *msg = &msgvec[vlen].msg_hdr;
+      struct iovec  *iov = &iovec[iovec_used];
+      msg->msg_name      = reinterpret_cast<caddr_t>(&packet->to.sa);
+      msg->msg_namelen   = ats_ip_size(packet->to);
+      int iov_len        = 0;
       for (IOBufferBlock *b = packet->p.chain.get(); b != nullptr; b = b->next.get()) {
         iov[iov_len].iov_base = static_cast<caddr_t>(b->start());
         iov[iov_len].iov_len  = b->size();
         iov_len++;
       }
-      msg->msg_iov    = iov;
-      msg->msg_iovlen = iov_len;
+      iovec_used      += iov_len;
+      msg->msg_iov     = iov;
+      msg->msg_iovlen  = iov_len;
+      set_control(packet, msg, packet->p.segment_size > 0);
+      msg_packet[vlen] = i;
+      msg_dgrams[vlen] = packet->p.segment_size > 0 ?
+                           (packet->p.chain.get()->size() + packet->p.segment_size - 1) / packet->p.segment_size :
+                           1;
       vlen++;
     }
   }
 
-  if (vlen == 0) {
-    return 0;
-  }
-
-  int res = ::sendmmsg(fd, msgvec, vlen, 0);
-  if (res < 0) {
+  // sendmmsg may send only some of the messages, so keep going until all of them are sent or the socket buffer is full.
+  int sent = 0;
+  while (sent < vlen) {
+    int res = ::sendmmsg(fd, msgvec + sent, vlen - sent, 0);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        Dbg(dbg_ctl_udp_send, "Socket buffer is full, %d of %d messages left", vlen - sent, vlen);
+        break;
+      }
 #ifdef SOL_UDP
-    if (use_udp_gso && errno == EIO) {
-      Warning("Disabling UDP GSO due to an error");
-      Dbg(dbg_ctl_udp_send, "Disabling UDP GSO due to an error");
-      use_udp_gso = false;
-      return SendMultipleUDPPackets(p, n);
-    } else {
-      Dbg(dbg_ctl_udp_send, "udp_gso=%d res=%d errno=%d", use_udp_gso, res, errno);
-      return res;
-    }
-#else
-    Dbg(dbg_ctl_udp_send, "res=%d errno=%d", res, errno);
-    return res;
+      if (use_gso && errno == EIO) {
+        Dbg(dbg_ctl_udp_send, "Sending without UDP GSO due to an error");
+        _on_gso_failure();
+        // Messages map to packets one to one with GSO, so the rest of the packets start at the first unsent message.
+        int done = msg_packet[sent];
+        tmp->free();
+        return done + SendMultipleUDPPackets(p + done, n - done, false);
+      }
 #endif
+      // The first message failed. Drop it and carry on with the rest, which may be going elsewhere.
+      Dbg(dbg_ctl_udp_send, "udp_gso=%d res=%d errno=%d", use_gso, res, errno);
+      ++sent;
+      continue;
+    }
+
+    int n_dgrams = 0;
+    for (int i = sent; i < sent + res; ++i) {
+      n_dgrams += msg_dgrams[i];
+    }
+    record_send_batch(n_dgrams);
+    Dbg(dbg_ctl_udp_send, "Sent %d messages (%d datagrams) for %d UDPPackets%s", res, n_dgrams, n, use_gso ? " (GSO)" : "");
+    sent += res;
   }
 
-  if (res > 0) {
-#ifdef SOL_UDP
-    if (use_udp_gso) {
-      ink_assert(res <= n);
-      Dbg(dbg_ctl_udp_send, "Sent %d messages by processing %d UDPPackets (GSO)", res, n);
-    } else {
-#endif
-      int i    = 0;
-      int nmsg = res;
-      for (i = 0; i < n && res > 0; ++i) {
-        if (p[i]->p.segment_size == 0) {
-          res -= 1;
-        } else {
-          res -= (p[i]->p.chain.get()->size() / p[i]->p.segment_size) + ((p[i]->p.chain.get()->size() % p[i]->p.segment_size) != 0);
-        }
-      }
-      Dbg(dbg_ctl_udp_send, "Sent %d messages by processing %d UDPPackets", nmsg, i);
-      res = i;
 #ifdef SOL_UDP
-    }
-#endif
+  if (use_gso && sent > 0) {
+    gso_failures = 0;
   }
+#endif
+
+  // A packet is done once its last message is processed
+  int done = sent >= vlen ? n : msg_packet[sent];
   tmp->free();
-  tmp2->free();
 
-  return res;
+  return done;
 #else
   // sendmmsg is unavailable
+  (void)allow_gso;
   for (int i = 0; i < n; ++i) {
     SendUDPPacket(p[i]);
   }
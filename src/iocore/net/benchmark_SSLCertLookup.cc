@@ -0,0 +1,158 @@
+/** @file
+
+  Benchmark of the certificate lookups done during TLS handshakes.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <malloc.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "P_SSLCertLookup.h"
+
+namespace
+{
+/// @return Bytes currently allocated from the heap.
+size_t
+heap_in_use()
+{
+#if defined(__GLIBC__)
+  auto info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+// Name counts, from the environment so the large ones can be left out.
+std::vector<int>
+name_counts()
+{
+  std::vector<int> counts;
+  char const      *text = getenv("CERT_LOOKUP_BENCHMARK_NAMES");
+  for (std::string_view spot{text ? text : "1000,100000,1000000"}; !spot.empty();) {
+    auto comma = spot.find(',');
+    counts.push_back(atoi(std::string{spot.substr(0, comma)}.c_str()));
+    spot = comma == spot.npos ? std::string_view{} : spot.substr(comma + 1);
+  }
+  return counts;
+}
+
+// One name in ten is a wildcard for a tenant domain, the rest are host names.
+std::string
+cert_name(int i)
+{
+  return i % 10 == 0 ? "*.tenant" + std::to_string(i) + ".example.net" : "www" + std::to_string(i) + ".example.com";
+}
+} // namespace
+
+TEST_CASE("SSLCertLookup by name", "[bench][ssl]")
+{
+  // The contexts are all the same, only the number of names matters to the lookups.
+  shared_SSL_CTX ctx{SSL_CTX_new(TLS_server_method()), SSL_CTX_free};
+
+  for (int n : name_counts()) {
+    size_t        before = heap_in_use();
+    SSLCertLookup lookup;
+    for (int i = 0; i < n; ++i) {
+      SSLCertContext cc;
+      cc.setCtx(ctx);
+      REQUIRE(lookup.insert(cert_name(i).c_str(), cc) >= 0);
+    }
+    printf("%d names: %zu bytes, %zu bytes per name\n", n, heap_in_use() - before, (heap_in_use() - before) / n);
+
+    std::vector<std::string> hosts;
+    std::vector<std::string> wilds;
+    for (int i = 0; i < 1024; ++i) {
+      int k = (i * 7919) % n;
+      hosts.push_back("www" + std::to_string(k - k % 10 + 1) + ".example.com");
+      wilds.push_back("api.tenant" + std::to_string(k - k % 10) + ".example.net");
+    }
+    std::string miss  = "www.example.org";
+    std::string mixed = "WWW1.Example.COM";
+
+    REQUIRE(lookup.find(hosts[1]) == lookup.get(7919 % n - 7919 % n % 10 + 1));
+    REQUIRE(lookup.find(wilds[1]) == lookup.get(7919 % n - 7919 % n % 10));
+    REQUIRE(lookup.find(mixed) == lookup.get(1));
+    REQUIRE(lookup.find("a." + wilds[1]) == nullptr);
+    REQUIRE(lookup.find(miss) == nullptr);
+
+    int i = 0;
+    BENCHMARK("host " + std::to_string(n) + " names")
+    {
+      return lookup.find(hosts[i++ & 1023]);
+    };
+    BENCHMARK("wildcard " + std::to_string(n) + " names")
+    {
+      return lookup.find(wilds[i++ & 1023]);
+    };
+    BENCHMARK("miss " + std::to_string(n) + " names")
+    {
+      return lookup.find(miss);
+    };
+    BENCHMARK("host and context " + std::to_string(n) + " names")
+    {
+      return lookup.find(hosts[i++ & 1023])->getCtx();
+    };
+  }
+}
+
+// Handshakes on every thread getting the context of the same popular certificate.
+TEST_CASE("SSLCertContext from many threads", "[bench][ssl]")
+{
+  SSLCertContext cc;
+  cc.setCtx(shared_SSL_CTX{SSL_CTX_new(TLS_server_method()), SSL_CTX_free});
+
+  for (int threads : {1, 4, 16}) {
+    constexpr int            PER_THREAD = 1000000;
+    std::atomic<bool>        go{false};
+    std::atomic<int>         missing{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+      workers.emplace_back([&]() {
+        while (!go) {
+          std::this_thread::yield();
+        }
+        for (int k = 0; k < PER_THREAD; ++k) {
+          if (cc.getCtx() == nullptr) {
+            ++missing;
+          }
+        }
+      });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go         = true;
+    for (auto &w : workers) {
+      w.join();
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(missing == 0);
+    printf("%d threads: %.1f ns per getCtx\n", threads, double(ns) / PER_THREAD);
+  }
+}
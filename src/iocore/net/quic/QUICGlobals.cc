@@ -75,8 +75,11 @@ void
 QUIC::_register_stats()
 {
   // Transferred packet counts
-  quic_rsb.total_packets_sent = Metrics::Counter::createPtr("proxy.process.quic.total_packets_sent");
+  quic_rsb.total_packets_sent     = Metrics::Counter::createPtr("proxy.process.quic.total_packets_sent");
+  quic_rsb.total_packets_received = Metrics::Counter::createPtr("proxy.process.quic.total_packets_received");
+
+  // Packets handed to an ET_NET thread other than the one paired with the receiving ET_UDP thread
+  quic_rsb.total_packets_forwarded = Metrics::Counter::createPtr("proxy.process.quic.total_packets_forwarded");
 
   // quic_rsb.total_packets_retransmitted = Metrics::Counter::createPtr("proxy.process.quic.total_packets_retransmitted");
-  // quic_rsb.total_packets_received      = Metrics::Counter::createPtr("proxy.process.quic.total_packets_received");
 }
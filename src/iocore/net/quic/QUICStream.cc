@@ -72,6 +72,12 @@ QUICStream::final_offset() const
   return 0;
 }
 
+uint64_t
+QUICStream::sent_bytes() const
+{
+  return this->_sent_bytes;
+}
+
 void
 QUICStream::stop_sending(QUICStreamErrorUPtr /* error ATS_UNUSED */)
 {
@@ -113,17 +113,48 @@ QUICStreamManager::create_stream(QUICStreamId stream_id, QUICConnectionError & /
 }
 
 QUICConnectionErrorUPtr
-QUICStreamManager::create_uni_stream(QUICStreamId /* new_stream_id ATS_UNUSED */)
+QUICStreamManager::create_uni_stream(QUICStreamId &new_stream_id)
 {
-  return nullptr;
+  return this->_create_local_stream(new_stream_id, true);
+}
+
+QUICConnectionErrorUPtr
+QUICStreamManager::create_bidi_stream(QUICStreamId &new_stream_id)
+{
+  return this->_create_local_stream(new_stream_id, false);
 }
 
 QUICConnectionErrorUPtr
-QUICStreamManager::create_bidi_stream(QUICStreamId /* new_stream_id ATS_UNUSED */)
+QUICStreamManager::_create_local_stream(QUICStreamId &new_stream_id, bool uni)
 {
+  // The two low bits of a stream id are the initiator and the directionality, RFC 9000 2.1
+  uint64_t &count = uni ? this->_local_uni_stream_count : this->_local_bidi_stream_count;
+  new_stream_id   = (count++ << 2) | (uni ? 0x02 : 0x00) | (this->_context->connection_info()->direction() == NET_VCONNECTION_IN);
+
+  QUICConnectionError err;
+  this->create_stream(new_stream_id, err);
+  this->_new_streams.push_back(new_stream_id);
   return nullptr;
 }
 
+void
+QUICStreamManager::send_new_streams(quiche_conn *quiche_con)
+{
+  for (auto it = this->_new_streams.begin(); it != this->_new_streams.end();) {
+    QUICStream *stream = this->find_stream(*it);
+    if (stream != nullptr) {
+      // Setting the priority makes quiche create the stream, the values are the defaults of RFC 9218
+      quiche_conn_stream_priority(quiche_con, stream->id(), 3, true);
+      stream->send_data(quiche_con);
+    }
+    if (stream == nullptr || stream->sent_bytes() > 0) {
+      it = this->_new_streams.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 QUICConnectionErrorUPtr
 QUICStreamManager::delete_stream(QUICStreamId stream_id)
 {
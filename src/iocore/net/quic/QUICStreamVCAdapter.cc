@@ -84,7 +84,9 @@ QUICStreamVCAdapter::_read(size_t len)
     SCOPED_MUTEX_LOCK(lock, this->_write_vio.mutex, this_ethread());
 
     IOBufferReader *reader = this->_write_vio.get_reader();
-    block                  = make_ptr<IOBufferBlock>(reader->get_current_block()->clone());
+    // Data written by cloning blocks lands after the empty block the buffer started with
+    reader->skip_empty_blocks();
+    block = make_ptr<IOBufferBlock>(reader->get_current_block()->clone());
     if (block->size()) {
       block->consume(reader->start_offset);
       block->_end             = std::min(block->start() + len, block->_buf_end);
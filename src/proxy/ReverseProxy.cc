@@ -39,6 +39,12 @@
 #include "proxy/http/remap/RemapProcessor.h"
 #include "proxy/http/remap/UrlRewrite.h"
 #include "proxy/http/remap/UrlMapping.h"
+#include "tsutil/Metrics.h"
+
+#include <cstdio>
+#include <unistd.h>
+
+using ts::Metrics;
 
 namespace
 {
@@ -46,6 +52,30 @@ Ptr<ProxyMutex> reconfig_mutex;
 
 DbgCtl dbg_ctl_url_rewrite{"url_rewrite"};
 
+struct RemapReloadStats {
+  Metrics::Counter::AtomicType *reloads             = nullptr;
+  Metrics::Counter::AtomicType *reload_failures     = nullptr;
+  Metrics::Gauge::AtomicType   *reload_time         = nullptr;
+  Metrics::Gauge::AtomicType   *reload_memory_delta = nullptr;
+} remap_reload_stats;
+
+/// @return The current resident set size of the process, in bytes, or 0 if it is not available.
+int64_t
+resident_memory()
+{
+  long  size     = 0;
+  long  resident = 0;
+  FILE *statm    = fopen("/proc/self/statm", "r");
+
+  if (statm != nullptr) {
+    if (fscanf(statm, "%ld %ld", &size, &resident) != 2) {
+      resident = 0;
+    }
+    fclose(statm);
+  }
+  return static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE);
+}
+
 } // end anonymous namespace
 
 // Global Ptrs
@@ -70,12 +100,18 @@ init_reverse_proxy()
   reconfig_mutex = new_ProxyMutex();
   rewrite_table  = new UrlRewrite();
 
+  remap_reload_stats.reloads             = Metrics::Counter::createPtr("proxy.process.http.remap.reloads");
+  remap_reload_stats.reload_failures     = Metrics::Counter::createPtr("proxy.process.http.remap.reload_failures");
+  remap_reload_stats.reload_time         = Metrics::Gauge::createPtr("proxy.process.http.remap.reload_time");
+  remap_reload_stats.reload_memory_delta = Metrics::Gauge::createPtr("proxy.process.http.remap.reload_memory_delta");
+
   Note("%s loading ...", ts::filename::REMAP);
   if (!rewrite_table->load()) {
     Emergency("%s failed to load", ts::filename::REMAP);
   } else {
     Note("%s finished loading", ts::filename::REMAP);
   }
+  rewrite_table->start_health_checks();
 
   RecRegisterConfigUpdateCb("proxy.config.url_remap.filename", url_rewrite_CB, (void *)FILE_CHANGED);
   RecRegisterConfigUpdateCb("proxy.config.proxy_name", url_rewrite_CB, (void *)TSNAME_CHANGED);
@@ -137,6 +173,8 @@ bool
 reloadUrlRewrite()
 {
   UrlRewrite *newTable, *oldTable;
+  ink_hrtime  start  = ink_get_hrtime();
+  int64_t     memory = resident_memory();
 
   Note("%s loading ...", ts::filename::REMAP);
   Dbg(dbg_ctl_url_rewrite, "%s updated, reloading...", ts::filename::REMAP);
@@ -144,6 +182,9 @@ reloadUrlRewrite()
   if (newTable->load()) {
     static const char *msg_format = "%s finished loading";
 
+    Metrics::Counter::increment(remap_reload_stats.reloads);
+    Metrics::Gauge::store(remap_reload_stats.reload_time, ink_hrtime_to_msec(ink_get_hrtime() - start));
+
     // Hold at least one lease, until we reload the configuration
     newTable->acquire();
 
@@ -152,6 +193,18 @@ reloadUrlRewrite()
 
     ink_assert(oldTable != nullptr);
 
+    // Only the table in use checks the next hop hosts.
+    newTable->start_health_checks();
+    oldTable->stop_health_checks();
+
+    // The memory the reload added or freed is only known once the old table is gone, which can be long after the swap if
+    // transactions still hold it.
+    if (memory > 0) {
+      oldTable->on_delete([memory]() {
+        Metrics::Gauge::store(remap_reload_stats.reload_memory_delta, resident_memory() - memory);
+      });
+    }
+
     // Release the old one
     oldTable->release();
 
@@ -162,6 +215,7 @@ reloadUrlRewrite()
     static const char *msg_format = "%s failed to load";
 
     delete newTable;
+    Metrics::Counter::increment(remap_reload_stats.reload_failures);
     Dbg(dbg_ctl_url_rewrite, msg_format, ts::filename::REMAP);
     Error(msg_format, ts::filename::REMAP);
     return false;
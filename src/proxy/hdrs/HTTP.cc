@@ -280,6 +280,7 @@ http_hdr_copy_onto(HTTPHdrImpl *s_hh, HdrHeap *s_heap, HTTPHdrImpl *d_hh, HdrHea
   ink_assert(d_mh != nullptr);
 
   memcpy(d_hh, s_hh, sizeof(HTTPHdrImpl));
+  hdr_copy_stats.obj_bytes += sizeof(HTTPHdrImpl);
   d_hh->m_fields_impl = d_mh; // restore pre-memcpy mime impl
 
   if (s_hh->m_polarity == HTTPType::REQUEST) {
@@ -45,6 +45,9 @@ static constexpr uint32_t MAX_HDR_HEAP_OBJ_LENGTH = (1 << 20) - 1; ///< m_length
 Allocator hdrHeapAllocator("hdrHeap", HdrHeap::DEFAULT_SIZE);
 Allocator strHeapAllocator("hdrStrHeap", HdrStrHeap::DEFAULT_SIZE);
 
+thread_local HdrCopyStats hdr_copy_stats;
+thread_local MarshalRelocs hdr_marshal_relocs;
+
 namespace
 {
 DbgCtl dbg_ctl_http{"http"};
@@ -276,6 +279,7 @@ HdrHeap::allocate_str(int nbytes)
       }
       // Try to allocate of our read/write string heap
       if (char *new_space = m_read_write_heap->allocate(nbytes); new_space) {
+        hdr_copy_stats.str_bytes += nbytes;
         return new_space;
       }
 
@@ -370,10 +374,12 @@ HdrHeap::coalesce_str_heaps(int incoming_size)
   ink_assert(incoming_size >= 0);
   ink_assert(m_writeable);
 
-  new_heap_size += required_space_for_evacuation();
+  int evacuate_size  = required_space_for_evacuation();
+  new_heap_size     += evacuate_size;
 
   HdrStrHeap *new_heap = HdrStrHeap::alloc(new_heap_size);
   evacuate_from_str_heaps(new_heap);
+  hdr_copy_stats.str_bytes += evacuate_size;
   m_lost_string_space = 0;
 
   // At this point none of the currently used string
@@ -572,17 +578,18 @@ int
 HdrHeap::marshal_length()
 {
   int len;
+  int obj_len = 0;
 
   // If there is more than one HdrHeap block, we'll
   //  coalesce the HdrHeap blocks together so we
   //  only need one block header
-  len        = HDR_HEAP_HDR_SIZE;
   HdrHeap *h = this;
 
   while (h) {
-    len += static_cast<int>(h->m_free_start - h->m_data_start);
-    h    = h->m_next;
+    obj_len += static_cast<int>(h->m_free_start - h->m_data_start);
+    h        = h->m_next;
   }
+  len = HDR_HEAP_HDR_SIZE + obj_len;
 
   // Since when we unmarshal, we won't have a writable string
   //  heap, we can drop the header on the read/write
@@ -598,7 +605,7 @@ HdrHeap::marshal_length()
   }
 
   len = HdrHeapMarshalBlocks(swoc::round_up(len));
-  return len;
+  return len + marshal_reloc_size(obj_len);
 }
 
 #ifdef HDR_HEAP_CHECKSUMS
@@ -633,6 +640,10 @@ compute_checksum(void *buf, int len)
 //     the heap to make this representation usable in the read-only
 //     form
 //
+//   The offsets of all the pointers are recorded in a bitmap
+//     after the strings so unmarshal does not need to know
+//     where each object type keeps its pointers
+//
 int
 HdrHeap::marshal(char *buf, int len)
 {
@@ -659,6 +670,9 @@ HdrHeap::marshal(char *buf, int len)
   // Variables used later on.  Sunpro doesn't like
   //   bypassing initializations with gotos
   int used;
+  int buf_len = len;
+  int reloc_offset;
+  int reloc_size;
 
   HdrHeap *unmarshal_hdr = this;
 
@@ -695,7 +709,7 @@ HdrHeap::marshal(char *buf, int len)
   //  we can fill in the header on marshalled block
   marshal_hdr->m_free_start = nullptr;
   marshal_hdr->m_data_start = reinterpret_cast<char *>(HDR_HEAP_HDR_SIZE.value()); // offset
-  marshal_hdr->m_magic      = HdrBufMagic::MARSHALED;
+  marshal_hdr->m_magic      = HdrBufMagic::MARSHALED_V2;
   marshal_hdr->m_writeable  = false;
   marshal_hdr->m_size       = ptr_heap_size + HDR_HEAP_HDR_SIZE;
   marshal_hdr->m_next       = nullptr;
@@ -767,6 +781,17 @@ HdrHeap::marshal(char *buf, int len)
   // Patch the str heap len
   marshal_hdr->m_ronly_heap[0].m_heap_len = str_size;
 
+  // The relocation bitmap goes after the strings, the object
+  //   marshal functions fill it in
+  reloc_offset = marshal_hdr->marshal_reloc_offset();
+  reloc_size   = marshal_reloc_size(ptr_heap_size);
+  if (reloc_offset + reloc_size > buf_len) {
+    goto Failed;
+  }
+  memset(buf + reloc_offset, 0, reloc_size);
+  hdr_marshal_relocs.base = buf + HDR_HEAP_HDR_SIZE;
+  hdr_marshal_relocs.bits = reinterpret_cast<uint64_t *>(buf + reloc_offset);
+
   // Take our translation tables and loop over the objects
   //    and call the object marshal function to patch live
   //    strings pointers & live object pointers to offsets
@@ -817,9 +842,10 @@ HdrHeap::marshal(char *buf, int len)
     }
   }
 
+  hdr_marshal_relocs.bits = nullptr;
+
   // Add up the total bytes used
-  used = ptr_heap_size + str_size + HDR_HEAP_HDR_SIZE;
-  used = HdrHeapMarshalBlocks(swoc::round_up(used));
+  used = reloc_offset + reloc_size;
 
 #ifdef HDR_HEAP_CHECKSUMS
   {
@@ -831,7 +857,8 @@ HdrHeap::marshal(char *buf, int len)
   return used;
 
 Failed:
-  marshal_hdr->m_magic = HdrBufMagic::CORRUPT;
+  hdr_marshal_relocs.bits = nullptr;
+  marshal_hdr->m_magic    = HdrBufMagic::CORRUPT;
   return -1;
 }
 
@@ -843,7 +870,7 @@ Failed:
 bool
 HdrHeap::check_marshalled(uint32_t buf_length)
 {
-  if (this->m_magic != HdrBufMagic::MARSHALED) {
+  if (this->m_magic != HdrBufMagic::MARSHALED && this->m_magic != HdrBufMagic::MARSHALED_V2) {
     return false;
   }
 
@@ -851,11 +878,15 @@ HdrHeap::check_marshalled(uint32_t buf_length)
     return false;
   }
 
+  if (this->m_magic == HdrBufMagic::MARSHALED_V2 && static_cast<uint32_t>(this->unmarshal_size()) > buf_length) {
+    return false;
+  }
+
   if (this->m_size != (uintptr_t)this->m_ronly_heap[0].m_heap_start) {
     return false;
   }
 
-  if ((uintptr_t)(this->m_size + m_ronly_heap[0].m_heap_start) > buf_length) {
+  if (this->m_size + m_ronly_heap[0].m_heap_len > buf_length) {
     return false;
   }
 
@@ -893,7 +924,7 @@ HdrHeap::unmarshal(int buf_length, int obj_type, HdrHeapObjImpl **found_obj, Ref
   *found_obj = nullptr;
 
   // Check out this heap and make sure it is OK
-  if (m_magic != HdrBufMagic::MARSHALED) {
+  if (m_magic != HdrBufMagic::MARSHALED && m_magic != HdrBufMagic::MARSHALED_V2) {
     ink_assert(!"HdrHeap::unmarshal bad magic");
     return -1;
   }
@@ -949,46 +980,69 @@ HdrHeap::unmarshal(int buf_length, int obj_type, HdrHeapObjImpl **found_obj, Ref
     m_ronly_heap[0].m_ref_count_ptr.swizzle(block_ref);
   }
 
-  // Loop over objects and swizzle there pointer to
-  //  live offsets
   char    *obj_data = m_data_start;
   intptr_t offset   = (intptr_t)this;
 
-  while (obj_data < m_free_start) {
-    HdrHeapObjImpl *obj = reinterpret_cast<HdrHeapObjImpl *>(obj_data);
-    ink_assert(obj_is_aligned(obj));
+  if (m_magic == HdrBufMagic::MARSHALED_V2) {
+    // The bitmap has all the pointers, the objects only
+    //  need to be walked to find the one asked for
+    unmarshal_relocs(offset);
 
-    // Object length cannot be 0 by design, otherwise something is wrong + infinite loop here!
-    ink_release_assert(0 != obj->m_length);
+    while (obj_data < m_free_start && *found_obj == nullptr) {
+      HdrHeapObjImpl *obj = reinterpret_cast<HdrHeapObjImpl *>(obj_data);
+      ink_release_assert(0 != obj->m_length);
 
-    if (obj->m_type == static_cast<unsigned>(obj_type) && *found_obj == nullptr) {
-      *found_obj = obj;
+      if (obj->m_type == static_cast<unsigned>(obj_type)) {
+        *found_obj = obj;
+      }
+      obj_data = obj_data + obj->m_length;
     }
+  } else {
+    // Loop over objects and swizzle there pointer to
+    //  live offsets
+    while (obj_data < m_free_start) {
+      HdrHeapObjImpl *obj = reinterpret_cast<HdrHeapObjImpl *>(obj_data);
+      ink_assert(obj_is_aligned(obj));
 
-    switch (static_cast<HdrHeapObjType>(obj->m_type)) {
-    case HdrHeapObjType::HTTP_HEADER:
-      ((HTTPHdrImpl *)obj)->unmarshal(offset);
-      break;
-    case HdrHeapObjType::URL:
-      ((URLImpl *)obj)->unmarshal(offset);
-      break;
-    case HdrHeapObjType::FIELD_BLOCK:
-      ((MIMEFieldBlockImpl *)obj)->unmarshal(offset);
-      break;
-    case HdrHeapObjType::MIME_HEADER:
-      ((MIMEHdrImpl *)obj)->unmarshal(offset);
-      break;
-    case HdrHeapObjType::EMPTY:
-      // Nothing to do
-      break;
-    default:
-      fprintf(stderr, "WARNING: Unmarshal failed due to unknown obj type %d after %d bytes", static_cast<int>(obj->m_type),
-              static_cast<int>(obj_data - reinterpret_cast<char *>(this)));
-      dump_heap(unmarshal_size);
-      return -1;
+      // Object length cannot be 0 by design, otherwise something is wrong + infinite loop here!
+      ink_release_assert(0 != obj->m_length);
+
+      if (obj->m_type == static_cast<unsigned>(obj_type) && *found_obj == nullptr) {
+        *found_obj = obj;
+      }
+
+      switch (static_cast<HdrHeapObjType>(obj->m_type)) {
+      case HdrHeapObjType::HTTP_HEADER:
+        ((HTTPHdrImpl *)obj)->unmarshal(offset);
+        break;
+      case HdrHeapObjType::URL:
+        ((URLImpl *)obj)->unmarshal(offset);
+        break;
+      case HdrHeapObjType::FIELD_BLOCK:
+        ((MIMEFieldBlockImpl *)obj)->unmarshal(offset);
+        break;
+      case HdrHeapObjType::MIME_HEADER:
+        ((MIMEHdrImpl *)obj)->unmarshal(offset);
+        break;
+      case HdrHeapObjType::EMPTY:
+        // Nothing to do
+        break;
+      default:
+        fprintf(stderr, "WARNING: Unmarshal failed due to unknown obj type %d after %d bytes", static_cast<int>(obj->m_type),
+                static_cast<int>(obj_data - reinterpret_cast<char *>(this)));
+        dump_heap(unmarshal_size);
+        return -1;
+      }
+
+      obj_data = obj_data + obj->m_length;
     }
+  }
 
-    obj_data = obj_data + obj->m_length;
+  // The MIME name filter is not marshalled, build it for the header that was asked for.
+  if (*found_obj != nullptr && (*found_obj)->m_type == static_cast<unsigned>(HdrHeapObjType::HTTP_HEADER)) {
+    if (MIMEHdrImpl *mh = static_cast<HTTPHdrImpl *>(*found_obj)->m_fields_impl; mh != nullptr) {
+      mh->recompute_name_filter();
+    }
   }
 
   m_magic = HdrBufMagic::ALIVE;
@@ -1093,11 +1147,13 @@ HdrHeap::inherit_string_heaps(const HdrHeap *inherit_from)
         inherit_from->m_read_write_heap->total_size() - sizeof(HdrStrHeap) - inherit_from->m_read_write_heap->space_avail();
       ink_release_assert(attach_str_heap(reinterpret_cast<char *>(inherit_from->m_read_write_heap.get() + 1), str_size,
                                          inherit_from->m_read_write_heap.get(), &first_free));
+      hdr_copy_stats.shared_bytes += str_size;
     }
     // Copy over read only string heaps
     for (const auto &i : inherit_from->m_ronly_heap) {
       if (i.m_heap_start) {
         ink_release_assert(attach_str_heap(i.m_heap_start, i.m_heap_len, i.m_ref_count_ptr.get(), &first_free));
+        hdr_copy_stats.shared_bytes += i.m_heap_len;
       }
     }
 
@@ -0,0 +1,303 @@
+/** @file
+
+  Vectorized character class scanning for the HTTP/MIME parsers
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "proxy/hdrs/HdrScan.h"
+
+#include "tscore/ParseRules.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define HDR_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+HdrScanMode current_mode = HdrScanMode::SCALAR;
+
+/* Field name bytes are looked up by nibble: bit @c hi of name_lut[lo] is set if (hi << 4 | lo) is valid in a field name.
+   Only 7 bit characters are valid so a byte with the top bit set never matches.
+ */
+alignas(32) uint8_t name_lut[32];
+alignas(32) uint8_t name_bit[32];
+
+void
+build_name_lut()
+{
+  for (int lo = 0; lo < 16; ++lo) {
+    uint8_t row = 0;
+    for (int hi = 0; hi < 8; ++hi) {
+      if (ParseRules::is_http_field_name(static_cast<char>(hi << 4 | lo))) {
+        row |= 1 << hi;
+      }
+    }
+    // Both AVX2 lanes are looked up separately, so each gets a copy.
+    name_lut[lo] = name_lut[lo + 16] = row;
+    name_bit[lo] = name_bit[lo + 16] = lo < 8 ? 1 << lo : 0;
+  }
+}
+
+//
+// Scalar
+//
+
+const char *
+scalar_find_lf(const char *s, const char *e, bool &nul_seen)
+{
+  auto lf  = static_cast<const char *>(memchr(s, ParseRules::CHAR_LF, e - s));
+  auto end = lf ? lf : e;
+  if (memchr(s, '\0', end - s) != nullptr) {
+    nul_seen = true;
+  }
+  return end;
+}
+
+bool
+scalar_has_control(const char *s, const char *e)
+{
+  for (; s < e; ++s) {
+    if (ParseRules::is_control(*s)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+scalar_is_field_name(const char *s, const char *e)
+{
+  for (; s < e; ++s) {
+    if (!ParseRules::is_http_field_name(*s)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr HdrScanFuncs scalar_funcs = {scalar_find_lf, scalar_has_control, scalar_is_field_name};
+
+#if HDR_SCAN_X86
+
+//
+// SSE4.2, 16 bytes at a time
+//
+
+__attribute__((target("sse4.2"))) const char *
+sse42_find_lf(const char *s, const char *e, bool &nul_seen)
+{
+  const __m128i lf   = _mm_set1_epi8(ParseRules::CHAR_LF);
+  const __m128i zero = _mm_setzero_si128();
+
+  for (; e - s >= 16; s += 16) {
+    __m128i  v        = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+    uint32_t lf_mask  = _mm_movemask_epi8(_mm_cmpeq_epi8(v, lf));
+    uint32_t nul_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+    if (lf_mask) {
+      int n = __builtin_ctz(lf_mask);
+      if (nul_mask & ((1u << n) - 1)) {
+        nul_seen = true;
+      }
+      return s + n;
+    }
+    if (nul_mask) {
+      nul_seen = true;
+    }
+  }
+  return scalar_find_lf(s, e, nul_seen);
+}
+
+// 0x00-0x08, 0x0a-0x1f and 0x7f
+__attribute__((target("sse4.2"))) inline __m128i
+sse42_control_mask(__m128i v)
+{
+  __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v);
+  low         = _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(ParseRules::CHAR_HT)), low);
+  return _mm_or_si128(low, _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f)));
+}
+
+__attribute__((target("sse4.2"))) bool
+sse42_has_control(const char *s, const char *e)
+{
+  for (; e - s >= 16; s += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+    if (_mm_movemask_epi8(sse42_control_mask(v))) {
+      return true;
+    }
+  }
+  return scalar_has_control(s, e);
+}
+
+__attribute__((target("sse4.2"))) bool
+sse42_is_field_name(const char *s, const char *e)
+{
+  const __m128i lut    = _mm_load_si128(reinterpret_cast<const __m128i *>(name_lut));
+  const __m128i bit    = _mm_load_si128(reinterpret_cast<const __m128i *>(name_bit));
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+
+  for (; e - s >= 16; s += 16) {
+    __m128i v   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+    __m128i row = _mm_shuffle_epi8(lut, _mm_and_si128(v, nibble));
+    __m128i hi  = _mm_shuffle_epi8(bit, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, hi), _mm_setzero_si128()))) {
+      return false;
+    }
+  }
+  return scalar_is_field_name(s, e);
+}
+
+constexpr HdrScanFuncs sse42_funcs = {sse42_find_lf, sse42_has_control, sse42_is_field_name};
+
+//
+// AVX2, 32 bytes at a time
+//
+
+__attribute__((target("avx2"))) const char *
+avx2_find_lf(const char *s, const char *e, bool &nul_seen)
+{
+  const __m256i lf   = _mm256_set1_epi8(ParseRules::CHAR_LF);
+  const __m256i zero = _mm256_setzero_si256();
+
+  for (; e - s >= 32; s += 32) {
+    __m256i  v        = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s));
+    uint32_t lf_mask  = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, lf));
+    uint32_t nul_mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero));
+    if (lf_mask) {
+      int n = __builtin_ctz(lf_mask);
+      if (nul_mask & ((uint64_t{1} << n) - 1)) {
+        nul_seen = true;
+      }
+      return s + n;
+    }
+    if (nul_mask) {
+      nul_seen = true;
+    }
+  }
+  return sse42_find_lf(s, e, nul_seen);
+}
+
+__attribute__((target("avx2"))) bool
+avx2_has_control(const char *s, const char *e)
+{
+  for (; e - s >= 32; s += 32) {
+    __m256i v   = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s));
+    __m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v);
+    low         = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(ParseRules::CHAR_HT)), low);
+    if (_mm256_movemask_epi8(_mm256_or_si256(low, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f))))) {
+      return true;
+    }
+  }
+  return sse42_has_control(s, e);
+}
+
+__attribute__((target("avx2"))) bool
+avx2_is_field_name(const char *s, const char *e)
+{
+  const __m256i lut    = _mm256_load_si256(reinterpret_cast<const __m256i *>(name_lut));
+  const __m256i bit    = _mm256_load_si256(reinterpret_cast<const __m256i *>(name_bit));
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+  for (; e - s >= 32; s += 32) {
+    __m256i v   = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s));
+    __m256i row = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, nibble));
+    __m256i hi  = _mm256_shuffle_epi8(bit, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, hi), _mm256_setzero_si256()))) {
+      return false;
+    }
+  }
+  return sse42_is_field_name(s, e);
+}
+
+constexpr HdrScanFuncs avx2_funcs = {avx2_find_lf, avx2_has_control, avx2_is_field_name};
+
+#endif // HDR_SCAN_X86
+
+} // namespace
+
+HdrScanFuncs hdr_scan_funcs = scalar_funcs;
+
+bool
+hdr_scan_init(HdrScanMode mode)
+{
+#if HDR_SCAN_X86
+  bool has_sse42 = __builtin_cpu_supports("sse4.2");
+  bool has_avx2  = __builtin_cpu_supports("avx2");
+#else
+  bool has_sse42 = false;
+  bool has_avx2  = false;
+#endif
+
+  if (mode == HdrScanMode::AUTO) {
+    mode = has_avx2 ? HdrScanMode::AVX2 : has_sse42 ? HdrScanMode::SSE42 : HdrScanMode::SCALAR;
+  }
+
+  build_name_lut();
+
+  switch (mode) {
+  case HdrScanMode::SCALAR:
+    hdr_scan_funcs = scalar_funcs;
+    break;
+#if HDR_SCAN_X86
+  case HdrScanMode::SSE42:
+    if (!has_sse42) {
+      return false;
+    }
+    hdr_scan_funcs = sse42_funcs;
+    break;
+  case HdrScanMode::AVX2:
+    if (!has_avx2) {
+      return false;
+    }
+    hdr_scan_funcs = avx2_funcs;
+    break;
+#endif
+  default:
+    return false;
+  }
+
+  current_mode = mode;
+  return true;
+}
+
+HdrScanMode
+hdr_scan_mode()
+{
+  return current_mode;
+}
+
+const char *
+hdr_scan_mode_name(HdrScanMode mode)
+{
+  switch (mode) {
+  case HdrScanMode::AUTO:
+    return "auto";
+  case HdrScanMode::SCALAR:
+    return "scalar";
+  case HdrScanMode::SSE42:
+    return "sse4.2";
+  case HdrScanMode::AVX2:
+    return "avx2";
+  }
+  return "unknown";
+}
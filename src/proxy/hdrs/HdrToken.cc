@@ -22,10 +22,12 @@
  */
 
 #include "tscore/ink_platform.h"
-#include "tscore/HashFNV.h"
 #include "tscore/Diags.h"
 #include "tscore/ink_memory.h"
+#include <array>
+#include <bit>
 #include <cstdio>
+#include <string_view>
 #include "tscore/Allocator.h"
 #include "proxy/hdrs/HTTP.h"
 #include "proxy/hdrs/HdrToken.h"
@@ -53,7 +55,7 @@ DbgCtl dbg_ctl_hdr_token{"hdr_token"};
 
 */
 
-const char *const _hdrtoken_strs[] = {
+constexpr const char *_hdrtoken_strs[] = {
   // MIME Field names
   "Accept-Charset", "Accept-Encoding", "Accept-Language", "Accept-Ranges", "Accept", "Age", "Allow",
   "Approved", // NNTP
@@ -292,71 +294,155 @@ DFA *hdrtoken_strs_dfa = nullptr;
  *                                                                     *
  ***********************************************************************/
 
-static constexpr size_t HDRTOKEN_HASH_TABLE_SIZE = 65536;
+/*
+  The well known strings are looked up in a perfect hash table built at compile time (hash and displace): the hash of a
+  string picks a bucket, and the bucket's displacement is mixed into the hash to pick a slot that no other well known
+  string uses. A lookup is therefore one hash of the string, one slot and one compare.
+*/
+
+namespace
+{
+constexpr size_t HDRTOKEN_HASH_TABLE_SIZE = std::bit_ceil(SIZEOF(_hdrtoken_strs));
+constexpr size_t HDRTOKEN_HASH_BUCKETS    = HDRTOKEN_HASH_TABLE_SIZE / 4;
+constexpr size_t HDRTOKEN_HASH_MAX_BUCKET = 16; ///< Most strings in one bucket the table builder can place
 
-struct HdrTokenHashBucket {
-  const char *wks;
-  uint32_t    hash;
+struct HdrTokenHashSlot {
+  uint32_t hash    = 0;
+  int16_t  wks_idx = -1;
 };
 
-HdrTokenHashBucket hdrtoken_hash_table[HDRTOKEN_HASH_TABLE_SIZE];
+struct HdrTokenHashTable {
+  std::array<uint16_t, HDRTOKEN_HASH_BUCKETS>            displacements{};
+  std::array<HdrTokenHashSlot, HDRTOKEN_HASH_TABLE_SIZE> slots{};
+  bool                                                   complete = false;
+};
+
+constexpr char
+hdrtoken_fold(char c)
+{
+  return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
 
 /**
-  basic FNV hash
+  basic FNV hash, case insensitive
 **/
-#define TINY_MASK(x) (((uint32_t)1 << (x)) - 1)
-
-inline uint32_t
-hash_to_slot(uint32_t hash)
+constexpr uint32_t
+hdrtoken_hash(const char *string, size_t length)
 {
-  return ((hash >> 15) ^ hash) & TINY_MASK(15);
+  uint32_t hash = 2166136261U;
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<uint8_t>(hdrtoken_fold(string[i]));
+    hash *= 16777619U;
+  }
+  return hash;
 }
 
-inline uint32_t
-hdrtoken_hash(const unsigned char *string, unsigned int length)
+constexpr size_t
+hash_to_bucket(uint32_t hash)
 {
-  ATSHash32FNV1a fnv;
-  fnv.update(string, length, ATSHash::nocase());
-  fnv.final();
-  return fnv.get();
+  return hash & (HDRTOKEN_HASH_BUCKETS - 1);
 }
 
-/*-------------------------------------------------------------------------
-  -------------------------------------------------------------------------*/
+constexpr size_t
+hash_to_slot(uint32_t hash, uint16_t displacement)
+{
+  uint32_t x  = hash ^ (displacement * 0x9e3779b9U);
+  x          ^= x >> 16;
+  x          *= 0x85ebca6bU;
+  x          ^= x >> 13;
+  x          *= 0xc2b2ae35U;
+  x          ^= x >> 16;
+  return x & (HDRTOKEN_HASH_TABLE_SIZE - 1);
+}
 
-void
-hdrtoken_hash_init()
+constexpr HdrTokenHashTable
+hdrtoken_hash_table_build()
 {
-  uint32_t i;
-  int      num_collisions;
-
-  memset(hdrtoken_hash_table, 0, sizeof(hdrtoken_hash_table));
-  num_collisions = 0;
-
-  for (i = 0; i < static_cast<int> SIZEOF(_hdrtoken_strs); i++) {
-    // convert the common string to the well-known token
-    unsigned const char *wks;
-    int                  wks_idx =
-      hdrtoken_tokenize_dfa(_hdrtoken_strs[i], static_cast<int>(strlen(_hdrtoken_strs[i])), reinterpret_cast<const char **>(&wks));
-    ink_release_assert(wks_idx >= 0);
-
-    uint32_t hash = hdrtoken_hash(wks, hdrtoken_str_lengths[wks_idx]);
-    uint32_t slot = hash_to_slot(hash);
-
-    if (hdrtoken_hash_table[slot].wks) {
-      printf("ERROR: hdrtoken_hash_table[%u] collision: '%s' replacing '%s'\n", slot, reinterpret_cast<const char *>(wks),
-             hdrtoken_hash_table[slot].wks);
-      ++num_collisions;
+  constexpr size_t n = SIZEOF(_hdrtoken_strs);
+
+  HdrTokenHashTable                                                                 table;
+  std::array<uint32_t, n>                                                           hashes{};
+  std::array<std::array<uint16_t, HDRTOKEN_HASH_MAX_BUCKET>, HDRTOKEN_HASH_BUCKETS> members{};
+  std::array<size_t, HDRTOKEN_HASH_BUCKETS>                                         sizes{};
+
+  for (size_t i = 0; i < n; ++i) {
+    hashes[i]     = hdrtoken_hash(_hdrtoken_strs[i], std::string_view(_hdrtoken_strs[i]).size());
+    size_t bucket = hash_to_bucket(hashes[i]);
+    if (sizes[bucket] == HDRTOKEN_HASH_MAX_BUCKET) {
+      return table;
     }
-    hdrtoken_hash_table[slot].wks  = reinterpret_cast<const char *>(wks);
-    hdrtoken_hash_table[slot].hash = hash;
+    members[bucket][sizes[bucket]++] = i;
   }
 
-  if (num_collisions > 0) {
-    abort();
+  // Place the largest buckets first, while the table is still empty enough for them.
+  for (size_t size = HDRTOKEN_HASH_MAX_BUCKET; size > 0; --size) {
+    for (size_t bucket = 0; bucket < HDRTOKEN_HASH_BUCKETS; ++bucket) {
+      if (sizes[bucket] != size) {
+        continue;
+      }
+
+      bool placed = false;
+      for (uint32_t d = 0; d <= UINT16_MAX && !placed; ++d) {
+        std::array<size_t, HDRTOKEN_HASH_MAX_BUCKET> slots{};
+        placed = true;
+        for (size_t k = 0; k < size && placed; ++k) {
+          slots[k] = hash_to_slot(hashes[members[bucket][k]], d);
+          placed   = table.slots[slots[k]].wks_idx < 0;
+          for (size_t j = 0; j < k && placed; ++j) {
+            placed = slots[j] != slots[k];
+          }
+        }
+        if (placed) {
+          table.displacements[bucket] = d;
+          for (size_t k = 0; k < size; ++k) {
+            table.slots[slots[k]] = {hashes[members[bucket][k]], static_cast<int16_t>(members[bucket][k])};
+          }
+        }
+      }
+      if (!placed) {
+        return table;
+      }
+    }
   }
+
+  table.complete = true;
+  return table;
 }
 
+constexpr HdrTokenHashTable hdrtoken_hash_table = hdrtoken_hash_table_build();
+static_assert(hdrtoken_hash_table.complete, "The well known strings do not fit the perfect hash table, are there duplicates?");
+
+// ASCII case folding of 8 bytes at a time.
+inline uint64_t
+hdrtoken_fold8(uint64_t x)
+{
+  constexpr uint64_t ones    = 0x0101010101010101ULL;
+  uint64_t           heptets = x & (0x7f * ones);
+  uint64_t           ge_A    = heptets + (0x80 - 'A') * ones;
+  uint64_t           gt_Z    = heptets + (0x80 - 'Z' - 1) * ones;
+  uint64_t           upper   = ge_A & ~gt_Z & ~x & (0x80 * ones);
+  return x | (upper >> 2);
+}
+
+inline bool
+hdrtoken_equal_nocase(const char *a, const char *b, size_t length)
+{
+  uint64_t wa, wb;
+  for (; length >= 8; length -= 8, a += 8, b += 8) {
+    memcpy(&wa, a, 8);
+    memcpy(&wb, b, 8);
+    if (hdrtoken_fold8(wa) != hdrtoken_fold8(wb)) {
+      return false;
+    }
+  }
+  wa = wb = 0;
+  memcpy(&wa, a, length);
+  memcpy(&wb, b, length);
+  return hdrtoken_fold8(wa) == hdrtoken_fold8(wb);
+}
+
+} // end anonymous namespace
+
 /***********************************************************************
  *                                                                     *
  *                 M A I N    H D R T O K E N    C O D E               *
@@ -385,9 +471,6 @@ hdrtoken_init()
   if (!inited) {
     inited = 1;
 
-    hdrtoken_strs_dfa = new DFA;
-    hdrtoken_strs_dfa->compile(_hdrtoken_strs, SIZEOF(_hdrtoken_strs), (RE_CASE_INSENSITIVE));
-
     // all the tokenized hdrtoken strings are placed in a special heap,
     // and each string is prepended with a HdrTokenHeapPrefix ---
     // this makes it easy to tell that a string is a tokenized
@@ -438,8 +521,8 @@ hdrtoken_init()
       int                 wks_idx;
       HdrTokenHeapPrefix *prefix;
 
-      wks_idx = hdrtoken_tokenize_dfa(_hdrtoken_strs_type_initializers[i].name,
-                                      static_cast<int>(strlen(_hdrtoken_strs_type_initializers[i].name)));
+      wks_idx = hdrtoken_tokenize(_hdrtoken_strs_type_initializers[i].name,
+                                  static_cast<int>(strlen(_hdrtoken_strs_type_initializers[i].name)));
 
       ink_assert((wks_idx >= 0) && (wks_idx < (int)SIZEOF(hdrtoken_strs)));
       // coverity[negative_returns]
@@ -452,8 +535,8 @@ hdrtoken_init()
       int                 wks_idx;
       HdrTokenHeapPrefix *prefix;
 
-      wks_idx = hdrtoken_tokenize_dfa(_hdrtoken_strs_field_initializers[i].name,
-                                      static_cast<int>(strlen(_hdrtoken_strs_field_initializers[i].name)));
+      wks_idx = hdrtoken_tokenize(_hdrtoken_strs_field_initializers[i].name,
+                                  static_cast<int>(strlen(_hdrtoken_strs_field_initializers[i].name)));
 
       ink_assert((wks_idx >= 0) && (wks_idx < (int)SIZEOF(hdrtoken_strs)));
       prefix                  = hdrtoken_index_to_prefix(wks_idx);
@@ -470,8 +553,6 @@ hdrtoken_init()
       hdrtoken_str_masks[i]       = prefix->wks_info.mask;   // parallel array for speed
       hdrtoken_str_flags[i]       = prefix->wks_info.flags;  // parallel array for speed
     }
-
-    hdrtoken_hash_init();
   }
 }
 
@@ -481,9 +562,14 @@ hdrtoken_init()
 int
 hdrtoken_tokenize_dfa(const char *string, int string_len, const char **wks_string_out)
 {
-  int wks_idx;
+  // Only used to check the hash table, so it is compiled on first use rather than at startup.
+  static DFA *dfa = [] {
+    hdrtoken_strs_dfa = new DFA;
+    hdrtoken_strs_dfa->compile(_hdrtoken_strs, SIZEOF(_hdrtoken_strs), (RE_CASE_INSENSITIVE));
+    return hdrtoken_strs_dfa;
+  }();
 
-  wks_idx = hdrtoken_strs_dfa->match({string, static_cast<size_t>(string_len)});
+  int wks_idx = dfa->match({string, static_cast<size_t>(string_len)});
 
   if (wks_idx < 0) {
     wks_idx = -1;
@@ -530,8 +616,7 @@ hdrtoken_method_tokenize(const char *string, int string_len)
 int
 hdrtoken_tokenize(const char *string, int string_len, const char **wks_string_out)
 {
-  int                 wks_idx;
-  HdrTokenHashBucket *bucket;
+  int wks_idx;
 
   ink_assert(string != nullptr);
 
@@ -543,14 +628,15 @@ hdrtoken_tokenize(const char *string, int string_len, const char **wks_string_ou
     return wks_idx;
   }
 
-  uint32_t hash = hdrtoken_hash(reinterpret_cast<const unsigned char *>(string), static_cast<unsigned int>(string_len));
-  uint32_t slot = hash_to_slot(hash);
+  uint32_t                hash = hdrtoken_hash(string, string_len);
+  const HdrTokenHashSlot &slot =
+    hdrtoken_hash_table.slots[hash_to_slot(hash, hdrtoken_hash_table.displacements[hash_to_bucket(hash)])];
 
-  bucket = &(hdrtoken_hash_table[slot]);
-  if ((bucket->wks != nullptr) && (bucket->hash == hash) && (hdrtoken_wks_to_length(bucket->wks) == string_len)) {
-    wks_idx = hdrtoken_wks_to_index(bucket->wks);
+  if (slot.hash == hash && slot.wks_idx >= 0 && hdrtoken_str_lengths[slot.wks_idx] == string_len &&
+      hdrtoken_equal_nocase(hdrtoken_strs[slot.wks_idx], string, string_len)) {
+    wks_idx = slot.wks_idx;
     if (wks_string_out) {
-      *wks_string_out = bucket->wks;
+      *wks_string_out = hdrtoken_strs[wks_idx];
     }
     return wks_idx;
   }
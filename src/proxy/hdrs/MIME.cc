@@ -33,6 +33,7 @@
 #include <string_view>
 #include "proxy/hdrs/MIME.h"
 #include "proxy/hdrs/HdrHeap.h"
+#include "proxy/hdrs/HdrScan.h"
 #include "proxy/hdrs/HdrToken.h"
 #include "proxy/hdrs/HdrUtils.h"
 #include "proxy/hdrs/HttpCompat.h"
@@ -408,6 +409,18 @@ mime_hdr_presence_unset(MIMEHdrImpl *h, int well_known_str_index)
   mime_hdr_presence_unset(h, wks);
 }
 
+/// @return The bit for @a name in MIMEHdrImpl::m_name_filter.
+uint32_t
+mime_field_name_filter_mask(std::string_view name)
+{
+  // FNV-1a over the name with bit 5 set, names that are equal ignoring case always get the same bit.
+  uint32_t hash = 2166136261U;
+  for (char c : name) {
+    hash = (hash ^ static_cast<uint8_t>(c | 0x20)) * 16777619U;
+  }
+  return 1U << (hash >> 27);
+}
+
 /***********************************************************************
  *                                                                     *
  *                  S L O T    A C C E L E R A T O R S                 *
@@ -416,6 +429,7 @@ mime_hdr_presence_unset(MIMEHdrImpl *h, int well_known_str_index)
 inline void
 mime_hdr_init_accelerators_and_presence_bits(MIMEHdrImpl *mh)
 {
+  mh->m_name_filter          = 0;
   mh->m_presence_bits        = 0;
   mh->m_slot_accelerators[0] = 0xFFFFFFFF;
   mh->m_slot_accelerators[1] = 0xFFFFFFFF;
@@ -457,12 +471,16 @@ mime_hdr_set_accelerators_and_presence_bits(MIMEHdrImpl *mh, MIMEField *field)
 {
   int       slot_id;
   ptrdiff_t slot_num;
+
+  ink_assert(mh);
+
+  // Every name goes in the filter, a well known name can be looked up with a string that is not the well known string.
+  mh->m_name_filter |= mime_field_name_filter_mask({field->m_ptr_name, field->m_len_name});
+
   if (field->m_wks_idx < 0) {
     return;
   }
 
-  ink_assert(mh);
-
   mime_hdr_presence_set(mh, field->m_wks_idx);
 
   slot_id = hdrtoken_index_to_slotid(field->m_wks_idx);
@@ -641,6 +659,7 @@ mime_init()
     init = 0;
 
     hdrtoken_init();
+    hdr_scan_init();
 
     MIME_FIELD_ACCEPT                    = hdrtoken_string_to_wks_sv("Accept");
     MIME_FIELD_ACCEPT_CHARSET            = hdrtoken_string_to_wks_sv("Accept-Charset");
@@ -965,6 +984,7 @@ _mime_field_block_copy(MIMEFieldBlockImpl *s_fblock, HdrHeap * /* s_heap ATS_UNU
 
   d_fblock = (MIMEFieldBlockImpl *)d_heap->allocate_obj(sizeof(MIMEFieldBlockImpl), HdrHeapObjType::FIELD_BLOCK);
   memcpy(d_fblock, s_fblock, sizeof(MIMEFieldBlockImpl));
+  hdr_copy_stats.obj_bytes += sizeof(MIMEFieldBlockImpl);
   return d_fblock;
 }
 
@@ -1020,6 +1040,7 @@ mime_hdr_copy_onto(MIMEHdrImpl *s_mh, HdrHeap *s_heap, MIMEHdrImpl *d_mh, HdrHea
 
   // copies useful part of enclosed first block too
   memcpy(d_mh, s_mh, bytes_below_top);
+  hdr_copy_stats.obj_bytes += bytes_below_top;
 
   if (d_mh->m_first_fblock.m_next == nullptr) // common case: no other block
   {
@@ -1160,9 +1181,9 @@ _mime_hdr_field_list_search_by_string(MIMEHdrImpl *mh, std::string_view field_na
 
     too_far_field = &(fblock->m_field_slots[fblock->m_freetop]);
     while (field < too_far_field) {
-      if (field->is_live() &&
-          strcasecmp(std::string_view{field->m_ptr_name, static_cast<std::string_view::size_type>(field->m_len_name)},
-                     field_name) == 0) {
+      // Compare the lengths first, most fields are rejected without looking at the name.
+      if (field->m_len_name == field_name.size() && field->is_live() &&
+          strncasecmp(field->m_ptr_name, field_name.data(), field_name.size()) == 0) {
         return field;
       }
       ++field;
@@ -1262,6 +1283,14 @@ mime_hdr_field_find(MIMEHdrImpl *mh, std::string_view field_name)
 #endif
     return f;
   } else {
+    if ((mh->m_name_filter & mime_field_name_filter_mask(field_name)) == 0) {
+#if TRACK_FIELD_FIND_CALLS
+      Dbg(dbg_ctl_http, "mime_hdr_field_find(hdr 0x%X, field %.*s): MISS (due to name filter)", mh,
+          static_cast<int>(field_name.length()), field_name.data());
+#endif
+      return nullptr;
+    }
+
     MIMEField *f = _mime_hdr_field_list_search_by_string(mh, field_name);
 
     ink_assert((f == nullptr) || f->is_live());
@@ -2226,6 +2255,8 @@ MIMEScanner::get(TextView &input, TextView &output, bool &output_shares_input, b
   ParseResult zret = ParseResult::CONT;
   // Need this for handling dangling CR.
   static const char RAW_CR{ParseRules::CHAR_CR};
+  // Every byte that is not CR, LF or a folding space is looked at by the INSIDE scan, which also checks for NUL.
+  bool nul_seen = false;
 
   auto text = input;
   while (ParseResult::CONT == zret && !text.empty()) {
@@ -2262,9 +2293,9 @@ MIMEScanner::get(TextView &input, TextView &output, bool &output_shares_input, b
       }
       break;
     case MimeParseState::INSIDE: {
-      auto lf_off = text.find(ParseRules::CHAR_LF);
-      if (lf_off != TextView::npos) {
-        text.remove_prefix(lf_off + 1); // drop up to and including LF
+      auto lf = hdr_scan_find_lf(text.data(), text.data_end(), nul_seen);
+      if (lf != text.data_end()) {
+        text.remove_prefix(lf - text.data() + 1); // drop up to and including LF
         if (ScanType::LINE == scan_type) {
           zret    = ParseResult::OK;
           m_state = MimeParseState::BEFORE;
@@ -2351,7 +2382,7 @@ MIMEScanner::get(TextView &input, TextView &output, bool &output_shares_input, b
   }
 
   // Make sure there are no null characters in the input scanned so far
-  if (zret != ParseResult::ERROR && TextView::npos != parsed_text.find('\0')) {
+  if (zret != ParseResult::ERROR && nul_seen) {
     zret = ParseResult::ERROR;
   }
 
@@ -2486,20 +2517,14 @@ mime_parser_parse(MIMEParser *parser, HdrHeap *heap, MIMEHdrImpl *mh, const char
 
     int field_name_wks_idx = hdrtoken_tokenize(field_name.data(), field_name.size());
 
-    if (field_name_wks_idx < 0) {
-      for (auto i : field_name) {
-        if (!ParseRules::is_http_field_name(i)) {
-          return ParseResult::ERROR;
-        }
-      }
+    if (field_name_wks_idx < 0 && !hdr_scan_is_field_name(field_name.data(), field_name.data_end())) {
+      return ParseResult::ERROR;
     }
 
     // RFC 9110 Section 5.5. Field Values
-    for (char i : field_value) {
-      // FIXME: ParseRules::is_http_field_value() should be used but the implementation looks wrong
-      if (ParseRules::is_control(i)) {
-        return ParseResult::ERROR;
-      }
+    // FIXME: ParseRules::is_http_field_value() should be used but the implementation looks wrong
+    if (hdr_scan_has_control(field_value.data(), field_value.data_end())) {
+      return ParseResult::ERROR;
     }
 
     ///////////////////////////////////////////
@@ -3565,6 +3590,9 @@ MIMEFieldBlockImpl::marshal(MarshalXlate *ptr_xlate, int num_ptr, MarshalXlate *
         if (field->m_next_dup) {
           HDR_MARSHAL_PTR_1(field->m_next_dup, MIMEField, ptr_xlate);
         }
+      } else {
+        // Clear out other types of slots, their pointers are not marshalled
+        field->m_readiness = MIME_FIELD_SLOT_READINESS_EMPTY;
       }
     }
   } else {
@@ -3577,6 +3605,8 @@ MIMEFieldBlockImpl::marshal(MarshalXlate *ptr_xlate, int num_ptr, MarshalXlate *
         if (field->m_next_dup) {
           HDR_MARSHAL_PTR(field->m_next_dup, MIMEField, ptr_xlate, num_ptr);
         }
+      } else {
+        field->m_readiness = MIME_FIELD_SLOT_READINESS_EMPTY;
       }
     }
   }
@@ -3698,6 +3728,19 @@ MIMEHdrImpl::recompute_accelerators_and_presence_bits()
   mime_hdr_reset_accelerators_and_presence_bits(this);
 }
 
+void
+MIMEHdrImpl::recompute_name_filter()
+{
+  m_name_filter = 0;
+  for (MIMEFieldBlockImpl *fblock = &m_first_fblock; fblock != nullptr; fblock = fblock->m_next) {
+    for (MIMEField *field = fblock->m_field_slots, *limit = field + fblock->m_freetop; field < limit; ++field) {
+      if (field->is_live() && field->is_dup_head()) {
+        m_name_filter |= mime_field_name_filter_mask({field->m_ptr_name, field->m_len_name});
+      }
+    }
+  }
+}
+
 /***********************************************************************
  *                                                                     *
  *                 C O O K E D    V A L U E    C A C H E               *
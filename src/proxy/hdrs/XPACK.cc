@@ -263,7 +263,7 @@ XpackDynamicTable::lookup(uint32_t index, const char **name, size_t *name_len, c
     return {0, XpackLookupResult::MatchType::NONE};
   }
 
-  uint32_t pos = this->_calc_index(this->_entries_head, index - this->_entries[this->_entries_head].index);
+  uint32_t pos = this->_calc_index(this->_entries_head, static_cast<int64_t>(index) - this->_entries[this->_entries_head].index);
   *name_len    = this->_entries[pos].name_len;
   *value_len   = this->_entries[pos].value_len;
   this->_storage.read(this->_entries[pos].offset, name, *name_len, value, *value_len);
@@ -278,32 +278,26 @@ XpackDynamicTable::lookup(const char *name, size_t name_len, const char *value,
 {
   XPACKDbg("Lookup entry: name=%.*s, value=%.*s", static_cast<int>(name_len), name, static_cast<int>(value_len), value);
   XpackLookupResult::MatchType match_type      = XpackLookupResult::MatchType::NONE;
-  uint32_t                     i               = this->_calc_index(this->_entries_tail, 1);
-  uint32_t                     end             = this->_calc_index(this->_entries_head, 1);
   uint32_t                     candidate_index = 0;
-  const char                  *tmp_name        = nullptr;
-  const char                  *tmp_value       = nullptr;
 
   // DynamicTable is empty
-  if (this->is_empty()) {
+  if (this->is_empty() || name_len == 0) {
     return {candidate_index, match_type};
   }
 
-  for (; i != end; i = this->_calc_index(i, 1)) {
-    if (name_len != 0 && this->_entries[i].name_len == name_len) {
-      this->_storage.read(this->_entries[i].offset, &tmp_name, this->_entries[i].name_len, &tmp_value, this->_entries[i].value_len);
-      if (match(name, name_len, tmp_name, this->_entries[i].name_len)) {
-        candidate_index = this->_entries[i].index;
-        if (match(value, value_len, tmp_value, this->_entries[i].value_len)) {
-          // Exact match
-          match_type = XpackLookupResult::MatchType::EXACT;
-          break;
-        } else {
-          // Name match -- Keep it for no exact matches
-          match_type = XpackLookupResult::MatchType::NAME;
-        }
-      }
-    }
+  std::string_view n{name, name_len};
+  std::string_view v{value, value_len};
+
+  if (auto spot = this->_field_index.find(_hash_field(n, v));
+      spot != this->_field_index.end() && this->_entry_matches(spot->second, n, &v)) {
+    // Exact match
+    candidate_index = spot->second;
+    match_type      = XpackLookupResult::MatchType::EXACT;
+  } else if (auto spot = this->_name_index.find(_hash_name(n));
+             spot != this->_name_index.end() && this->_entry_matches(spot->second, n, nullptr)) {
+    // Name match -- the newest entry with the name
+    candidate_index = spot->second;
+    match_type      = XpackLookupResult::MatchType::NAME;
   }
 
   XPACKDbg("Lookup entry: candidate_index=%u, match_type=%u", candidate_index, static_cast<unsigned int>(match_type));
@@ -367,6 +361,7 @@ XpackDynamicTable::insert_entry(const char *name, size_t name_len, const char *v
     0,
     wks};
   this->_available -= required_size;
+  this->_index_entry(this->_entries_head);
 
   XPACKDbg("Insert Entry: entry=%u, index=%u, size=%zu", this->_entries_head, this->_entries_inserted - 1, name_len + value_len);
   XPACKDbg("Available size: %u", this->_available);
@@ -420,6 +415,7 @@ XpackDynamicTable::update_maximum_size(uint32_t new_max_size)
     this->_maximum_size = new_max_size;
     this->_available    = new_max_size - used;
     this->_expand_storage_size(new_max_size);
+    this->_expand_entries(new_max_size);
     return true;
   }
 
@@ -450,14 +446,14 @@ XpackDynamicTable::maximum_size() const
 void
 XpackDynamicTable::ref_entry(uint32_t index)
 {
-  uint32_t pos = this->_calc_index(this->_entries_head, (index - this->_entries[this->_entries_head].index));
+  uint32_t pos = this->_calc_index(this->_entries_head, static_cast<int64_t>(index) - this->_entries[this->_entries_head].index);
   ++this->_entries[pos].ref_count;
 }
 
 void
 XpackDynamicTable::unref_entry(uint32_t index)
 {
-  uint32_t pos = this->_calc_index(this->_entries_head, (index - this->_entries[this->_entries_head].index));
+  uint32_t pos = this->_calc_index(this->_entries_head, static_cast<int64_t>(index) - this->_entries[this->_entries_head].index);
   --this->_entries[pos].ref_count;
 }
 
@@ -475,6 +471,13 @@ XpackDynamicTable::largest_index() const
   return this->_entries_inserted - 1;
 }
 
+uint32_t
+XpackDynamicTable::insert_count() const
+{
+  // The total number of entries inserted, which is also the absolute index of the next entry.
+  return this->_entries_inserted;
+}
+
 uint32_t
 XpackDynamicTable::count() const
 {
@@ -510,18 +513,24 @@ XpackDynamicTable::_make_space(uint64_t extra_space_needed)
 
   // Check to see if we need more space and that we have entries to evict
   while (extra_space_needed > freed && this->_entries_head != tail) {
-    tail = this->_calc_index(tail, 1); // Move to the next entry
+    uint32_t next = this->_calc_index(tail, 1);
 
-    if (this->_entries[tail].ref_count) {
+    // An entry that is still referenced must stay, and so must everything newer than it.
+    if (this->_entries[next].ref_count) {
       break;
     }
+    tail   = next; // Move to the next entry
     freed += this->_entries[tail].name_len + this->_entries[tail].value_len + ADDITIONAL_32_BYTES;
   }
 
   // Evict
   if (freed > 0) {
+    for (uint32_t i = this->_entries_tail; i != tail;) {
+      i = this->_calc_index(i, 1);
+      this->_unindex_entry(i);
+    }
     XPACKDbg("Evict entries: from %u to %u", this->_entries[this->_calc_index(this->_entries_tail, 1)].index,
-             this->_entries[tail - 1].index);
+             this->_entries[tail].index);
     this->_available    += freed;
     this->_entries_tail  = tail;
 
@@ -537,8 +546,106 @@ XpackDynamicTable::_calc_index(uint32_t base, int64_t offset) const
   if (unlikely(this->_max_entries == 0)) {
     return base + offset;
   } else {
-    return (base + offset) % this->_max_entries;
+    int64_t pos = (static_cast<int64_t>(base) + offset) % this->_max_entries;
+    return pos < 0 ? pos + this->_max_entries : pos;
+  }
+}
+
+void
+XpackDynamicTable::_expand_entries(uint32_t new_max_entries)
+{
+  if (new_max_entries <= this->_max_entries) {
+    return;
+  }
+
+  auto *entries =
+    static_cast<struct XpackDynamicTableEntry *>(ats_malloc(sizeof(struct XpackDynamicTableEntry) * new_max_entries));
+  uint32_t n = 0;
+  if (!this->is_empty()) {
+    uint32_t i   = this->_calc_index(this->_entries_tail, 1);
+    uint32_t end = this->_calc_index(this->_entries_head, 1);
+    for (; i != end; i = this->_calc_index(i, 1)) {
+      entries[n++] = this->_entries[i];
+    }
+  }
+  ats_free(this->_entries);
+
+  // Entries now occupy [0, n) and the tail sits just before them.
+  this->_entries      = entries;
+  this->_max_entries  = new_max_entries;
+  this->_entries_tail = new_max_entries - 1;
+  this->_entries_head = n == 0 ? this->_entries_tail : n - 1;
+}
+
+uint64_t
+XpackDynamicTable::_hash_name(std::string_view name)
+{
+  return std::hash<std::string_view>{}(name);
+}
+
+uint64_t
+XpackDynamicTable::_hash_field(std::string_view name, std::string_view value)
+{
+  uint64_t h = _hash_name(name);
+  return h ^ (std::hash<std::string_view>{}(value) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+void
+XpackDynamicTable::_index_entry(uint32_t pos)
+{
+  const auto &entry = this->_entries[pos];
+  const char *name  = nullptr;
+  const char *value = nullptr;
+
+  if (entry.name_len == 0) {
+    return;
+  }
+  this->_storage.read(entry.offset, &name, entry.name_len, &value, entry.value_len);
+  std::string_view n{name, entry.name_len};
+  std::string_view v{value, entry.value_len};
+  this->_name_index[_hash_name(n)]      = entry.index;
+  this->_field_index[_hash_field(n, v)] = entry.index;
+}
+
+void
+XpackDynamicTable::_unindex_entry(uint32_t pos)
+{
+  const auto &entry = this->_entries[pos];
+  const char *name  = nullptr;
+  const char *value = nullptr;
+
+  if (entry.name_len == 0) {
+    return;
+  }
+  this->_storage.read(entry.offset, &name, entry.name_len, &value, entry.value_len);
+  std::string_view n{name, entry.name_len};
+  std::string_view v{value, entry.value_len};
+  if (auto spot = this->_name_index.find(_hash_name(n)); spot != this->_name_index.end() && spot->second == entry.index) {
+    this->_name_index.erase(spot);
+  }
+  if (auto spot = this->_field_index.find(_hash_field(n, v)); spot != this->_field_index.end() && spot->second == entry.index) {
+    this->_field_index.erase(spot);
+  }
+}
+
+bool
+XpackDynamicTable::_entry_matches(uint32_t absolute_index, std::string_view name, const std::string_view *value) const
+{
+  if (absolute_index > this->_entries[this->_entries_head].index ||
+      absolute_index < this->_entries[this->_calc_index(this->_entries_tail, 1)].index) {
+    return false;
+  }
+
+  uint32_t pos =
+    this->_calc_index(this->_entries_head, static_cast<int64_t>(absolute_index) - this->_entries[this->_entries_head].index);
+  const auto &entry     = this->_entries[pos];
+  const char  *tmp_name  = nullptr;
+  const char  *tmp_value = nullptr;
+  this->_storage.read(entry.offset, &tmp_name, entry.name_len, &tmp_value, entry.value_len);
+  if (!match(name.data(), name.length(), tmp_name, entry.name_len)) {
+    return false;
   }
+  return value == nullptr || match(value->data(), value->length(), tmp_value, entry.value_len);
 }
 
 //
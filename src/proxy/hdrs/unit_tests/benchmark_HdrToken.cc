@@ -0,0 +1,87 @@
+/** @file
+
+  Benchmark of well known string tokenization
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_session.hpp>
+
+#include <string_view>
+
+#include "proxy/hdrs/HdrToken.h"
+#include "proxy/hdrs/HTTP.h"
+
+extern int cmd_disable_pfreelist;
+
+namespace
+{
+// Field names of a typical browser request, as they arrive on the wire
+constexpr std::string_view known[] = {
+  "Host",   "User-Agent", "Accept",        "Accept-Encoding", "Accept-Language", "Cookie",
+  "Referer", "Connection", "Cache-Control", "If-None-Match",   "If-Modified-Since", "Content-Length",
+};
+
+constexpr std::string_view unknown[] = {
+  "Sec-Fetch-Dest", "Sec-Fetch-Mode", "Sec-Fetch-Site", "Sec-Ch-Ua", "X-Request-Id", "Priority", "Dnt", "Origin",
+};
+
+template <typename F>
+int
+tokenize_all(F &&tokenize)
+{
+  int sum = 0;
+  for (auto s : known) {
+    sum += tokenize(s.data(), static_cast<int>(s.size()));
+  }
+  for (auto s : unknown) {
+    sum += tokenize(s.data(), static_cast<int>(s.size()));
+  }
+  return sum;
+}
+} // namespace
+
+TEST_CASE("hdrtoken tokenize", "[hdrs][hdrtoken]")
+{
+  // Both agree before anything is timed.
+  REQUIRE(tokenize_all([](const char *s, int len) { return hdrtoken_tokenize(s, len); }) ==
+          tokenize_all([](const char *s, int len) { return hdrtoken_tokenize_dfa(s, len); }));
+
+  BENCHMARK("perfect hash")
+  {
+    return tokenize_all([](const char *s, int len) { return hdrtoken_tokenize(s, len); });
+  };
+
+  BENCHMARK("dfa")
+  {
+    return tokenize_all([](const char *s, int len) { return hdrtoken_tokenize_dfa(s, len); });
+  };
+}
+
+int
+main(int argc, char *argv[])
+{
+  cmd_disable_pfreelist = true;
+  http_init();
+
+  return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,109 @@
+/** @file
+
+  Benchmark of MIME field lookup in headers with many fields
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_session.hpp>
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "proxy/hdrs/MIME.h"
+
+using namespace std::literals;
+
+extern int cmd_disable_pfreelist;
+
+namespace
+{
+// A request with @a nfields custom fields on top of a typical browser set.
+struct Request {
+  MIMEHdr                  hdr;
+  std::vector<std::string> names;
+
+  explicit Request(int nfields)
+  {
+    hdr.create(nullptr);
+    hdr.value_set("Host"sv, "www.example.com"sv);
+    hdr.value_set("User-Agent"sv, "Mozilla/5.0 (X11; Linux x86_64)"sv);
+    hdr.value_set("Accept"sv, "*/*"sv);
+    hdr.value_set("Accept-Encoding"sv, "gzip, br"sv);
+    hdr.value_set("Cookie"sv, "session=8f14e45fceea167a"sv);
+    for (int i = 0; i < nfields; ++i) {
+      names.push_back("X-Request-Attribute-" + std::to_string(i));
+      hdr.value_set(names.back(), "value"sv);
+    }
+  }
+
+  ~Request() { hdr.destroy(); }
+};
+
+void
+print_memory(int nfields)
+{
+  Request req(nfields);
+  printf("%2d custom fields: %d bytes of heap objects\n", nfields, req.hdr.m_heap->obj_size());
+}
+} // namespace
+
+TEST_CASE("MIME field find", "[hdrs][mime]")
+{
+  for (int nfields : {8, 40}) {
+    Request req(nfields);
+
+    // Last one added is at the end of the field list.
+    std::string hit = req.names.back();
+    BENCHMARK(std::to_string(nfields) + " fields, custom hit")
+    {
+      return req.hdr.field_find(hit);
+    };
+
+    std::string miss = "X-Not-Present";
+    BENCHMARK(std::to_string(nfields) + " fields, custom miss")
+    {
+      return req.hdr.field_find(miss);
+    };
+
+    BENCHMARK(std::to_string(nfields) + " fields, well known miss")
+    {
+      return req.hdr.field_find(static_cast<std::string_view>(MIME_FIELD_AUTHORIZATION));
+    };
+  }
+}
+
+int
+main(int argc, char *argv[])
+{
+  cmd_disable_pfreelist = true;
+  mime_init();
+
+  printf("sizeof(MIMEHdrImpl) %zu, sizeof(MIMEFieldBlockImpl) %zu, sizeof(MIMEField) %zu\n", sizeof(MIMEHdrImpl),
+         sizeof(MIMEFieldBlockImpl), sizeof(MIMEField));
+  print_memory(8);
+  print_memory(40);
+
+  return Catch::Session().run(argc, argv);
+}
@@ -18,9 +18,14 @@
    the License.
  */
 
+#include <memory>
+#include <string>
+#include <string_view>
+
 #include <catch2/catch_test_macros.hpp>
 
 #include "proxy/hdrs/HdrHeap.h"
+#include "proxy/hdrs/HTTP.h"
 #include "proxy/hdrs/URL.h"
 
 /**
@@ -130,3 +135,137 @@ TEST_CASE("HdrHeap", "[proxy][hdrheap]")
   // Clean up
   heap->destroy();
 }
+
+namespace
+{
+// Stands in for the cache block that owns a marshalled header.
+struct PinnedRefCountObj : public RefCountObj {
+  void
+  free() override
+  {
+  }
+};
+
+std::string
+print_hdr(HTTPHdr &hdr)
+{
+  char buf[4096];
+  int  bufindex   = 0;
+  int  dumpoffset = 0;
+  hdr.print(buf, sizeof(buf), &bufindex, &dumpoffset);
+  return {buf, static_cast<size_t>(bufindex)};
+}
+} // namespace
+
+TEST_CASE("HdrHeap copy of a marshalled header", "[proxy][hdrheap]")
+{
+  // Enough fields to need more than the field block embedded in the MIME header.
+  std::string response = "HTTP/1.1 200 OK\r\n";
+  for (int i = 0; i < 40; ++i) {
+    response += "X-Field-" + std::to_string(i) + ": value-" + std::to_string(i) + "\r\n";
+  }
+  response += "\r\n";
+
+  HTTPParser parser;
+  http_parser_init(&parser);
+  HTTPHdr hdr;
+  hdr.create(HTTPType::RESPONSE);
+  const char *start = response.data();
+  REQUIRE(hdr.parse_resp(&parser, &start, response.data() + response.size(), true) == ParseResult::DONE);
+  http_parser_clear(&parser);
+
+  // Marshal and unmarshal the way the cache does, leaving a read-only heap.
+  int                     marshal_len = hdr.m_heap->marshal_length();
+  std::unique_ptr<char[]> marshal_buf(new char[marshal_len]);
+  PinnedRefCountObj       ref;
+  ref.refcount_inc();
+  REQUIRE(hdr.m_heap->marshal(marshal_buf.get(), marshal_len) > 0);
+  HTTPHdr cached;
+  REQUIRE(cached.unmarshal(marshal_buf.get(), marshal_len, &ref) > 0);
+  REQUIRE(!cached.m_heap->m_writeable);
+
+  HdrCopyStats before = hdr_copy_stats;
+  HTTPHdr      copy;
+  copy.copy(&cached);
+
+  // The objects are copied and the strings are shared with the cached heap.
+  CHECK(hdr_copy_stats.obj_bytes - before.obj_bytes > 0);
+  CHECK(hdr_copy_stats.obj_bytes - before.obj_bytes <= static_cast<uint64_t>(cached.m_heap->obj_size()));
+  CHECK(hdr_copy_stats.str_bytes == before.str_bytes);
+  CHECK(hdr_copy_stats.shared_bytes - before.shared_bytes >= static_cast<uint64_t>(cached.m_heap->m_ronly_heap[0].m_heap_len));
+  CHECK(copy.m_heap->m_read_write_heap.get() == nullptr);
+  CHECK(print_hdr(copy) == print_hdr(hdr));
+
+  // Changes go to the copy's own string heap and leave the cached header alone.
+  std::string cached_print = print_hdr(cached);
+  before                   = hdr_copy_stats;
+  copy.value_set_int(static_cast<std::string_view>(MIME_FIELD_AGE), 42);
+  copy.field_delete(std::string_view{"X-Field-0"});
+  CHECK(hdr_copy_stats.str_bytes > before.str_bytes);
+  CHECK(copy.m_heap->m_read_write_heap.get() != nullptr);
+  CHECK(print_hdr(cached) == cached_print);
+  CHECK(print_hdr(copy) != cached_print);
+
+  copy.destroy();
+  hdr.destroy();
+}
+
+TEST_CASE("HdrHeap marshal formats", "[proxy][hdrheap]")
+{
+  std::string request = "GET http://www.example.com:8080/path/to/it?q=1 HTTP/1.1\r\n"
+                        "Host: www.example.com\r\n";
+  for (int i = 0; i < 40; ++i) {
+    request += "X-Field-" + std::to_string(i % 10) + ": value-" + std::to_string(i) + "\r\n";
+  }
+  request += "\r\n";
+
+  HTTPParser parser;
+  http_parser_init(&parser);
+  HTTPHdr hdr;
+  hdr.create(HTTPType::REQUEST);
+  const char *start = request.data();
+  REQUIRE(hdr.parse_req(&parser, &start, request.data() + request.size(), true) == ParseResult::DONE);
+  http_parser_clear(&parser);
+  // Leave a deleted slot and a duplicate chain in the field blocks.
+  hdr.field_delete(std::string_view{"Host"});
+  std::string expected = print_hdr(hdr);
+  // The name filter is rebuilt on unmarshal, a header written by an older version has whatever was in the padding.
+  hdr.m_mime->m_name_filter = 0;
+
+  int                     marshal_len = hdr.m_heap->marshal_length();
+  std::unique_ptr<char[]> v2_buf(new char[marshal_len]);
+  int                     used = hdr.m_heap->marshal(v2_buf.get(), marshal_len);
+  REQUIRE(used > 0);
+  REQUIRE(used <= marshal_len);
+
+  HdrHeap *v2_heap = reinterpret_cast<HdrHeap *>(v2_buf.get());
+  CHECK(v2_heap->m_magic == HdrBufMagic::MARSHALED_V2);
+  CHECK(v2_heap->unmarshal_size() == used);
+  CHECK(v2_heap->check_marshalled(used));
+
+  // The legacy format is the same without the relocation bitmap, each object swizzles its own pointers.
+  std::unique_ptr<char[]> legacy_buf(new char[used]);
+  memcpy(legacy_buf.get(), v2_buf.get(), used);
+  HdrHeap *legacy_heap = reinterpret_cast<HdrHeap *>(legacy_buf.get());
+  legacy_heap->m_magic = HdrBufMagic::MARSHALED;
+  CHECK(legacy_heap->check_marshalled(used));
+
+  PinnedRefCountObj ref;
+  ref.refcount_inc();
+  HTTPHdr v2;
+  HTTPHdr legacy;
+  CHECK(v2.unmarshal(v2_buf.get(), used, &ref) == used);
+  CHECK(legacy.unmarshal(legacy_buf.get(), used, &ref) > 0);
+  CHECK(print_hdr(v2) == expected);
+  CHECK(print_hdr(legacy) == expected);
+  CHECK(v2.url_get()->host_get() == "www.example.com");
+  CHECK(v2.value_get(std::string_view{"X-Field-3"}) == "value-3");
+  CHECK(legacy.value_get(std::string_view{"X-Field-3"}) == "value-3");
+
+  // Truncated buffers are rejected before anything is touched.
+  std::unique_ptr<char[]> short_buf(new char[used]);
+  memcpy(short_buf.get(), v2_buf.get(), used);
+  CHECK(!reinterpret_cast<HdrHeap *>(short_buf.get())->check_marshalled(used - sizeof(uint64_t)));
+
+  hdr.destroy();
+}
@@ -0,0 +1,164 @@
+/** @file
+
+  Unit tests for HdrScan
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "tscore/ParseRules.h"
+#include "proxy/hdrs/HdrScan.h"
+#include "proxy/hdrs/HTTP.h"
+
+namespace
+{
+std::vector<HdrScanMode>
+supported_modes()
+{
+  std::vector<HdrScanMode> modes;
+  for (auto mode : {HdrScanMode::SCALAR, HdrScanMode::SSE42, HdrScanMode::AVX2}) {
+    if (hdr_scan_init(mode)) {
+      modes.push_back(mode);
+    }
+  }
+  hdr_scan_init();
+  return modes;
+}
+
+// Parse @a msg and print the result so that it can be compared across modes.
+std::string
+parse_and_print(const std::string &msg)
+{
+  HTTPParser parser;
+  http_parser_init(&parser);
+
+  HTTPHdr  req_hdr;
+  HdrHeap *heap = new_HdrHeap(HdrHeap::DEFAULT_SIZE + 64);
+  req_hdr.create(HTTPType::REQUEST, HTTP_1_1, heap);
+
+  const char *start = msg.data();
+  ParseResult ret   = req_hdr.parse_req(&parser, &start, msg.data() + msg.size(), true);
+
+  std::string out = std::to_string(static_cast<int>(ret)) + " " + std::to_string(start - msg.data()) + "\n";
+  if (ret == ParseResult::DONE) {
+    char buf[4096];
+    int  bufindex   = 0;
+    int  dumpoffset = 0;
+    req_hdr.print(buf, sizeof(buf), &bufindex, &dumpoffset);
+    out.append(buf, bufindex);
+  }
+
+  req_hdr.destroy();
+  http_parser_clear(&parser);
+  return out;
+}
+} // namespace
+
+TEST_CASE("HdrScan character classes", "[proxy][hdrscan]")
+{
+  for (auto mode : supported_modes()) {
+    CAPTURE(hdr_scan_mode_name(mode));
+    REQUIRE(hdr_scan_init(mode));
+
+    // Put every byte value at every position of buffers that cover the vector widths and the scalar tails.
+    for (size_t len = 1; len <= 70; ++len) {
+      for (size_t pos = 0; pos < len; ++pos) {
+        for (int c = 0; c < 256; ++c) {
+          std::string buf(len, 'a');
+          buf[pos]      = static_cast<char>(c);
+          const char *s = buf.data();
+          const char *e = s + len;
+
+          bool        nul_seen = false;
+          const char *lf       = hdr_scan_find_lf(s, e, nul_seen);
+          bool        ok       = lf == (c == ParseRules::CHAR_LF ? s + pos : e) && nul_seen == (c == 0) &&
+                    hdr_scan_has_control(s, e) == static_cast<bool>(ParseRules::is_control(c)) &&
+                    hdr_scan_is_field_name(s, e) == static_cast<bool>(ParseRules::is_http_field_name(c));
+          if (!ok) {
+            CAPTURE(len, pos, c);
+            REQUIRE(ok);
+          }
+        }
+      }
+    }
+
+    // A NUL after the LF is not part of the line.
+    std::string line(40, 'a');
+    line[33]      = '\n';
+    line[35]      = '\0';
+    bool nul_seen = false;
+    REQUIRE(hdr_scan_find_lf(line.data(), line.data() + line.size(), nul_seen) == line.data() + 33);
+    REQUIRE(!nul_seen);
+  }
+
+  hdr_scan_init();
+}
+
+TEST_CASE("HdrScan parse results", "[proxy][hdrscan]")
+{
+  std::string long_value(200, 'v');
+  // clang-format off
+  std::vector<std::string> messages = {
+    "GET http://www.news.com:80/ HTTP/1.0\r\n"
+    "Proxy-Connection: Keep-Alive\r\n"
+    "User-Agent: Mozilla/4.04 [en] (X11; I; Linux 2.0.33 i586)\r\n"
+    "Pragma: no-cache\r\n"
+    "Host: www.news.com\r\n"
+    "Accept: image/gif, image/x-xbitmap, image/jpeg, image/pjpeg, image/png, */*\r\n"
+    "Accept-Language: en\r\n"
+    "Accept-Charset: iso-8859-1, *, utf-8\r\n"
+    "Cookie: u_vid_0_0=00031ba3; s_cur_0_0=0101sisi091314775496e7d3Jx4+POyJakrMybmNOsq6XOn5bVn5Z6a4Ln5crU5M7Rxq2lm5aWpqupo20=\r\n"
+    "X-Custom-Header-With-A-Long-Name: " + long_value + "\r\n"
+    "\r\n",
+    "GET / HTTP/1.1\r\nHost: example.com\r\nX-Folded: first\r\n second\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: example.com\r\nX-Ctl: abc\x01" + long_value + "\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: example.com\r\nX-Nul: " + long_value + std::string(1, '\0') + "\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: example.com\r\nX-Bad-Name-" + long_value + "\x7f: 1\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: example.com\r\nX-Tab: a\tb\r\n\r\n",
+    "GET / HTTP/1.1\nHost: example.com\nX-Lf-Only: " + long_value + "\n\n",
+    "POST /upload HTTP/1.1\r\nHost: example.com\r\nContent-Length: 10\r\n",
+  };
+  // clang-format on
+
+  std::vector<std::string> expected;
+  REQUIRE(hdr_scan_init(HdrScanMode::SCALAR));
+  for (auto const &msg : messages) {
+    expected.push_back(parse_and_print(msg));
+  }
+  auto error = std::to_string(static_cast<int>(ParseResult::ERROR)) + " ";
+  CHECK(expected[0].starts_with(std::to_string(static_cast<int>(ParseResult::DONE)) + " "));
+  CHECK(expected[2].starts_with(error));
+  CHECK(expected[3].starts_with(error));
+  CHECK(expected[4].starts_with(error));
+
+  for (auto mode : supported_modes()) {
+    CAPTURE(hdr_scan_mode_name(mode));
+    REQUIRE(hdr_scan_init(mode));
+    for (size_t i = 0; i < messages.size(); ++i) {
+      CAPTURE(i);
+      CHECK(parse_and_print(messages[i]) == expected[i]);
+    }
+  }
+
+  hdr_scan_init();
+}
@@ -0,0 +1,87 @@
+/** @file
+
+  Unit tests for HdrToken
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <cctype>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "proxy/hdrs/HdrToken.h"
+#include "proxy/hdrs/MIME.h"
+
+TEST_CASE("hdrtoken_tokenize", "[proxy][hdrtoken]")
+{
+  hdrtoken_init();
+
+  SECTION("every well known string")
+  {
+    for (int i = 0; i < hdrtoken_num_wks; ++i) {
+      std::string wks{hdrtoken_index_to_wks(i)};
+      CAPTURE(wks);
+
+      const char *out = nullptr;
+      CHECK(hdrtoken_tokenize(wks.data(), wks.size(), &out) == i);
+      CHECK(out == hdrtoken_index_to_wks(i));
+      CHECK(hdrtoken_tokenize_dfa(wks.data(), wks.size()) == i);
+
+      std::string upper = wks;
+      std::string lower = wks;
+      for (auto &c : upper) {
+        c = toupper(c);
+      }
+      for (auto &c : lower) {
+        c = tolower(c);
+      }
+      CHECK(hdrtoken_tokenize(upper.data(), upper.size()) == i);
+      CHECK(hdrtoken_tokenize(lower.data(), lower.size()) == i);
+
+      // Same length, one byte off
+      std::string changed  = wks;
+      changed.back()      ^= 0x01;
+      CHECK(hdrtoken_tokenize(changed.data(), changed.size()) != i);
+
+      // Prefix and extension
+      CHECK(hdrtoken_tokenize(wks.data(), wks.size() - 1) != i);
+      std::string longer = wks + "x";
+      CHECK(hdrtoken_tokenize(longer.data(), longer.size()) != i);
+    }
+  }
+
+  SECTION("unknown strings")
+  {
+    for (const char *s : {"", "X-Request-Id", "Sec-Fetch-Mode", "Content-Lengt", "Content_Length", "Accept-Ranges-",
+                          "Content-Length\x01", "@ats-internal2"}) {
+      CAPTURE(s);
+      CHECK(hdrtoken_tokenize(s, strlen(s)) == -1);
+    }
+  }
+
+  SECTION("well known field names")
+  {
+    const char *out = nullptr;
+    int         idx = hdrtoken_tokenize("content-length", 14, &out);
+    REQUIRE(idx >= 0);
+    CHECK(out == MIME_FIELD_CONTENT_LENGTH.c_str());
+    CHECK(hdrtoken_index_to_slotid(idx) == MIME_SLOTID_CONTENT_LENGTH);
+  }
+}
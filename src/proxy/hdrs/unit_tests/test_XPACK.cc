@@ -389,6 +389,67 @@ TEST_CASE("XPACK_String", "[xpack]")
       dt.insert_entry(name, value);
     }
   }
+
+  SECTION("Dynamic Table Lookup By Name And Value")
+  {
+    XpackDynamicTable dt(128);
+    XpackLookupResult result;
+
+    dt.insert_entry("name1", "value1");
+    dt.insert_entry("name2", "value2");
+
+    result = dt.lookup("name1", "value1");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::EXACT);
+    REQUIRE(result.index == 0);
+    result = dt.lookup("name2", "value2");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::EXACT);
+    REQUIRE(result.index == 1);
+    result = dt.lookup("name1", "other");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::NAME);
+    REQUIRE(result.index == 0);
+    result = dt.lookup("name3", "value1");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::NONE);
+    result = dt.lookup_relative("name1", "value1");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::EXACT);
+    REQUIRE(result.index == 1);
+
+    // The newest entry with a name is the name match. This evicts name1.
+    dt.insert_entry("name2", "value3");
+    result = dt.lookup("name2", "other");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::NAME);
+    REQUIRE(result.index == 2);
+    result = dt.lookup("name2", "value2");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::EXACT);
+    REQUIRE(result.index == 1);
+
+    // Evicted entries are no longer found.
+    result = dt.lookup("name1", "value1");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::NONE);
+
+    // A referenced entry is not evicted, so the insert fails and lookups are unchanged.
+    dt.ref_entry(1);
+    result = dt.insert_entry("name4", "value4");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::NONE);
+    result = dt.lookup("name2", "value2");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::EXACT);
+    REQUIRE(result.index == 1);
+    dt.unref_entry(1);
+
+    // Grow the table past the number of entries it was created with.
+    dt.update_maximum_size(16384);
+    for (int i = 0; i < 200; ++i) {
+      std::string name = "n" + std::to_string(i);
+      dt.insert_entry(name, "v");
+    }
+    REQUIRE(dt.count() == 202);
+    REQUIRE(dt.insert_count() == 203);
+    result = dt.lookup("name2", "value2");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::EXACT);
+    REQUIRE(result.index == 1);
+    result = dt.lookup("n199", "v");
+    REQUIRE(result.match_type == XpackLookupResult::MatchType::EXACT);
+    REQUIRE(result.index == dt.largest_index());
+  }
 }
 
 // Return a 110 character string.
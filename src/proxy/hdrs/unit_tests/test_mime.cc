@@ -23,7 +23,9 @@
 
 #include <cstdio>
 
+#include <string>
 #include <string_view>
+#include <vector>
 
 using namespace std::literals;
 
@@ -69,6 +71,56 @@ TEST_CASE("Mime", "[proxy][mime]")
   hdr.destroy();
 }
 
+TEST_CASE("MimeFieldFind", "[proxy][mime]")
+{
+  MIMEHdr hdr;
+  hdr.create(NULL);
+
+  // Enough fields to need several field blocks, with names that share a prefix and a length.
+  std::vector<std::string> names;
+  for (int i = 0; i < 48; ++i) {
+    names.push_back("X-Custom-" + std::to_string(100 + i));
+    hdr.value_set(names.back(), "v"sv);
+  }
+  hdr.value_set("Content-Type"sv, "text/plain"sv);
+
+  for (auto const &name : names) {
+    std::string lower = name;
+    for (char &c : lower) {
+      c = ParseRules::ink_tolower(c);
+    }
+    REQUIRE(hdr.field_find(name) != nullptr);
+    CHECK(hdr.field_find(lower) == hdr.field_find(name));
+  }
+  CHECK(hdr.field_find("X-Custom-99"sv) == nullptr);
+  CHECK(hdr.field_find("X-Custom-1000"sv) == nullptr);
+  CHECK(hdr.field_find("X-Missing"sv) == nullptr);
+
+  // A well known name can be looked up with a string that is not the well known string.
+  std::string content_type = "content-type";
+  REQUIRE(hdr.field_find(content_type) != nullptr);
+  CHECK(hdr.field_find(content_type)->value_get() == "text/plain");
+
+  // Deleted and renamed fields.
+  hdr.field_delete("X-Custom-120"sv);
+  CHECK(hdr.field_find("X-Custom-120"sv) == nullptr);
+  MIMEField *field = hdr.field_find("X-Custom-121"sv);
+  REQUIRE(field != nullptr);
+  hdr.field_detach(field);
+  field->name_set(hdr.m_heap, hdr.m_mime, "X-Renamed"sv);
+  hdr.field_attach(field);
+  CHECK(hdr.field_find("X-Custom-121"sv) == nullptr);
+  CHECK(hdr.field_find("x-renamed"sv) == field);
+
+  // Recomputing, as is done for objects read from an older cache, gives the same filter.
+  uint32_t filter = hdr.m_mime->m_name_filter;
+  hdr.m_mime->recompute_accelerators_and_presence_bits();
+  CHECK((hdr.m_mime->m_name_filter & ~filter) == 0);
+  CHECK(hdr.field_find("x-renamed"sv) == field);
+
+  hdr.destroy();
+}
+
 TEST_CASE("MimeGetHostPortValues", "[proxy][mimeport]")
 {
   MIMEHdr hdr;
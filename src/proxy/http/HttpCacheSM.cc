@@ -22,6 +22,7 @@
  */
 
 #include "proxy/http/HttpCacheSM.h"
+#include "proxy/http/CollapsedForwardingTable.h"
 #include "iocore/eventsystem/Thread.h"
 #include "proxy/http/HttpSM.h"
 #include "proxy/http/HttpDebugNames.h"
@@ -43,6 +44,9 @@
 namespace
 {
 DbgCtl dbg_ctl_http_cache{"http_cache"};
+
+// Collapsed forwarding, the transactions waiting on the cache writes of other transactions
+CollapsedForwardingTable<HttpCacheSM> collapsed_table;
 } // end anonymous namespace
 
 ////
@@ -83,6 +87,99 @@ HttpCacheSM::cancel_pending_action()
     _read_retry_event->cancel();
     _read_retry_event = nullptr;
   }
+
+  _collapse_leave(nullptr);
+  collapse_release();
+}
+
+void
+HttpCacheSM::_collapse_lead()
+{
+  if (_collapse_leader || master_sm->t_state.http_config_param->collapsed_forwarding_max_waiters <= 0) {
+    return;
+  }
+
+  if (collapsed_table.lead(cache_key.hash, this)) {
+    _collapse_leader = true;
+    _collapse_key    = cache_key.hash;
+    Metrics::Counter::increment(http_rsb.cache_collapsed_leaders);
+  }
+}
+
+void
+HttpCacheSM::collapse_release()
+{
+  if (!_collapse_leader) {
+    return;
+  }
+  _collapse_leader = false;
+
+  size_t n = collapsed_table.release(_collapse_key, this, [](HttpCacheSM *waiter) {
+    waiter->_collapse_event = waiter->_collapse_thread->schedule_imm(waiter, EVENT_INTERVAL);
+  });
+  if (n > 0) {
+    Dbg(dbg_ctl_http_cache, "[%" PRId64 "] [collapse_release] waking %zu waiters", master_sm->sm_id, n);
+    Metrics::Counter::increment(http_rsb.cache_collapsed_wakeups, n);
+  }
+}
+
+/**
+  Wait on the leader of the write of our object instead of polling the cache.
+
+  @return @c false if there is no leader or it already has the maximum number of waiters.
+ */
+bool
+HttpCacheSM::_collapse_wait()
+{
+  MgmtInt const max_waiters = master_sm->t_state.http_config_param->collapsed_forwarding_max_waiters;
+  if (max_waiters <= 0) {
+    return false;
+  }
+
+  auto result = collapsed_table.wait(cache_key.hash, this, max_waiters, [this](HttpCacheSM *leader) {
+    _collapse_thread = this_ethread();
+    Dbg(dbg_ctl_http_cache, "[%" PRId64 "] [collapse_wait] waiting on sm %" PRId64, master_sm->sm_id, leader->master_sm->sm_id);
+  });
+  switch (result) {
+  case CollapsedForwardingTable<HttpCacheSM>::Wait::WAITING:
+    Metrics::Counter::increment(http_rsb.cache_collapsed_waits);
+    return true;
+  case CollapsedForwardingTable<HttpCacheSM>::Wait::FULL:
+    Metrics::Counter::increment(http_rsb.cache_collapsed_overflows);
+    break;
+  case CollapsedForwardingTable<HttpCacheSM>::Wait::NO_LEADER:
+    break;
+  }
+  return false;
+}
+
+/**
+  Stop waiting on the leader. @a e is the event that called us back, either the wake up from the leader or the timeout, or
+  @c nullptr if the wait is abandoned.
+ */
+void
+HttpCacheSM::_collapse_leave(Event *e)
+{
+  if (_collapse_thread == nullptr) {
+    return;
+  }
+
+  collapsed_table.leave(cache_key.hash, this, [this, e](bool waiting) {
+    if (waiting) {
+      if (e != nullptr) {
+        Metrics::Counter::increment(http_rsb.cache_collapsed_timeouts);
+      }
+    } else if (_collapse_event != nullptr && _collapse_event != e) {
+      _collapse_event->cancel(this);
+    } else if (e != nullptr && _collapse_event == e && _read_retry_event != nullptr) {
+      // Woken up by the leader, the timeout is not needed
+      _read_retry_event->cancel();
+      _read_retry_event = nullptr;
+    }
+
+    _collapse_event  = nullptr;
+    _collapse_thread = nullptr;
+  });
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -161,6 +258,7 @@ HttpCacheSM::state_cache_open_read(int event, void *data)
     if (_read_retry_event == static_cast<Event *>(data)) {
       _read_retry_event = nullptr;
     }
+    _collapse_leave(static_cast<Event *>(data));
 
     // Retry the cache open read if the number retries is less
     // than or equal to the max number of open read retries,
@@ -211,6 +309,7 @@ HttpCacheSM::state_cache_open_write(int event, void *data)
     Metrics::Gauge::increment(http_rsb.current_cache_connections);
     ink_assert(cache_write_vc == nullptr);
     cache_write_vc = static_cast<CacheVConnection *>(data);
+    _collapse_lead();
     master_sm->handleEvent(event, &captive_action);
     break;
 
@@ -263,6 +362,7 @@ HttpCacheSM::state_cache_open_write(int event, void *data)
     if (_read_retry_event == static_cast<Event *>(data)) {
       _read_retry_event = nullptr;
     }
+    _collapse_leave(static_cast<Event *>(data));
 
     if (master_sm->t_state.txn_conf->cache_open_write_fail_action ==
         static_cast<MgmtByte>(CacheOpenWriteFailAction_t::READ_RETRY)) {
@@ -298,6 +398,9 @@ HttpCacheSM::state_cache_open_write(int event, void *data)
 /**
   Schedule a read retry event to this HttpCacheSM continuation with cache_open_read_retry_time delay.
   The scheduled event is tracked by `_read_retry_event`.
+
+  If another transaction is writing the object and collapsed forwarding is enabled, wait on that transaction instead. The
+  retry event is then only a timeout, with collapsed_forwarding_timeout delay.
  */
 void
 HttpCacheSM::_schedule_read_retry()
@@ -307,9 +410,15 @@ HttpCacheSM::_schedule_read_retry()
   if (_read_retry_event != nullptr && _read_retry_event->cancelled == false) {
     _read_retry_event->cancel();
   }
+  _read_retry_event = nullptr;
+  _collapse_leave(nullptr);
+
+  MgmtInt delay = master_sm->t_state.txn_conf->cache_open_read_retry_time;
+  if (_collapse_wait()) {
+    delay = master_sm->t_state.http_config_param->collapsed_forwarding_timeout;
+  }
 
-  _read_retry_event =
-    mutex->thread_holding->schedule_in(this, HRTIME_MSECONDS(master_sm->t_state.txn_conf->cache_open_read_retry_time));
+  _read_retry_event = mutex->thread_holding->schedule_in(this, HRTIME_MSECONDS(delay));
 
   return;
 }
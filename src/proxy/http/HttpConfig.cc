@@ -37,6 +37,7 @@
 #include "../../records/P_RecUtils.h"
 #include "records/RecHttp.h"
 #include "proxy/http/HttpSessionManager.h"
+#include "proxy/http/HttpStateTrace.h"
 
 #define HttpEstablishStaticConfigStringAlloc(_ix, _n) \
   RecEstablishStaticConfigString(_ix, _n);            \
@@ -273,8 +274,16 @@ register_stat_callbacks()
   http_rsb.background_fill_current_count     = Metrics::Gauge::createPtr("proxy.process.http.background_fill_current_count");
   http_rsb.background_fill_total_count       = Metrics::Counter::createPtr("proxy.process.http.background_fill_total_count");
   http_rsb.broken_server_connections         = Metrics::Counter::createPtr("proxy.process.http.broken_server_connections");
+  http_rsb.cache_collapsed_leaders           = Metrics::Counter::createPtr("proxy.process.http.cache_collapsed_leaders");
+  http_rsb.cache_collapsed_overflows         = Metrics::Counter::createPtr("proxy.process.http.cache_collapsed_overflows");
+  http_rsb.cache_collapsed_timeouts          = Metrics::Counter::createPtr("proxy.process.http.cache_collapsed_timeouts");
+  http_rsb.cache_collapsed_waits             = Metrics::Counter::createPtr("proxy.process.http.cache_collapsed_waits");
+  http_rsb.cache_collapsed_wakeups           = Metrics::Counter::createPtr("proxy.process.http.cache_collapsed_wakeups");
   http_rsb.cache_deletes                     = Metrics::Counter::createPtr("proxy.process.http.cache_deletes");
   http_rsb.cache_hit_fresh                   = Metrics::Counter::createPtr("proxy.process.http.cache_hit_fresh");
+  http_rsb.cache_hit_fresh_fast_path         = Metrics::Counter::createPtr("proxy.process.http.cache_hit_fresh_fast_path");
+  http_rsb.cache_hit_hdr_copied_bytes        = Metrics::Counter::createPtr("proxy.process.http.cache_hit_hdr_copied_bytes");
+  http_rsb.cache_hit_hdr_shared_bytes        = Metrics::Counter::createPtr("proxy.process.http.cache_hit_hdr_shared_bytes");
   http_rsb.cache_hit_ims                     = Metrics::Counter::createPtr("proxy.process.http.cache_hit_ims");
   http_rsb.cache_hit_mem_fresh               = Metrics::Counter::createPtr("proxy.process.http.cache_hit_mem_fresh");
   http_rsb.cache_hit_reval                   = Metrics::Counter::createPtr("proxy.process.http.cache_hit_revalidated");
@@ -497,6 +506,10 @@ register_stat_callbacks()
   http_rsb.total_transactions_time           = Metrics::Counter::createPtr("proxy.process.http.total_transactions_time");
   http_rsb.total_x_redirect                  = Metrics::Counter::createPtr("proxy.process.http.total_x_redirect_count");
   http_rsb.trace_requests                    = Metrics::Counter::createPtr("proxy.process.http.trace_requests");
+  http_rsb.transaction_allocator_allocations =
+    Metrics::Counter::createPtr("proxy.process.http.transaction_allocator_allocations");
+  http_rsb.transaction_arena_allocations     = Metrics::Counter::createPtr("proxy.process.http.transaction_arena_allocations");
+  http_rsb.transaction_arena_heap_blocks     = Metrics::Counter::createPtr("proxy.process.http.transaction_arena_heap_blocks");
   http_rsb.tunnel_current_active_connections = Metrics::Gauge::createPtr("proxy.process.tunnel.current_active_connections");
   http_rsb.tunnels                           = Metrics::Counter::createPtr("proxy.process.http.tunnels");
   http_rsb.ua_begin_time                     = Metrics::Counter::createPtr("proxy.process.http.milestone.ua_begin");
@@ -1062,6 +1075,14 @@ HttpConfig::startup()
   HttpEstablishStaticConfigLongLong(c.oride.cache_open_read_retry_time, "proxy.config.http.cache.open_read_retry_time");
   HttpEstablishStaticConfigLongLong(c.oride.cache_generation_number, "proxy.config.http.cache.generation");
 
+  // collapsed forwarding
+  HttpEstablishStaticConfigLongLong(c.collapsed_forwarding_max_waiters, "proxy.config.http.cache.collapsed_forwarding_max_waiters");
+  HttpEstablishStaticConfigLongLong(c.collapsed_forwarding_timeout, "proxy.config.http.cache.collapsed_forwarding_timeout");
+
+  HttpEstablishStaticConfigByte(c.state_timing, "proxy.config.http.state_timing.enabled");
+  HttpEstablishStaticConfigLongLong(c.state_trace_sample, "proxy.config.http.state_timing.trace_sample");
+  HttpStateTrace::startup(c.state_timing);
+
   // open write failure retries
   HttpEstablishStaticConfigLongLong(c.oride.max_cache_open_write_retries, "proxy.config.http.cache.max_open_write_retries");
   HttpEstablishStaticConfigLongLong(c.oride.max_cache_open_write_retry_timeout,
@@ -1361,6 +1382,13 @@ HttpConfig::reconfigure()
   params->oride.cache_open_read_retry_time  = m_master.oride.cache_open_read_retry_time;
   params->oride.cache_generation_number     = m_master.oride.cache_generation_number;
 
+  // collapsed forwarding
+  params->collapsed_forwarding_max_waiters = m_master.collapsed_forwarding_max_waiters;
+  params->collapsed_forwarding_timeout     = m_master.collapsed_forwarding_timeout;
+
+  params->state_timing       = m_master.state_timing;
+  params->state_trace_sample = m_master.state_trace_sample;
+
   // open write failure retries
   params->oride.max_cache_open_write_retries = m_master.oride.max_cache_open_write_retries;
 
@@ -281,6 +281,8 @@ HttpSM::~HttpSM()
   http_parser_clear(&http_parser);
 
   HttpConfig::release(t_state.http_config_param);
+  // The next hop strategy belongs to the remap table, let go of the host before the table.
+  NextHopSelectionStrategy::releaseNextHop(t_state.parent_result);
   m_remap->release();
 
   cache_sm.cancel_pending_action();
@@ -322,6 +324,7 @@ HttpSM::init(bool from_early_data)
   t_state.state_machine = this;
 
   t_state.http_config_param = HttpConfig::acquire();
+  state_trace.start(sm_id, t_state.http_config_param);
   // Acquire a lease on the global remap / rewrite table (stupid global name ...)
   m_remap = rewrite_table->acquire();
 
@@ -2681,7 +2684,8 @@ HttpSM::main_handler(int event, void *data)
   //  space that we don't care about
   SMDbg(dbg_ctl_http, "%s, %d", HttpDebugNames::get_event_name(event), event);
 
-  HttpVCTableEntry *vc_entry = nullptr;
+  HttpVCTableEntry *vc_entry     = nullptr;
+  uint64_t          allocs_start = ink_thread_alloc_count;
 
   if (data != nullptr) {
     // Only search the VC table if the event could have to
@@ -2702,6 +2706,11 @@ HttpSM::main_handler(int event, void *data)
     (this->*default_handler)(event, data);
   }
 
+  // A reentrant call is already counted by the outermost one.
+  if (reentrancy_count == 1) {
+    allocator_allocs += ink_thread_alloc_count - allocs_start;
+  }
+
   // The sub-handler signals when it is time for the state
   //  machine to exit.  We can only exit if we are not reentrantly
   //  called otherwise when the our call unwinds, we will be
@@ -6573,6 +6582,7 @@ HttpSM::perform_cache_write_action()
       ink_assert(transform_cache_sm.cache_write_vc == nullptr);
       transform_cache_sm.cache_write_vc = cache_sm.cache_write_vc;
       cache_sm.cache_write_vc           = nullptr;
+      cache_sm.collapse_release();
     }
     break;
 
@@ -6918,6 +6928,8 @@ HttpSM::setup_cache_write_transfer(HttpCacheSM *c_sm, VConnection *source_vc, HT
 
   c_sm->cache_write_vc->set_http_info(store_info);
   store_info->clear();
+  // Readers can read while we write from here on
+  c_sm->collapse_release();
 
   tunnel.add_consumer(c_sm->cache_write_vc, source_vc, &HttpSM::tunnel_handler_cache_write, HttpTunnelType_t::CACHE_WRITE, name,
                       skip_bytes);
@@ -7691,6 +7703,7 @@ HttpSM::update_stats()
 {
   ATS_PROBE1(milestone_sm_finish, sm_id);
   milestones[TS_MILESTONE_SM_FINISH] = ink_get_hrtime();
+  state_trace.finish(milestones[TS_MILESTONE_SM_FINISH]);
 
   if (is_action_tag_set("bad_length_state_dump")) {
     if (t_state.hdr_info.client_response.valid() && t_state.hdr_info.client_response.status_get() == HTTPStatus::OK) {
@@ -7706,6 +7719,10 @@ HttpSM::update_stats()
     }
   }
 
+  Metrics::Counter::increment(http_rsb.transaction_arena_allocations, t_state.arena.alloc_count());
+  Metrics::Counter::increment(http_rsb.transaction_arena_heap_blocks, t_state.arena.block_count());
+  Metrics::Counter::increment(http_rsb.transaction_allocator_allocations, allocator_allocs);
+
   ink_hrtime total_time = milestones.elapsed(TS_MILESTONE_SM_START, TS_MILESTONE_SM_FINISH);
 
   // ua_close will not be assigned properly in some exceptional situation.
@@ -7918,6 +7935,8 @@ HttpSM::call_transact_and_set_next_state(TransactEntryFunc_t f)
 {
   last_action = t_state.next_action; // remember where we were
 
+  ink_hrtime decide_start = state_trace.is_enabled() ? ink_get_hrtime() : 0;
+
   // The callee can either specify a method to call in to Transact,
   //   or call with NULL which indicates that Transact should use
   //   its stored entry point.
@@ -7928,6 +7947,10 @@ HttpSM::call_transact_and_set_next_state(TransactEntryFunc_t f)
     f(&t_state);
   }
 
+  if (state_trace.is_enabled()) {
+    state_trace.enter(t_state.next_action, decide_start, ink_get_hrtime());
+  }
+
   SMDbg(dbg_ctl_http, "State Transition: %s -> %s", HttpDebugNames::get_action_name(last_action),
         HttpDebugNames::get_action_name(t_state.next_action));
 
@@ -8495,6 +8518,7 @@ HttpSM::redirect_request(const char *arg_redirect_url, const int arg_redirect_le
   // we want to close the server session
   // will do that in handle_api_return under the
   // HttpTransact::StateMachineAction_t::REDIRECT_READ state
+  NextHopSelectionStrategy::releaseNextHop(t_state.parent_result);
   t_state.parent_result.reset();
   t_state.request_sent_time      = 0;
   t_state.response_received_time = 0;
@@ -164,6 +164,20 @@ ServerSessionPool::acquireSession(sockaddr const *addr, CryptoHash const &hostna
   HSMresult_t zret = HSMresult_t::NOT_FOUND;
   to_return        = nullptr;
 
+  // A multiplexing session stays in the pool while it has stream capacity left, so several of them can match. Spread the
+  // transactions by picking the one with the fewest active streams. Any other session is idle and is taken as soon as it matches.
+  // Returns true if the search can stop.
+  auto select = [&to_return](PoolableSession *ssn) -> bool {
+    if (!ssn->is_multiplexing()) {
+      to_return = ssn;
+      return true;
+    }
+    if (to_return == nullptr || ssn->get_active_stream_count() < to_return->get_active_stream_count()) {
+      to_return = ssn;
+    }
+    return to_return->get_active_stream_count() == 0;
+  };
+
   if ((TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTONLY & match_style) && !(TS_SERVER_SESSION_SHARING_MATCH_MASK_IP & match_style)) {
     Dbg(dbg_ctl_http_ss, "Search for host name only not IP.  Pool size %zu", m_fqdn_pool.count());
     // This is broken out because only in this case do we check the host hash first. The range must be checked
@@ -178,17 +192,13 @@ ServerSessionPool::acquireSession(sockaddr const *addr, CryptoHash const &hostna
           (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_SNI) || validate_sni(sm, iter->get_netvc())) &&
           (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTSNISYNC) || validate_host_sni(sm, iter->get_netvc())) &&
           (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_CERT) || validate_cert(sm, iter->get_netvc()))) {
-        zret = HSMresult_t::DONE;
-        break;
+        if (select(&*iter)) {
+          break;
+        }
       }
       ++iter;
     }
-    if (zret == HSMresult_t::DONE) {
-      to_return = &*iter;
-      if (!to_return->is_multiplexing()) {
-        this->removeSession(to_return);
-      }
-    } else if (iter != end) {
+    if (to_return == nullptr && range.begin() != range.end()) {
       Dbg(dbg_ctl_http_ss, "Failed find entry due to name mismatch %s", sm->t_state.current.server->name);
     }
   } else if (TS_SERVER_SESSION_SHARING_MATCH_MASK_IP & match_style) { // matching is not disabled.
@@ -199,25 +209,25 @@ ServerSessionPool::acquireSession(sockaddr const *addr, CryptoHash const &hostna
     // The range is all that is needed in the match IP case, otherwise need to scan for matching fqdn
     // And matches the other constraints as well
     // Note the port is matched as part of the address key so it doesn't need to be checked again.
-    if (match_style & (~TS_SERVER_SESSION_SHARING_MATCH_MASK_IP)) {
-      while (iter != end) {
-        if ((!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTONLY) || iter->hostname_hash == hostname_hash) &&
-            (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_SNI) || validate_sni(sm, iter->get_netvc())) &&
-            (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTSNISYNC) || validate_host_sni(sm, iter->get_netvc())) &&
-            (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_CERT) || validate_cert(sm, iter->get_netvc()))) {
-          zret = HSMresult_t::DONE;
+    bool const match_ip_only = !(match_style & (~TS_SERVER_SESSION_SHARING_MATCH_MASK_IP));
+    while (iter != end) {
+      if (match_ip_only ||
+          ((!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTONLY) || iter->hostname_hash == hostname_hash) &&
+           (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_SNI) || validate_sni(sm, iter->get_netvc())) &&
+           (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTSNISYNC) || validate_host_sni(sm, iter->get_netvc())) &&
+           (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_CERT) || validate_cert(sm, iter->get_netvc())))) {
+        if (select(&*iter)) {
           break;
         }
-        ++iter;
       }
-    } else if (iter != end) {
-      zret = HSMresult_t::DONE;
+      ++iter;
     }
-    if (zret == HSMresult_t::DONE) {
-      to_return = &*iter;
-      if (!to_return->is_multiplexing()) {
-        this->removeSession(to_return);
-      }
+  }
+
+  if (to_return != nullptr) {
+    zret = HSMresult_t::DONE;
+    if (!to_return->is_multiplexing()) {
+      this->removeSession(to_return);
     }
   }
   return zret;
@@ -0,0 +1,174 @@
+/** @file
+
+  Per state timing of the HTTP state machine
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "proxy/http/HttpStateTrace.h"
+#include "proxy/http/HttpConfig.h"
+#include "proxy/http/HttpDebugNames.h"
+#include "tsutil/Metrics.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+using ts::Metrics;
+
+namespace
+{
+bool metrics_created = false;
+
+std::string                   action_names[HttpStateTrace::ACTIONS];
+Metrics::Counter::AtomicType *state_time[HttpStateTrace::ACTIONS][HttpStateTrace::BUCKETS];
+Metrics::Counter::AtomicType *decision_time[HttpStateTrace::ACTIONS];
+
+/// Metric and log name of @a action, the enumerator name in lower case.
+std::string
+action_name(HttpStateTrace::Action action)
+{
+  std::string_view name{HttpDebugNames::get_action_name(action)};
+  if (auto pos = name.rfind(':'); pos != std::string_view::npos) {
+    name.remove_prefix(pos + 1);
+  }
+
+  std::string lower{name};
+  std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+  return lower;
+}
+
+int
+bucket(ink_hrtime elapsed)
+{
+  int b = 0;
+  for (ink_hrtime bound = HRTIME_USECONDS(10); b < HttpStateTrace::BUCKETS - 1 && elapsed >= bound; bound *= 10) {
+    ++b;
+  }
+  return b;
+}
+} // end anonymous namespace
+
+void
+HttpStateTrace::startup(bool enabled)
+{
+  for (int i = 0; i < ACTIONS; ++i) {
+    action_names[i] = action_name(static_cast<Action>(i));
+  }
+  if (!enabled || metrics_created) {
+    return;
+  }
+
+  char name[256];
+  for (int i = 0; i < ACTIONS; ++i) {
+    const char *action = action_names[i].c_str();
+    std::string prefix = std::string{"proxy.process.http.state_time."} + action;
+    int         bound  = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+      state_time[i][b] = Metrics::Counter::createBucketPtr(prefix, bound, "us");
+      bound            = bound ? bound * 10 : 10;
+    }
+    snprintf(name, sizeof(name), "proxy.process.http.state_decision_time.%s", action);
+    decision_time[i] = Metrics::Counter::createPtr(name);
+  }
+  metrics_created = true;
+}
+
+void
+HttpStateTrace::start(int64_t sm_id, const HttpConfigParams *params)
+{
+  _timing  = metrics_created && params->state_timing;
+  _sampled = params->state_trace_sample > 0 && sm_id % params->state_trace_sample == 0;
+  _current = Action::UNDEFINED;
+  _count   = 0;
+  _entry   = -1;
+}
+
+void
+HttpStateTrace::_end_state(ink_hrtime now)
+{
+  if (_current == Action::UNDEFINED) {
+    return;
+  }
+
+  ink_hrtime elapsed = now - _start;
+  if (_timing) {
+    Metrics::Counter::increment(state_time[static_cast<int>(_current)][bucket(elapsed)]);
+  }
+  if (_entry >= 0) {
+    _entries[_entry].state_us = std::min<ink_hrtime>(ink_hrtime_to_usec(elapsed), UINT32_MAX);
+  }
+  _current = Action::UNDEFINED;
+}
+
+void
+HttpStateTrace::enter(Action action, ink_hrtime decide_start, ink_hrtime decide_end)
+{
+  _end_state(decide_start);
+
+  int        i        = static_cast<int>(action);
+  ink_hrtime decision = decide_end - decide_start;
+  if (i <= 0 || i >= ACTIONS) {
+    return;
+  }
+
+  if (_timing) {
+    Metrics::Counter::increment(decision_time[i], decision);
+  }
+  _entry = -1;
+  if (_sampled && _count < ENTRIES) {
+    _entry           = _count++;
+    _entries[_entry] = {action, static_cast<uint32_t>(std::min<ink_hrtime>(decision, UINT32_MAX)), 0};
+  }
+  _current = action;
+  _start   = decide_end;
+}
+
+void
+HttpStateTrace::finish(ink_hrtime now)
+{
+  if (is_enabled()) {
+    _end_state(now);
+  }
+}
+
+int
+HttpStateTrace::print(char *buf, int len) const
+{
+  int n = 0;
+
+  if (len > 0) {
+    buf[0] = '\0';
+  }
+  if (!_sampled) {
+    return 0;
+  }
+
+  for (int i = 0; i < _count; ++i) {
+    int w = snprintf(buf + std::min(n, len), std::max(len - n, 0), "%s%s:%u:%u", i ? "," : "",
+                     action_names[static_cast<int>(_entries[i].action)].c_str(), _entries[i].decision_ns, _entries[i].state_us);
+    if (w < 0) {
+      break;
+    }
+    n += w;
+  }
+  return n;
+}
@@ -274,6 +274,32 @@ markParentUp(HttpTransact::State *s)
   }
 }
 
+// tell a remap next hop strategy how long the parent took to respond, a failure
+// costs at least a connect timeout.
+inline static void
+recordParentResponseTime(HttpTransact::State *s)
+{
+  if (s->response_action.handled || nullptr == s->next_hop_strategy) {
+    return;
+  }
+
+  auto const &milestones = s->state_machine->milestones;
+  if (milestones[TS_MILESTONE_SERVER_CONNECT] == 0) {
+    return;
+  }
+  bool failed = s->current.state != HttpTransact::CONNECTION_ALIVE &&
+                !(s->current.state == HttpTransact::PARENT_RETRY && s->current.retry_type == ParentRetry_t::SIMPLE);
+  ink_hrtime done = milestones[TS_MILESTONE_SERVER_READ_HEADER_DONE];
+  if (failed || done == 0) {
+    done = ink_get_hrtime();
+  }
+  ink_hrtime elapsed = done - milestones[TS_MILESTONE_SERVER_CONNECT];
+  if (failed) {
+    elapsed = std::max(elapsed, HRTIME_SECONDS(s->txn_conf->connect_attempts_timeout));
+  }
+  s->next_hop_strategy->recordResponseTime(reinterpret_cast<TSHttpTxn>(s->state_machine), elapsed);
+}
+
 // wrapper to choose between a remap next hop strategy or use parent.config
 // remap next hop strategy is preferred
 inline static bool
@@ -2394,6 +2420,11 @@ HttpTransact::HandleCacheOpenRead(State *s)
   } else {
     // cache hit
     TxnDbg(dbg_ctl_http_trans, "CacheOpenRead -- hit");
+    // Without a hook to call out to there is no need to go back to the state machine
+    if (!s->state_machine->has_api_hooks(TS_HTTP_READ_CACHE_HDR_HOOK)) {
+      HandleCacheOpenReadHitFreshness(s);
+      return;
+    }
     TRANSACT_RETURN(StateMachineAction_t::API_READ_CACHE_HDR, HandleCacheOpenReadHitFreshness);
   }
 
@@ -2597,6 +2628,17 @@ HttpTransact::HandleCacheOpenReadHitFreshness(State *s)
     SET_VIA_STRING(VIA_CACHE_RESULT, VIA_IN_CACHE_STALE);
   }
 
+  // Fast path for a fresh hit nobody wants to look at, decide how to serve it right away
+  if (s->cache_lookup_result == CacheLookupResult_t::HIT_FRESH &&
+      !s->state_machine->has_api_hooks(TS_HTTP_CACHE_LOOKUP_COMPLETE_HOOK)) {
+    HandleCacheOpenReadHit(s);
+    if (s->next_action == StateMachineAction_t::SERVE_FROM_CACHE) {
+      TxnDbg(dbg_ctl_http_trans, "Fresh hit fast path");
+      Metrics::Counter::increment(http_rsb.cache_hit_fresh_fast_path);
+    }
+    return;
+  }
+
   TRANSACT_RETURN(StateMachineAction_t::API_CACHE_LOOKUP_COMPLETE, HttpTransact::HandleCacheOpenReadHit);
 }
 
@@ -2981,6 +3023,7 @@ HttpTransact::build_response_from_cache(State *s, HTTPWarningCode warning_code)
   HTTPHdr       *cached_response = nullptr;
   HTTPHdr       *to_warn         = &s->hdr_info.client_response;
   CacheHTTPInfo *obj;
+  HdrCopyStats   copy_start      = hdr_copy_stats;
 
   if (s->api_update_cached_object == HttpTransact::UpdateCachedObject_t::CONTINUE) {
     obj = &s->cache_info.object_store;
@@ -3096,6 +3139,12 @@ HttpTransact::build_response_from_cache(State *s, HTTPWarningCode warning_code)
     delete_warning_value(to_warn, warning_code);
     HttpTransactHeaders::insert_warning_header(s->http_config_param, to_warn, warning_code);
   }
+
+  uint64_t copied = (hdr_copy_stats.obj_bytes - copy_start.obj_bytes) + (hdr_copy_stats.str_bytes - copy_start.str_bytes);
+  uint64_t shared = hdr_copy_stats.shared_bytes - copy_start.shared_bytes;
+  Metrics::Counter::increment(http_rsb.cache_hit_hdr_copied_bytes, copied);
+  Metrics::Counter::increment(http_rsb.cache_hit_hdr_shared_bytes, shared);
+  TxnDbg(dbg_ctl_http_trans, "Response from cache copied %" PRIu64 " header bytes, shared %" PRIu64, copied, shared);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -3548,6 +3597,7 @@ HttpTransact::handle_response_from_parent(State *s)
   }
 
   simple_or_unavailable_server_retry(s);
+  recordParentResponseTime(s);
 
   s->parent_info.state = s->current.state;
   switch (s->current.state) {
@@ -58,6 +58,53 @@ const char *const CHUNK_HEADER_FMT         = "%" PRIx64 "\r\n";
 // a block in the input stream.
 int const CHUNK_IOBUFFER_SIZE_INDEX = MIN_IOBUFFER_SIZE;
 
+/** Parse a chunk size line, "[CRLF]<hex>[extension]CRLF", that is entirely in [s, e).
+
+    This only handles well formed lines, ones that the ChunkedHandler::read_size() state machine accepts with the same
+    result. Anything else, including a line that continues in the next block, is left to the state machine so that it
+    gets the same checks and errors no matter how the input is split into blocks.
+
+    @return The number of bytes in the line or 0 if it was not parsed.
+ */
+int64_t
+parse_chunk_size_line(const char *s, const char *e, bool leading_crlf, int &size)
+{
+  const char *p = s;
+
+  if (leading_crlf) {
+    if (e - p < 2 || p[0] != '\r' || p[1] != '\n') {
+      return 0;
+    }
+    p += 2;
+  }
+
+  auto lf = static_cast<const char *>(memchr(p, '\n', e - p));
+  if (lf == nullptr || lf - p < 2 || lf[-1] != '\r') {
+    return 0;
+  }
+  const char *cr = lf - 1;
+
+  int sum    = 0;
+  int digits = 0;
+  for (; p < cr && ParseRules::is_hex(*p); ++p) {
+    // 7 digits can not overflow, let the state machine deal with longer sizes.
+    if (++digits > 7) {
+      return 0;
+    }
+    sum = (sum << 4) + (ParseRules::is_digit(*p) ? *p - '0' : ParseRules::ink_tolower(*p) - 'a' + 10);
+  }
+  if (digits == 0) {
+    return 0;
+  }
+  // A chunk extension may follow, but not a second CR.
+  if (p < cr && ((!ParseRules::is_ws(*p) && *p != ';') || memchr(p, '\r', cr - p) != nullptr)) {
+    return 0;
+  }
+
+  size = sum;
+  return lf + 1 - s;
+}
+
 } // end anonymous namespace
 
 ChunkedHandler::ChunkedHandler() : max_chunk_size(DEFAULT_MAX_CHUNK_SIZE) {}
@@ -160,6 +207,22 @@ ChunkedHandler::read_size()
     ink_assert(data_size > 0);
     int64_t bytes_used = 0;
 
+    // Most size lines are complete in the block, take those in one step.
+    if (num_cr == 0 && (state == ChunkedState::READ_SIZE_START || (state == ChunkedState::READ_SIZE && num_digits == 0))) {
+      int size = 0;
+      if (int64_t line_len = parse_chunk_size_line(tmp, tmp + data_size, state == ChunkedState::READ_SIZE_START, size);
+          line_len > 0) {
+        Dbg(dbg_ctl_http_chunk, "read chunk size of %d bytes", size);
+        bytes_used           = line_len;
+        data_size            = 0;
+        running_sum          = size;
+        prev_is_cr           = true;
+        cur_chunk_bytes_left = (cur_chunk_size = running_sum);
+        state                = (running_sum == 0) ? ChunkedState::READ_TRAILER_BLANK : ChunkedState::READ_CHUNK;
+        done                 = true;
+      }
+    }
+
     while (data_size > 0) {
       bytes_used++;
       if (state == ChunkedState::READ_SIZE) {
@@ -449,17 +512,15 @@ ChunkedHandler::generate_chunked_content()
       chunked_size += max_chunk_header_len;
     }
 
-    // Output the chunk itself.
-    //
-    // BZ# 54395 Note - we really should only do a
-    //   block transfer if there is sizable amount of
-    //   data (like we do for the case where we are
-    //   removing chunked encoding in ChunkedHandler::transfer_bytes()
-    //   However, I want to do this fix with as small a risk
-    //   as possible so I'm leaving this issue alone for
-    //   now
-    //
-    chunked_buffer->write(dechunked_reader, write_val);
+    // Output the chunk itself. As in transfer_bytes(), only reference blocks for a sizable amount of data, a small chunk is
+    // copied next to its header so that the chunked output does not build up lots of tiny blocks.
+    if (write_val >= min_block_transfer_bytes) {
+      chunked_buffer->write(dechunked_reader, write_val);
+    } else {
+      char small_chunk[min_block_transfer_bytes];
+      dechunked_reader->memcpy(small_chunk, write_val);
+      chunked_buffer->write(small_chunk, write_val);
+    }
     chunked_size += write_val;
     dechunked_reader->consume(write_val);
     consumed_bytes += write_val;
@@ -21,6 +21,9 @@
   limitations under the License.
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include <yaml-cpp/yaml.h>
 
 #include "proxy/http/HttpSM.h"
@@ -42,6 +45,28 @@ constexpr std::string_view hash_url_request = "request";
 constexpr std::string_view hash_url_cache   = "cache";
 constexpr std::string_view hash_url_parent  = "parent";
 
+// hash_selection strings
+constexpr std::string_view hash_selection_ring         = "ring";
+constexpr std::string_view hash_selection_bounded_load = "bounded_load";
+constexpr std::string_view hash_selection_maglev       = "maglev";
+
+constexpr uint32_t MAGLEV_MAX_TABLE_SIZE = 16777213; // largest prime below 2^24.
+constexpr uint32_t MAGLEV_NO_HOST        = UINT32_MAX;
+
+static bool
+isPrime(uint32_t n)
+{
+  if (n < 2) {
+    return false;
+  }
+  for (uint64_t d = 2; d * d <= n; d++) {
+    if (n % d == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 static bool
 isWrapped(std::vector<bool> &wrap_around, uint32_t groups)
 {
@@ -63,6 +88,15 @@ NextHopConsistentHash::chashLookup(const std::shared_ptr<ATSConsistentHash> &rin
   HostRecord                *host_rec = nullptr;
   ATSConsistentHashIter     *iter     = &result.chashIter[cur_ring];
 
+  // with maglev the first choice comes from the table, later ones walk the ring from the hash.
+  if (hash_selection == NHHashSelection::MAGLEV && !result.maglev_init[cur_ring] && !result.chash_init[cur_ring] &&
+      !maglev_tables[cur_ring].empty()) {
+    hash_key                     = getHashKey(sm_id, request_info, hash.get());
+    result.maglev_init[cur_ring] = true;
+    *wrapped                     = false;
+    return host_groups[cur_ring][maglev_tables[cur_ring][hash_key % maglev_tables[cur_ring].size()]];
+  }
+
   if (result.chash_init[cur_ring] == false) {
     hash_key                    = getHashKey(sm_id, request_info, hash.get());
     host_rec                    = static_cast<HostRecord *>(ring->lookup_by_hashval(hash_key, iter, wrapped));
@@ -191,6 +225,58 @@ NextHopConsistentHash::NextHopConsistentHash(const std::string_view name, const
                                 "', this strategy will be ignored.");
   }
 
+  // Parse hash_selection
+  try {
+    if (n["hash_selection"]) {
+      auto hash_selection_val = n["hash_selection"].Scalar();
+      if (hash_selection_val == hash_selection_ring) {
+        hash_selection = NHHashSelection::RING;
+      } else if (hash_selection_val == hash_selection_bounded_load) {
+        hash_selection = NHHashSelection::BOUNDED_LOAD;
+      } else if (hash_selection_val == hash_selection_maglev) {
+        hash_selection = NHHashSelection::MAGLEV;
+      } else {
+        hash_selection = NHHashSelection::RING;
+        NH_Note("Invalid 'hash_selection' value, '%s', for the strategy named '%s', using default '%s'.",
+                hash_selection_val.c_str(), strategy_name.c_str(), hash_selection_ring.data());
+      }
+    }
+  } catch (std::exception &ex) {
+    throw std::invalid_argument("Error parsing the strategy named '" + strategy_name + "' due to '" + ex.what() +
+                                "', this strategy will be ignored.");
+  }
+
+  // Parse load_factor
+  try {
+    if (n["load_factor"]) {
+      load_factor = n["load_factor"].as<double>();
+      if (!(load_factor > 1.0)) {
+        NH_Note("Invalid 'load_factor' value, %g, for the strategy named '%s', must be > 1.0, using default 1.25.", load_factor,
+                strategy_name.c_str());
+        load_factor = 1.25;
+      }
+    }
+  } catch (std::exception &ex) {
+    throw std::invalid_argument("Error parsing the strategy named '" + strategy_name + "' due to '" + ex.what() +
+                                "', this strategy will be ignored.");
+  }
+
+  // Parse maglev_table_size
+  try {
+    if (n["maglev_table_size"]) {
+      maglev_table_size = n["maglev_table_size"].as<uint32_t>();
+      if (!isPrime(maglev_table_size) || maglev_table_size > MAGLEV_MAX_TABLE_SIZE) {
+        NH_Note("Invalid 'maglev_table_size' value, %u, for the strategy named '%s', must be a prime no larger than %u, using "
+                "default 65537.",
+                maglev_table_size, strategy_name.c_str(), MAGLEV_MAX_TABLE_SIZE);
+        maglev_table_size = 65537;
+      }
+    }
+  } catch (std::exception &ex) {
+    throw std::invalid_argument("Error parsing the strategy named '" + strategy_name + "' due to '" + ex.what() +
+                                "', this strategy will be ignored.");
+  }
+
   hash = createHashInstance(parseHashAlgorithm(hash_algorithm), hash_seed0, hash_seed1);
 
   // load up the hash rings.
@@ -213,6 +299,113 @@ NextHopConsistentHash::NextHopConsistentHash(const std::string_view name, const
     }
     hash->clear();
     rings.push_back(std::move(hash_ring));
+
+    float weight = 0;
+    for (auto const &host : host_groups[i]) {
+      weight += host->weight;
+    }
+    group_weights.push_back(weight);
+    if (hash_selection == NHHashSelection::MAGLEV) {
+      buildMaglevTable(i, hash.get());
+    }
+  }
+
+  load_skew = ts::Metrics::Gauge::createPtr("proxy.process.http.next_hop." + strategy_name + ".load_skew");
+}
+
+// fills the maglev lookup table of a group, each host claims its preferred
+// free slots in turn with a share of the table in proportion to its weight.
+void
+NextHopConsistentHash::buildMaglevTable(uint32_t group, ATSHash64 *h)
+{
+  auto const           &hosts = host_groups[group];
+  uint32_t const        size  = maglev_table_size;
+  std::vector<uint32_t> table;
+
+  if (!hosts.empty()) {
+    std::vector<uint64_t> offset(hosts.size());
+    std::vector<uint64_t> skip(hosts.size());
+    std::vector<uint64_t> next(hosts.size(), 0);
+    std::vector<double>   share(hosts.size());
+    std::vector<double>   credit(hosts.size(), 0);
+    float                 max_weight = 0;
+
+    for (auto const &host : hosts) {
+      max_weight = std::max(max_weight, host->weight);
+    }
+    for (uint32_t j = 0; j < hosts.size(); j++) {
+      h->update(hosts[j]->name, strlen(hosts[j]->name));
+      h->final();
+      uint64_t value = h->get();
+      h->clear();
+      offset[j] = value % size;
+      skip[j]   = (value >> 32) % (size - 1) + 1;
+      share[j]  = max_weight > 0 ? hosts[j]->weight / max_weight : 1.0;
+    }
+
+    table.assign(size, MAGLEV_NO_HOST);
+    for (uint32_t filled = 0; filled < size;) {
+      for (uint32_t j = 0; j < hosts.size() && filled < size; j++) {
+        for (credit[j] += share[j]; credit[j] >= 1.0 && filled < size; credit[j] -= 1.0) {
+          uint64_t slot = 0;
+          do {
+            slot = (offset[j] + next[j]++ * skip[j]) % size;
+          } while (table[slot] != MAGLEV_NO_HOST);
+          table[slot] = j;
+          filled++;
+        }
+      }
+    }
+  }
+  maglev_tables.push_back(std::move(table));
+}
+
+// the part of its group's load that a host should carry.
+float
+NextHopConsistentHash::hostShare(const HostRecord &host) const
+{
+  float group_weight = group_weights[host.group_index];
+  if (group_weight > 0) {
+    return host.weight / group_weight;
+  }
+  return 1.0 / host_groups[host.group_index].size();
+}
+
+// bounded loads, a host may take a transaction while it has less than
+// load_factor times its share of the group's transactions, including this one.
+bool
+NextHopConsistentHash::isOverloaded(const HostRecord &host) const
+{
+  int64_t total = 0;
+  for (auto const &h : host_groups[host.group_index]) {
+    total += h->inflight.load(std::memory_order_relaxed);
+  }
+  double bound = std::ceil(load_factor * (total + 1) * hostShare(host));
+  return host.inflight.load(std::memory_order_relaxed) + 1 > bound;
+}
+
+// the busiest host's in flight transactions against its share of its group's,
+// as a percentage, for the most skewed group. 100 is an even spread.
+void
+NextHopConsistentHash::updateLoadSkew()
+{
+  int64_t skew = -1;
+  for (auto const &group : host_groups) {
+    int64_t total = 0;
+    double  most  = 0;
+    for (auto const &h : group) {
+      int32_t inflight  = h->inflight.load(std::memory_order_relaxed);
+      total            += inflight;
+      if (double share = hostShare(*h); share > 0) {
+        most = std::max(most, inflight / share);
+      }
+    }
+    if (total > 0) {
+      skew = std::max(skew, static_cast<int64_t>(100 * most / total));
+    }
+  }
+  if (skew >= 0) {
+    ts::Metrics::Gauge::store(load_skew, skew);
   }
 }
 
@@ -340,6 +533,11 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void * /* ih ATS_UNUSED */, t
   Machine                    *machine   = Machine::instance();
   std::string_view            first_call_host;
   int                         first_call_port = 0;
+  std::shared_ptr<HostRecord> overloaded      = nullptr; // bounded loads, the first choice that was skipped.
+  uint32_t                    overloaded_ring = 0;
+
+  // a host is only counted in flight for the last selection.
+  releaseNextHop(result);
 
   if (result.line_number == -1 && result.result == ParentResultType::UNDEFINED) {
     firstcall = true;
@@ -356,8 +554,9 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void * /* ih ATS_UNUSED */, t
     result.line_number = distance;
     cur_ring           = 0;
     for (uint32_t i = 0; i < groups; i++) {
-      result.chash_init[i] = false;
-      wrap_around[i]       = false;
+      result.chash_init[i]  = false;
+      result.maglev_init[i] = false;
+      wrap_around[i]        = false;
     }
   } else {
     // not first call, save the previously tried parent.
@@ -461,6 +660,21 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void * /* ih ATS_UNUSED */, t
 
         // use the available selected parent
         if (pRec->available.load() && host_stat == TS_HOST_STATUS_UP) {
+          if (hash_selection == NHHashSelection::BOUNDED_LOAD && isOverloaded(*pRec)) {
+            NH_Dbg(NH_DBG_CTL, "[%" PRIu64 "] %s is over its load bound with %d in flight", sm_id, pRec->hostname.c_str(),
+                   pRec->inflight.load());
+            if (overloaded == nullptr) {
+              overloaded      = pRec;
+              overloaded_ring = cur_ring;
+            }
+            // search on around the same ring, unless every host on it has been seen.
+            if (!wrap_around[cur_ring]) {
+              pRec = nullptr;
+              continue;
+            }
+            pRec     = overloaded;
+            cur_ring = overloaded_ring;
+          }
           break;
         }
       }
@@ -492,6 +706,13 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void * /* ih ATS_UNUSED */, t
       }
     } while (!pRec);
 
+    // every other host is over its bound or down, go with the first choice.
+    if (pRec == nullptr && overloaded != nullptr && cur_ring != NO_RING_USE_POST_REMAP && overloaded->available.load()) {
+      pRec      = overloaded;
+      cur_ring  = overloaded_ring;
+      host_stat = TS_HOST_STATUS_UP;
+    }
+
     NH_Dbg(NH_DBG_CTL, "[%" PRIu64 "] Initial parent lookups: %d", sm_id, lookups);
   }
 
@@ -514,6 +735,10 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void * /* ih ATS_UNUSED */, t
       break;
     }
     result.retry = nextHopRetry;
+
+    holdNextHop(result, pRec.get());
+    updateLoadSkew();
+
     // if using a peering ring mode and the parent selected came from the 'peering' group,
     // cur_ring == 0, then if the config allows it, set the flag to not cache the result.
     if (ring_mode == NHRingMode::PEERING_RING && !cache_peer_result && cur_ring == 0) {
@@ -0,0 +1,283 @@
+/** @file
+
+  Built in active health checks of next hop hosts.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <unordered_map>
+
+#include "iocore/eventsystem/EventSystem.h"
+#include "iocore/hostdb/HostDBProcessor.h"
+#include "iocore/net/NetProcessor.h"
+#include "proxy/HostStatus.h"
+#include "proxy/http/remap/NextHopHealthCheck.h"
+#include "proxy/http/remap/NextHopStrategyFactory.h"
+
+namespace
+{
+DbgCtl dbg_ctl_health_check{"next_hop_health_check"};
+
+// Only the status line of the response matters, "HTTP/1.1 200".
+constexpr int STATUS_LINE_LEN = 12;
+
+// @return true for a 2xx or 3xx status line.
+bool
+status_passed(std::string_view status)
+{
+  if (status.substr(0, 5) != "HTTP/" || status[8] != ' ') {
+    return false;
+  }
+  int code = 0;
+  std::from_chars(status.data() + 9, status.data() + STATUS_LINE_LEN, code);
+  return code >= 200 && code < 400;
+}
+} // end anonymous namespace
+
+NextHopHealthCheck::NextHopHealthCheck(const NHHealthCheckTarget &target, const HealthChecks &cfg,
+                                       std::shared_ptr<std::atomic<bool>> running)
+  : Continuation(new_ProxyMutex()),
+    _target(target),
+    _counter(cfg.healthy_threshold, cfg.unhealthy_threshold),
+    _timeout(cfg.timeout),
+    _running(std::move(running))
+{
+  SET_HANDLER(&NextHopHealthCheck::check_event);
+}
+
+void
+NextHopHealthCheck::start(NextHopStrategyFactory &factory)
+{
+  std::unordered_map<std::string, NextHopHealthCheck *> checks;
+
+  for (auto const &[name, strategy] : factory.strategies()) {
+    HealthChecks const &cfg = strategy->health_checks;
+    if (cfg.type == NHHealthCheckType::NONE) {
+      continue;
+    }
+    for (auto const &group : strategy->host_groups) {
+      for (auto const &host : group) {
+        NHHealthCheckTarget target;
+        if (host->self || !target.init(*host, strategy->scheme, cfg.type)) {
+          continue;
+        }
+        // Strategies that share a host share its check, with the settings of the first one.
+        auto &check = checks[target.key()];
+        if (check == nullptr) {
+          check = new NextHopHealthCheck(target, cfg, factory.activeHealthChecksRunning());
+          eventProcessor.schedule_every(check, HRTIME_SECONDS(cfg.interval), ET_NET);
+        }
+        check->_hosts.push_back(host);
+      }
+    }
+  }
+  if (!checks.empty()) {
+    Note("started %zu next hop active health checks", checks.size());
+  }
+}
+
+int
+NextHopHealthCheck::check_event(int event, void *data)
+{
+  switch (event) {
+  case EVENT_INTERVAL:
+    if (data == _timeout_event) {
+      _timeout_event = nullptr;
+      Dbg(dbg_ctl_health_check, "%s:%d timed out", _target.host.c_str(), _target.port);
+      finish(false);
+    } else if (!*_running) {
+      static_cast<Event *>(data)->cancel();
+      reset();
+      delete this;
+      return EVENT_DONE;
+    } else if (_timeout_event == nullptr) {
+      start_check();
+    }
+    break;
+  case EVENT_HOST_DB_LOOKUP:
+    _pending_action = nullptr;
+    connect(static_cast<HostDBRecord *>(data));
+    break;
+  case NET_EVENT_OPEN:
+    _pending_action = nullptr;
+    _netvc          = static_cast<NetVConnection *>(data);
+    send_request();
+    break;
+  case VC_EVENT_WRITE_READY:
+    // The connection, and the TLS handshake, are done once the first write is ready.
+    if (_target.type != NHHealthCheckType::HTTP) {
+      finish(true);
+    } else {
+      static_cast<VIO *>(data)->reenable();
+    }
+    break;
+  case VC_EVENT_WRITE_COMPLETE:
+    _netvc->do_io_write(nullptr, 0, nullptr);
+    _netvc->do_io_read(this, INT64_MAX, _buf);
+    break;
+  case VC_EVENT_READ_READY:
+  case VC_EVENT_READ_COMPLETE:
+    if (_reader->read_avail() >= STATUS_LINE_LEN) {
+      char buf[STATUS_LINE_LEN];
+      _reader->memcpy(buf, sizeof(buf));
+      finish(status_passed({buf, sizeof(buf)}));
+    } else {
+      static_cast<VIO *>(data)->reenable();
+    }
+    break;
+  case NET_EVENT_OPEN_FAILED:
+    _pending_action = nullptr;
+    [[fallthrough]];
+  default:
+    // End of stream, error or timeout before a result.
+    Dbg(dbg_ctl_health_check, "%s:%d %s (%d)", _target.host.c_str(), _target.port, get_vc_event_name(event), event);
+    finish(false);
+    break;
+  }
+  return EVENT_CONT;
+}
+
+// Start a check, limited to the timeout: look up the host, connect, handshake and for HTTP checks get the path.
+void
+NextHopHealthCheck::start_check()
+{
+  _timeout_event = this_ethread()->schedule_in(this, HRTIME_SECONDS(_timeout));
+
+  IpEndpoint addr;
+  if (ats_ip_pton(_target.host, &addr) == 0) {
+    connect(addr);
+    return;
+  }
+  Action *action = hostDBProcessor.getbyname_re(this, _target.host.c_str(), _target.host.size());
+  if (action != ACTION_RESULT_DONE) {
+    _pending_action = action;
+  }
+}
+
+void
+NextHopHealthCheck::connect(HostDBRecord *record)
+{
+  if (record == nullptr || record->is_failed() || record->rr_info().empty()) {
+    Dbg(dbg_ctl_health_check, "%s:%d no address", _target.host.c_str(), _target.port);
+    finish(false);
+    return;
+  }
+  IpEndpoint addr;
+  addr.assign(record->rr_info()[0].data.ip);
+  connect(addr);
+}
+
+void
+NextHopHealthCheck::connect(IpEndpoint &addr)
+{
+  addr.network_order_port() = htons(_target.port);
+
+  NetVCOptions opt;
+  opt.f_blocking_connect = false;
+
+  Action *action = nullptr;
+  if (_target.tls) {
+    // Checks only look for a handshake, whatever certificate the host has.
+    opt.set_sni_servername(_target.host.data(), _target.host.size());
+    opt.verifyServerPolicy = YamlSNIConfig::Policy::DISABLED;
+    action                 = sslNetProcessor.connect_re(this, &addr.sa, opt);
+  } else {
+    action = netProcessor.connect_re(this, &addr.sa, opt);
+  }
+  if (action != ACTION_RESULT_DONE) {
+    _pending_action = action;
+  }
+}
+
+// Write the GET for an HTTP check, any other check only waits for the connection.
+void
+NextHopHealthCheck::send_request()
+{
+  _buf    = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+  _reader = _buf->alloc_reader();
+
+  int64_t len = INT64_MAX;
+  if (_target.type == NHHealthCheckType::HTTP) {
+    std::string host = _target.host.find(':') == std::string::npos ? _target.host : "[" + _target.host + "]";
+    std::string req  = "GET " + _target.path + " HTTP/1.1\r\nHost: " + host + ":" + std::to_string(_target.port) +
+                      "\r\nUser-Agent: ATS next hop health check\r\nConnection: close\r\n\r\n";
+
+    len = _buf->write(req.data(), req.size());
+  }
+  _netvc->do_io_write(this, len, _reader);
+}
+
+// End the check in progress and count its result.
+void
+NextHopHealthCheck::finish(bool passed)
+{
+  reset();
+
+  auto was = _counter.state();
+  Dbg(dbg_ctl_health_check, "%s:%d %s", _target.host.c_str(), _target.port, passed ? "passed" : "failed");
+  if (_counter.record(passed)) {
+    mark(_counter.state() == NHHealthCheckCounter::State::UP, was != NHHealthCheckCounter::State::UNKNOWN || !passed);
+  }
+}
+
+void
+NextHopHealthCheck::reset()
+{
+  if (_timeout_event != nullptr) {
+    _timeout_event->cancel();
+    _timeout_event = nullptr;
+  }
+  if (_pending_action != nullptr) {
+    _pending_action->cancel();
+    _pending_action = nullptr;
+  }
+  if (_netvc != nullptr) {
+    _netvc->do_io_close();
+    _netvc = nullptr;
+  }
+  if (_buf != nullptr) {
+    free_MIOBuffer(_buf);
+    _buf    = nullptr;
+    _reader = nullptr;
+  }
+}
+
+// Set the state of the hosts, @a changed is false for the first result of hosts that are up as expected.
+void
+NextHopHealthCheck::mark(bool up, bool changed)
+{
+  HostStatus &h_stat = HostStatus::instance();
+
+  for (auto const &host : _hosts) {
+    if (up) {
+      host->set_available();
+    } else {
+      host->set_unavailable();
+    }
+    h_stat.setHostStatus(host->hostname, up ? TSHostStatus::TS_HOST_STATUS_UP : TSHostStatus::TS_HOST_STATUS_DOWN, 0,
+                         Reason::ACTIVE);
+  }
+  if (!changed) {
+    Dbg(dbg_ctl_health_check, "next hop %s:%d is up", _target.host.c_str(), _target.port);
+  } else if (up) {
+    Note("next hop %s:%d passed its active health checks, marked up", _target.host.c_str(), _target.port);
+  } else {
+    Warning("next hop %s:%d failed its active health checks, marked down", _target.host.c_str(), _target.port);
+  }
+}
@@ -26,6 +26,37 @@
 
 #include "proxy/http/HttpSM.h"
 #include "proxy/http/remap/NextHopRoundRobin.h"
+#include "tscore/Random.h"
+#include "tsutil/YamlCfg.h"
+
+NextHopRoundRobin::NextHopRoundRobin(const std::string_view &name, const NHPolicyType &policy, ts::Yaml::Map &n)
+  : NextHopSelectionStrategy(name, policy, n)
+{
+  // Parse ewma_weight
+  try {
+    if (n["ewma_weight"]) {
+      ewma_weight = n["ewma_weight"].as<double>();
+      if (!(ewma_weight > 0 && ewma_weight <= 1)) {
+        NH_Note("Invalid 'ewma_weight' value, %g, for the strategy named '%s', must be > 0 and <= 1, using default 0.3.",
+                ewma_weight, strategy_name.c_str());
+        ewma_weight = 0.3;
+      }
+    }
+  } catch (std::exception &ex) {
+    throw std::invalid_argument("Error parsing the strategy named '" + strategy_name + "' due to '" + ex.what() +
+                                "', this strategy will be ignored.");
+  }
+
+  if (policy_type == NHPolicyType::LEAST_LATENCY) {
+    for (auto const &group : host_groups) {
+      auto &group_scores = scores.emplace_back();
+      for (auto const &host : group) {
+        group_scores.push_back(
+          ts::Metrics::Gauge::createPtr("proxy.process.http.next_hop." + strategy_name + "." + host->hostname + ".score"));
+      }
+    }
+  }
+}
 
 NextHopRoundRobin::~NextHopRoundRobin()
 {
@@ -56,6 +87,9 @@ NextHopRoundRobin::findNextHop(TSHttpTxn txnp, void * /* ih ATS_UNUSED */, time_
   HostStatus                 &pStatus   = HostStatus::instance();
   TSHostStatus                host_stat = TSHostStatus::TS_HOST_STATUS_UP;
 
+  // a host is only counted in flight for the last selection.
+  releaseNextHop(*result);
+
   if (result->line_number != -1 && result->result != ParentResultType::UNDEFINED) {
     firstcall = false;
   }
@@ -88,6 +122,10 @@ NextHopRoundRobin::findNextHop(TSHttpTxn txnp, void * /* ih ATS_UNUSED */, time_
       cur_grp_index = 0;
       cur_hst_index = result->start_parent = latched_index;
       break;
+    case NHPolicyType::LEAST_LATENCY:
+      cur_grp_index = 0;
+      cur_hst_index = result->start_parent = leastLatencyIndex(cur_grp_index);
+      break;
     default:
       ink_assert(0);
       break;
@@ -170,6 +208,10 @@ NextHopRoundRobin::findNextHop(TSHttpTxn txnp, void * /* ih ATS_UNUSED */, time_
       result->last_parent = cur_hst_index;
       result->last_group  = cur_grp_index;
       result->retry       = parentRetry;
+      if (policy_type == NHPolicyType::LEAST_LATENCY) {
+        holdNextHop(*result, cur_host.get());
+        updateScore(*cur_host);
+      }
       setHostHeader(txnp, result->hostname);
       ink_assert(result->hostname != nullptr);
       ink_assert(result->port != 0);
@@ -222,3 +264,59 @@ NextHopRoundRobin::findNextHop(TSHttpTxn txnp, void * /* ih ATS_UNUSED */, time_
   result->hostname = nullptr;
   result->port     = 0;
 }
+
+// the lower the better, the response time scaled by the transactions the host
+// would have in flight. Hosts not yet measured score on load alone.
+int64_t
+NextHopRoundRobin::updateScore(const HostRecord &host)
+{
+  int64_t score = (host.latency.load(std::memory_order_relaxed) + 1) * (host.inflight.load(std::memory_order_relaxed) + 1);
+  ts::Metrics::Gauge::store(scores[host.group_index][host.host_index], score);
+  return score;
+}
+
+// power of two choices, the better scoring of two different random hosts of
+// the group, preferring one that is available.
+uint32_t
+NextHopRoundRobin::leastLatencyIndex(uint32_t group)
+{
+  auto const &hosts = host_groups[group];
+  if (hosts.size() < 2) {
+    return 0;
+  }
+
+  uint32_t first  = ts::Random::random() % hosts.size();
+  uint32_t second = ts::Random::random() % (hosts.size() - 1);
+  if (second >= first) {
+    second++;
+  }
+  if (hosts[first]->available.load() != hosts[second]->available.load()) {
+    return hosts[first]->available.load() ? first : second;
+  }
+  return updateScore(*hosts[second]) < updateScore(*hosts[first]) ? second : first;
+}
+
+void
+NextHopRoundRobin::recordResponseTime(TSHttpTxn txnp, ink_hrtime elapsed)
+{
+  HttpSM     *sm   = reinterpret_cast<HttpSM *>(txnp);
+  HostRecord *host = sm->t_state.parent_result.inflight_host;
+
+  if (policy_type != NHPolicyType::LEAST_LATENCY || host == nullptr) {
+    return;
+  }
+
+  // concurrent updates may lose a sample, the average does not need to be exact.
+  int64_t sample  = std::max<int64_t>(ink_hrtime_to_usec(elapsed), 1);
+  int64_t average = host->latency.load(std::memory_order_relaxed);
+  if (average == 0) {
+    average = sample;
+  } else {
+    average += static_cast<int64_t>(ewma_weight * (sample - average));
+  }
+  host->latency.store(std::max<int64_t>(average, 1), std::memory_order_relaxed);
+  updateScore(*host);
+
+  NH_Dbg(NH_DBG_CTL, "[%" PRIu64 "] %s responded in %" PRId64 "us, average %" PRId64 "us", sm->sm_id, host->hostname.c_str(), sample,
+         average);
+}
@@ -40,8 +40,14 @@ constexpr std::string_view peering_rings   = "peering_ring";
 constexpr std::string_view active_health_check  = "active";
 constexpr std::string_view passive_health_check = "passive";
 
-constexpr const char *policy_strings[] = {"NHPolicyType::UNDEFINED", "NHPolicyType::FIRST_LIVE", "NHPolicyType::RR_STRICT",
-                                          "NHPolicyType::RR_IP",     "NHPolicyType::RR_LATCHED", "NHPolicyType::CONSISTENT_HASH"};
+// active health check type strings
+constexpr std::string_view http_health_check = "http";
+constexpr std::string_view tcp_health_check  = "tcp";
+constexpr std::string_view tls_health_check  = "tls";
+
+constexpr const char *policy_strings[] = {"NHPolicyType::UNDEFINED",       "NHPolicyType::FIRST_LIVE", "NHPolicyType::RR_STRICT",
+                                          "NHPolicyType::RR_IP",           "NHPolicyType::RR_LATCHED", "NHPolicyType::CONSISTENT_HASH",
+                                          "NHPolicyType::LEAST_LATENCY"};
 
 NextHopSelectionStrategy::NextHopSelectionStrategy(const std::string_view &name, const NHPolicyType &policy, ts::Yaml::Map &n)
   : strategy_name(name), policy_type(policy)
@@ -177,6 +183,40 @@ NextHopSelectionStrategy::NextHopSelectionStrategy(const std::string_view &name,
           }
         }
       }
+      YAML::Node active_check_node_n = failover_node["active_health_check"];
+      if (active_check_node_n) {
+        ts::Yaml::Map active_check_node{active_check_node_n};
+        auto          type_val = active_check_node["type"] ? active_check_node["type"].Scalar() : std::string{http_health_check};
+        if (type_val == http_health_check) {
+          health_checks.type = NHHealthCheckType::HTTP;
+        } else if (type_val == tcp_health_check) {
+          health_checks.type = NHHealthCheckType::TCP;
+        } else if (type_val == tls_health_check) {
+          health_checks.type = NHHealthCheckType::TLS;
+        } else {
+          NH_Error("Invalid active health check type '%s' for the strategy named '%s', skipping active health checks.",
+                   type_val.c_str(), strategy_name.c_str());
+        }
+        auto positive = [&](std::string_view key, int &value) {
+          if (active_check_node[key]) {
+            int val = active_check_node[key].as<int>();
+            if (val > 0) {
+              value = val;
+            } else {
+              NH_Note("Invalid active health check %.*s '%d' for the strategy named '%s', using %d.", static_cast<int>(key.size()),
+                      key.data(), val, strategy_name.c_str(), value);
+            }
+          }
+        };
+        positive("interval", health_checks.interval);
+        positive("timeout", health_checks.timeout);
+        positive("healthy_threshold", health_checks.healthy_threshold);
+        positive("unhealthy_threshold", health_checks.unhealthy_threshold);
+        active_check_node.done();
+        if (health_checks.type != NHHealthCheckType::NONE) {
+          health_checks.active = true;
+        }
+      }
       failover_node.done();
     }
 
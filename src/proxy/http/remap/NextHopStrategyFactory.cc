@@ -44,6 +44,7 @@ NextHopStrategyFactory::NextHopStrategyFactory(const char *file) : fn(file)
   constexpr std::string_view rr_strict       = "rr_strict";
   constexpr std::string_view rr_ip           = "rr_ip";
   constexpr std::string_view latched         = "latched";
+  constexpr std::string_view least_latency   = "least_latency";
 
   bool error_loading   = false;
   strategies_loaded    = true;
@@ -97,6 +98,8 @@ NextHopStrategyFactory::NextHopStrategyFactory(const char *file) : fn(file)
         policy_type = NHPolicyType::RR_IP;
       } else if (policy_value == latched) {
         policy_type = NHPolicyType::RR_LATCHED;
+      } else if (policy_value == least_latency) {
+        policy_type = NHPolicyType::LEAST_LATENCY;
       }
       if (policy_type == NHPolicyType::UNDEFINED) {
         NH_Error("Invalid policy '%s' for the strategy named '%s', this strategy will be ignored.", policy_value.c_str(),
@@ -124,6 +127,7 @@ done:
 NextHopStrategyFactory::~NextHopStrategyFactory()
 {
   NH_Dbg(NH_DBG_CTL, "destroying NextHopStrategyFactory");
+  stopActiveHealthChecks();
 
   for (auto &[_, ptr] : _strategies) {
     delete ptr;
@@ -145,7 +149,8 @@ NextHopStrategyFactory::createStrategy(const std::string &name, const NHPolicyTy
     case NHPolicyType::FIRST_LIVE:
     case NHPolicyType::RR_STRICT:
     case NHPolicyType::RR_IP:
-    case NHPolicyType::RR_LATCHED: {
+    case NHPolicyType::RR_LATCHED:
+    case NHPolicyType::LEAST_LATENCY: {
       NextHopRoundRobin *const strat_rr = new NextHopRoundRobin(name, policy_type, node);
       _strategies.emplace(std::make_pair(std::string(name), strat_rr));
       break;
@@ -0,0 +1,257 @@
+/** @file
+
+    Literal prefilter for the host expressions of regex_map rules
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "proxy/http/remap/RegexMappingIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <deque>
+
+namespace
+{
+/// Skip the character class that starts at @a i, @return the index of its closing bracket or @c npos.
+size_t
+skip_class(std::string_view pattern, size_t i)
+{
+  ++i;
+  if (i < pattern.size() && pattern[i] == '^') {
+    ++i;
+  }
+  if (i < pattern.size() && pattern[i] == ']') {
+    ++i;
+  }
+  for (; i < pattern.size(); ++i) {
+    if (pattern[i] == '\\') {
+      ++i;
+    } else if (pattern[i] == '[' && i + 1 < pattern.size() && pattern[i + 1] == ':') {
+      // POSIX class, [:alpha:]
+      if (i = pattern.find(":]", i + 2); i == std::string_view::npos) {
+        return i;
+      }
+      ++i;
+    } else if (pattern[i] == ']') {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+/// Skip the group that starts at @a i, @return the index of its closing parenthesis or @c npos.
+size_t
+skip_group(std::string_view pattern, size_t i)
+{
+  int depth = 0;
+  for (; i < pattern.size(); ++i) {
+    switch (pattern[i]) {
+    case '\\':
+      ++i;
+      break;
+    case '[':
+      if (i = skip_class(pattern, i); i == std::string_view::npos) {
+        return i;
+      }
+      break;
+    case '(':
+      ++depth;
+      break;
+    case ')':
+      if (--depth == 0) {
+        return i;
+      }
+      break;
+    }
+  }
+  return std::string_view::npos;
+}
+} // end anonymous namespace
+
+std::string
+RegexMappingIndex::required_literal(std::string_view pattern)
+{
+  std::string best;
+  std::string run;
+  auto        end_run = [&]() {
+    if (run.size() > best.size()) {
+      best = run;
+    }
+    run.clear();
+  };
+
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    char c = pattern[i];
+    switch (c) {
+    case '\\':
+      if (++i == pattern.size()) {
+        return {};
+      }
+      c = pattern[i];
+      if (!isalnum(static_cast<unsigned char>(c))) {
+        run += c;
+      } else if (strchr("dswbDSWB", c)) {
+        end_run();
+      } else {
+        // Escapes with arguments, back references, \Q quoting and so on.
+        return {};
+      }
+      break;
+    case '[':
+      end_run();
+      if (i = skip_class(pattern, i); i == std::string_view::npos) {
+        return {};
+      }
+      break;
+    case '(':
+      // Verbs and option settings can change what the rest of the expression matches.
+      if (i + 1 < pattern.size() && (pattern[i + 1] == '*' || (pattern[i + 1] == '?' && i + 2 < pattern.size() &&
+                                                                !strchr(":=!<>|", pattern[i + 2])))) {
+        return {};
+      }
+      end_run();
+      if (i = skip_group(pattern, i); i == std::string_view::npos) {
+        return {};
+      }
+      break;
+    case ')':
+    case '|':
+      return {};
+    case '?':
+    case '*':
+    case '{':
+      // The atom before an optional quantifier is not required.
+      if (!run.empty()) {
+        run.pop_back();
+      }
+      end_run();
+      if (c == '{' && (i = pattern.find('}', i)) == std::string_view::npos) {
+        return {};
+      }
+      break;
+    case '+':
+    case '.':
+    case '^':
+    case '$':
+      end_run();
+      break;
+    default:
+      run += c;
+      break;
+    }
+  }
+  end_run();
+
+  return best;
+}
+
+int
+RegexMappingIndex::_child(int node, char c) const
+{
+  for (auto const &[byte, child] : _nodes[node].next) {
+    if (byte == c) {
+      return child;
+    }
+  }
+  return -1;
+}
+
+void
+RegexMappingIndex::add(std::string_view pattern)
+{
+  int         rule    = _rules++;
+  std::string literal = required_literal(pattern);
+
+  _built = false;
+  if (literal.empty()) {
+    _unindexed.push_back(rule);
+    return;
+  }
+
+  int node = 0;
+  for (char c : literal) {
+    int child = _child(node, c);
+    if (child < 0) {
+      child = _nodes.size();
+      _nodes[node].next.emplace_back(c, child);
+      _nodes.emplace_back();
+    }
+    node = child;
+  }
+  _nodes[node].rules.push_back(rule);
+}
+
+void
+RegexMappingIndex::build()
+{
+  // Breadth first, so the fail node of a node is always done before it.
+  std::deque<int> queue;
+  for (auto const &[c, child] : _nodes[0].next) {
+    _nodes[child].fail = 0;
+    _nodes[child].dict = -1;
+    queue.push_back(child);
+  }
+  while (!queue.empty()) {
+    int node = queue.front();
+    queue.pop_front();
+    for (auto const &[c, child] : _nodes[node].next) {
+      int fail = _nodes[node].fail;
+      int next = _child(fail, c);
+      while (fail != 0 && next < 0) {
+        fail = _nodes[fail].fail;
+        next = _child(fail, c);
+      }
+      _nodes[child].fail = next < 0 ? 0 : next;
+      _nodes[child].dict = _nodes[_nodes[child].fail].rules.empty() ? _nodes[_nodes[child].fail].dict : _nodes[child].fail;
+      queue.push_back(child);
+    }
+  }
+  _built = true;
+}
+
+bool
+RegexMappingIndex::lookup(std::string_view host, Candidates &candidates) const
+{
+  if (!_built) {
+    return false;
+  }
+
+  // The rules are collected straight into @a candidates, so a caller that keeps it does not allocate.
+  candidates.clear();
+  int node = 0;
+  for (char c : host) {
+    int next = _child(node, c);
+    while (node != 0 && next < 0) {
+      node = _nodes[node].fail;
+      next = _child(node, c);
+    }
+    node = next < 0 ? 0 : next;
+    for (int n = _nodes[node].rules.empty() ? _nodes[node].dict : node; n > 0; n = _nodes[n].dict) {
+      candidates.insert(candidates.end(), _nodes[n].rules.begin(), _nodes[n].rules.end());
+    }
+  }
+
+  // Add the rules that are always tried, a rule can be found more than once.
+  candidates.insert(candidates.end(), _unindexed.begin(), _unindexed.end());
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  return true;
+}
@@ -28,6 +28,7 @@
 #include "tscore/Layout.h"
 #include "tscore/Filenames.h"
 #include "proxy/http/HttpSM.h"
+#include "proxy/http/remap/NextHopHealthCheck.h"
 
 #define modulePrefix "[ReverseProxy]"
 
@@ -36,6 +37,9 @@ namespace
 DbgCtl dbg_ctl_url_rewrite_regex{"url_rewrite_regex"};
 DbgCtl dbg_ctl_url_rewrite{"url_rewrite"};
 
+/// With fewer regex rules than this, trying every rule is as fast as finding the candidates.
+constexpr int REGEX_INDEX_MIN_RULES = 32;
+
 /**
   Determines where we are in a situation where a virtual path is
   being mapped to a server home page. If it is, we set a special flag
@@ -171,6 +175,26 @@ UrlRewrite::~UrlRewrite()
   /* Deactivate the factory when all SM are gone for sure. */
   pluginFactory.deactivate();
   delete strategyFactory;
+
+  if (_on_delete) {
+    _on_delete();
+  }
+}
+
+void
+UrlRewrite::start_health_checks()
+{
+  if (strategyFactory != nullptr) {
+    NextHopHealthCheck::start(*strategyFactory);
+  }
+}
+
+void
+UrlRewrite::stop_health_checks()
+{
+  if (strategyFactory != nullptr) {
+    strategyFactory->stopActiveHealthChecks();
+  }
 }
 
 /** Sets the reverse proxy flag. */
@@ -732,6 +756,8 @@ UrlRewrite::_addToStore(MappingsStore &store, url_mapping *new_mapping, RegexMap
   new_mapping->setRemapKey();  // Used for remap hit stats
   if (is_cur_mapping_regex) {
     store.regex_list.enqueue(reg_map);
+    store.regex_index.add(src_host);
+    store.regex_rules.push_back(reg_map);
     retval = true;
   } else {
     retval = TableInsert(store.hash_lookup, new_mapping, src_host);
@@ -839,6 +865,15 @@ UrlRewrite::BuildTable(const char *path)
     return TS_ERROR;
   }
 
+  for (auto store : {&forward_mappings, &reverse_mappings, &permanent_redirects, &temporary_redirects,
+                     &forward_mappings_with_recv_port}) {
+    if (store->regex_index.size() >= REGEX_INDEX_MIN_RULES) {
+      store->regex_index.build();
+      Dbg(dbg_ctl_url_rewrite_regex, "Indexed %d regex rules, %d without a literal", store->regex_index.size(),
+          store->regex_index.unindexed());
+    }
+  }
+
   // Destroy unused tables
   if (num_rules_forward == 0) {
     forward_mappings.hash_lookup.reset(nullptr);
@@ -938,7 +973,7 @@ UrlRewrite::_mappingLookup(MappingsStore &mappings, URL *request_url, int reques
     mapping_container.set(mapping);
     retval = true;
   }
-  if (_regexMappingLookup(mappings.regex_list, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
+  if (_regexMappingLookup(mappings, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
                           mapping_container)) {
     Dbg(dbg_ctl_url_rewrite, "Using regex mapping with rank %d", (mapping_container.getMapping())->getRank());
     retval = true;
@@ -998,7 +1033,7 @@ lOverFlow:
 }
 
 bool
-UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
+UrlRewrite::_regexMappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host,
                                 int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container)
 {
   bool         retval = false;
@@ -1019,9 +1054,19 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
     request_scheme = std::string_view{request_port == 80 ? URL_SCHEME_HTTP : URL_SCHEME_HTTPS};
   }
 
-  // Loop over the entire linked list, or until we're satisfied
-  forl_LL(RegexMapping, list_iter, regex_mappings)
-  {
+  // Only the rules whose host expression can match the request host have to be tried, in rule order.
+  static thread_local RegexMappingIndex::Candidates candidates;
+  bool const indexed      = mappings.regex_index.lookup({request_host, static_cast<size_t>(request_host_len)}, candidates);
+  size_t     next         = 0;
+  auto       next_mapping = [&](RegexMapping *current) -> RegexMapping * {
+    if (!indexed) {
+      return current ? current->link.next : mappings.regex_list.head;
+    }
+    return next < candidates.size() ? mappings.regex_rules[candidates[next++]] : nullptr;
+  };
+
+  // Loop over the candidates, or until we're satisfied
+  for (RegexMapping *list_iter = next_mapping(nullptr); list_iter != nullptr; list_iter = next_mapping(list_iter)) {
     int reg_map_rank = list_iter->url_map->getRank();
 
     if (reg_map_rank > rank_ceiling) {
@@ -0,0 +1,120 @@
+/** @file
+
+  Benchmark of finding the regex_map rule for a host as the number of rules grows
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <string>
+#include <vector>
+
+#include "proxy/http/remap/RegexMappingIndex.h"
+#include "tsutil/Regex.h"
+
+namespace
+{
+// Host expressions like the ones in regex_map rules, in the order they would be in remap.config.
+std::vector<std::string>
+host_patterns(int n)
+{
+  std::vector<std::string> patterns;
+  for (int i = 0; i < n; ++i) {
+    switch (i % 3) {
+    case 0:
+      patterns.push_back("^(.*)\\.site" + std::to_string(i) + "\\.example\\.com$");
+      break;
+    case 1:
+      patterns.push_back("^cdn[0-9]+\\.tenant" + std::to_string(i) + "\\.net$");
+      break;
+    default:
+      patterns.push_back("^(www|img|api)\\.brand" + std::to_string(i) + "\\.(com|org)$");
+      break;
+    }
+  }
+  return patterns;
+}
+} // namespace
+
+TEST_CASE("regex_map host lookup", "[remap][regex]")
+{
+  for (int n : {10, 100, 1000, 3000}) {
+    auto               patterns = host_patterns(n);
+    std::vector<Regex> regexes(n);
+    RegexMappingIndex  index;
+    for (int i = 0; i < n; ++i) {
+      REQUIRE(regexes[i].compile(patterns[i]));
+      index.add(patterns[i]);
+    }
+    index.build();
+
+    // One of the last rules, after nearly every other one has been tried, and a host that no rule matches.
+    int last = n - 1;
+    while (last % 3 != 1) {
+      --last;
+    }
+    std::string hit  = "cdn7.tenant" + std::to_string(last) + ".net";
+    std::string miss = "www.not-mapped.example.org";
+
+    auto every_rule = [&](std::string_view host) {
+      RegexMatches matches;
+      for (int i = 0; i < n; ++i) {
+        if (regexes[i].exec(host, matches) > 0) {
+          return i;
+        }
+      }
+      return -1;
+    };
+    RegexMappingIndex::Candidates candidates;
+    auto                          indexed = [&](std::string_view host) {
+      RegexMatches matches;
+      index.lookup(host, candidates);
+      for (int i : candidates) {
+        if (regexes[i].exec(host, matches) > 0) {
+          return i;
+        }
+      }
+      return -1;
+    };
+    REQUIRE(every_rule(hit) == last);
+    REQUIRE(indexed(hit) == last);
+    REQUIRE(every_rule(miss) == -1);
+    REQUIRE(indexed(miss) == -1);
+
+    BENCHMARK("every rule, miss, " + std::to_string(n) + " rules")
+    {
+      return every_rule(miss);
+    };
+    BENCHMARK("indexed, miss, " + std::to_string(n) + " rules")
+    {
+      return indexed(miss);
+    };
+    BENCHMARK("every rule, late hit, " + std::to_string(n) + " rules")
+    {
+      return every_rule(hit);
+    };
+    BENCHMARK("indexed, late hit, " + std::to_string(n) + " rules")
+    {
+      return indexed(hit);
+    };
+  }
+}
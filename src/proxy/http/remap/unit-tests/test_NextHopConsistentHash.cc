@@ -29,6 +29,11 @@
 #include <catch2/catch_test_macros.hpp> /* catch unit-test framework */
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+
 #include "proxy/http/HttpSM.h"
 #include "nexthop_test_stubs.h"
 #include "proxy/http/remap/NextHopSelectionStrategy.h"
@@ -660,3 +665,223 @@ SCENARIO("Testing NextHopConsistentHash using a peering ring_mode.")
     }
   }
 }
+
+SCENARIO("Testing NextHopConsistentHash with bounded loads", "[NextHopConsistentHash]")
+{
+  // We need this to build a HdrHeap object in build_request();
+  // No thread setup, forbid use of thread local allocators.
+  cmd_disable_pfreelist = true;
+  // Get all of the HTTP WKS items populated.
+  http_init();
+
+  GIVEN("Loading the consistent-hash-tests.yaml config for 'consistent_hash' tests.")
+  {
+    NextHopStrategyFactory          nhf(TS_SRC_DIR "/consistent-hash-tests.yaml");
+    NextHopSelectionStrategy *const strategy = nhf.strategyInstance("bounded-load");
+
+    WHEN("requests for the same path are in flight.")
+    {
+      THEN("no host takes more than its bound and they are released.")
+      {
+        HttpSM        sm;
+        ParentResult *result = &sm.t_state.parent_result;
+        TSHttpTxn     txnp   = reinterpret_cast<TSHttpTxn>(&sm);
+
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+        auto *chash = dynamic_cast<NextHopConsistentHash *>(strategy);
+        REQUIRE(chash != nullptr);
+        CHECK(chash->hash_selection == NHHashSelection::BOUNDED_LOAD);
+        CHECK(chash->load_factor == 1.25);
+
+        auto const &hosts = strategy->host_groups[0];
+
+        // every request hashes to the same host, leave each one in flight.
+        for (int i = 0; i < 40; i++) {
+          build_request(40000 + i, &sm, nullptr, "rabbit.net", nullptr);
+          result->reset();
+          strategy->findNextHop(txnp);
+          REQUIRE(result->result == ParentResultType::SPECIFIED);
+
+          int total = 0;
+          for (auto const &host : hosts) {
+            total += host->inflight;
+          }
+          CHECK(total == i + 1);
+          for (auto const &host : hosts) {
+            CHECK(host->inflight <= std::ceil(1.25 * total / hosts.size()));
+          }
+        }
+        // the ring alone would have put all 40 on one host, a skew of 400%.
+        int most = 0;
+        for (auto const &host : hosts) {
+          most = std::max(most, host->inflight.load());
+        }
+        CHECK(most <= 13);
+
+        ts::Metrics::IdType id;
+        auto               *skew = ts::Metrics::Gauge::lookup("proxy.process.http.next_hop.bounded-load.load_skew", &id);
+        REQUIRE(skew != nullptr);
+        CHECK(ts::Metrics::Gauge::load(skew) == most * 100 * 4 / 40);
+
+        // a retry gives back the host it had, finishing gives back the last one.
+        build_request(40100, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp);
+        REQUIRE(result->result == ParentResultType::SPECIFIED);
+        std::string first = result->hostname;
+        strategy->markNextHop(txnp, result->hostname, result->port, NHCmd::MARK_DOWN);
+        strategy->findNextHop(txnp);
+        REQUIRE(result->result == ParentResultType::SPECIFIED);
+        CHECK(first != result->hostname);
+
+        int total = 0;
+        for (auto const &host : hosts) {
+          total += host->inflight;
+        }
+        CHECK(total == 41);
+        NextHopSelectionStrategy::releaseNextHop(*result);
+        NextHopSelectionStrategy::releaseNextHop(*result);
+        total = 0;
+        for (auto const &host : hosts) {
+          total += host->inflight;
+        }
+        CHECK(total == 40);
+
+        // free up request resources.
+        br_destroy(sm);
+      }
+    }
+  }
+}
+
+SCENARIO("Testing NextHopConsistentHash load skew over several groups", "[NextHopConsistentHash]")
+{
+  // We need this to build a HdrHeap object in build_request();
+  // No thread setup, forbid use of thread local allocators.
+  cmd_disable_pfreelist = true;
+  // Get all of the HTTP WKS items populated.
+  http_init();
+
+  GIVEN("Loading the consistent-hash-tests.yaml config for 'consistent_hash' tests.")
+  {
+    NextHopStrategyFactory          nhf(TS_SRC_DIR "/consistent-hash-tests.yaml");
+    NextHopSelectionStrategy *const strategy = nhf.strategyInstance("consistent-hash-1");
+
+    WHEN("a group other than the one selected from is skewed.")
+    {
+      THEN("the gauge reports the most skewed group.")
+      {
+        HttpSM        sm;
+        ParentResult *result = &sm.t_state.parent_result;
+        TSHttpTxn     txnp   = reinterpret_cast<TSHttpTxn>(&sm);
+
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+
+        // the first group is even, the last one has 9 of its 10 transactions on one of its two hosts.
+        for (auto const &host : strategy->host_groups[0]) {
+          host->inflight = 5;
+        }
+        strategy->host_groups[2][0]->inflight = 9;
+        strategy->host_groups[2][1]->inflight = 1;
+
+        build_request(60000, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp);
+        REQUIRE(result->result == ParentResultType::SPECIFIED);
+        std::string host = result->hostname;
+        CHECK((host == "p1.foo.com" || host == "p2.foo.com"));
+
+        ts::Metrics::IdType id;
+        auto               *skew = ts::Metrics::Gauge::lookup("proxy.process.http.next_hop.consistent-hash-1.load_skew", &id);
+        REQUIRE(skew != nullptr);
+        // 180 for the last group, the first one is at 6 / 0.5 / 11 = 109.
+        CHECK(ts::Metrics::Gauge::load(skew) == 180);
+
+        NextHopSelectionStrategy::releaseNextHop(*result);
+        br_destroy(sm);
+      }
+    }
+  }
+}
+
+SCENARIO("Testing NextHopConsistentHash with a maglev table", "[NextHopConsistentHash]")
+{
+  // We need this to build a HdrHeap object in build_request();
+  // No thread setup, forbid use of thread local allocators.
+  cmd_disable_pfreelist = true;
+  // Get all of the HTTP WKS items populated.
+  http_init();
+
+  GIVEN("Loading the consistent-hash-tests.yaml config for 'consistent_hash' tests.")
+  {
+    NextHopStrategyFactory          nhf(TS_SRC_DIR "/consistent-hash-tests.yaml");
+    NextHopSelectionStrategy *const strategy = nhf.strategyInstance("maglev");
+    NextHopSelectionStrategy *const smaller  = nhf.strategyInstance("maglev-less-one");
+
+    WHEN("requests are received for many paths.")
+    {
+      THEN("they are spread by weight, and removing a host only moves its own paths.")
+      {
+        HttpSM        sm;
+        ParentResult *result = &sm.t_state.parent_result;
+        TSHttpTxn     txnp   = reinterpret_cast<TSHttpTxn>(&sm);
+
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+        REQUIRE(smaller != nullptr);
+        auto *chash = dynamic_cast<NextHopConsistentHash *>(strategy);
+        REQUIRE(chash != nullptr);
+        CHECK(chash->hash_selection == NHHashSelection::MAGLEV);
+        CHECK(chash->maglev_table_size == 1009);
+
+        auto select = [&](NextHopSelectionStrategy *s, std::string const &path) {
+          build_request(50000, &sm, nullptr, "rabbit.net", nullptr);
+          sm.t_state.request_data.hdr->url_get()->path_set(path);
+          result->reset();
+          s->findNextHop(txnp);
+          REQUIRE(result->result == ParentResultType::SPECIFIED);
+          std::string host = result->hostname;
+          NextHopSelectionStrategy::releaseNextHop(*result);
+          return host;
+        };
+
+        std::map<std::string, int> counts;
+        int                        moved = 0;
+        int const                  paths = 3000;
+        for (int i = 0; i < paths; i++) {
+          std::string path = "asset" + std::to_string(i);
+          std::string host = select(strategy, path);
+          counts[host]++;
+          CHECK(select(strategy, path) == host);
+          if (host != "m3.foo.com" && select(smaller, path) != host) {
+            moved++;
+          }
+        }
+        CHECK(counts.size() == 3);
+        CHECK(counts["m3.foo.com"] > paths * 0.4);
+        CHECK(counts["m3.foo.com"] < paths * 0.6);
+        CHECK(counts["m1.foo.com"] > paths * 0.15);
+        CHECK(counts["m2.foo.com"] > paths * 0.15);
+        CHECK(moved < paths / 20);
+
+        // the first choice is down, a retry walks the ring.
+        build_request(50001, &sm, nullptr, "rabbit.net", nullptr);
+        sm.t_state.request_data.hdr->url_get()->path_set("asset1");
+        result->reset();
+        strategy->findNextHop(txnp);
+        REQUIRE(result->result == ParentResultType::SPECIFIED);
+        std::string first = result->hostname;
+        strategy->markNextHop(txnp, result->hostname, result->port, NHCmd::MARK_DOWN);
+        strategy->findNextHop(txnp);
+        REQUIRE(result->result == ParentResultType::SPECIFIED);
+        CHECK(first != result->hostname);
+        NextHopSelectionStrategy::releaseNextHop(*result);
+
+        // free up request resources.
+        br_destroy(sm);
+      }
+    }
+  }
+}
@@ -29,11 +29,15 @@
 #include <catch2/catch_test_macros.hpp> /* catch unit-test framework */
 #include <yaml-cpp/yaml.h>
 
+#include <map>
+#include <string>
+
 #include "proxy/http/HttpSM.h"
 #include "nexthop_test_stubs.h"
 #include "proxy/http/remap/NextHopSelectionStrategy.h"
 #include "proxy/http/remap/NextHopStrategyFactory.h"
 #include "proxy/http/remap/NextHopRoundRobin.h"
+#include "tscore/Random.h"
 
 SCENARIO("Testing NextHopRoundRobin class, using policy 'rr-strict'", "[NextHopRoundRobin]")
 {
@@ -379,3 +383,111 @@ SCENARIO("Testing NextHopRoundRobin class, using policy 'latched'", "[NextHopRou
     }
   }
 }
+
+SCENARIO("Testing NextHopRoundRobin class, using policy 'least_latency'", "[NextHopRoundRobin]")
+{
+  // We need this to build a HdrHeap object in build_request();
+  // No thread setup, forbid use of thread local allocators.
+  cmd_disable_pfreelist = true;
+  // Get all of the HTTP WKS items populated.
+  http_init();
+
+  GIVEN("Loading the round-robin-tests.yaml config for 'least_latency' tests.")
+  {
+    NextHopStrategyFactory          nhf(TS_SRC_DIR "/round-robin-tests.yaml");
+    NextHopSelectionStrategy *const strategy = nhf.strategyInstance("least-latency");
+    HttpSM                          sm;
+    ParentResult                   *result = &sm.t_state.parent_result;
+    TSHttpTxn                       txnp   = reinterpret_cast<TSHttpTxn>(&sm);
+
+    ts::Random::seed(42);
+
+    WHEN("the config is loaded.")
+    {
+      THEN("then the 'least_latency' strategy is ready.")
+      {
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+        REQUIRE(strategy->policy_type == NHPolicyType::LEAST_LATENCY);
+        CHECK(dynamic_cast<NextHopRoundRobin *>(strategy)->ewma_weight == 0.5);
+      }
+    }
+
+    WHEN("requests are left in flight.")
+    {
+      THEN("they are spread over the hosts of the first group.")
+      {
+        REQUIRE(strategy != nullptr);
+        std::map<std::string, int> counts;
+        for (int i = 0; i < 30; i++) {
+          build_request(20000 + i, &sm, nullptr, "rabbit.net", nullptr);
+          result->reset();
+          strategy->findNextHop(txnp);
+          REQUIRE(result->result == ParentResultType::SPECIFIED);
+          counts[result->hostname]++;
+        }
+        CHECK(counts.size() == 3);
+        for (auto const &host : strategy->host_groups[0]) {
+          CAPTURE(host->hostname);
+          CHECK(host->inflight >= 8);
+          CHECK(host->inflight <= 12);
+        }
+        CHECK(strategy->host_groups[1][0]->inflight == 0);
+      }
+    }
+
+    WHEN("one host responds slowly.")
+    {
+      THEN("it stops being selected, and a failure selects another host.")
+      {
+        REQUIRE(strategy != nullptr);
+        auto respond = [&](int64_t sm_id) {
+          build_request(sm_id, &sm, nullptr, "rabbit.net", nullptr);
+          result->reset();
+          strategy->findNextHop(txnp);
+          REQUIRE(result->result == ParentResultType::SPECIFIED);
+          std::string host = result->hostname;
+          strategy->recordResponseTime(txnp, host == "l1.foo.com" ? HRTIME_MSECONDS(500) : HRTIME_MSECONDS(5));
+          NextHopSelectionStrategy::releaseNextHop(*result);
+          return host;
+        };
+
+        // until every host has a response time.
+        for (int i = 0; i < 30; i++) {
+          respond(21000 + i);
+        }
+        CHECK(strategy->host_groups[0][0]->latency > 400000);
+        CHECK(strategy->host_groups[0][1]->latency < 10000);
+
+        // the slowest of three can not win against either of the others.
+        std::map<std::string, int> counts;
+        for (int i = 0; i < 100; i++) {
+          counts[respond(22000 + i)]++;
+        }
+        CHECK(counts["l1.foo.com"] == 0);
+        CHECK(counts["l2.foo.com"] > 20);
+        CHECK(counts["l3.foo.com"] > 20);
+
+        ts::Metrics::IdType id;
+        auto *slow = ts::Metrics::Gauge::lookup("proxy.process.http.next_hop.least-latency.l1.foo.com.score", &id);
+        auto *fast = ts::Metrics::Gauge::lookup("proxy.process.http.next_hop.least-latency.l2.foo.com.score", &id);
+        REQUIRE(slow != nullptr);
+        REQUIRE(fast != nullptr);
+        CHECK(ts::Metrics::Gauge::load(slow) > ts::Metrics::Gauge::load(fast));
+
+        // a failed host is left for the next in the group, per the ring mode.
+        build_request(23000, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp);
+        REQUIRE(result->result == ParentResultType::SPECIFIED);
+        std::string first = result->hostname;
+        strategy->markNextHop(txnp, result->hostname, result->port, NHCmd::MARK_DOWN);
+        strategy->findNextHop(txnp);
+        REQUIRE(result->result == ParentResultType::SPECIFIED);
+        CHECK(first != result->hostname);
+        NextHopSelectionStrategy::releaseNextHop(*result);
+      }
+    }
+    br_destroy(sm);
+  }
+}
@@ -34,6 +34,7 @@
 
 #include "nexthop_test_stubs.h"
 #include "proxy/http/remap/NextHopSelectionStrategy.h"
+#include "proxy/http/remap/NextHopHealthCheck.h"
 #include "proxy/http/remap/NextHopStrategyFactory.h"
 #include "proxy/http/remap/NextHopConsistentHash.h"
 #include "proxy/http/remap/NextHopRoundRobin.h"
@@ -628,6 +629,19 @@ SCENARIO("factory tests loading yaml configs", "[loadConfig]")
         CHECK(!strategy->resp_codes.contains(604));
         CHECK(strategy->health_checks.active == true);
         CHECK(strategy->health_checks.passive == false);
+        CHECK(strategy->health_checks.type == NHHealthCheckType::HTTP);
+        CHECK(strategy->health_checks.interval == 10);
+        CHECK(strategy->health_checks.timeout == 1);
+        CHECK(strategy->health_checks.healthy_threshold == 2);
+        CHECK(strategy->health_checks.unhealthy_threshold == 2);
+
+        // the https protocol and its health_check_url are checked.
+        NHHealthCheckTarget target;
+        REQUIRE(target.init(*strategy->host_groups[0][0], strategy->scheme, strategy->health_checks.type));
+        CHECK(target.host == "192.168.1.1");
+        CHECK(target.port == 443);
+        CHECK(target.path == "/");
+        CHECK(target.tls == true);
         std::shared_ptr<HostRecord> h = strategy->host_groups[0][0];
         CHECK(h != nullptr);
         for (unsigned int i = 0; i < strategy->groups; i++) {
@@ -714,6 +728,7 @@ SCENARIO("factory tests loading yaml configs", "[loadConfig]")
         CHECK(!strategy->resp_codes.contains(604));
         CHECK(strategy->health_checks.active == true);
         CHECK(strategy->health_checks.passive == false);
+        CHECK(strategy->health_checks.type == NHHealthCheckType::NONE);
         std::shared_ptr<HostRecord> h = strategy->host_groups[0][0];
         CHECK(h != nullptr);
         for (unsigned int i = 0; i < strategy->groups; i++) {
@@ -956,3 +971,98 @@ SCENARIO("factory tests loading yaml configs from a directory", "[loadConfig]")
     }
   }
 }
+
+SCENARIO("active health check targets and thresholds", "[healthCheck]")
+{
+  GIVEN("a host with http and https protocols")
+  {
+    HostRecordCfg cfg;
+    cfg.hostname = "p1.foo.com";
+    cfg.protocols.push_back(std::make_shared<NHProtocol>(NHProtocol{NHSchemeType::HTTP, 8080, ""}));
+    cfg.protocols.push_back(std::make_shared<NHProtocol>(NHProtocol{NHSchemeType::HTTPS, 8443, "https://10.0.0.1/health?x=1"}));
+    HostRecord host(std::move(cfg));
+
+    WHEN("the targets are set up")
+    {
+      THEN("the protocol for the strategy scheme and its health_check_url are used")
+      {
+        NHHealthCheckTarget target;
+        REQUIRE(target.init(host, NHSchemeType::HTTP, NHHealthCheckType::HTTP));
+        CHECK(target.host == "p1.foo.com");
+        CHECK(target.port == 8080);
+        CHECK(target.path == "/");
+        CHECK(target.tls == false);
+
+        REQUIRE(target.init(host, NHSchemeType::HTTPS, NHHealthCheckType::HTTP));
+        CHECK(target.host == "10.0.0.1");
+        CHECK(target.port == 443);
+        CHECK(target.path == "/health?x=1");
+        CHECK(target.tls == true);
+
+        NHHealthCheckTarget tcp;
+        REQUIRE(tcp.init(host, NHSchemeType::HTTPS, NHHealthCheckType::TCP));
+        CHECK(tcp.tls == false);
+        CHECK(tcp.key() != target.key());
+
+        NHHealthCheckTarget tls;
+        REQUIRE(tls.init(host, NHSchemeType::NONE, NHHealthCheckType::TLS));
+        CHECK(tls.host == "p1.foo.com");
+        CHECK(tls.port == 8080);
+        CHECK(tls.tls == true);
+        CHECK(!tls.init(host, NHSchemeType::HTTP, NHHealthCheckType::NONE));
+      }
+      THEN("health_check_urls are parsed")
+      {
+        NHHealthCheckTarget target;
+        REQUIRE(target.parse_url("http://[::1]:8081/ping"));
+        CHECK(target.host == "::1");
+        CHECK(target.port == 8081);
+        CHECK(target.path == "/ping");
+        REQUIRE(target.parse_url("tls://origin.example.com"));
+        CHECK(target.host == "origin.example.com");
+        CHECK(target.port == 443);
+        CHECK(target.tls == true);
+        CHECK(!target.parse_url("ftp://origin.example.com"));
+        CHECK(!target.parse_url("http://origin.example.com:http/"));
+        CHECK(!target.parse_url("http://[::1/"));
+        CHECK(!target.parse_url("http:///health"));
+      }
+    }
+  }
+
+  GIVEN("a counter that marks hosts up after 2 passed checks and down after 3 failed checks")
+  {
+    NHHealthCheckCounter counter(2, 3);
+    using State = NHHealthCheckCounter::State;
+
+    THEN("the state changes only when a threshold is reached")
+    {
+      CHECK(counter.state() == State::UNKNOWN);
+      CHECK(!counter.record(true));
+      CHECK(counter.record(true));
+      CHECK(counter.state() == State::UP);
+      CHECK(!counter.record(true));
+
+      // failures that are not consecutive do not count.
+      CHECK(!counter.record(false));
+      CHECK(!counter.record(false));
+      CHECK(!counter.record(true));
+      CHECK(!counter.record(false));
+      CHECK(!counter.record(false));
+      CHECK(counter.record(false));
+      CHECK(counter.state() == State::DOWN);
+      CHECK(!counter.record(false));
+
+      CHECK(!counter.record(true));
+      CHECK(counter.record(true));
+      CHECK(counter.state() == State::UP);
+    }
+    THEN("a host can be found down from the start")
+    {
+      CHECK(!counter.record(false));
+      CHECK(!counter.record(false));
+      CHECK(counter.record(false));
+      CHECK(counter.state() == State::DOWN);
+    }
+  }
+}
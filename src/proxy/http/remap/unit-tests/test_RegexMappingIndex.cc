@@ -0,0 +1,116 @@
+/** @file
+
+  Unit tests for RegexMappingIndex
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "proxy/http/remap/RegexMappingIndex.h"
+#include "tsutil/Regex.h"
+
+TEST_CASE("RegexMappingIndex required literal", "[proxy][remap][regex]")
+{
+  CHECK(RegexMappingIndex::required_literal("^(.*)\\.example\\.com$") == ".example.com");
+  CHECK(RegexMappingIndex::required_literal("^cdn[0-9]+\\.tenant1\\.net$") == ".tenant1.net");
+  CHECK(RegexMappingIndex::required_literal("^(www|img)\\.brand2\\.(com|org)$") == ".brand2.");
+  CHECK(RegexMappingIndex::required_literal("www\\.example\\.com") == "www.example.com");
+  CHECK(RegexMappingIndex::required_literal("origin-?abc\\.net") == "abc.net");
+  CHECK(RegexMappingIndex::required_literal("ab*cdef") == "cdef");
+  CHECK(RegexMappingIndex::required_literal("abc+d") == "abc");
+  CHECK(RegexMappingIndex::required_literal("x[[:alpha:]]yz") == "yz");
+  CHECK(RegexMappingIndex::required_literal("ab{2}cde") == "cde");
+  CHECK(RegexMappingIndex::required_literal("host\\d\\.example") == ".example");
+
+  // Nothing that every match has to contain.
+  CHECK(RegexMappingIndex::required_literal("").empty());
+  CHECK(RegexMappingIndex::required_literal(".*").empty());
+  CHECK(RegexMappingIndex::required_literal("a\\.com|b\\.org").empty());
+  CHECK(RegexMappingIndex::required_literal("(?i)example\\.com").empty());
+  CHECK(RegexMappingIndex::required_literal("(*ACCEPT)example\\.com").empty());
+  CHECK(RegexMappingIndex::required_literal("(a)\\1\\.example\\.com").empty());
+  CHECK(RegexMappingIndex::required_literal("\\x41\\.example\\.com").empty());
+  CHECK(RegexMappingIndex::required_literal("\\Qa.b\\E").empty());
+}
+
+TEST_CASE("RegexMappingIndex lookup", "[proxy][remap][regex]")
+{
+  std::vector<std::string> patterns = {
+    "^(.*)\\.example\\.com$",           // 0
+    ".*",                               // 1, always tried
+    "^cdn[0-9]+\\.example\\.com$",      // 2
+    "^(www|img)\\.brand\\.(com|org)$",  // 3
+    "^ample\\.co",                      // 4, a suffix of another literal
+    "foo|bar",                          // 5, always tried
+    "^api\\.(.*)\\.example\\.com\\.au", // 6
+  };
+  std::vector<std::string> hosts = {
+    "www.example.com", "cdn12.example.com", "img.brand.org", "ample.com", "api.x.example.com.au", "nothing.test", "", "e",
+  };
+
+  RegexMappingIndex  index;
+  RegexMappingIndex::Candidates none;
+  REQUIRE(!index.lookup("www.example.com", none));
+
+  std::vector<Regex> regexes(patterns.size());
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    REQUIRE(regexes[i].compile(patterns[i]));
+    index.add(patterns[i]);
+  }
+  REQUIRE(!index.lookup("www.example.com", none));
+  index.build();
+  CHECK(index.size() == static_cast<int>(patterns.size()));
+  CHECK(index.unindexed() == 2);
+
+  for (auto const &host : hosts) {
+    CAPTURE(host);
+    RegexMappingIndex::Candidates candidates;
+    REQUIRE(index.lookup(host, candidates));
+
+    // Every rule that matches is a candidate, and candidates are in rule order.
+    for (size_t i = 1; i < candidates.size(); ++i) {
+      CHECK(candidates[i - 1] < candidates[i]);
+    }
+    for (size_t i = 0; i < regexes.size(); ++i) {
+      if (regexes[i].exec(host)) {
+        CAPTURE(i);
+        CHECK(std::find(candidates.begin(), candidates.end(), static_cast<int>(i)) != candidates.end());
+      }
+    }
+  }
+
+  RegexMappingIndex::Candidates candidates;
+  REQUIRE(index.lookup("nothing.test", candidates));
+  CHECK(candidates.size() == 2);
+  CHECK(candidates[0] == 1);
+  CHECK(candidates[1] == 5);
+
+  RegexMappingIndex::Candidates example;
+  REQUIRE(index.lookup("api.x.example.com.au", example));
+  CHECK(std::vector<int>(example.begin(), example.end()) == std::vector<int>{0, 1, 2, 4, 5, 6});
+
+  // The candidates of an earlier lookup are replaced.
+  REQUIRE(index.lookup("nothing.test", example));
+  CHECK(std::vector<int>(example.begin(), example.end()) == std::vector<int>{1, 5});
+}
@@ -224,4 +224,38 @@ map_with_recv_port http://front.example.com \
       REQUIRE(urlrw->forwardMappingWithRecvPortLookup(&url.url, 0, host, strlen(host), urlmap) == false);
     }
   }
+  GIVEN("regex_map rules that can match the same host")
+  {
+    std::unique_ptr<UrlRewrite> urlrw = std::make_unique<UrlRewrite>();
+
+    std::string config = R"RMCFG(
+regex_map http://^(.*)\.a\.example\.com$ http://$1.origin-a.example.com
+regex_map http://^www\.(.*)\.example\.com$ http://origin-www.example.com
+regex_map https://^cdn[0-9]+\.b\.example\.com$ https://origin-b-tls.example.com
+regex_map http://^cdn[0-9]+\.b\.example\.com$ http://origin-b.example.com
+regex_map http://.* http://fallback.example.com
+  )RMCFG";
+
+    auto cpath = write_test_remap(config, "regex-order");
+    int  rc    = urlrw->BuildTable(cpath.c_str());
+
+    auto remapped_host = [&](std::string_view host) -> std::string {
+      EasyURL             url("http://" + std::string(host) + "/");
+      UrlMappingContainer urlmap;
+      if (!urlrw->forwardMappingLookup(&url.url, 80, host.data(), host.size(), urlmap)) {
+        return "";
+      }
+      return std::string(urlmap.getToURL()->host_get());
+    };
+
+    THEN("the first rule in the file that matches wins")
+    {
+      REQUIRE(rc == TS_SUCCESS);
+      REQUIRE(urlrw->rule_count() == 5);
+      CHECK(remapped_host("www.a.example.com") == "www.origin-a.example.com");
+      CHECK(remapped_host("www.c.example.com") == "origin-www.example.com");
+      CHECK(remapped_host("cdn7.b.example.com") == "origin-b.example.com");
+      CHECK(remapped_host("other.test") == "fallback.example.com");
+    }
+  }
 }
@@ -0,0 +1,178 @@
+/** @file
+
+  Throughput benchmark of the chunked transfer coding in ChunkedHandler
+
+  Reports the body bytes per second a single thread dechunks, chunks and validates in passthru mode.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/Layout.h"
+#include "iocore/eventsystem/EventSystem.h"
+#include "records/RecordsConfig.h"
+
+#include "proxy/http/HttpTunnel.h"
+
+#include "iocore/utils/diags.i"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Write @a body_size bytes as chunks of @a chunk_size to @a buf.
+void
+write_chunked(MIOBuffer *buf, int64_t body_size, int64_t chunk_size)
+{
+  std::string chunk(chunk_size, 'x');
+  char        header[32];
+
+  for (int64_t left = body_size; left > 0; left -= chunk_size) {
+    int64_t n   = std::min(left, chunk_size);
+    int     len = snprintf(header, sizeof(header), "%" PRIx64 "\r\n", n);
+    buf->write(header, len);
+    buf->write(chunk.data(), n);
+    buf->write("\r\n", 2);
+  }
+  buf->write("0\r\n\r\n", 5);
+}
+
+// @return The time to run @a action over @a input @a iterations times.
+double
+run(IOBufferReader *input, ChunkedHandler::Action action, int64_t max_chunk_size, int iterations)
+{
+  auto start = Clock::now();
+
+  for (int i = 0; i < iterations; ++i) {
+    ChunkedHandler handler;
+    handler.init_by_action(input, action, false, true);
+
+    IOBufferReader *out = nullptr;
+    bool            done;
+    if (action == ChunkedHandler::Action::DOCHUNK) {
+      handler.state = ChunkedHandler::ChunkedState::WRITE_CHUNK;
+      handler.set_max_chunk_size(max_chunk_size);
+      handler.last_server_event = VC_EVENT_READ_COMPLETE;
+      out                       = handler.chunked_buffer->alloc_reader();
+      done                      = handler.generate_chunked_content().second;
+    } else {
+      handler.state = ChunkedHandler::ChunkedState::READ_SIZE;
+      if (action == ChunkedHandler::Action::DECHUNK) {
+        out = handler.dechunked_buffer->alloc_reader();
+      }
+      done = handler.process_chunked_content().second && handler.state == ChunkedHandler::ChunkedState::READ_DONE;
+    }
+    if (!done) {
+      fprintf(stderr, "Processing failed\n");
+      exit(1);
+    }
+    if (out) {
+      out->consume(out->read_avail());
+    }
+
+    // The handler reads through a clone of the input reader, drop it so the input can be read again.
+    IOBufferReader *clone = action == ChunkedHandler::Action::DOCHUNK ? handler.dechunked_reader : handler.chunked_reader;
+    input->mbuf->dealloc_reader(clone);
+    handler.clear();
+  }
+
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  return elapsed.count();
+}
+
+void
+usage(const char *name)
+{
+  fprintf(stderr, "Usage: %s [-s body_bytes] [-c input_chunk_size] [-m output_max_chunk_size] [-i iterations]\n", name);
+  exit(1);
+}
+
+} // namespace
+
+int
+main(int argc, char *argv[])
+{
+  int64_t body_size      = 16 * 1024 * 1024;
+  int64_t chunk_size     = 4096;
+  int64_t max_chunk_size = 4096;
+  int     iterations     = 10;
+  int     opt;
+
+  while ((opt = getopt(argc, argv, "s:c:m:i:")) != -1) {
+    switch (opt) {
+    case 's':
+      body_size = atoll(optarg);
+      break;
+    case 'c':
+      chunk_size = atoll(optarg);
+      break;
+    case 'm':
+      max_chunk_size = atoll(optarg);
+      break;
+    case 'i':
+      iterations = atoi(optarg);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (body_size <= 0 || chunk_size <= 0 || max_chunk_size <= 0 || iterations <= 0) {
+    usage(argv[0]);
+  }
+
+  Layout::create();
+  init_diags("", nullptr);
+  RecProcessInit();
+  LibRecordsConfigInit();
+  ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+  eventProcessor.start(1);
+
+  EThread *main_thread = new EThread;
+  main_thread->set_specific();
+
+  MIOBuffer      *chunked        = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  IOBufferReader *chunked_reader = chunked->alloc_reader();
+  write_chunked(chunked, body_size, chunk_size);
+
+  MIOBuffer      *plain        = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  IOBufferReader *plain_reader = plain->alloc_reader();
+  std::string     block(32 * 1024, 'x');
+  for (int64_t left = body_size; left > 0; left -= block.size()) {
+    plain->write(block.data(), std::min<int64_t>(left, block.size()));
+  }
+
+  printf("body: %" PRId64 " bytes, input chunks of %" PRId64 ", output chunks of %" PRId64 ", %d iterations\n", body_size,
+         chunk_size, max_chunk_size, iterations);
+
+  double total = static_cast<double>(body_size) * iterations / (1024 * 1024);
+  printf("dechunk:  %.1f MB/s\n", total / run(chunked_reader, ChunkedHandler::Action::DECHUNK, max_chunk_size, iterations));
+  printf("passthru: %.1f MB/s\n", total / run(chunked_reader, ChunkedHandler::Action::PASSTHRU, max_chunk_size, iterations));
+  printf("chunk:    %.1f MB/s\n", total / run(plain_reader, ChunkedHandler::Action::DOCHUNK, max_chunk_size, iterations));
+
+  free_MIOBuffer(chunked);
+  free_MIOBuffer(plain);
+  return 0;
+}
@@ -0,0 +1,196 @@
+/** @file
+
+  Unit tests for ChunkedHandler
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <string>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "proxy/http/HttpTunnel.h"
+
+using namespace std::literals;
+
+namespace
+{
+struct Result {
+  std::string                  body;
+  ChunkedHandler::ChunkedState state;
+  int64_t                      consumed;
+
+  // After an error the handler drops the rest of the block it is in, so how much is consumed depends on the split.
+  bool
+  operator==(Result const &that) const
+  {
+    return body == that.body && state == that.state &&
+           (consumed == that.consumed || state == ChunkedHandler::ChunkedState::READ_ERROR);
+  }
+};
+
+std::string
+read_all(IOBufferReader *reader)
+{
+  std::string out(reader->read_avail(), '\0');
+  reader->memcpy(out.data(), out.size());
+  reader->consume(out.size());
+  return out;
+}
+
+/** Run @a input through a handler doing @a action.
+
+    The input is put @a offset bytes into a buffer of small blocks, so that moving @a offset moves the block boundaries
+    over the input.
+ */
+Result
+process(std::string_view input, ChunkedHandler::Action action, bool strict, int offset)
+{
+  MIOBuffer      *in     = new_MIOBuffer(BUFFER_SIZE_INDEX_128);
+  IOBufferReader *reader = in->alloc_reader();
+  std::string     filler(offset, 'f');
+  in->write(filler.data(), filler.size());
+  in->write(input.data(), input.size());
+  reader->consume(offset);
+
+  ChunkedHandler handler;
+  handler.init_by_action(reader, action, false, strict);
+  handler.state = ChunkedHandler::ChunkedState::READ_SIZE;
+
+  IOBufferReader *out = action == ChunkedHandler::Action::DECHUNK ? handler.dechunked_buffer->alloc_reader() : nullptr;
+
+  auto [consumed, done] = handler.process_chunked_content();
+  Result result{out ? read_all(out) : "", handler.state, consumed};
+  CHECK(done == (handler.state == ChunkedHandler::ChunkedState::READ_DONE ||
+                 handler.state == ChunkedHandler::ChunkedState::READ_ERROR));
+
+  handler.clear();
+  free_MIOBuffer(in);
+  return result;
+}
+
+// The result must not depend on where the input is split into blocks.
+Result
+process_all_splits(std::string_view input, ChunkedHandler::Action action, bool strict = true)
+{
+  Result first = process(input, action, strict, 0);
+  for (int offset = 1; offset < 128; ++offset) {
+    CAPTURE(input, offset);
+    REQUIRE(process(input, action, strict, offset) == first);
+  }
+  return first;
+}
+} // namespace
+
+TEST_CASE("ChunkedHandler dechunk", "[http][chunked]")
+{
+  using State = ChunkedHandler::ChunkedState;
+  auto action = ChunkedHandler::Action::DECHUNK;
+
+  auto r = process_all_splits("5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n"sv, action);
+  CHECK(r.state == State::READ_DONE);
+  CHECK(r.body == "hello world");
+
+  r = process_all_splits("5;name=value\r\nhello\r\n6 \r\n world\r\n0\r\n\r\n"sv, action);
+  CHECK(r.state == State::READ_DONE);
+  CHECK(r.body == "hello world");
+
+  r = process_all_splits("A\r\n0123456789\r\n0a\r\n0123456789\r\n0\r\nX-Trailer: 1\r\n\r\n"sv, action);
+  CHECK(r.state == State::READ_DONE);
+  CHECK(r.body == "01234567890123456789");
+
+  std::string big(300, 'b');
+  r = process_all_splits("12c\r\n" + big + "\r\n0\r\n\r\n", action);
+  CHECK(r.state == State::READ_DONE);
+  CHECK(r.body == big);
+
+  // Incomplete input is not an error.
+  r = process_all_splits("5\r\nhel"sv, action);
+  CHECK(r.state == State::READ_CHUNK);
+  CHECK(r.body == "hel");
+
+  // Bare LFs are only allowed if parsing is not strict.
+  CHECK(process_all_splits("5\nhello\r\n0\r\n\r\n"sv, action).state == State::READ_ERROR);
+  CHECK(process_all_splits("5\nhello\r\n0\r\n\r\n"sv, action, false).state != State::READ_ERROR);
+
+  CHECK(process_all_splits("5;a\r\r\nhello\r\n0\r\n\r\n"sv, action).state == State::READ_ERROR);
+  CHECK(process_all_splits("x\r\nhello\r\n0\r\n\r\n"sv, action).state == State::READ_ERROR);
+  CHECK(process_all_splits("\r\n"sv, action).state == State::READ_ERROR);
+  CHECK(process_all_splits("5x\r\nhello\r\n0\r\n\r\n"sv, action).state == State::READ_ERROR);
+  CHECK(process_all_splits("5\r\nhelloX\r\n0\r\n\r\n"sv, action).state == State::READ_ERROR);
+  CHECK(process_all_splits("100000000\r\n"sv, action).state == State::READ_ERROR);
+
+  // Leading zeros beyond what the single step parser takes.
+  r = process_all_splits("000000005\r\nhello\r\n0\r\n\r\n"sv, action);
+  CHECK(r.state == State::READ_DONE);
+  CHECK(r.body == "hello");
+}
+
+TEST_CASE("ChunkedHandler passthru", "[http][chunked]")
+{
+  using State = ChunkedHandler::ChunkedState;
+  auto action = ChunkedHandler::Action::PASSTHRU;
+
+  std::string_view input = "5\r\nhello\r\n6\r\n world\r\n0\r\n\r\nGET / HTTP/1.1\r\n"sv;
+  auto             r     = process_all_splits(input, action);
+  CHECK(r.state == State::READ_DONE);
+  CHECK(r.consumed == static_cast<int64_t>(input.find("GET")));
+
+  CHECK(process_all_splits("5\r\nhelloX\r\n0\r\n\r\n"sv, action).state == State::READ_ERROR);
+}
+
+TEST_CASE("ChunkedHandler chunk", "[http][chunked]")
+{
+  std::string body;
+  for (int i = 0; i < 5000; ++i) {
+    body += static_cast<char>('a' + i % 26);
+  }
+
+  for (int64_t max_chunk_size : {4096, 100}) {
+    CAPTURE(max_chunk_size);
+
+    MIOBuffer      *in     = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+    IOBufferReader *reader = in->alloc_reader();
+    in->write(body.data(), body.size());
+
+    ChunkedHandler handler;
+    handler.init_by_action(reader, ChunkedHandler::Action::DOCHUNK, false, true);
+    handler.state = ChunkedHandler::ChunkedState::WRITE_CHUNK;
+    handler.set_max_chunk_size(max_chunk_size);
+    handler.last_server_event = VC_EVENT_READ_COMPLETE;
+
+    IOBufferReader *out   = handler.chunked_buffer->alloc_reader();
+    auto [consumed, done] = handler.generate_chunked_content();
+
+    std::string chunked = read_all(out);
+    CHECK(done);
+    CHECK(consumed == static_cast<int64_t>(body.size()));
+    CHECK(handler.chunked_size == static_cast<int64_t>(chunked.size()));
+    CHECK(chunked.ends_with("\r\n0\r\n\r\n"));
+
+    // Dechunking gives the body back.
+    auto r = process_all_splits(chunked, ChunkedHandler::Action::DECHUNK);
+    CHECK(r.state == ChunkedHandler::ChunkedState::READ_DONE);
+    CHECK(r.body == body);
+
+    handler.clear();
+    free_MIOBuffer(in);
+  }
+}
@@ -0,0 +1,172 @@
+/** @file
+
+  Catch based unit tests for the collapsed forwarding table
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "proxy/http/CollapsedForwardingTable.h"
+
+namespace
+{
+/// A transaction that blocks its thread while it waits.
+struct Txn {
+  std::mutex              mutex;
+  std::condition_variable cv;
+  bool                    woken = false;
+
+  void
+  wake()
+  {
+    std::lock_guard lock(mutex);
+    woken = true;
+    cv.notify_one();
+  }
+
+  void
+  wait_woken()
+  {
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [this]() { return woken; });
+    woken = false;
+  }
+};
+
+using Table = CollapsedForwardingTable<Txn>;
+
+CryptoHash
+make_key(uint64_t a, uint64_t b)
+{
+  CryptoHash key;
+  key.u64[0] = a;
+  key.u64[1] = b;
+  return key;
+}
+} // namespace
+
+TEST_CASE("CollapsedForwardingTable concurrent misses", "[http][collapse]")
+{
+  CryptoHash const key = make_key(0x1234, 0x5678);
+
+  for (int round = 0; round < 100; ++round) {
+    Table             table;
+    Txn               txns[2];
+    std::atomic<bool> cached{false};
+    std::atomic<int>  fetches{0};
+    std::atomic<int>  waiting{0};
+    std::atomic<int>  woken{0};
+
+    // A cache miss: the transaction with the write lock goes to the origin, the other waits on it and then reads the cache.
+    auto miss = [&](Txn &txn) {
+      while (!cached) {
+        if (table.lead(key, &txn)) {
+          // Hold the write until the other transaction waits on it
+          while (waiting == 0) {
+            std::this_thread::yield();
+          }
+          ++fetches;
+          cached = true;
+          woken += table.release(key, &txn, [](Txn *waiter) { waiter->wake(); });
+          return;
+        }
+        if (table.wait(key, &txn, 8, [&](Txn *) { ++waiting; }) == Table::Wait::WAITING) {
+          txn.wait_woken();
+        }
+      }
+    };
+
+    std::thread first(miss, std::ref(txns[0]));
+    std::thread second(miss, std::ref(txns[1]));
+    first.join();
+    second.join();
+
+    CHECK(fetches == 1);
+    CHECK(waiting == 1);
+    CHECK(woken == 1);
+  }
+}
+
+TEST_CASE("CollapsedForwardingTable", "[http][collapse]")
+{
+  Table      table;
+  Txn        leader, waiter, other;
+  CryptoHash key = make_key(0x1234, 0x5678);
+  Txn       *waited_on;
+  bool       was_waiting;
+
+  auto on_wait  = [&](Txn *txn) { waited_on = txn; };
+  auto on_leave = [&](bool waiting) { was_waiting = waiting; };
+
+  REQUIRE(table.lead(key, &leader));
+  CHECK_FALSE(table.lead(key, &waiter));
+  // The leader does not wait on itself
+  CHECK(table.wait(key, &leader, 8, on_wait) == Table::Wait::NO_LEADER);
+
+  SECTION("waiter timeout")
+  {
+    REQUIRE(table.wait(key, &waiter, 8, on_wait) == Table::Wait::WAITING);
+    CHECK(waited_on == &leader);
+
+    // The timeout fires before the leader is done, the waiter is not woken after that.
+    table.leave(key, &waiter, on_leave);
+    CHECK(was_waiting);
+    CHECK(table.release(key, &leader, [](Txn *) { FAIL("a waiter that left was woken"); }) == 0);
+    CHECK_FALSE(waiter.woken);
+  }
+
+  SECTION("waiter woken")
+  {
+    REQUIRE(table.wait(key, &waiter, 8, on_wait) == Table::Wait::WAITING);
+    CHECK(table.release(key, &leader, [](Txn *txn) { txn->wake(); }) == 1);
+    CHECK(waiter.woken);
+
+    // The timeout that fires later finds the waiter gone.
+    table.leave(key, &waiter, on_leave);
+    CHECK_FALSE(was_waiting);
+  }
+
+  SECTION("maximum waiters")
+  {
+    REQUIRE(table.wait(key, &waiter, 1, on_wait) == Table::Wait::WAITING);
+    CHECK(table.wait(key, &other, 1, on_wait) == Table::Wait::FULL);
+    CHECK(table.release(key, &leader, [](Txn *txn) { txn->wake(); }) == 1);
+    CHECK_FALSE(other.woken);
+  }
+
+  SECTION("keys in the same partition")
+  {
+    CryptoHash next = make_key(0x1234, 0x9abc);
+    CHECK(table.lead(next, &other));
+    CHECK(table.wait(next, &waiter, 8, on_wait) == Table::Wait::WAITING);
+    CHECK(waited_on == &other);
+    CHECK(table.release(next, &other, [](Txn *) {}) == 1);
+    CHECK(table.release(key, &leader, [](Txn *) {}) == 0);
+  }
+
+  // Once released the key is free for the next write.
+  CHECK(table.wait(key, &waiter, 8, on_wait) == Table::Wait::NO_LEADER);
+  CHECK(table.lead(key, &waiter));
+}
@@ -0,0 +1,91 @@
+/** @file
+
+  Catch-based tests for HttpStateTrace.cc.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "proxy/http/HttpConfig.h"
+#include "proxy/http/HttpStateTrace.h"
+
+using SMAction = HttpStateTrace::Action;
+
+TEST_CASE("HttpStateTrace", "[http][state_trace]")
+{
+  HttpStateTrace::startup(false);
+
+  HttpConfigParams params;
+  HttpStateTrace   trace;
+  char             buf[256];
+
+  SECTION("not sampled")
+  {
+    params.state_trace_sample = 2;
+    trace.start(1, &params);
+    CHECK(!trace.is_enabled());
+    CHECK(trace.print(buf, sizeof(buf)) == 0);
+    CHECK(buf[0] == '\0');
+  }
+
+  SECTION("sampled")
+  {
+    params.state_trace_sample = 2;
+    trace.start(4, &params);
+    REQUIRE(trace.is_enabled());
+
+    ink_hrtime t = HRTIME_SECONDS(1);
+    trace.enter(SMAction::DNS_LOOKUP, t, t + 500);
+    t += 500 + HRTIME_USECONDS(20);
+    trace.enter(SMAction::ORIGIN_SERVER_OPEN, t, t + 250);
+    t += 250 + HRTIME_USECONDS(7);
+    trace.finish(t);
+
+    std::string expected = "dns_lookup:500:20,origin_server_open:250:7";
+    CHECK(trace.print(buf, sizeof(buf)) == static_cast<int>(expected.size()));
+    CHECK(std::string(buf) == expected);
+
+    // Truncated output still reports the full length.
+    CHECK(trace.print(buf, 11) == static_cast<int>(expected.size()));
+    CHECK(std::string(buf) == "dns_lookup");
+
+    // Starting again forgets the previous transaction.
+    trace.start(6, &params);
+    CHECK(trace.print(buf, sizeof(buf)) == 0);
+  }
+
+  SECTION("kept states are limited")
+  {
+    params.state_trace_sample = 1;
+    trace.start(1, &params);
+    for (int i = 0; i < HttpStateTrace::ENTRIES + 8; ++i) {
+      trace.enter(SMAction::CACHE_LOOKUP, i * 1000, i * 1000 + 10);
+    }
+    trace.finish(HttpStateTrace::ENTRIES * 1000 + 8000);
+
+    std::string out(trace.print(nullptr, 0), '\0');
+    REQUIRE(!out.empty());
+    trace.print(out.data(), out.size() + 1);
+    CHECK(std::count(out.begin(), out.end(), ',') == HttpStateTrace::ENTRIES - 1);
+  }
+}
@@ -28,8 +28,11 @@ using namespace std::string_view_literals;
 #include "tscore/Diags.h"
 #include "tsutil/PostScript.h"
 
+#include "api/InkAPIInternal.h"
+#include "proxy/http/HttpSM.h"
 #include "proxy/http/HttpTransact.h"
 #include "records/RecordsConfig.h"
+#include "ts/InkAPIPrivateIOCore.h"
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -542,3 +545,106 @@ TEST_CASE("HttpTransact", "[http]")
     }
   }
 }
+
+TEST_CASE("HttpHookState::has_hooks", "[http][hooks]")
+{
+  HttpAPIHooks    global, ssn, txn;
+  INKContInternal cont;
+
+  CHECK_FALSE(HttpHookState::has_hooks(TS_HTTP_READ_CACHE_HDR_HOOK, nullptr));
+  CHECK_FALSE(HttpHookState::has_hooks(TS_HTTP_READ_CACHE_HDR_HOOK, &global, &ssn, &txn));
+
+  SECTION("global hook")
+  {
+    global.append(TS_HTTP_READ_CACHE_HDR_HOOK, &cont);
+  }
+  SECTION("session hook")
+  {
+    ssn.append(TS_HTTP_READ_CACHE_HDR_HOOK, &cont);
+  }
+  SECTION("transaction hook")
+  {
+    txn.append(TS_HTTP_READ_CACHE_HDR_HOOK, &cont);
+  }
+
+  CHECK(HttpHookState::has_hooks(TS_HTTP_READ_CACHE_HDR_HOOK, &global, &ssn, &txn));
+  // Only the hook ID that has a hook counts
+  CHECK_FALSE(HttpHookState::has_hooks(TS_HTTP_CACHE_LOOKUP_COMPLETE_HOOK, &global, &ssn, &txn));
+}
+
+TEST_CASE("HttpTransact cache hit API callouts", "[http][hooks]")
+{
+  url_init();
+  mime_init();
+  http_init();
+  if (http_global_hooks == nullptr) {
+    init_global_http_hooks();
+  }
+
+  // Not destroyed, the destructor releases the configuration and remap table of an initialized state machine.
+  HttpSM              *sm = new HttpSM;
+  HttpTransact::State &s  = sm->t_state;
+  HttpConfigParams     params;
+  HTTPHdr              request, response;
+  CacheHTTPInfo        obj;
+  INKContInternal      cont;
+
+  request.create(HTTPType::REQUEST);
+  request.method_set(static_cast<std::string_view>(HTTP_METHOD_GET));
+  request.url_set("http://example.com/"sv);
+  response.create(HTTPType::RESPONSE);
+  response.status_set(HTTPStatus::OK);
+  obj.create();
+  obj.request_set(&request);
+  obj.response_set(&response);
+
+  s.state_machine          = sm;
+  s.http_config_param      = &params;
+  s.method                 = HTTP_WKSIDX_GET;
+  s.cache_info.object_read = &obj;
+  s.setup_per_txn_configs();
+  s.hdr_info.client_request.copy(&request);
+  // The freshness is already decided, as if by a plugin
+  s.cache_lookup_result = HttpTransact::CacheLookupResult_t::HIT_STALE;
+
+  SECTION("no hooks")
+  {
+    // Straight on to the freshness check, without the READ_CACHE_HDR callout
+    HttpTransact::HandleCacheOpenRead(&s);
+    CHECK(s.next_action == HttpTransact::StateMachineAction_t::API_CACHE_LOOKUP_COMPLETE);
+  }
+
+  SECTION("global hook")
+  {
+    http_global_hooks->append(TS_HTTP_READ_CACHE_HDR_HOOK, &cont);
+    sm->hooks_set = true;
+    HttpTransact::HandleCacheOpenRead(&s);
+    CHECK(s.next_action == HttpTransact::StateMachineAction_t::API_READ_CACHE_HDR);
+    CHECK(s.transact_return_point == HttpTransact::HandleCacheOpenReadHitFreshness);
+    http_global_hooks->clear();
+  }
+
+  SECTION("transaction hook")
+  {
+    sm->txn_hook_add(TS_HTTP_READ_CACHE_HDR_HOOK, &cont);
+    HttpTransact::HandleCacheOpenRead(&s);
+    CHECK(s.next_action == HttpTransact::StateMachineAction_t::API_READ_CACHE_HDR);
+    CHECK(s.transact_return_point == HttpTransact::HandleCacheOpenReadHitFreshness);
+  }
+
+  SECTION("fresh hit with a CACHE_LOOKUP_COMPLETE hook")
+  {
+    // The hook for the other callout does not stop the READ_CACHE_HDR one from being skipped
+    sm->txn_hook_add(TS_HTTP_CACHE_LOOKUP_COMPLETE_HOOK, &cont);
+    s.cache_lookup_result = HttpTransact::CacheLookupResult_t::HIT_FRESH;
+    HttpTransact::HandleCacheOpenRead(&s);
+    CHECK(s.next_action == HttpTransact::StateMachineAction_t::API_CACHE_LOOKUP_COMPLETE);
+    CHECK(s.transact_return_point == HttpTransact::HandleCacheOpenReadHit);
+  }
+
+  s.cache_info.object_read = nullptr;
+  obj.destroy();
+  s.hdr_info.client_request.destroy();
+  request.destroy();
+  response.destroy();
+}
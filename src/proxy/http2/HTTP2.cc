@@ -30,6 +30,9 @@
 #include "tscore/ink_assert.h"
 #include "tsutil/LocalBuffer.h"
 
+#include <algorithm>
+#include <bit>
+
 #include "../../records/P_RecCore.h"
 
 const char *const HTTP2_CONNECTION_PREFACE = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
@@ -640,9 +643,22 @@ Http2::init()
   http2_frame_metrics_in[9]  = http2_rsb.continuation_frames_in;
   http2_frame_metrics_in[10] = http2_rsb.unknown_frames_in;
 
+  for (int i = 0; i < HTTP2_SERVER_STREAMS_PER_CONNECTION_BUCKETS; ++i) {
+    http2_rsb.server_streams_per_connection[i] =
+      Metrics::Counter::createBucketPtr("proxy.process.http2.server_streams_per_connection", 1 << i);
+  }
+
   http2_init();
 }
 
+void
+http2_record_server_streams_per_connection(uint32_t streams)
+{
+  // A connection that closes without a stream is not counted, the first bucket is for 1 stream
+  int bucket = std::clamp(static_cast<int>(std::bit_width(streams)) - 1, 0, HTTP2_SERVER_STREAMS_PER_CONNECTION_BUCKETS - 1);
+  Metrics::Counter::increment(http2_rsb.server_streams_per_connection[bucket]);
+}
+
 void
 http2_init()
 {
@@ -485,6 +485,14 @@ Http2CommonSession::is_outbound() const
   return false;
 }
 
+void
+Http2CommonSession::start_transaction(Http2Stream &stream, bool from_early_data)
+{
+  stream.new_transaction(from_early_data);
+  // Send request header to SM
+  stream.send_headers(this->connection_state);
+}
+
 void
 Http2CommonSession::_count_received_frames(uint32_t type)
 {
@@ -512,9 +512,7 @@ Http2ConnectionState::rcv_headers_frame(const Http2Frame &frame)
       SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
       stream->mark_milestone(Http2StreamMilestone::START_TXN);
       stream->cancel_active_timeout();
-      stream->new_transaction(frame.is_from_early_data());
-      // Send request header to SM
-      stream->send_headers(*this);
+      this->session->start_transaction(*stream, frame.is_from_early_data());
     } else {
       // If this is a trailer, first signal to the SM that the body is done
       if (stream->trailing_header_is_possible()) {
@@ -1648,13 +1646,13 @@ Http2ConnectionState::state_closed(int event, void *edata)
 bool
 Http2ConnectionState::is_peer_concurrent_stream_ub() const
 {
-  return peer_streams_count_in >= (peer_settings.get(HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS)) * 0.9;
+  return peer_streams_count_in >= peer_settings.get(HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS);
 }
 
 bool
 Http2ConnectionState::is_peer_concurrent_stream_lb() const
 {
-  return peer_streams_count_in <= (peer_settings.get(HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS)) / 2;
+  return peer_streams_count_in < peer_settings.get(HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS);
 }
 
 void
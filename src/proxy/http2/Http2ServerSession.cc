@@ -29,6 +29,8 @@
 #include "proxy/http2/Http2CommonSessionInternal.h"
 #include "proxy/http/HttpSessionManager.h"
 
+#include <algorithm>
+
 ClassAllocator<Http2ServerSession, false> http2ServerSessionAllocator("http2ServerSessionAllocator");
 
 static int
@@ -48,6 +50,9 @@ Http2ServerSession::destroy()
     write_vio  = nullptr;
     this->remove_session();
     this->release_outbound_connection_tracking();
+    if (this->_peak_stream_count > 0) {
+      http2_record_server_streams_per_connection(this->_peak_stream_count);
+    }
     REMEMBER(NO_EVENT, this->recursion)
     Http2SsnDebug("session destroy");
     if (_vc) {
@@ -333,6 +338,9 @@ Http2ServerSession::new_transaction()
 
     remove_session();
   }
+  if (stream) {
+    this->_peak_stream_count = std::max(this->_peak_stream_count, connection_state.get_peer_stream_count());
+  }
 
   return stream;
 }
@@ -377,6 +385,12 @@ Http2ServerSession::is_multiplexing() const
   return true;
 }
 
+uint32_t
+Http2ServerSession::get_active_stream_count() const
+{
+  return connection_state.get_peer_stream_count();
+}
+
 bool
 Http2ServerSession::is_outbound() const
 {
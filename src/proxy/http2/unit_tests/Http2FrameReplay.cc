@@ -0,0 +1,306 @@
+/** @file
+
+  Replay of HTTP/2 frame streams without a session, for benchmarks and fuzzing
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "Http2FrameReplay.h"
+
+#include "../../../iocore/net/P_Net.h"
+#include "../../../iocore/net/P_UnixNetVConnection.h"
+#include "proxy/http2/Http2ClientSession.h"
+#include "proxy/http/HttpSessionAccept.h"
+
+#include <cstring>
+#include <string>
+
+namespace
+{
+/// A client connection without a socket. The replay hands the frames to the session, nothing is read or written here.
+class ReplayNetVConnection : public UnixNetVConnection
+{
+public:
+  void
+  do_io_close(int /* lerrno ATS_UNUSED */) override
+  {
+    delete this;
+  }
+  void
+  reenable(VIO * /* vio ATS_UNUSED */) override
+  {
+  }
+  void
+  reenable_re(VIO * /* vio ATS_UNUSED */) override
+  {
+  }
+  bool
+  add_to_active_queue() override
+  {
+    return true;
+  }
+  void
+  add_to_keep_alive_queue() override
+  {
+  }
+  void
+  remove_from_keep_alive_queue() override
+  {
+  }
+  int
+  set_tcp_congestion_control(tcp_congestion_control_side /* side ATS_UNUSED */) override
+  {
+    return 0;
+  }
+};
+} // namespace
+
+/**
+   An Http2ClientSession whose frames come from the replay. Frames are read with the same calls as
+   do_process_frame_read(), without the events it schedules to let other work run in between.
+ */
+class Http2ReplaySession : public Http2ClientSession
+{
+public:
+  explicit Http2ReplaySession(Http2FrameReplay &replay) : _replay(replay)
+  {
+    this->accept_options = &this->_accept_options;
+    this->_body          = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+    this->_body_reader   = this->_body->alloc_reader();
+  }
+
+  ~Http2ReplaySession() override { free_MIOBuffer(this->_body); }
+
+  int64_t read_frame(const uint8_t *buf, size_t len);
+
+  void start_transaction(Http2Stream &stream, bool from_early_data) override;
+  void free() override;
+
+private:
+  void _finish_request(Http2StreamId id);
+
+  Http2FrameReplay          &_replay;
+  HttpSessionAccept::Options _accept_options;
+  MIOBuffer                 *_body        = nullptr;
+  IOBufferReader            *_body_reader = nullptr;
+};
+
+/** Read the frame at the front of @a buf, which holds at least a frame header.
+
+    @return The size of the frame, 0 if @a buf does not hold all of it or -1 on a connection error.
+ */
+int64_t
+Http2ReplaySession::read_frame(const uint8_t *buf, size_t len)
+{
+  if (this->connection_state.tx_error_code.code != static_cast<uint32_t>(Http2ErrorCode::HTTP2_ERROR_NO_ERROR) ||
+      this->connection_state.is_state_closed()) {
+    return -1;
+  }
+
+  Http2FrameHeader hdr;
+  http2_parse_frame_header(make_iovec(const_cast<uint8_t *>(buf), HTTP2_FRAME_HEADER_LEN), hdr);
+  // A frame over the maximum size is refused on its header, the rest of it is never read
+  if (hdr.length > this->connection_state.local_settings.get(HTTP2_SETTINGS_MAX_FRAME_SIZE)) {
+    len = HTTP2_FRAME_HEADER_LEN;
+  } else if (len < HTTP2_FRAME_HEADER_LEN + hdr.length) {
+    return 0;
+  } else {
+    len = HTTP2_FRAME_HEADER_LEN + hdr.length;
+  }
+  this->read_buffer->write(buf, len);
+
+  Http2ErrorCode err = Http2ErrorCode::HTTP2_ERROR_NO_ERROR;
+  if (this->do_start_frame_read(err) < 0) {
+    if (err > Http2ErrorCode::HTTP2_ERROR_NO_ERROR && !this->connection_state.is_state_closed()) {
+      this->connection_state.send_goaway_frame(this->connection_state.get_latest_stream_id_in(), err);
+      this->set_half_close_local_flag(true);
+    }
+  } else {
+    this->do_complete_frame_read();
+    this->_finish_request(hdr.streamid);
+  }
+
+  this->_replay.bytes_sent += this->_write_buffer_reader->read_avail();
+  this->_write_buffer_reader->consume(this->_write_buffer_reader->read_avail());
+
+  if (this->connection_state.tx_error_code.code != static_cast<uint32_t>(Http2ErrorCode::HTTP2_ERROR_NO_ERROR)) {
+    return -1;
+  }
+  return HTTP2_FRAME_HEADER_LEN + hdr.length;
+}
+
+void
+Http2ReplaySession::start_transaction(Http2Stream &stream, bool /* from_early_data ATS_UNUSED */)
+{
+  ++this->_replay.requests;
+  stream.do_io_read(nullptr, INT64_MAX, this->_body);
+}
+
+/// Drain the request body received on stream @a id and reset the stream once the whole request is in.
+void
+Http2ReplaySession::_finish_request(Http2StreamId id)
+{
+  Http2Stream *stream = this->connection_state.find_stream(id);
+  if (stream == nullptr || stream->read_vio_writer() != this->_body) {
+    return;
+  }
+
+  this->_body_reader->consume(this->_body_reader->read_avail());
+  this->connection_state.restart_receiving(stream);
+  if (stream->receive_end_stream) {
+    stream->initiating_close();
+  }
+}
+
+void
+Http2ReplaySession::free()
+{
+  if (Http2CommonSession::common_free(this)) {
+    Metrics::Gauge::decrement(http2_rsb.current_client_session_count);
+    delete this;
+  }
+}
+
+Http2FrameReplay::Http2FrameReplay() : _mutex(new_ProxyMutex())
+{
+  SCOPED_MUTEX_LOCK(lock, this->_mutex, this_ethread());
+
+  ReplayNetVConnection *vc = new ReplayNetVConnection;
+  vc->mutex                = this->_mutex;
+  this->_session           = new Http2ReplaySession(*this);
+  this->_session->new_connection(vc, nullptr, nullptr);
+}
+
+Http2FrameReplay::~Http2FrameReplay()
+{
+  SCOPED_MUTEX_LOCK(lock, this->_mutex, this_ethread());
+
+  // The client goes away, the session closes the streams left and frees itself
+  this->_session->handleEvent(VC_EVENT_EOS, nullptr);
+}
+
+int64_t
+Http2FrameReplay::process_frame(const uint8_t *buf, size_t len)
+{
+  if (len < HTTP2_FRAME_HEADER_LEN) {
+    return 0;
+  }
+
+  SCOPED_MUTEX_LOCK(lock, this->_mutex, this_ethread());
+  int64_t n = this->_session->read_frame(buf, len);
+  if (n > 0) {
+    ++this->frames;
+  }
+  return n;
+}
+
+size_t
+Http2FrameReplay::process(const uint8_t *buf, size_t len)
+{
+  size_t offset = 0;
+
+  if (len >= HTTP2_CONNECTION_PREFACE_LEN && memcmp(buf, HTTP2_CONNECTION_PREFACE, HTTP2_CONNECTION_PREFACE_LEN) == 0) {
+    offset = HTTP2_CONNECTION_PREFACE_LEN;
+  }
+
+  while (offset < len) {
+    int64_t n = this->process_frame(buf + offset, len - offset);
+    if (n <= 0) {
+      break;
+    }
+    offset += n;
+  }
+
+  return offset;
+}
+
+std::vector<uint8_t>
+Http2FrameReplay::synthesize(int nrequests)
+{
+  std::vector<uint8_t> out;
+
+  auto append_frame = [&out](uint8_t type, uint8_t flags, Http2StreamId stream_id, const uint8_t *payload, uint32_t len) {
+    uint8_t header[HTTP2_FRAME_HEADER_LEN];
+    http2_write_frame_header({len, type, flags, stream_id}, make_iovec(header));
+    out.insert(out.end(), header, header + sizeof(header));
+    out.insert(out.end(), payload, payload + len);
+  };
+
+  out.insert(out.end(), HTTP2_CONNECTION_PREFACE, HTTP2_CONNECTION_PREFACE + HTTP2_CONNECTION_PREFACE_LEN);
+
+  uint8_t settings[HTTP2_SETTINGS_PARAMETER_LEN * 2];
+  http2_write_settings({HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, 100}, make_iovec(settings, HTTP2_SETTINGS_PARAMETER_LEN));
+  http2_write_settings({HTTP2_SETTINGS_INITIAL_WINDOW_SIZE, 1 << 20},
+                       make_iovec(settings + HTTP2_SETTINGS_PARAMETER_LEN, HTTP2_SETTINGS_PARAMETER_LEN));
+  append_frame(HTTP2_FRAME_TYPE_SETTINGS, 0, 0, settings, sizeof(settings));
+
+  uint8_t window_update[HTTP2_WINDOW_UPDATE_LEN];
+  http2_write_window_update(1 << 24, make_iovec(window_update));
+  append_frame(HTTP2_FRAME_TYPE_WINDOW_UPDATE, 0, 0, window_update, sizeof(window_update));
+
+  HpackHandle encoder(HTTP2_HEADER_TABLE_SIZE);
+  uint8_t     block[4096];
+  uint8_t     body[1024];
+  memset(body, 'x', sizeof(body));
+
+  for (int i = 0; i < nrequests; ++i) {
+    Http2StreamId stream_id = 2 * i + 1;
+    bool          post      = (i % 4) == 3;
+    std::string   path      = "/assets/" + std::to_string(i) + (post ? "/upload" : ".js");
+
+    HTTPHdr req;
+    req.create(HTTPType::REQUEST);
+    std::pair<std::string_view, std::string_view> fields[] = {
+      {":method",         post ? "POST" : "GET"                                                         },
+      {":scheme",         "https"                                                                       },
+      {":authority",      "www.example.com"                                                             },
+      {":path",           path                                                                          },
+      {"user-agent",      "Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0"     },
+      {"accept",          "*/*"                                                                         },
+      {"accept-encoding", "gzip, deflate, br, zstd"                                                     },
+      {"cookie",          "session=8f14e45fceea167a5a36dedd4bea2543; theme=dark; consent=1"             },
+    };
+    for (auto &[name, value] : fields) {
+      MIMEField *field = req.field_create(name);
+      req.field_attach(field);
+      req.field_value_set(field, value);
+    }
+    int64_t block_len = hpack_encode_header_block(encoder, block, sizeof(block), &req);
+    req.destroy();
+
+    if (i % 8 == 0) {
+      uint8_t priority[HTTP2_PRIORITY_LEN] = {0, 0, 0, 0, HTTP2_PRIORITY_DEFAULT_WEIGHT};
+      append_frame(HTTP2_FRAME_TYPE_PRIORITY, 0, stream_id, priority, sizeof(priority));
+    }
+
+    uint8_t flags = HTTP2_FLAGS_HEADERS_END_HEADERS | (post ? 0 : HTTP2_FLAGS_HEADERS_END_STREAM);
+    append_frame(HTTP2_FRAME_TYPE_HEADERS, flags, stream_id, block, block_len);
+    if (post) {
+      append_frame(HTTP2_FRAME_TYPE_DATA, HTTP2_FLAGS_DATA_END_STREAM, stream_id, body, sizeof(body));
+    }
+
+    // Rarely enough to stay under proxy.config.http2.max_ping_frames_per_minute
+    if (i % 256 == 15) {
+      uint8_t ping[HTTP2_PING_LEN] = {0};
+      append_frame(HTTP2_FRAME_TYPE_PING, 0, 0, ping, sizeof(ping));
+    }
+  }
+
+  return out;
+}
@@ -0,0 +1,76 @@
+/** @file
+
+  Replay of HTTP/2 frame streams through a session without a socket, for benchmarks and fuzzing
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "proxy/http2/HTTP2.h"
+#include "iocore/eventsystem/Lock.h"
+
+#include <cstdint>
+#include <vector>
+
+class Http2ReplaySession;
+
+/**
+   Feeds the HTTP/2 frames of a client connection to a server side Http2ClientSession and its Http2ConnectionState. The
+   session reads each frame as it would off the wire, the net VC underneath it is a stub. A request is taken by a stub
+   transaction instead of an HttpSM: its body is drained and the stream is reset once the request is complete. Anything
+   the session sends is discarded.
+
+   The event system and Http2::init() are needed, the session runs on the calling thread.
+ */
+class Http2FrameReplay
+{
+public:
+  Http2FrameReplay();
+  ~Http2FrameReplay();
+
+  // noncopyable
+  Http2FrameReplay(const Http2FrameReplay &)            = delete;
+  Http2FrameReplay &operator=(const Http2FrameReplay &) = delete;
+
+  /** Process the frame at the front of @a buf.
+
+      @return The size of the frame, 0 if @a buf does not hold a whole frame or -1 if the frame is a connection error.
+   */
+  int64_t process_frame(const uint8_t *buf, size_t len);
+
+  /** Process every complete frame in @a buf. A leading connection preface is skipped.
+
+      @return The number of bytes consumed. Processing stops at the first connection error.
+   */
+  size_t process(const uint8_t *buf, size_t len);
+
+  /** Build a frame stream that looks like a client connection: SETTINGS and WINDOW_UPDATE followed by @a nrequests
+      requests. Every fourth request is a POST with a DATA frame and PING/PRIORITY frames are interleaved.
+   */
+  static std::vector<uint8_t> synthesize(int nrequests);
+
+  uint64_t frames     = 0; ///< Frames processed
+  uint64_t requests   = 0; ///< Transactions started
+  uint64_t bytes_sent = 0; ///< Bytes sent back by the session
+
+private:
+  Ptr<ProxyMutex>     _mutex;
+  Http2ReplaySession *_session = nullptr;
+};
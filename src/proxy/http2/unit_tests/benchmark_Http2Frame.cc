@@ -0,0 +1,196 @@
+/** @file
+
+  Throughput benchmark of HTTP/2 frame processing
+
+  Replays a synthetic client connection, or a recorded one given with -f, through Http2FrameReplay and reports frames per
+  second, heap allocations per frame and the per frame processing time distribution.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "Http2FrameReplay.h"
+
+#include "tscore/Layout.h"
+#include "iocore/eventsystem/EventSystem.h"
+#include "iocore/utils/Machine.h"
+#include "records/RecordsConfig.h"
+
+#include "iocore/utils/diags.i"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <unistd.h>
+
+namespace
+{
+std::atomic<uint64_t> allocations{0};
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<uint8_t>
+read_file(const char *path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    exit(1);
+  }
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void
+usage(const char *name)
+{
+  fprintf(stderr, "Usage: %s [-n requests] [-i iterations] [-f recorded_stream]\n", name);
+  exit(1);
+}
+
+} // namespace
+
+// Count heap allocations done through operator new
+void *
+operator new(size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void
+operator delete(void *p, size_t) noexcept
+{
+  free(p);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int         nrequests  = 1000;
+  int         iterations = 100;
+  const char *file       = nullptr;
+  int         opt;
+
+  while ((opt = getopt(argc, argv, "n:i:f:")) != -1) {
+    switch (opt) {
+    case 'n':
+      nrequests = atoi(optarg);
+      break;
+    case 'i':
+      iterations = atoi(optarg);
+      break;
+    case 'f':
+      file = optarg;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (nrequests <= 0 || iterations <= 0) {
+    usage(argv[0]);
+  }
+
+  Layout::create();
+  init_diags("", nullptr);
+  RecProcessInit();
+  LibRecordsConfigInit();
+  ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+  eventProcessor.start(1);
+
+  EThread *main_thread = new EThread;
+  main_thread->set_specific();
+
+  Machine::init("localhost", nullptr);
+  url_init();
+  mime_init();
+  http_init();
+  http2_init();
+  Http2::init();
+
+  std::vector<uint8_t> stream = file ? read_file(file) : Http2FrameReplay::synthesize(nrequests);
+
+  // Warm up the allocators and check the stream once
+  {
+    Http2FrameReplay replay;
+    if (size_t consumed = replay.process(stream.data(), stream.size()); consumed != stream.size()) {
+      fprintf(stderr, "Stream is malformed at offset %zu, replaying the first %" PRIu64 " frames only\n", consumed, replay.frames);
+      stream.resize(consumed);
+    }
+  }
+
+  // Throughput, without timing each frame
+  uint64_t frames        = 0;
+  uint64_t allocs_before = allocations.load();
+  auto     start         = Clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    Http2FrameReplay replay;
+    replay.process(stream.data(), stream.size());
+    frames += replay.frames;
+  }
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  uint64_t                      allocs  = allocations.load() - allocs_before;
+
+  // Per frame latency
+  std::vector<uint64_t> latencies;
+  latencies.reserve(frames);
+  for (int i = 0; i < iterations; ++i) {
+    Http2FrameReplay replay;
+    size_t           offset = 0;
+    if (stream.size() >= HTTP2_CONNECTION_PREFACE_LEN &&
+        memcmp(stream.data(), HTTP2_CONNECTION_PREFACE, HTTP2_CONNECTION_PREFACE_LEN) == 0) {
+      offset = HTTP2_CONNECTION_PREFACE_LEN;
+    }
+    while (offset < stream.size()) {
+      auto    frame_start = Clock::now();
+      int64_t n           = replay.process_frame(stream.data() + offset, stream.size() - offset);
+      latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - frame_start).count());
+      if (n <= 0) {
+        break;
+      }
+      offset += n;
+    }
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) -> uint64_t {
+    return latencies.empty() ? 0 : latencies[static_cast<size_t>((latencies.size() - 1) * p)];
+  };
+
+  printf("stream: %zu bytes, %" PRIu64 " frames per iteration, %d iterations\n", stream.size(), frames / iterations, iterations);
+  printf("frames/sec: %.0f\n", frames / elapsed.count());
+  printf("allocations/frame: %.2f\n", frames ? static_cast<double>(allocs) / frames : 0.0);
+  printf("per frame ns: p50 %" PRIu64 " p90 %" PRIu64 " p99 %" PRIu64 " max %" PRIu64 "\n", percentile(0.5), percentile(0.9),
+         percentile(0.99), percentile(1.0));
+
+  return 0;
+}
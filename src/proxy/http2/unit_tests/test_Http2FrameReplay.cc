@@ -0,0 +1,120 @@
+/** @file
+
+  Unit tests for Http2FrameReplay
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "Http2FrameReplay.h"
+
+#include "iocore/utils/Machine.h"
+
+TEST_CASE("Http2FrameReplay", "[http2][replay]")
+{
+  static bool initialized = []() {
+    Machine::init("localhost", nullptr);
+    url_init();
+    mime_init();
+    http_init();
+    http2_init();
+    Http2::init();
+    return true;
+  }();
+  REQUIRE(initialized);
+
+  SECTION("synthetic stream")
+  {
+    std::vector<uint8_t> stream = Http2FrameReplay::synthesize(16);
+    Http2FrameReplay     replay;
+
+    CHECK(replay.process(stream.data(), stream.size()) == stream.size());
+    // SETTINGS, WINDOW_UPDATE, 16 HEADERS, 4 DATA, 2 PRIORITY and 1 PING
+    CHECK(replay.frames == 25);
+    CHECK(replay.requests == 16);
+    // At least the SETTINGS ACK, the PING ACK and a RST_STREAM for every request
+    CHECK(replay.bytes_sent >= 2 * HTTP2_FRAME_HEADER_LEN + HTTP2_PING_LEN + 16 * (HTTP2_FRAME_HEADER_LEN + HTTP2_RST_STREAM_LEN));
+  }
+
+  SECTION("stream errors keep the connection open")
+  {
+    std::vector<uint8_t> stream = Http2FrameReplay::synthesize(1);
+    Http2FrameReplay     replay;
+
+    REQUIRE(replay.process(stream.data(), stream.size()) == stream.size());
+    // DATA on the stream of the request, which is closed by now
+    uint8_t data[] = {0x00, 0x00, 0x01, HTTP2_FRAME_TYPE_DATA, HTTP2_FLAGS_DATA_END_STREAM, 0x00, 0x00, 0x00, 0x01, 'x'};
+    CHECK(replay.process_frame(data, sizeof(data)) == sizeof(data));
+    uint8_t ping[] = {0x00, 0x00, 0x08, HTTP2_FRAME_TYPE_PING, 0x00, 0x00, 0x00, 0x00, 0x00, 0, 0, 0, 0, 0, 0, 0, 0};
+    CHECK(replay.process_frame(ping, sizeof(ping)) == sizeof(ping));
+  }
+
+  SECTION("incomplete frame")
+  {
+    uint8_t          frame[] = {0x00, 0x00, 0x08, HTTP2_FRAME_TYPE_PING, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02};
+    Http2FrameReplay replay;
+
+    CHECK(replay.process_frame(frame, sizeof(frame)) == 0);
+    CHECK(replay.frames == 0);
+  }
+
+  SECTION("PING on a stream")
+  {
+    uint8_t          ping[] = {0x00, 0x00, 0x08, HTTP2_FRAME_TYPE_PING, 0x00, 0x00, 0x00, 0x00, 0x01, 0, 0, 0, 0, 0, 0, 0, 0};
+    Http2FrameReplay replay;
+
+    CHECK(replay.process_frame(ping, sizeof(ping)) == -1);
+    CHECK(replay.frames == 0);
+  }
+
+  SECTION("DATA on stream 0")
+  {
+    uint8_t          data[] = {0x00, 0x00, 0x01, HTTP2_FRAME_TYPE_DATA, 0x00, 0x00, 0x00, 0x00, 0x00, 'x'};
+    Http2FrameReplay replay;
+
+    CHECK(replay.process_frame(data, sizeof(data)) == -1);
+  }
+
+  SECTION("padding longer than the payload")
+  {
+    uint8_t          data[] = {0x00, 0x00, 0x02, HTTP2_FRAME_TYPE_DATA, HTTP2_FLAGS_DATA_PADDED, 0x00, 0x00, 0x00, 0x01, 0x05, 'x'};
+    Http2FrameReplay replay;
+
+    CHECK(replay.process_frame(data, sizeof(data)) == -1);
+  }
+
+  SECTION("frame over the maximum size")
+  {
+    uint8_t          frame[] = {0x01, 0x00, 0x00, HTTP2_FRAME_TYPE_DATA, 0x00, 0x00, 0x00, 0x00, 0x01};
+    Http2FrameReplay replay;
+
+    CHECK(replay.process_frame(frame, sizeof(frame)) == -1);
+  }
+
+  SECTION("no frame is read after a connection error")
+  {
+    uint8_t          ping[] = {0x00, 0x00, 0x08, HTTP2_FRAME_TYPE_PING, 0x00, 0x00, 0x00, 0x00, 0x01, 0, 0, 0, 0, 0, 0, 0, 0};
+    Http2FrameReplay replay;
+
+    REQUIRE(replay.process_frame(ping, sizeof(ping)) == -1);
+    ping[8] = 0x00;
+    CHECK(replay.process_frame(ping, sizeof(ping)) == -1);
+  }
+}
@@ -47,6 +47,13 @@ Http3::init()
   http3_rsb.max_push_id            = Metrics::Counter::createPtr("proxy.process.http3.max_push_id_frames_in");
   http3_rsb.unknown_frames_in      = Metrics::Counter::createPtr("proxy.process.http3.unknown_frames_in");
 
+  http3_rsb.qpack_encoder_header_bytes_uncompressed =
+    Metrics::Counter::createPtr("proxy.process.http3.qpack_encoder_header_bytes_uncompressed");
+  http3_rsb.qpack_encoder_header_bytes_compressed =
+    Metrics::Counter::createPtr("proxy.process.http3.qpack_encoder_header_bytes_compressed");
+  http3_rsb.qpack_decoder_blocked_streams = Metrics::Counter::createPtr("proxy.process.http3.qpack_decoder_blocked_streams");
+  http3_rsb.qpack_decoder_blocked_time    = Metrics::Counter::createPtr("proxy.process.http3.qpack_decoder_blocked_time");
+
   http3_frame_metrics_in[static_cast<int>(Http3FrameType::DATA)]         = http3_rsb.data_frames_in;
   http3_frame_metrics_in[static_cast<int>(Http3FrameType::HEADERS)]      = http3_rsb.headers_frames_in;
   http3_frame_metrics_in[static_cast<int>(Http3FrameType::X_RESERVED_1)] = http3_rsb.unknown_frames_in;
@@ -23,6 +23,7 @@
 
 #include "proxy/http3/Http3App.h"
 
+#include <memory>
 #include <utility>
 
 #include "tscore/ink_resolver.h"
@@ -86,21 +87,18 @@ Http3App::~Http3App()
 void
 Http3App::start()
 {
-  QUICStreamId            stream_id{};
-  QUICConnectionErrorUPtr error;
-
-  error = this->create_uni_stream(stream_id, Http3StreamType::CONTROL);
-
-  // TODO: Open uni streams for QPACK when dynamic table is used
-  // error = this->create_uni_stream(stream_id, Http3StreamType::QPACK_ENCODER);
-  // if (error == nullptr) {
-  //   this->_handle_uni_stream_on_write_ready(VC_EVENT_WRITE_READY, this->_find_stream_io(stream_id));
-  // }
-
-  // error = this->create_uni_stream(stream_id, Http3StreamType::QPACK_DECODER);
-  // if (error == nullptr) {
-  //   this->_handle_uni_stream_on_write_ready(VC_EVENT_WRITE_READY, this->_find_stream_io(stream_id));
-  // }
+  QUICStreamId stream_id{};
+
+  // The type of each stream is written on its first write ready, the QPACK streams are then handed over to QPACK
+  for (auto type : {Http3StreamType::CONTROL, Http3StreamType::QPACK_ENCODER, Http3StreamType::QPACK_DECODER}) {
+    if (this->create_uni_stream(stream_id, type) != nullptr) {
+      // Each endpoint MUST open a control stream and the QPACK streams are needed for the dynamic table, there is no HTTP/3
+      // without them.
+      this->_qc->close_quic_connection(std::make_unique<QUICConnectionError>(
+        QUICErrorClass::APPLICATION, static_cast<uint16_t>(Http3ErrorCode::H3_STREAM_CREATION_ERROR), "Could not open stream"));
+      return;
+    }
+  }
 }
 
 void
@@ -273,6 +271,10 @@ Http3App::_handle_uni_stream_on_read_ready(int /* event */, VIO *vio)
   case Http3StreamType::QPACK_ENCODER:
   case Http3StreamType::QPACK_DECODER: {
     this->_set_qpack_stream(type, adapter);
+    // The instructions that came with the stream type are for QPACK now
+    if (vio->get_reader()->is_read_avail_more_than(0)) {
+      adapter->encourge_read();
+    }
     break;
   }
   case Http3StreamType::UNKNOWN: {
@@ -361,7 +363,10 @@ Http3App::_handle_uni_stream_on_write_ready(int /* event */, VIO *vio)
     break;
   case Http3StreamType::QPACK_ENCODER:
   case Http3StreamType::QPACK_DECODER: {
+    uint8_t buf[] = {static_cast<uint8_t>(it->second)};
+    vio->get_writer()->write(buf, sizeof(uint8_t));
     this->_set_qpack_stream(it->second, adapter);
+    break;
   }
   case Http3StreamType::UNKNOWN:
   case Http3StreamType::PUSH:
@@ -396,26 +401,20 @@ Http3App::_handle_uni_stream_on_eos(int /* event ATS_UNUSED */, VIO * /* v ATS_U
 void
 Http3App::_set_qpack_stream(Http3StreamType type, QUICStreamVCAdapter *adapter)
 {
+  // Our encoder stream and the peer's decoder stream are for the table we encode with, the peer's encoder stream and our
+  // decoder stream are for the table we decode with.
+  bool   sending = adapter->stream().direction() == QUICStreamDirection::SEND;
+  QPACK *qpack   = (type == Http3StreamType::QPACK_ENCODER) == sending ? this->_ssn->local_qpack() : this->_ssn->remote_qpack();
+
   // Change app to QPACK from Http3
   if (type == Http3StreamType::QPACK_ENCODER) {
-    if (this->_qc->direction() == NET_VCONNECTION_IN) {
-      this->_ssn->remote_qpack()->set_encoder_stream(adapter->stream().id());
-      this->_update_vio_cont_to_QPACK(this->_ssn->remote_qpack(), adapter);
-    } else {
-      this->_ssn->local_qpack()->set_encoder_stream(adapter->stream().id());
-      this->_update_vio_cont_to_QPACK(this->_ssn->local_qpack(), adapter);
-    }
+    qpack->set_encoder_stream(adapter->stream().id());
   } else if (type == Http3StreamType::QPACK_DECODER) {
-    if (this->_qc->direction() == NET_VCONNECTION_IN) {
-      this->_ssn->local_qpack()->set_decoder_stream(adapter->stream().id());
-      this->_update_vio_cont_to_QPACK(this->_ssn->local_qpack(), adapter);
-    } else {
-      this->_ssn->remote_qpack()->set_decoder_stream(adapter->stream().id());
-      this->_update_vio_cont_to_QPACK(this->_ssn->remote_qpack(), adapter);
-    }
+    qpack->set_decoder_stream(adapter->stream().id());
   } else {
     ink_abort("unknown stream type");
   }
+  this->_update_vio_cont_to_QPACK(qpack, adapter);
 }
 
 QUICStreamVCAdapter::IOInfo &
@@ -25,6 +25,7 @@
 #include "iocore/net/QUICSupport.h"
 
 #include "proxy/http3/Http3.h"
+#include "proxy/http3/Http3Config.h"
 #include "proxy/http3/Http3Types.h"
 
 //
@@ -178,10 +179,13 @@ HQSession::main_event_handler(int event, void *edata)
 Http3Session::Http3Session(NetVConnection *vc) : HQSession(vc)
 {
   QUICConnection *qc = vc->get_service<QUICSupport>()->get_quic_connection();
+  // The encoder starts with the defaults and follows the SETTINGS from the peer
   this->_local_qpack =
     new QPACK(qc, HTTP3_DEFAULT_MAX_FIELD_SECTION_SIZE, HTTP3_DEFAULT_HEADER_TABLE_SIZE, HTTP3_DEFAULT_QPACK_BLOCKED_STREAMS);
+  // The decoder enforces the limits we advertise in our SETTINGS
+  ts::Http3Config::scoped_config params;
   this->_remote_qpack =
-    new QPACK(qc, HTTP3_DEFAULT_MAX_FIELD_SECTION_SIZE, HTTP3_DEFAULT_HEADER_TABLE_SIZE, HTTP3_DEFAULT_QPACK_BLOCKED_STREAMS);
+    new QPACK(qc, params->max_field_section_size(), params->header_table_size(), params->qpack_blocked_streams());
 }
 
 Http3Session::~Http3Session()
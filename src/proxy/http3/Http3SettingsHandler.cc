@@ -55,23 +55,24 @@ Http3SettingsHandler::handle_frame(std::shared_ptr<const Http3Frame> frame, Http
   }
 
   // TODO: Add length check: the maximum number of values are 2^62 - 1, but some fields have shorter maximum than it.
+  // These settings limit what we send, so they apply to the encoder.
   if (settings_frame->contains(Http3SettingsId::HEADER_TABLE_SIZE)) {
     uint64_t header_table_size = settings_frame->get(Http3SettingsId::HEADER_TABLE_SIZE);
-    this->_session->remote_qpack()->update_max_table_size(header_table_size);
+    this->_session->local_qpack()->update_max_table_size(header_table_size);
 
     Dbg(dbg_ctl_http3, "SETTINGS_HEADER_TABLE_SIZE: %" PRId64, header_table_size);
   }
 
   if (settings_frame->contains(Http3SettingsId::MAX_FIELD_SECTION_SIZE)) {
     uint64_t max_field_section_size = settings_frame->get(Http3SettingsId::MAX_FIELD_SECTION_SIZE);
-    this->_session->remote_qpack()->update_max_field_section_size(max_field_section_size);
+    this->_session->local_qpack()->update_max_field_section_size(max_field_section_size);
 
     Dbg(dbg_ctl_http3, "SETTINGS_MAX_FIELD_SECTION_SIZE: %" PRId64, max_field_section_size);
   }
 
   if (settings_frame->contains(Http3SettingsId::QPACK_BLOCKED_STREAMS)) {
     uint64_t qpack_blocked_streams = settings_frame->get(Http3SettingsId::QPACK_BLOCKED_STREAMS);
-    this->_session->remote_qpack()->update_max_blocking_streams(qpack_blocked_streams);
+    this->_session->local_qpack()->update_max_blocking_streams(qpack_blocked_streams);
 
     Dbg(dbg_ctl_http3, "SETTINGS_QPACK_BLOCKED_STREAMS: %" PRId64, qpack_blocked_streams);
   }
@@ -24,6 +24,7 @@
 #include "proxy/hdrs/HTTP.h"
 #include "proxy/hdrs/XPACK.h"
 #include "proxy/http3/QPACK.h"
+#include "proxy/http3/Http3.h"
 #include "tscore/ink_defs.h"
 #include "tscore/ink_memory.h"
 
@@ -34,6 +35,9 @@ namespace
 {
 DbgCtl dbg_ctl_qpack{"qpack"};
 
+// RFC 9204 Section 3.2.1
+constexpr uint32_t ENTRY_OVERHEAD = 32;
+
 } // end anonymous namespace
 
 // qpack-05 Appendix A.
@@ -233,31 +237,52 @@ QPACK::encode(uint64_t stream_id, HTTPHdr &header_set, MIOBuffer *header_block,
     return -1;
   }
 
-  uint16_t base_index = this->_largest_known_received_index;
+  // Only the encoding side announces a capacity, the decoding side follows the peer's instructions
+  this->_update_encoder_table_capacity();
+
+  uint16_t base_index = this->_known_received_count;
+  bool     may_block  = this->_can_block(stream_id);
 
-  // Compress headers and record the largest reference
-  uint16_t       referred_index     = 0;
-  uint16_t       largest_reference  = 0;
-  uint16_t       smallest_reference = 0;
-  IOBufferBlock *compressed_headers = new_IOBufferBlock();
+  // Compress headers and record the required insert count
+  uint16_t              referred_insert_count = 0;
+  uint16_t              required_insert_count = 0;
+  uint64_t              uncompressed_len      = 0;
+  std::vector<uint16_t> referred_indices;
+  IOBufferBlock        *compressed_headers = new_IOBufferBlock();
   compressed_headers->alloc(BUFFER_SIZE_INDEX_2K);
 
   for (auto &field : header_set) {
-    int ret            = this->_encode_header(field, base_index, compressed_headers, referred_index);
-    largest_reference  = std::max(largest_reference, referred_index);
-    smallest_reference = std::min(smallest_reference, referred_index);
+    int ret = this->_encode_header(field, base_index, may_block, compressed_headers, referred_insert_count);
     if (ret < 0) {
+      for (auto index : referred_indices) {
+        this->_dynamic_table.unref_entry(index);
+      }
       compressed_headers->free();
       return ret;
     }
+    if (referred_insert_count > 0) {
+      required_insert_count = std::max(required_insert_count, referred_insert_count);
+      referred_indices.push_back(referred_insert_count - 1);
+    }
+    uncompressed_len += field.name_get().length() + field.value_get().length();
+  }
+
+  if (required_insert_count > 0) {
+    struct EntryReference &eref = this->_references[stream_id];
+    eref.required_insert_count  = std::max(eref.required_insert_count, required_insert_count);
+    eref.indices.insert(eref.indices.end(), referred_indices.begin(), referred_indices.end());
+    if (required_insert_count > this->_known_received_count) {
+      this->_blocking_streams.insert(stream_id);
+    }
+  } else {
+    // Base is meaningless without dynamic table references
+    base_index = 0;
   }
-  struct EntryReference eref = {smallest_reference, largest_reference};
-  this->_references.emplace(stream_id, eref);
 
   // Make an IOBufferBlock for Header Data Prefix
   IOBufferBlock *header_data_prefix = new_IOBufferBlock();
   header_data_prefix->alloc(BUFFER_SIZE_INDEX_128);
-  this->_encode_prefix(largest_reference, base_index, header_data_prefix);
+  this->_encode_prefix(required_insert_count, base_index, header_data_prefix);
 
   header_block->append_block(header_data_prefix);
   header_block_len += header_data_prefix->size();
@@ -265,6 +290,10 @@ QPACK::encode(uint64_t stream_id, HTTPHdr &header_set, MIOBuffer *header_block,
   header_block->append_block(compressed_headers);
   header_block_len += compressed_headers->size();
 
+  Metrics::Counter::increment(http3_rsb.qpack_encoder_header_bytes_uncompressed, uncompressed_len);
+  Metrics::Counter::increment(http3_rsb.qpack_encoder_header_bytes_compressed,
+                              header_data_prefix->size() + compressed_headers->size());
+
   return 0;
 }
 
@@ -281,17 +310,17 @@ QPACK::decode(uint64_t stream_id, const uint8_t *header_block, size_t header_blo
     return -1;
   }
 
-  uint64_t tmp = 0;
-  int64_t  ret = xpack_decode_integer(tmp, header_block, header_block + header_block_len, 8);
-  if (ret < 0 && tmp > 0xFFFF) {
+  uint64_t encoded_insert_count  = 0;
+  uint16_t required_insert_count = 0;
+  if (xpack_decode_integer(encoded_insert_count, header_block, header_block + header_block_len, 8) < 0 ||
+      this->_decode_required_insert_count(encoded_insert_count, required_insert_count) < 0) {
     return -1;
   }
-  uint16_t largest_reference = tmp;
 
-  if (largest_reference != 0 && (this->_dynamic_table.is_empty() || this->_dynamic_table.largest_index() < largest_reference)) {
+  if (required_insert_count > this->_dynamic_table.insert_count()) {
     // Blocked
     if (this->_add_to_blocked_list(
-          new DecodeRequest(largest_reference, thread, cont, stream_id, header_block, header_block_len, hdr))) {
+          new DecodeRequest(required_insert_count, thread, cont, stream_id, header_block, header_block_len, hdr))) {
       return 1;
     } else {
       // Number of blocked streams exceed the limit
@@ -299,7 +328,7 @@ QPACK::decode(uint64_t stream_id, const uint8_t *header_block, size_t header_blo
     }
   }
 
-  this->_decode(thread, cont, stream_id, header_block, header_block_len, hdr);
+  this->_decode(thread, cont, stream_id, required_insert_count, header_block, header_block_len, hdr);
 
   return 0;
 }
@@ -307,7 +336,8 @@ QPACK::decode(uint64_t stream_id, const uint8_t *header_block, size_t header_blo
 void
 QPACK::set_encoder_stream(QUICStreamId id)
 {
-  this->_encoder_stream_id = id;
+  this->_encoder_stream_id  = id;
+  this->_has_encoder_stream = true;
 }
 
 void
@@ -326,6 +356,7 @@ void
 QPACK::update_max_table_size(uint16_t max_table_size)
 {
   this->_max_table_size = max_table_size;
+  this->_update_encoder_table_capacity();
 }
 
 void
@@ -335,22 +366,31 @@ QPACK::update_max_blocking_streams(uint16_t max_blocking_streams)
 }
 
 int
-QPACK::_encode_prefix(uint16_t largest_reference, uint16_t base_index, IOBufferBlock *prefix)
+QPACK::_encode_prefix(uint16_t required_insert_count, uint16_t base_index, IOBufferBlock *prefix)
 {
+  // Encoded Required Insert Count (RFC 9204 Section 4.5.1.1)
+  uint64_t encoded_insert_count = 0;
+  if (required_insert_count > 0) {
+    uint32_t max_entries = this->_max_table_size / ENTRY_OVERHEAD;
+    ink_assert(max_entries > 0);
+    encoded_insert_count = (required_insert_count % (2 * max_entries)) + 1;
+  }
+
   int ret;
   if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(prefix->end()),
-                                  reinterpret_cast<uint8_t *>(prefix->end() + prefix->write_avail()), largest_reference, 8)) < 0) {
+                                  reinterpret_cast<uint8_t *>(prefix->end() + prefix->write_avail()), encoded_insert_count,
+                                  8)) < 0) {
     return -1;
   }
   prefix->fill(ret);
 
   uint16_t delta;
   prefix->end()[0] = 0x0;
-  if (base_index < largest_reference) {
+  if (base_index < required_insert_count) {
     prefix->end()[0] |= 0x80;
-    delta             = largest_reference - base_index;
+    delta             = required_insert_count - base_index - 1;
   } else {
-    delta = base_index - largest_reference;
+    delta = base_index - required_insert_count;
   }
 
   if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(prefix->end()),
@@ -359,13 +399,15 @@ QPACK::_encode_prefix(uint16_t largest_reference, uint16_t base_index, IOBufferB
   }
   prefix->fill(ret);
 
-  QPACKDebug("Encoded Header Data Prefix: largest_ref=%d, base_index=%d, delta=%d", largest_reference, base_index, delta);
+  QPACKDebug("Encoded Header Data Prefix: required_insert_count=%d, base_index=%d, delta=%d", required_insert_count, base_index,
+             delta);
 
   return 0;
 }
 
 int
-QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock *compressed_header, uint16_t &referred_index)
+QPACK::_encode_header(const MIMEField &field, uint16_t base_index, bool may_block, IOBufferBlock *compressed_header,
+                      uint16_t &required_insert_count)
 {
   auto  name{field.name_get()};
   char *lowered_name = this->_arena.str_store(name.data(), name.length());
@@ -377,84 +419,43 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
   // TODO Set never_index flag on/off according to encoding headers
   bool never_index = false;
 
-  // Find from tables, and insert / duplicate a entry prior to encode it
+  required_insert_count = 0;
+
+  // Find from tables, and insert a entry prior to encode it
   XpackLookupResult lookup_result_static;
   XpackLookupResult lookup_result_dynamic;
   lookup_result_static = StaticTable::lookup(lowered_name, name.length(), value.data(), value.length());
   if (lookup_result_static.match_type != XpackLookupResult::MatchType::EXACT) {
     lookup_result_dynamic = this->_dynamic_table.lookup(lowered_name, name.length(), value.data(), value.length());
-    if (lookup_result_dynamic.match_type == XpackLookupResult::MatchType::EXACT) {
-      if (this->_dynamic_table.should_duplicate(lookup_result_dynamic.index)) {
-        // Duplicate an entry and use the new entry
-        uint16_t current_index = lookup_result_dynamic.index;
-        lookup_result_dynamic  = this->_dynamic_table.duplicate_entry(current_index);
-        if (lookup_result_dynamic.match_type != XpackLookupResult::MatchType::NONE) {
-          this->_write_duplicate(current_index);
-          QPACKDebug("Wrote Duplicate: current_index=%d", current_index);
-          this->_dynamic_table.ref_entry(current_index);
-        }
-      }
-    } else if (lookup_result_static.match_type == XpackLookupResult::MatchType::NAME) {
-      if (never_index) {
-        // Name in static table is always available. Do nothing.
-      } else {
-        // Insert both the name and the value
-        lookup_result_dynamic = this->_dynamic_table.insert_entry(lowered_name, name.length(), value.data(), value.length());
-        if (lookup_result_dynamic.match_type != XpackLookupResult::MatchType::NONE) {
+    if (lookup_result_dynamic.match_type != XpackLookupResult::MatchType::NONE &&
+        lookup_result_dynamic.index >= this->_known_received_count && !may_block) {
+      // Referring an entry that the decoder may not have received would block this stream, and we are out of blocked streams.
+      lookup_result_dynamic = {};
+    }
+
+    // Insert an entry only if this header block can refer it right away. The decoder acknowledges the insertion when it
+    // acknowledges this header block, so the entry becomes usable for the following header blocks without blocking them.
+    if (lookup_result_dynamic.match_type != XpackLookupResult::MatchType::EXACT && !never_index && may_block &&
+        this->_should_insert(name.length(), value.length())) {
+      uint32_t insert_count = this->_dynamic_table.insert_count();
+      if (this->_dynamic_table.insert_entry(lowered_name, name.length(), value.data(), value.length()).match_type !=
+          XpackLookupResult::MatchType::NONE) {
+        if (lookup_result_static.match_type == XpackLookupResult::MatchType::NAME) {
           this->_write_insert_with_name_ref(lookup_result_static.index, false, value.data(), value.length());
           QPACKDebug("Wrote Insert With Name Ref: index=%u, dynamic_table=%d value=%.*s", lookup_result_static.index, false,
                      static_cast<int>(value.length()), value.data());
-        }
-      }
-    } else if (lookup_result_dynamic.match_type == XpackLookupResult::MatchType::NAME) {
-      if (never_index) {
-        if (this->_dynamic_table.should_duplicate(lookup_result_dynamic.index)) {
-          // Duplicate an entry and use the new entry
-          uint16_t current_index = lookup_result_dynamic.index;
-          lookup_result_dynamic  = this->_dynamic_table.duplicate_entry(current_index);
-          if (lookup_result_dynamic.match_type != XpackLookupResult::MatchType::NONE) {
-            this->_write_duplicate(current_index);
-            QPACKDebug("Wrote Duplicate: current_index=%d", current_index);
-            this->_dynamic_table.ref_entry(current_index);
-          }
-        }
-      } else {
-        if (this->_dynamic_table.should_duplicate(lookup_result_dynamic.index)) {
-          // Duplicate an entry and use the new entry
-          uint16_t current_index = lookup_result_dynamic.index;
-          lookup_result_dynamic  = this->_dynamic_table.duplicate_entry(current_index);
-          if (lookup_result_dynamic.match_type != XpackLookupResult::MatchType::NONE) {
-            this->_write_duplicate(current_index);
-            QPACKDebug("Wrote Duplicate: current_index=%d", current_index);
-            this->_dynamic_table.ref_entry(current_index);
-          }
+        } else if (lookup_result_dynamic.match_type == XpackLookupResult::MatchType::NAME) {
+          // The name index of an encoder instruction is relative to the insert count
+          uint16_t relative_index = insert_count - 1 - lookup_result_dynamic.index;
+          this->_write_insert_with_name_ref(relative_index, true, value.data(), value.length());
+          QPACKDebug("Wrote Insert With Name Ref: index=%u, dynamic_table=%d, value=%.*s", relative_index, true,
+                     static_cast<int>(value.length()), value.data());
         } else {
-          // Insert both the name and the value
-          uint16_t current_index = lookup_result_dynamic.index;
-          lookup_result_dynamic  = this->_dynamic_table.insert_entry(lowered_name, name.length(), value.data(), value.length());
-          if (lookup_result_dynamic.match_type != XpackLookupResult::MatchType::NONE) {
-            this->_write_insert_with_name_ref(current_index, true, value.data(), value.length());
-            QPACKDebug("Wrote Insert With Name Ref: index=%u, dynamic_table=%d, value=%.*s", current_index, true,
-                       static_cast<int>(value.length()), value.data());
-          }
-        }
-      }
-    } else {
-      if (never_index) {
-        // Insert only the name
-        lookup_result_dynamic = this->_dynamic_table.insert_entry(lowered_name, name.length(), "", 0);
-        if (lookup_result_dynamic.match_type != XpackLookupResult::MatchType::NONE) {
-          this->_write_insert_without_name_ref(lowered_name, name.length(), "", 0);
-          QPACKDebug("Wrote Insert Without Name Ref: name=%.*s value=%.*s", static_cast<int>(name.length()), lowered_name, 0, "");
-        }
-      } else {
-        // Insert both the name and the value
-        lookup_result_dynamic = this->_dynamic_table.insert_entry(lowered_name, name.length(), value.data(), value.length());
-        if (lookup_result_dynamic.match_type != XpackLookupResult::MatchType::NONE) {
           this->_write_insert_without_name_ref(lowered_name, name.length(), value.data(), value.length());
           QPACKDebug("Wrote Insert Without Name Ref: name=%.*s value=%.*s", static_cast<int>(name.length()), lowered_name,
                      static_cast<int>(value.length()), value.data());
         }
+        lookup_result_dynamic = {insert_count, XpackLookupResult::MatchType::EXACT};
       }
     }
   }
@@ -464,9 +465,8 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
     this->_encode_indexed_header_field(lookup_result_static.index, base_index, false, compressed_header);
     QPACKDebug("Encoded Indexed Header Field: abs_index=%d, base_index=%d, dynamic_table=%d", lookup_result_static.index,
                base_index, false);
-    referred_index = 0;
   } else if (lookup_result_dynamic.match_type == XpackLookupResult::MatchType::EXACT) {
-    if (lookup_result_dynamic.index < this->_largest_known_received_index) {
+    if (lookup_result_dynamic.index < base_index) {
       this->_encode_indexed_header_field(lookup_result_dynamic.index, base_index, true, compressed_header);
       QPACKDebug("Encoded Indexed Header Field: abs_index=%d, base_index=%d, dynamic_table=%d", lookup_result_dynamic.index,
                  base_index, true);
@@ -477,16 +477,15 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
                  lookup_result_dynamic.index, base_index, never_index);
     }
     this->_dynamic_table.ref_entry(lookup_result_dynamic.index);
-    referred_index = lookup_result_dynamic.index;
+    required_insert_count = lookup_result_dynamic.index + 1;
   } else if (lookup_result_static.match_type == XpackLookupResult::MatchType::NAME) {
     this->_encode_literal_header_field_with_name_ref(lookup_result_static.index, false, base_index, value.data(), value.length(),
                                                      never_index, compressed_header);
     QPACKDebug(
       "Encoded Literal Header Field With Name Ref: abs_index=%d, base_index=%d, dynamic_table=%d, value=%.*s, never_index=%d",
       lookup_result_static.index, base_index, false, static_cast<int>(value.length()), value.data(), never_index);
-    referred_index = 0;
   } else if (lookup_result_dynamic.match_type == XpackLookupResult::MatchType::NAME) {
-    if (lookup_result_dynamic.index <= this->_largest_known_received_index) {
+    if (lookup_result_dynamic.index < base_index) {
       this->_encode_literal_header_field_with_name_ref(lookup_result_dynamic.index, true, base_index, value.data(), value.length(),
                                                        never_index, compressed_header);
       QPACKDebug(
@@ -499,7 +498,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
                  lookup_result_dynamic.index, base_index, static_cast<int>(value.length()), value.data(), never_index);
     }
     this->_dynamic_table.ref_entry(lookup_result_dynamic.index);
-    referred_index = lookup_result_dynamic.index;
+    required_insert_count = lookup_result_dynamic.index + 1;
   } else {
     this->_encode_literal_header_field_without_name_ref(lowered_name, name.length(), value.data(), value.length(), never_index,
                                                         compressed_header);
@@ -686,7 +685,7 @@ QPACK::_encode_literal_header_field_with_postbase_name_ref(uint16_t index, uint1
 }
 
 int
-QPACK::_decode_indexed_header_field(int16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr, uint32_t &header_len)
+QPACK::_decode_indexed_header_field(uint16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr, uint32_t &header_len)
 {
   // Read index field
   int      len = 0;
@@ -725,7 +724,7 @@ QPACK::_decode_indexed_header_field(int16_t base_index, const uint8_t *buf, size
 }
 
 int
-QPACK::_decode_literal_header_field_with_name_ref(int16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
+QPACK::_decode_literal_header_field_with_name_ref(uint16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
                                                   uint32_t &header_len)
 {
   int read_len = 0;
@@ -822,7 +821,7 @@ QPACK::_decode_literal_header_field_without_name_ref(const uint8_t *buf, size_t
 }
 
 int
-QPACK::_decode_indexed_header_field_with_postbase_index(int16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
+QPACK::_decode_indexed_header_field_with_postbase_index(uint16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
                                                         uint32_t &header_len)
 {
   // Read index field
@@ -858,7 +857,7 @@ QPACK::_decode_indexed_header_field_with_postbase_index(int16_t base_index, cons
 }
 
 int
-QPACK::_decode_literal_header_field_with_postbase_name_ref(int16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
+QPACK::_decode_literal_header_field_with_postbase_name_ref(uint16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
                                                            uint32_t &header_len)
 {
   int read_len = 0;
@@ -911,41 +910,44 @@ QPACK::_decode_literal_header_field_with_postbase_name_ref(int16_t base_index, c
 }
 
 int
-QPACK::_decode_header(const uint8_t *header_block, size_t header_block_len, HTTPHdr &hdr)
+QPACK::_decode_header(uint16_t required_insert_count, const uint8_t *header_block, size_t header_block_len, HTTPHdr &hdr)
 {
-  const uint8_t *pos        = header_block;
-  size_t         remain_len = header_block_len;
+  const uint8_t *pos = header_block;
+  const uint8_t *end = header_block + header_block_len;
   int64_t        ret;
 
-  // Decode Header Data Prefix
+  // Decode Header Data Prefix. The Required Insert Count has been decoded by the caller already.
   uint64_t tmp;
-  if ((ret = xpack_decode_integer(tmp, pos, pos + remain_len, 8)) < 0 && tmp > 0xFFFF) {
+  if ((ret = xpack_decode_integer(tmp, pos, end, 8)) < 0) {
     return -1;
   }
-  pos                        += ret;
-  uint16_t largest_reference  = tmp;
+  pos += ret;
 
   uint64_t delta_base_index;
   uint16_t base_index;
-  if ((ret = xpack_decode_integer(delta_base_index, pos, pos + remain_len, 7)) < 0 && delta_base_index < 0xFFFF) {
+  if ((ret = xpack_decode_integer(delta_base_index, pos, end, 7)) < 0 || delta_base_index > 0xFFFF) {
     return -2;
   }
 
   if (pos[0] & 0x80) {
-    if (delta_base_index == 0) {
+    if (delta_base_index >= required_insert_count) {
       return -3;
     }
-    base_index = largest_reference - delta_base_index;
+    base_index = required_insert_count - delta_base_index - 1;
   } else {
-    base_index = largest_reference + delta_base_index;
+    if (required_insert_count + delta_base_index > 0xFFFF) {
+      return -3;
+    }
+    base_index = required_insert_count + delta_base_index;
   }
   pos += ret;
 
   uint32_t decoded_header_list_size = 0;
 
   // Decode Instructions
-  while (pos < header_block + header_block_len) {
+  while (pos < end) {
     uint32_t header_len = 0;
+    size_t   remain_len = end - pos;
 
     if (pos[0] & 0x80) { // Index Header Field
       ret = this->_decode_indexed_header_field(base_index, pos, remain_len, hdr, header_len);
@@ -975,18 +977,54 @@ QPACK::_decode_header(const uint8_t *header_block, size_t header_block_len, HTTP
   return ret;
 }
 
+int
+QPACK::_decode_required_insert_count(uint64_t encoded_insert_count, uint16_t &required_insert_count) const
+{
+  // RFC 9204 Section 4.5.1.1
+  if (encoded_insert_count == 0) {
+    required_insert_count = 0;
+    return 0;
+  }
+
+  uint64_t max_entries = this->_max_table_size / ENTRY_OVERHEAD;
+  uint64_t full_range  = 2 * max_entries;
+  if (encoded_insert_count > full_range) {
+    return -1;
+  }
+
+  uint64_t max_value   = this->_dynamic_table.insert_count() + max_entries;
+  uint64_t max_wrapped = (max_value / full_range) * full_range;
+  uint64_t ric         = max_wrapped + encoded_insert_count - 1;
+  if (ric > max_value) {
+    if (ric <= full_range) {
+      return -1;
+    }
+    ric -= full_range;
+  }
+
+  if (ric == 0 || ric > 0xFFFF) {
+    return -1;
+  }
+  required_insert_count = ric;
+
+  return 0;
+}
+
 void
-QPACK::_decode(EThread *ethread, Continuation *cont, uint64_t stream_id, const uint8_t *header_block, size_t header_block_len,
-               HTTPHdr &hdr)
+QPACK::_decode(EThread *ethread, Continuation *cont, uint64_t stream_id, uint16_t required_insert_count,
+               const uint8_t *header_block, size_t header_block_len, HTTPHdr &hdr)
 {
   int event;
-  int res = this->_decode_header(header_block, header_block_len, hdr);
+  int res = this->_decode_header(required_insert_count, header_block, header_block_len, hdr);
   if (res < 0) {
     event = QPACK_EVENT_DECODE_FAILED;
     QPACKDebug("decoding header failed (%d)", res);
   } else {
     event = QPACK_EVENT_DECODE_COMPLETE;
-    this->_write_header_acknowledgement(stream_id);
+    // Header blocks that do not refer the dynamic table are not acknowledged
+    if (required_insert_count > 0) {
+      this->_write_header_acknowledgement(stream_id);
+    }
   }
   ethread->schedule_imm(cont, event, &hdr);
 }
@@ -999,30 +1037,85 @@ QPACK::_add_to_blocked_list(DecodeRequest *decode_request)
   }
 
   this->_blocked_list.append(decode_request);
+  Metrics::Counter::increment(http3_rsb.qpack_decoder_blocked_streams);
   return true;
 }
 
 void
-QPACK::_update_largest_known_received_index_by_insert_count(uint16_t insert_count)
+QPACK::_update_known_received_count_by_insert_count(uint16_t insert_count)
+{
+  uint32_t known_received_count = this->_known_received_count + insert_count;
+  this->_known_received_count   = std::min(known_received_count, this->_dynamic_table.insert_count());
+  this->_prune_blocking_streams();
+}
+
+void
+QPACK::_update_known_received_count_by_stream_id(uint64_t stream_id)
 {
-  this->_largest_known_received_index += insert_count;
+  auto it = this->_references.find(stream_id);
+  if (it == this->_references.end()) {
+    return;
+  }
+
+  if (it->second.required_insert_count > this->_known_received_count) {
+    this->_known_received_count = it->second.required_insert_count;
+  }
+  this->_blocking_streams.erase(stream_id);
+  this->_prune_blocking_streams();
 }
 
 void
-QPACK::_update_largest_known_received_index_by_stream_id(uint64_t stream_id)
+QPACK::_prune_blocking_streams()
 {
-  uint16_t largest_ref_index = this->_references[stream_id].largest;
-  if (largest_ref_index > this->_largest_known_received_index) {
-    this->_largest_known_received_index = largest_ref_index;
+  for (auto it = this->_blocking_streams.begin(); it != this->_blocking_streams.end();) {
+    auto ref = this->_references.find(*it);
+    if (ref == this->_references.end() || ref->second.required_insert_count <= this->_known_received_count) {
+      it = this->_blocking_streams.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool
+QPACK::_can_block(uint64_t stream_id) const
+{
+  return this->_blocking_streams.count(stream_id) > 0 || this->_blocking_streams.size() < this->_max_blocking_streams;
+}
+
+bool
+QPACK::_should_insert(size_t name_len, size_t value_len) const
+{
+  // Large entries would evict most of the table to make a room for a field that may never be seen again
+  uint64_t entry_size = static_cast<uint64_t>(name_len) + value_len + ENTRY_OVERHEAD;
+  return this->_announced_table_capacity > 0 && entry_size * ENTRY_SIZE_RATIO_TO_INSERT <= this->_announced_table_capacity;
+}
+
+void
+QPACK::_update_encoder_table_capacity()
+{
+  // The initial capacity of the decoder's table is 0, so the capacity has to be told on the encoder stream before using it.
+  if (!this->_has_encoder_stream || this->_announced_table_capacity == this->_max_table_size) {
+    return;
+  }
+
+  if (this->_dynamic_table.update_maximum_size(this->_max_table_size)) {
+    this->_write_dynamic_table_size_update(this->_max_table_size);
+    this->_announced_table_capacity = this->_max_table_size;
+    QPACKDebug("Wrote Dynamic Table Size Update: max_size=%d", this->_max_table_size);
   }
 }
 
 void
 QPACK::_update_reference_counts(uint64_t stream_id)
 {
-  uint16_t smallest_ref_index = this->_references[stream_id].smallest;
-  if (smallest_ref_index) {
-    this->_dynamic_table.unref_entry(smallest_ref_index);
+  auto it = this->_references.find(stream_id);
+  if (it == this->_references.end()) {
+    return;
+  }
+
+  for (auto index : it->second.indices) {
+    this->_dynamic_table.unref_entry(index);
   }
 }
 
@@ -1031,8 +1124,10 @@ QPACK::_resume_decode()
 {
   DecodeRequest *r = this->_blocked_list.head();
   while (r) {
-    if (this->_largest_known_received_index >= r->largest_reference()) {
-      this->_decode(r->thread(), r->continuation(), r->stream_id(), r->header_block(), r->header_block_len(), r->hdr());
+    if (this->_dynamic_table.insert_count() >= r->largest_reference()) {
+      Metrics::Counter::increment(http3_rsb.qpack_decoder_blocked_time, ink_hrtime_to_msec(ink_get_hrtime() - r->blocked_at()));
+      this->_decode(r->thread(), r->continuation(), r->stream_id(), r->largest_reference(), r->header_block(),
+                    r->header_block_len(), r->hdr());
       DecodeRequest *tmp = r;
       r                  = DecodeRequest::Linkage::next_ptr(r);
       this->_blocked_list.erase(tmp);
@@ -1050,15 +1145,11 @@ QPACK::_abort_decode()
 
   DecodeRequest *r = this->_blocked_list.head();
   while (r) {
-    if (this->_largest_known_received_index >= r->largest_reference()) {
-      r->thread()->schedule_imm(r->continuation(), QPACK_EVENT_DECODE_FAILED, nullptr);
-      DecodeRequest *tmp = r;
-      r                  = DecodeRequest::Linkage::next_ptr(r);
-      this->_blocked_list.erase(tmp);
-      delete tmp;
-    } else {
-      r = DecodeRequest::Linkage::next_ptr(r);
-    }
+    r->thread()->schedule_imm(r->continuation(), QPACK_EVENT_DECODE_FAILED, nullptr);
+    DecodeRequest *tmp = r;
+    r                  = DecodeRequest::Linkage::next_ptr(r);
+    this->_blocked_list.erase(tmp);
+    delete tmp;
   }
 }
 
@@ -1098,30 +1189,34 @@ QPACK::_on_write_ready(VIO *vio)
 int
 QPACK::_on_decoder_stream_read_ready(IOBufferReader &reader)
 {
-  if (reader.is_read_avail_more_than(0)) {
+  while (reader.is_read_avail_more_than(0)) {
     uint8_t buf;
     reader.memcpy(&buf, 1);
     if (buf & 0x80) { // Header Acknowledgement
       uint64_t stream_id;
-      if (this->_read_header_acknowledgement(reader, stream_id) >= 0) {
-        QPACKDebug("Received Header Acknowledgement: stream_id=%" PRIu64, stream_id);
-        this->_update_largest_known_received_index_by_stream_id(stream_id);
-        this->_update_reference_counts(stream_id);
-        this->_references.erase(stream_id);
+      if (this->_read_header_acknowledgement(reader, stream_id) < 0) {
+        break;
       }
+      QPACKDebug("Received Header Acknowledgement: stream_id=%" PRIu64, stream_id);
+      this->_update_known_received_count_by_stream_id(stream_id);
+      this->_update_reference_counts(stream_id);
+      this->_references.erase(stream_id);
     } else if (buf & 0x40) { // Stream Cancellation
       uint64_t stream_id;
-      if (this->_read_stream_cancellation(reader, stream_id) >= 0) {
-        QPACKDebug("Received Stream Cancellation: stream_id=%" PRIu64, stream_id);
-        this->_update_reference_counts(stream_id);
-        this->_references.erase(stream_id);
+      if (this->_read_stream_cancellation(reader, stream_id) < 0) {
+        break;
       }
+      QPACKDebug("Received Stream Cancellation: stream_id=%" PRIu64, stream_id);
+      this->_update_reference_counts(stream_id);
+      this->_references.erase(stream_id);
+      this->_blocking_streams.erase(stream_id);
     } else { // Table State Synchronize
       uint16_t insert_count;
-      if (this->_read_table_state_synchronize(reader, insert_count) >= 0) {
-        QPACKDebug("Received Table State Synchronize: inserted_count=%d", insert_count);
-        this->_update_largest_known_received_index_by_insert_count(insert_count);
+      if (this->_read_table_state_synchronize(reader, insert_count) < 0) {
+        break;
       }
+      QPACKDebug("Received Table State Synchronize: inserted_count=%d", insert_count);
+      this->_update_known_received_count_by_insert_count(insert_count);
     }
   }
 
@@ -1149,8 +1244,22 @@ QPACK::_on_encoder_stream_read_ready(IOBufferReader &reader)
       }
       QPACKDebug("Received Insert With Name Ref: is_static=%d, index=%d, value=%.*s", is_static, index, static_cast<int>(value_len),
                  value);
-      StaticTable::lookup(index, &name, &name_len, &dummy, &dummy_len);
-      this->_dynamic_table.insert_entry(name, name_len, value, value_len);
+      XpackLookupResult result;
+      if (is_static) {
+        result = StaticTable::lookup(index, &name, &name_len, &dummy, &dummy_len);
+      } else {
+        // The index is relative to the insert count
+        result = this->_dynamic_table.lookup_relative(index, &name, &name_len, &dummy, &dummy_len);
+      }
+      if (result.match_type != XpackLookupResult::MatchType::EXACT) {
+        this->_arena.str_free(value);
+        this->_abort_decode();
+        return EVENT_DONE;
+      }
+      // The name can be in the dynamic table and get evicted by this insertion
+      char *duped_name = this->_arena.str_store(name, name_len);
+      this->_dynamic_table.insert_entry(duped_name, name_len, value, value_len);
+      this->_arena.str_free(duped_name);
       this->_arena.str_free(value);
     } else if (buf & 0x40) { // Insert Without Name Reference
       char  *name;
@@ -1165,9 +1274,10 @@ QPACK::_on_encoder_stream_read_ready(IOBufferReader &reader)
                  static_cast<int>(value_len), value);
       this->_dynamic_table.insert_entry(name, name_len, value, value_len);
       this->_arena.str_free(name);
+      this->_arena.str_free(value);
     } else if (buf & 0x20) { // Dynamic Table Size Update
       uint16_t max_size;
-      if (this->_read_dynamic_table_size_update(reader, max_size) < 0) {
+      if (this->_read_dynamic_table_size_update(reader, max_size) < 0 || max_size > this->_max_table_size) {
         this->_abort_decode();
         return EVENT_DONE;
       }
@@ -1180,7 +1290,8 @@ QPACK::_on_encoder_stream_read_ready(IOBufferReader &reader)
         return EVENT_DONE;
       }
       QPACKDebug("Received Duplicate: index=%d", index);
-      this->_dynamic_table.duplicate_entry(index);
+      // The index is relative to the insert count
+      this->_dynamic_table.duplicate_entry(this->_dynamic_table.insert_count() - 1 - index);
     }
 
     this->_resume_decode();
@@ -1215,6 +1326,10 @@ QPACK::estimate_header_block_size(const HTTPHdr & /* hdr ATS_UNUSED */)
 const XpackLookupResult
 QPACK::StaticTable::lookup(uint16_t index, const char **name, size_t *name_len, const char **value, size_t *value_len)
 {
+  if (index >= countof(STATIC_HEADER_FIELDS)) {
+    return {0, XpackLookupResult::MatchType::NONE};
+  }
+
   const Header &header = STATIC_HEADER_FIELDS[index];
   *name                = header.name;
   *name_len            = header.name_len;
@@ -1250,28 +1365,29 @@ QPACK::StaticTable::lookup(const char *name, size_t name_len, const char *value,
   return {candidate_index, match_type};
 }
 
+// Absolute indices start from 0 as in RFC 9204 Section 3.2.4, which matches the indices in XpackDynamicTable.
 uint16_t
 QPACK::_calc_absolute_index_from_relative_index(uint16_t base_index, uint16_t relative_index)
 {
-  return base_index - relative_index;
+  return base_index - 1 - relative_index;
 }
 
 uint16_t
 QPACK::_calc_absolute_index_from_postbase_index(uint16_t base_index, uint16_t postbase_index)
 {
-  return base_index + postbase_index + 1;
+  return base_index + postbase_index;
 }
 
 uint16_t
 QPACK::_calc_relative_index_from_absolute_index(uint16_t base_index, uint16_t absolute_index)
 {
-  return base_index - absolute_index;
+  return base_index - 1 - absolute_index;
 }
 
 uint16_t
 QPACK::_calc_postbase_index_from_absolute_index(uint16_t base_index, uint16_t absolute_index)
 {
-  return absolute_index - base_index - 1;
+  return absolute_index - base_index;
 }
 
 void
@@ -1369,6 +1485,9 @@ QPACK::_write_duplicate(uint16_t index)
   char *buf_end = buf + instruction->write_avail();
   int   written = 0;
 
+  // Duplicate
+  buf[0] = 0x00;
+
   // Index
   int ret;
   if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(buf + written), reinterpret_cast<uint8_t *>(buf_end), index, 5)) <
@@ -1422,6 +1541,9 @@ QPACK::_write_table_state_synchronize(uint16_t insert_count)
   char *buf_end = buf + instruction->write_avail();
   int   written = 0;
 
+  // Insert Count Increment
+  buf[0] = 0x00;
+
   // Insert Count
   int ret;
   if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(buf + written), reinterpret_cast<uint8_t *>(buf_end), insert_count,
@@ -1432,7 +1554,7 @@ QPACK::_write_table_state_synchronize(uint16_t insert_count)
 
   // Finalize and Schedule to send
   instruction->fill(written);
-  this->_encoder_stream_sending_instructions->append_block(instruction);
+  this->_decoder_stream_sending_instructions->append_block(instruction);
 
   return 0;
 }
@@ -1460,7 +1582,7 @@ QPACK::_write_header_acknowledgement(uint64_t stream_id)
 
   // Finalize and Schedule to send
   instruction->fill(written);
-  this->_encoder_stream_sending_instructions->append_block(instruction);
+  this->_decoder_stream_sending_instructions->append_block(instruction);
 
   return 0;
 }
@@ -1480,7 +1602,7 @@ QPACK::_write_stream_cancellation(uint64_t stream_id)
 
   // Stream ID
   int ret;
-  if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(buf + written), reinterpret_cast<uint8_t *>(buf_end), stream_id, 7)) <
+  if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(buf + written), reinterpret_cast<uint8_t *>(buf_end), stream_id, 6)) <
       0) {
     return ret;
   }
@@ -1488,7 +1610,7 @@ QPACK::_write_stream_cancellation(uint64_t stream_id)
 
   // Finalize and Schedule to send
   instruction->fill(written);
-  this->_encoder_stream_sending_instructions->append_block(instruction);
+  this->_decoder_stream_sending_instructions->append_block(instruction);
 
   return 0;
 }
@@ -1508,14 +1630,14 @@ QPACK::_read_insert_with_name_ref(IOBufferReader &reader, bool &is_static, uint1
 
   // Name Index
   uint64_t tmp;
-  if ((ret = xpack_decode_integer(tmp, input, input + input_len, 6)) < 0 && tmp > 0xFFFF) {
+  if ((ret = xpack_decode_integer(tmp, input, input + input_len, 6)) < 0 || tmp > 0xFFFF) {
     return -1;
   }
   index     = tmp;
   read_len += ret;
 
   // Value
-  if ((ret = xpack_decode_string(arena, value, tmp, input + read_len, input + input_len, 7)) < 0 && tmp > 0xFF) {
+  if ((ret = xpack_decode_string(arena, value, tmp, input + read_len, input + input_len, 7)) < 0 || tmp > 0xFFFF) {
     return -1;
   }
   value_len  = tmp;
@@ -1538,14 +1660,14 @@ QPACK::_read_insert_without_name_ref(IOBufferReader &reader, Arena &arena, char
 
   // Name
   uint64_t tmp;
-  if ((ret = xpack_decode_string(arena, name, tmp, input, input + input_len, 5)) < 0 && tmp > 0xFFFF) {
+  if ((ret = xpack_decode_string(arena, name, tmp, input, input + input_len, 5)) < 0 || tmp > 0xFFFF) {
     return -1;
   }
   name_len  = tmp;
   read_len += ret;
 
   // Value
-  if ((ret = xpack_decode_string(arena, value, tmp, input + read_len, input + input_len, 7)) < 0 && tmp > 0xFFFF) {
+  if ((ret = xpack_decode_string(arena, value, tmp, input + read_len, input + input_len, 7)) < 0 || tmp > 0xFFFF) {
     return -1;
   }
   value_len  = tmp;
@@ -1567,7 +1689,7 @@ QPACK::_read_duplicate(IOBufferReader &reader, uint16_t &index)
 
   // Index
   uint64_t tmp;
-  if ((ret = xpack_decode_integer(tmp, input, input + input_len, 5)) < 0 && tmp > 0xFFFF) {
+  if ((ret = xpack_decode_integer(tmp, input, input + input_len, 5)) < 0 || tmp > 0xFFFF) {
     return -1;
   }
   index     = tmp;
@@ -1589,7 +1711,7 @@ QPACK::_read_dynamic_table_size_update(IOBufferReader &reader, uint16_t &max_siz
   uint64_t tmp;
 
   // Max Size
-  if ((ret = xpack_decode_integer(tmp, input, input + input_len, 5)) < 0 && tmp > 0xFFFF) {
+  if ((ret = xpack_decode_integer(tmp, input, input + input_len, 5)) < 0 || tmp > 0xFFFF) {
     return -1;
   }
   max_size  = tmp;
@@ -1611,7 +1733,7 @@ QPACK::_read_table_state_synchronize(IOBufferReader &reader, uint16_t &insert_co
   uint64_t tmp;
 
   // Insert Count
-  if ((ret = xpack_decode_integer(tmp, input, input + input_len, 6)) < 0 && tmp > 0xFFFF) {
+  if ((ret = xpack_decode_integer(tmp, input, input + input_len, 6)) < 0 || tmp > 0xFFFF) {
     return -1;
   }
   insert_count  = tmp;
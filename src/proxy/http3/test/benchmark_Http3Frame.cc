@@ -0,0 +1,314 @@
+/** @file
+
+  Throughput benchmark of HTTP/3 frame processing
+
+  Replays a synthetic connection, or a recorded request stream given with -f, through Http3FrameDispatcher and
+  Http3ProtocolEnforcer and reports frames per second, heap allocations per frame and the per frame processing time
+  distribution.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/Layout.h"
+#include "iocore/eventsystem/EventSystem.h"
+#include "iocore/net/quic/QUICIntUtil.h"
+#include "records/RecordsConfig.h"
+
+#include "proxy/http3/Http3Config.h"
+#include "proxy/http3/Http3FrameDispatcher.h"
+#include "proxy/http3/Http3FrameHandler.h"
+#include "proxy/http3/Http3ProtocolEnforcer.h"
+
+#include "iocore/utils/diags.i"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+std::atomic<uint64_t> allocations{0};
+
+using Clock = std::chrono::steady_clock;
+
+struct Frame {
+  QUICStreamId         stream_id;
+  Http3StreamType      stream_type;
+  std::vector<uint8_t> bytes;
+};
+
+class CountingFrameHandler : public Http3FrameHandler
+{
+public:
+  uint64_t frames = 0;
+
+  std::vector<Http3FrameType>
+  interests() override
+  {
+    return {Http3FrameType::DATA, Http3FrameType::HEADERS, Http3FrameType::SETTINGS};
+  }
+
+  Http3ErrorUPtr
+  handle_frame(std::shared_ptr<const Http3Frame> /* frame ATS_UNUSED */, Http3StreamType /* s_type ATS_UNUSED */) override
+  {
+    ++this->frames;
+    return Http3ErrorUPtr(nullptr);
+  }
+};
+
+void
+append_varint(std::vector<uint8_t> &out, uint64_t value)
+{
+  uint8_t buf[8];
+  size_t  len = 0;
+  QUICVariableInt::encode(buf, sizeof(buf), len, value);
+  out.insert(out.end(), buf, buf + len);
+}
+
+Frame
+make_frame(QUICStreamId stream_id, Http3StreamType stream_type, Http3FrameType type, const std::vector<uint8_t> &payload)
+{
+  Frame frame{stream_id, stream_type, {}};
+  append_varint(frame.bytes, static_cast<uint64_t>(type));
+  append_varint(frame.bytes, payload.size());
+  frame.bytes.insert(frame.bytes.end(), payload.begin(), payload.end());
+  return frame;
+}
+
+// SETTINGS on the control stream followed by @a nrequests request streams. Every fourth request carries a DATA frame.
+std::vector<Frame>
+synthesize(int nrequests)
+{
+  std::vector<Frame>   frames;
+  std::vector<uint8_t> settings;
+
+  append_varint(settings, static_cast<uint64_t>(Http3SettingsId::HEADER_TABLE_SIZE));
+  append_varint(settings, 4096);
+  append_varint(settings, static_cast<uint64_t>(Http3SettingsId::MAX_FIELD_SECTION_SIZE));
+  append_varint(settings, 16384);
+  append_varint(settings, static_cast<uint64_t>(Http3SettingsId::QPACK_BLOCKED_STREAMS));
+  append_varint(settings, 100);
+  frames.push_back(make_frame(2, Http3StreamType::CONTROL, Http3FrameType::SETTINGS, settings));
+
+  // The dispatcher does not decode field sections, so only the size of the HEADERS payload matters
+  std::vector<uint8_t> field_section(96, 0x51);
+  std::vector<uint8_t> body(1024, 'x');
+
+  for (int i = 0; i < nrequests; ++i) {
+    QUICStreamId stream_id = 4 * i;
+    frames.push_back(make_frame(stream_id, Http3StreamType::UNKNOWN, Http3FrameType::HEADERS, field_section));
+    if (i % 4 == 3) {
+      frames.push_back(make_frame(stream_id, Http3StreamType::UNKNOWN, Http3FrameType::DATA, body));
+    }
+  }
+
+  return frames;
+}
+
+// Split a recorded request stream into frames
+std::vector<Frame>
+read_file(const char *path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    exit(1);
+  }
+  std::vector<uint8_t> data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+  std::vector<Frame>   frames;
+
+  for (size_t offset = 0; offset < data.size();) {
+    uint64_t type, length;
+    size_t   type_len, length_len;
+    if (QUICVariableInt::decode(type, type_len, data.data() + offset, data.size() - offset) != 0 ||
+        QUICVariableInt::decode(length, length_len, data.data() + offset + type_len, data.size() - offset - type_len) != 0 ||
+        length > data.size() - offset - type_len - length_len) {
+      fprintf(stderr, "Stream is truncated at offset %zu, replaying the first %zu frames only\n", offset, frames.size());
+      break;
+    }
+    size_t frame_len = type_len + length_len + length;
+    frames.push_back({0, Http3StreamType::UNKNOWN, {data.begin() + offset, data.begin() + offset + frame_len}});
+    offset += frame_len;
+  }
+
+  return frames;
+}
+
+/** Feed @a frames to the dispatchers one frame at a time, the way they arrive from QUIC streams.
+
+    @return The number of frames processed. Processing stops at the first frame that raises an error.
+ */
+template <typename F>
+uint64_t
+replay(const std::vector<Frame> &frames, F &&on_frame)
+{
+  Http3FrameDispatcher  control_dispatcher;
+  Http3FrameDispatcher  request_dispatcher;
+  Http3ProtocolEnforcer control_enforcer;
+  Http3ProtocolEnforcer request_enforcer;
+  CountingFrameHandler  handler;
+
+  control_dispatcher.add_handler(&control_enforcer);
+  control_dispatcher.add_handler(&handler);
+  request_dispatcher.add_handler(&request_enforcer);
+  request_dispatcher.add_handler(&handler);
+
+  MIOBuffer      *buf    = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  IOBufferReader *reader = buf->alloc_reader();
+  uint64_t        count  = 0;
+
+  for (const Frame &frame : frames) {
+    Http3FrameDispatcher &dispatcher = frame.stream_type == Http3StreamType::CONTROL ? control_dispatcher : request_dispatcher;
+    uint64_t              nread      = 0;
+    Http3ErrorUPtr        error      = Http3ErrorUPtr(nullptr);
+
+    on_frame([&]() {
+      buf->write(frame.bytes.data(), frame.bytes.size());
+      error = dispatcher.on_read_ready(frame.stream_id, frame.stream_type, *reader, nread);
+    });
+    if (error || nread != frame.bytes.size()) {
+      break;
+    }
+    ++count;
+  }
+
+  free_MIOBuffer(buf);
+  return count;
+}
+
+void
+usage(const char *name)
+{
+  fprintf(stderr, "Usage: %s [-n requests] [-i iterations] [-f recorded_request_stream]\n", name);
+  exit(1);
+}
+
+} // namespace
+
+// Count heap allocations done through operator new
+void *
+operator new(size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void
+operator delete(void *p, size_t) noexcept
+{
+  free(p);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int         nrequests  = 1000;
+  int         iterations = 100;
+  const char *file       = nullptr;
+  int         opt;
+
+  while ((opt = getopt(argc, argv, "n:i:f:")) != -1) {
+    switch (opt) {
+    case 'n':
+      nrequests = atoi(optarg);
+      break;
+    case 'i':
+      iterations = atoi(optarg);
+      break;
+    case 'f':
+      file = optarg;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (nrequests <= 0 || iterations <= 0) {
+    usage(argv[0]);
+  }
+
+  Layout::create();
+  init_diags("", nullptr);
+  RecProcessInit();
+  LibRecordsConfigInit();
+  ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+  eventProcessor.start(1);
+
+  EThread *main_thread = new EThread;
+  main_thread->set_specific();
+
+  ts::Http3Config::startup();
+
+  std::vector<Frame> frames = file ? read_file(file) : synthesize(nrequests);
+
+  // Warm up the allocators and check the stream once
+  if (uint64_t n = replay(frames, [](auto &&process) { process(); }); n != frames.size()) {
+    fprintf(stderr, "Frame %" PRIu64 " is rejected, replaying the first %" PRIu64 " frames only\n", n, n);
+    frames.resize(n);
+  }
+
+  // Throughput, without timing each frame
+  uint64_t total         = 0;
+  uint64_t allocs_before = allocations.load();
+  auto     start         = Clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    total += replay(frames, [](auto &&process) { process(); });
+  }
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  uint64_t                      allocs  = allocations.load() - allocs_before;
+
+  // Per frame latency
+  std::vector<uint64_t> latencies;
+  latencies.reserve(total);
+  for (int i = 0; i < iterations; ++i) {
+    replay(frames, [&latencies](auto &&process) {
+      auto frame_start = Clock::now();
+      process();
+      latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - frame_start).count());
+    });
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) -> uint64_t {
+    return latencies.empty() ? 0 : latencies[static_cast<size_t>((latencies.size() - 1) * p)];
+  };
+
+  printf("stream: %zu frames per iteration, %d iterations\n", frames.size(), iterations);
+  printf("frames/sec: %.0f\n", total / elapsed.count());
+  printf("allocations/frame: %.2f\n", total ? static_cast<double>(allocs) / total : 0.0);
+  printf("per frame ns: p50 %" PRIu64 " p90 %" PRIu64 " p99 %" PRIu64 " max %" PRIu64 "\n", percentile(0.5), percentile(0.9),
+         percentile(0.99), percentile(1.0));
+
+  return 0;
+}
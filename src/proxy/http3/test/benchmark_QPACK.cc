@@ -0,0 +1,233 @@
+/** @file
+
+  Micro benchmark for QPACK encoding with and without the dynamic table
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/reporters/catch_reporter_event_listener.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <catch2/catch_session.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "tscore/Layout.h"
+#include "tscore/Diags.h"
+
+#include "iocore/eventsystem/EventSystem.h"
+#include "records/RecordsConfig.h"
+
+#include "iocore/net/quic/QUICConfig.h"
+#include "iocore/net/quic/Mock.h"
+#include "proxy/hdrs/HTTP.h"
+#include "proxy/http3/Http3.h"
+#include "proxy/http3/QPACK.h"
+
+namespace
+{
+int nrequests  = 100;
+int blocked    = 100;
+int table_size = 4096;
+
+class BenchQUICStream : public QUICStream
+{
+public:
+  BenchQUICStream(QUICStreamId sid) : QUICStream(new MockQUICConnectionInfoProvider(), sid) {}
+
+  void
+  write(const uint8_t *buf, size_t buf_len, QUICOffset offset, bool last)
+  {
+    this->_adapter->write(offset, buf, buf_len, last);
+    this->_adapter->encourge_read();
+  }
+
+  // Drop the instructions the QPACK wrote so that the stream buffer does not keep growing.
+  void
+  drain()
+  {
+    uint8_t buf[1024];
+    while (true) {
+      this->_adapter->encourge_read();
+      auto           ibb = this->_adapter->read(sizeof(buf));
+      IOBufferReader reader;
+      reader.block = ibb;
+      if (reader.read(buf, sizeof(buf)) == 0) {
+        break;
+      }
+    }
+  }
+};
+
+// A request shaped like what browsers send for subresources of a page
+HTTPHdr *
+make_request(int i)
+{
+  HTTPHdr *hdr = new HTTPHdr();
+  hdr->create(HTTPType::REQUEST);
+
+  std::string path = "/assets/img/" + std::to_string(i) + ".png";
+  std::pair<std::string_view, std::string_view> fields[] = {
+    {":method",         "GET"                                                                    },
+    {":scheme",         "https"                                                                  },
+    {":authority",      "www.example.com"                                                        },
+    {":path",           path                                                                     },
+    {"user-agent",      "Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0"},
+    {"accept",          "image/avif,image/webp,image/png,image/svg+xml,image/*;q=0.8,*/*;q=0.5"  },
+    {"accept-language", "en-US,en;q=0.5"                                                         },
+    {"accept-encoding", "gzip, deflate, br, zstd"                                                },
+    {"referer",         "https://www.example.com/index.html"                                     },
+    {"cookie",          "session=8f14e45fceea167a5a36dedd4bea2543; theme=dark; consent=1"        },
+  };
+
+  for (auto &[name, value] : fields) {
+    auto field = hdr->field_create(name);
+    hdr->field_attach(field);
+    hdr->field_value_set(field, value);
+  }
+
+  return hdr;
+}
+
+void
+acknowledge_header_block(BenchQUICStream *stream, uint64_t stream_id)
+{
+  uint8_t buf[128];
+
+  buf[0]  = 0x80;
+  int ret = xpack_encode_integer(buf, buf + sizeof(buf), stream_id, 7);
+  stream->write(buf, ret, 0, false);
+}
+
+void
+run_encode(uint16_t dynamic_table_size)
+{
+  std::vector<HTTPHdr *> requests;
+  for (int i = 0; i < nrequests; ++i) {
+    requests.push_back(make_request(i));
+  }
+
+  MockQUICConnection connection;
+  QPACK             *qpack          = new QPACK(&connection, UINT32_MAX, dynamic_table_size, blocked);
+  BenchQUICStream   *encoder_stream = new BenchQUICStream(0);
+  BenchQUICStream   *decoder_stream = new BenchQUICStream(10);
+  qpack->on_stream_open(*encoder_stream);
+  qpack->on_stream_open(*decoder_stream);
+  qpack->set_encoder_stream(encoder_stream->id());
+  qpack->set_decoder_stream(decoder_stream->id());
+
+  MIOBuffer      *header_block        = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  IOBufferReader *header_block_reader = header_block->alloc_reader();
+  uint64_t        compressed_len      = 0;
+  uint64_t        uncompressed_len    = 0;
+
+  std::string name = "encode " + std::to_string(nrequests) + " requests, dynamic table " + std::to_string(dynamic_table_size);
+  BENCHMARK(name.c_str())
+  {
+    compressed_len   = 0;
+    uncompressed_len = 0;
+    for (int i = 0; i < nrequests; ++i) {
+      uint64_t stream_id        = i * 4;
+      uint64_t header_block_len = 0;
+      qpack->encode(stream_id, *requests[i], header_block, header_block_len);
+      header_block_reader->consume(header_block_reader->read_avail());
+      compressed_len += header_block_len;
+      for (auto &field : *requests[i]) {
+        uncompressed_len += field.name_get().length() + field.value_get().length();
+      }
+      acknowledge_header_block(decoder_stream, stream_id);
+    }
+    encoder_stream->drain();
+    return compressed_len;
+  };
+
+  // Entries stay on the table across iterations, so this is the steady state ratio.
+  std::cout << name << ": " << uncompressed_len << " -> " << compressed_len << " bytes (ratio "
+            << static_cast<double>(compressed_len) / uncompressed_len << ")" << std::endl;
+
+  free_MIOBuffer(header_block);
+  delete qpack;
+  for (auto hdr : requests) {
+    hdr->destroy();
+    delete hdr;
+  }
+}
+
+} // namespace
+
+TEST_CASE("QPACK encode", "[qpack]")
+{
+  run_encode(0);
+  run_encode(table_size);
+}
+
+struct EventProcessorListener : Catch::EventListenerBase {
+  using EventListenerBase::EventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    BaseLogFile *base_log_file = new BaseLogFile("stderr");
+    DiagsPtr::set(new Diags(std::string_view{testRunInfo.name.data(), testRunInfo.name.size()}, "" /* tags */, "" /* actions */,
+                            base_log_file));
+
+    Layout::create();
+    RecProcessInit();
+    LibRecordsConfigInit();
+
+    QUICConfig::startup();
+    Http3::init();
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(1);
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+
+    url_init();
+    mime_init();
+    http_init();
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
+
+int
+main(int argc, char *argv[])
+{
+  Catch::Session session;
+
+  using namespace Catch::Clara;
+
+  auto cli = session.cli() | Opt(nrequests, "n")["--q-requests"]("number of requests encoded per iteration (default: 100)") |
+             Opt(blocked, "n")["--q-max-blocked-streams"]("max blocked streams for encoding (default: 100)") |
+             Opt(table_size, "size")["--q-dynamic-table-size"]("dynamic table size to compare with 0 (default: 4096)");
+
+  session.cli(cli);
+
+  if (int res = session.applyCommandLine(argc, argv); res != 0) {
+    return res;
+  }
+
+  return session.run();
+}
@@ -36,6 +36,7 @@
 #include "iocore/net/quic/QUICConfig.h"
 #include "proxy/hdrs/HuffmanCodec.h"
 #include "proxy/hdrs/HTTP.h"
+#include "proxy/http3/Http3.h"
 
 #define TEST_THREADS 1
 
@@ -66,6 +67,7 @@ struct EventProcessorListener : Catch::EventListenerBase {
     LibRecordsConfigInit();
 
     QUICConfig::startup();
+    Http3::init();
 
     ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
     eventProcessor.start(TEST_THREADS);
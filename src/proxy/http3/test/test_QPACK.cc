@@ -22,10 +22,12 @@
  */
 
 #include <catch2/catch_test_macros.hpp>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <string>
 #include "proxy/hdrs/XPACK.h"
 #include "proxy/http3/QPACK.h"
 #include "proxy/hdrs/HTTP.h"
@@ -87,6 +89,13 @@ public:
     reader.block = ibb;
     return reader.read(buf, buf_len);
   }
+
+  // A connection does this when the stream can take more data
+  void
+  encourge_write()
+  {
+    this->_adapter->encourge_write();
+  }
 };
 
 class TestQPACKEventHandler : public Continuation
@@ -469,3 +478,219 @@ TEST_CASE("Decoding", "[qpack-decode]")
     }
   }
 }
+
+// The streams between an encoding and a decoding QPACK are driven on an event thread the way a connection drives them.
+class QPACKRoundTrip : public Continuation
+{
+public:
+  static constexpr uint64_t REQUEST_STREAM_ID = 16;
+
+  QPACKRoundTrip() : Continuation(new_ProxyMutex())
+  {
+    SET_HANDLER(&QPACKRoundTrip::state_encode);
+
+    this->_request.create(HTTPType::REQUEST);
+    std::pair<std::string_view, std::string_view> fields[] = {
+      {":method",    "GET"                                  },
+      {":scheme",    "https"                                },
+      {":authority", "www.example.com"                      },
+      {":path",      "/index.html"                          },
+      {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) qpack"},
+      {"x-tenant",   "round-trip"                           },
+    };
+    for (auto &[name, value] : fields) {
+      auto field = this->_request.field_create(name);
+      this->_request.field_attach(field);
+      this->_request.field_value_set(field, value);
+    }
+    this->_decoded.create(HTTPType::REQUEST);
+  }
+
+  int
+  state_encode(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    // The streams signal their first events on the thread that opens them
+    this->_encoder->on_stream_open(this->_encoder_encoder_stream);
+    this->_encoder->on_stream_open(this->_encoder_decoder_stream);
+    this->_encoder->set_encoder_stream(this->_encoder_encoder_stream.id());
+    this->_encoder->set_decoder_stream(this->_encoder_decoder_stream.id());
+    this->_decoder->on_stream_open(this->_decoder_encoder_stream);
+    this->_decoder->on_stream_open(this->_decoder_decoder_stream);
+    this->_decoder->set_encoder_stream(this->_decoder_encoder_stream.id());
+    this->_decoder->set_decoder_stream(this->_decoder_decoder_stream.id());
+
+    this->_encode(REQUEST_STREAM_ID, this->_first_block);
+    this->required_insert_count = this->_first_block.empty() ? 0 : this->_first_block[0];
+    this->_encoder_encoder_stream.encourge_write();
+
+    SET_HANDLER(&QPACKRoundTrip::state_decode);
+    this_ethread()->schedule_in(this, HRTIME_MSECONDS(10));
+    return EVENT_DONE;
+  }
+
+  int
+  state_decode(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    // The header block arrives before the instructions it depends on, so the decode waits for them
+    SET_HANDLER(&QPACKRoundTrip::state_decoded);
+    this->decode_result = this->_decoder->decode(REQUEST_STREAM_ID, this->_first_block.data(), this->_first_block.size(),
+                                                 this->_decoded, this, this_ethread());
+    this->instructions_len =
+      this->_transfer(this->_encoder_encoder_stream, this->_decoder_encoder_stream, this->_encoder_stream_offset).size();
+    return EVENT_DONE;
+  }
+
+  int
+  state_decoded(int event, Event * /* e ATS_UNUSED */)
+  {
+    this->decode_event = event;
+    this->decoded      = to_string(this->_decoded);
+    this->_decoder_decoder_stream.encourge_write();
+
+    SET_HANDLER(&QPACKRoundTrip::state_acknowledged);
+    this_ethread()->schedule_in(this, HRTIME_MSECONDS(10));
+    return EVENT_DONE;
+  }
+
+  int
+  state_acknowledged(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    this->acknowledgement =
+      this->_transfer(this->_decoder_decoder_stream, this->_encoder_decoder_stream, this->_decoder_stream_offset);
+
+    SET_HANDLER(&QPACKRoundTrip::state_encode_again);
+    this_ethread()->schedule_in(this, HRTIME_MSECONDS(10));
+    return EVENT_DONE;
+  }
+
+  int
+  state_encode_again(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    this->_encode(REQUEST_STREAM_ID + 4, this->_second_block);
+    this->_encoder_encoder_stream.encourge_write();
+
+    SET_HANDLER(&QPACKRoundTrip::state_decode_again);
+    this_ethread()->schedule_in(this, HRTIME_MSECONDS(10));
+    return EVENT_DONE;
+  }
+
+  int
+  state_decode_again(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    this->instructions_again_len =
+      this->_transfer(this->_encoder_encoder_stream, this->_decoder_encoder_stream, this->_encoder_stream_offset).size();
+
+    SET_HANDLER(&QPACKRoundTrip::state_decoded_again);
+    this->_decoded_again.create(HTTPType::REQUEST);
+    this->decode_again_result = this->_decoder->decode(REQUEST_STREAM_ID + 4, this->_second_block.data(),
+                                                       this->_second_block.size(), this->_decoded_again, this, this_ethread());
+    return EVENT_DONE;
+  }
+
+  int
+  state_decoded_again(int event, Event * /* e ATS_UNUSED */)
+  {
+    this->decode_again_event = event;
+    this->decoded_again      = to_string(this->_decoded_again);
+    this->done               = true;
+    return EVENT_DONE;
+  }
+
+  static std::string
+  to_string(HTTPHdr &hdr)
+  {
+    std::string text;
+    for (auto const &field : hdr) {
+      text.append(field.name_get()).append(": ").append(field.value_get()).append("\n");
+    }
+    return text;
+  }
+
+  std::string
+  request()
+  {
+    return to_string(this->_request);
+  }
+
+  std::atomic<bool>    done{false};
+  uint8_t              required_insert_count  = 0;
+  size_t               instructions_len       = 0;
+  size_t               instructions_again_len = 0;
+  int                  decode_result          = -1;
+  int                  decode_event           = 0;
+  int                  decode_again_result    = -1;
+  int                  decode_again_event     = 0;
+  std::string          decoded;
+  std::string          decoded_again;
+  std::vector<uint8_t> acknowledgement;
+
+private:
+  void
+  _encode(uint64_t stream_id, std::vector<uint8_t> &block)
+  {
+    MIOBuffer      *buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+    IOBufferReader *reader = buffer->alloc_reader();
+    uint64_t        len    = 0;
+    this->_encoder->encode(stream_id, this->_request, buffer, len);
+    block.resize(len);
+    reader->read(block.data(), len);
+    free_MIOBuffer(buffer);
+  }
+
+  // Move what QPACK wrote on @a from to what the peer reads on @a to.
+  std::vector<uint8_t>
+  _transfer(TestQUICStream &from, TestQUICStream &to, QUICOffset &offset)
+  {
+    std::vector<uint8_t> data;
+    uint8_t              buf[1024];
+    while (size_t n = from.read(buf, sizeof(buf))) {
+      data.insert(data.end(), buf, buf + n);
+    }
+    if (!data.empty()) {
+      to.write(data.data(), data.size(), offset, false);
+      offset += data.size();
+    }
+    return data;
+  }
+
+  TestQUICConnection   _connection;
+  QPACK               *_encoder = new QPACK(&_connection, UINT32_MAX, 4096, 100);
+  QPACK               *_decoder = new QPACK(&_connection, UINT32_MAX, 4096, 100);
+  TestQUICStream       _encoder_encoder_stream{0};
+  TestQUICStream       _encoder_decoder_stream{4};
+  TestQUICStream       _decoder_encoder_stream{8};
+  TestQUICStream       _decoder_decoder_stream{12};
+  QUICOffset           _encoder_stream_offset = 0;
+  QUICOffset           _decoder_stream_offset = 0;
+  HTTPHdr              _request;
+  HTTPHdr              _decoded;
+  HTTPHdr              _decoded_again;
+  std::vector<uint8_t> _first_block;
+  std::vector<uint8_t> _second_block;
+};
+
+TEST_CASE("Dynamic table round trip", "[qpack]")
+{
+  QPACKRoundTrip *trip = new QPACKRoundTrip();
+  eventProcessor.schedule_imm(trip, ET_CALL);
+  for (int i = 0; i < 500 && !trip->done; ++i) {
+    usleep(10000);
+  }
+  REQUIRE(trip->done);
+
+  // The header block refers to the entries the encoder inserted
+  CHECK(trip->required_insert_count != 0);
+  // The decoder waited for the encoder stream and then got the same fields
+  CHECK(trip->decode_result == 1);
+  CHECK(trip->decode_event == QPACK_EVENT_DECODE_COMPLETE);
+  CHECK(trip->decoded == trip->request());
+  CHECK(trip->instructions_len > 0);
+  // The decoder acknowledged the section
+  REQUIRE(!trip->acknowledgement.empty());
+  CHECK((trip->acknowledgement[0] & 0x80) != 0);
+  // Once acknowledged, the entries are referred without being sent again and nothing blocks
+  CHECK(trip->instructions_again_len == 0);
+  CHECK(trip->decode_again_result == 0);
+  CHECK(trip->decode_again_event == QPACK_EVENT_DECODE_COMPLETE);
+  CHECK(trip->decoded_again == trip->request());
+}
@@ -3081,6 +3081,26 @@ LogAccess::marshal_client_http_transaction_id(char *buf)
   return INK_MIN_ALIGN;
 }
 
+/*-------------------------------------------------------------------------
+  -------------------------------------------------------------------------*/
+
+int
+LogAccess::marshal_transaction_state_trace(char *buf)
+{
+  char trace[1024];
+  int  trace_len = 0;
+
+  if (m_http_sm) {
+    trace_len = std::min<int>(m_http_sm->state_trace.print(trace, sizeof(trace)), sizeof(trace) - 1);
+  }
+
+  int len = trace_len ? padded_length(trace_len + 1) : INK_MIN_ALIGN;
+  if (buf) {
+    marshal_mem(buf, trace, trace_len, len);
+  }
+  return len;
+}
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -155,7 +155,7 @@ CacheScan::unmarshal(HdrHeap *hh, int buf_length, int obj_type, HdrHeapObjImpl *
   *found_obj = nullptr;
 
   // Check out this heap and make sure it is OK
-  if (hh->m_magic != HdrBufMagic::MARSHALED) {
+  if (hh->m_magic != HdrBufMagic::MARSHALED && hh->m_magic != HdrBufMagic::MARSHALED_V2) {
     ink_assert(!"HdrHeap::unmarshal bad magic");
     return zret;
   }
@@ -204,6 +204,11 @@ CacheScan::unmarshal(HdrHeap *hh, int buf_length, int obj_type, HdrHeapObjImpl *
   //  live offsets
   char    *obj_data = hh->m_data_start;
   intptr_t offset   = (intptr_t)hh;
+  bool     relocs   = hh->m_magic == HdrBufMagic::MARSHALED_V2;
+
+  if (relocs) {
+    hh->unmarshal_relocs(offset);
+  }
 
   while (obj_data < hh->m_free_start) {
     HdrHeapObjImpl *obj = reinterpret_cast<HdrHeapObjImpl *>(obj_data);
@@ -216,7 +221,7 @@ CacheScan::unmarshal(HdrHeap *hh, int buf_length, int obj_type, HdrHeapObjImpl *
       *found_obj = obj;
     }
     // TODO : fix this switch
-    switch (static_cast<HdrHeapObjType>(obj->m_type)) {
+    switch (relocs ? HdrHeapObjType::EMPTY : static_cast<HdrHeapObjType>(obj->m_type)) {
     case HdrHeapObjType::HTTP_HEADER:
       this->unmarshal((HTTPHdrImpl *)obj, offset);
       break;
@@ -246,9 +251,10 @@ CacheScan::unmarshal(HdrHeap *hh, int buf_length, int obj_type, HdrHeapObjImpl *
     obj_data = obj_data + obj->m_length;
   }
 
-  hh->m_magic = HdrBufMagic::ALIVE;
+  unmarshal_size = HdrHeapMarshalBlocks(swoc::round_up(unmarshal_size));
+  hh->m_magic    = HdrBufMagic::ALIVE;
 
-  return HdrHeapMarshalBlocks(swoc::round_up(hh->unmarshal_size()));
+  return unmarshal_size;
 }
 
 Errata
@@ -91,6 +91,20 @@ block_alloc(ArenaBlock *block, size_t size, size_t alignment)
   return nullptr;
 }
 
+Arena::Arena(void *buffer, size_t size)
+{
+  ink_assert(size > sizeof(ArenaBlock));
+
+  m_inline                = static_cast<ArenaBlock *>(buffer);
+  m_inline->next          = nullptr;
+  m_inline->m_heap_end    = static_cast<char *>(buffer) + size;
+  m_inline->m_water_level = m_inline->data;
+  m_blocks                = m_inline;
+}
+
+/*-------------------------------------------------------------------------
+  -------------------------------------------------------------------------*/
+
 void *
 Arena::alloc(size_t size, size_t alignment)
 {
@@ -100,6 +114,8 @@ Arena::alloc(size_t size, size_t alignment)
 
   ink_assert((alignment & (alignment - 1)) == 0);
 
+  ++m_alloc_count;
+
   b = m_blocks;
   while (b) {
     mem = block_alloc(b, size, alignment);
@@ -117,6 +133,7 @@ Arena::alloc(size_t size, size_t alignment)
   b        = blk_alloc(block_size);
   b->next  = m_blocks;
   m_blocks = b;
+  ++m_block_count;
 
   mem = block_alloc(b, size, alignment);
   return mem;
@@ -150,10 +167,16 @@ Arena::reset()
 {
   ArenaBlock *b;
 
-  while (m_blocks) {
+  while (m_blocks != m_inline) {
     b = m_blocks->next;
     blk_free(m_blocks);
     m_blocks = b;
   }
-  ink_assert(m_blocks == nullptr);
+  ink_assert(m_blocks == m_inline);
+
+  if (m_inline) {
+    m_inline->m_water_level = m_inline->data;
+  }
+  m_alloc_count = 0;
+  m_block_count = 0;
 }
@@ -202,6 +202,8 @@ ink_freelist_create(const char *name, uint32_t type_size, uint32_t chunk_size, u
 
 #define ADDRESS_OF_NEXT(x, offset) ((void **)((char *)x + offset))
 
+thread_local uint64_t ink_thread_alloc_count = 0;
+
 void *
 ink_freelist_new(InkFreeList *f)
 {
@@ -209,6 +211,7 @@ ink_freelist_new(InkFreeList *f)
 
   if (likely(ptr = freelist_global_ops->fl_new(f))) {
     ink_atomic_increment(reinterpret_cast<int *>(&f->used), 1);
+    ++ink_thread_alloc_count;
   }
 
   return ptr;
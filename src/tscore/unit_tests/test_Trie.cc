@@ -0,0 +1,120 @@
+/** @file
+
+    Unit tests for Trie
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string>
+#include <vector>
+
+#include "tscore/Trie.h"
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+struct Value {
+  explicit Value(std::string n) : name(std::move(n)) {}
+  std::string name;
+  LINK(Value, link);
+
+  void
+  Print() const
+  {
+  }
+};
+
+std::string
+search(Trie<Value> const &trie, std::string const &key)
+{
+  Value *v = trie.Search(key.data(), key.size());
+  return v ? v->name : "-";
+}
+} // namespace
+
+TEST_CASE("Trie", "[libts][Trie]")
+{
+  Trie<Value> trie;
+
+  CHECK(trie.Empty());
+  CHECK(search(trie, "") == "-");
+  CHECK(search(trie, "a") == "-");
+
+  // Inserted so that later keys split the nodes of earlier ones.
+  REQUIRE(trie.Insert("images/logo", new Value("logo"), 0));
+  REQUIRE(trie.Insert("images/", new Value("images"), 1));
+  REQUIRE(trie.Insert("img", new Value("img"), 2));
+  REQUIRE(trie.Insert("", new Value("root"), 3));
+  REQUIRE(trie.Insert("images/logo.png", new Value("png"), 4));
+  CHECK(!trie.Empty());
+
+  SECTION("search")
+  {
+    CHECK(search(trie, "") == "root");
+    CHECK(search(trie, "other") == "root");
+    CHECK(search(trie, "i") == "root");
+    CHECK(search(trie, "im") == "root");
+    CHECK(search(trie, "img") == "img");
+    CHECK(search(trie, "img/a.gif") == "img");
+    CHECK(search(trie, "images") == "root");
+    CHECK(search(trie, "images/") == "images");
+    CHECK(search(trie, "images/icon") == "images");
+    // The lowest rank wins, not the longest key.
+    CHECK(search(trie, "images/logo") == "logo");
+    CHECK(search(trie, "images/logo.png") == "logo");
+    CHECK(search(trie, "images/lo") == "images");
+    CHECK(trie.Search("img/a.gif") != nullptr);
+  }
+
+  SECTION("duplicates")
+  {
+    Value dup{"dup"};
+    CHECK(!trie.Insert("images/", &dup, 5));
+    CHECK(!trie.Insert("img", &dup, 5));
+    CHECK(!trie.Insert("", &dup, 5));
+    CHECK(search(trie, "images/") == "images");
+  }
+
+  SECTION("rank")
+  {
+    Trie<Value> ranked;
+    REQUIRE(ranked.Insert("a", new Value("a"), 9));
+    REQUIRE(ranked.Insert("ab", new Value("ab"), 3));
+    REQUIRE(ranked.Insert("abcd", new Value("abcd"), 3));
+    CHECK(search(ranked, "a") == "a");
+    CHECK(search(ranked, "abc") == "ab");
+    // The deeper of equal ranks wins.
+    CHECK(search(ranked, "abcde") == "abcd");
+  }
+
+  SECTION("iteration and clear")
+  {
+    std::vector<std::string> names;
+    for (auto const &v : trie) {
+      names.push_back(v.name);
+    }
+    CHECK(names.size() == 5);
+
+    trie.Clear();
+    CHECK(trie.Empty());
+    CHECK(search(trie, "images/") == "-");
+    REQUIRE(trie.Insert("images/", new Value("again"), 0));
+    CHECK(search(trie, "images/logo") == "again");
+  }
+}
@@ -36,8 +36,11 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "tscore/Arena.h"
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <memory>
+#include <string_view>
 
 void
 fill_test_data(char *ptr, int size, int seed)
@@ -87,3 +90,32 @@ TEST_CASE("test arena", "[libts][arena]")
     a->reset();
   }
 }
+
+TEST_CASE("arena with inline storage", "[libts][arena]")
+{
+  alignas(double) char buffer[256];
+  auto                 in_buffer = [&buffer](void const *p) {
+    auto addr = reinterpret_cast<uintptr_t>(p);
+    return addr >= reinterpret_cast<uintptr_t>(buffer) && addr < reinterpret_cast<uintptr_t>(buffer + sizeof(buffer));
+  };
+
+  Arena a{buffer, sizeof(buffer)};
+
+  char *first = a.str_store("inline", 6);
+  REQUIRE(in_buffer(first));
+  REQUIRE(a.alloc_count() == 1);
+  REQUIRE(a.block_count() == 0);
+
+  // Too big for what is left of the buffer
+  void *big = a.alloc(1024);
+  REQUIRE(!in_buffer(big));
+  REQUIRE(a.alloc_count() == 2);
+  REQUIRE(a.block_count() == 1);
+  memset(big, 'x', 1024);
+  REQUIRE(std::string_view(first) == "inline");
+
+  a.reset();
+  REQUIRE(a.alloc_count() == 0);
+  REQUIRE(a.block_count() == 0);
+  REQUIRE(a.str_store("inline", 6) == first);
+}
@@ -0,0 +1,80 @@
+/** @file
+
+   fuzzing proxy/http2 frame processing
+
+   @section license License
+
+   Licensed to the Apache Software Foundation (ASF) under one
+   or more contributor license agreements.  See the NOTICE file
+   distributed with this work for additional information
+   regarding copyright ownership.  The ASF licenses this file
+   to you under the Apache License, Version 2.0 (the
+   "License"); you may not use this file except in compliance
+   with the License.  You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Http2FrameReplay.h"
+
+#include "iocore/eventsystem/EventSystem.h"
+#include "iocore/utils/Machine.h"
+#include "records/RecordsConfig.h"
+#include "tscore/Layout.h"
+
+#include "iocore/utils/diags.i"
+
+#define kMinInputLength 9
+#define kMaxInputLength 16384
+
+#define TEST_THREADS 1
+
+extern int cmd_disable_pfreelist;
+
+bool
+DoInitialization()
+{
+  Layout::create();
+  init_diags("", nullptr);
+  RecProcessInit();
+  LibRecordsConfigInit();
+
+  ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+  eventProcessor.start(TEST_THREADS);
+
+  // The replayed session runs on this thread
+  EThread *main_thread = new EThread;
+  main_thread->set_specific();
+
+  Machine::init("localhost", nullptr);
+  url_init();
+  mime_init();
+  http_init();
+  http2_init();
+  Http2::init();
+
+  return true;
+}
+
+extern "C" int
+LLVMFuzzerTestOneInput(const uint8_t *input_data, size_t size_data)
+{
+  if (size_data < kMinInputLength || size_data > kMaxInputLength) {
+    return 0;
+  }
+
+  cmd_disable_pfreelist = true;
+
+  static bool Initialized = DoInitialization();
+
+  Http2FrameReplay replay;
+  replay.process(input_data, size_data);
+
+  return 0;
+}
@@ -0,0 +1,136 @@
+/** @file
+
+  Benchmark of the Trie that holds the path prefixes of remap rules.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <malloc.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tscore/Trie.h"
+
+namespace
+{
+struct Mapping {
+  int id;
+  LINK(Mapping, link);
+
+  void
+  Print() const
+  {
+  }
+};
+
+using MappingTrie = Trie<Mapping>;
+
+/// @return Bytes currently allocated from the heap.
+size_t
+heap_in_use()
+{
+#if defined(__GLIBC__)
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+// Rule counts, from the environment so the large ones can be left out.
+std::vector<int>
+rule_counts()
+{
+  std::vector<int> counts;
+  char const      *text = getenv("TRIE_BENCHMARK_RULES");
+  for (std::string_view spot{text ? text : "10000,100000,1000000"}; !spot.empty();) {
+    auto comma = spot.find(',');
+    counts.push_back(atoi(std::string{spot.substr(0, comma)}.c_str()));
+    spot = comma == spot.npos ? std::string_view{} : spot.substr(comma + 1);
+  }
+  return counts;
+}
+} // namespace
+
+// One trie per host, as in UrlMappingPathIndex, most of which have only a rule for the whole host.
+TEST_CASE("Trie per host", "[bench][trie]")
+{
+  for (int n : rule_counts()) {
+    size_t                                    before = heap_in_use();
+    std::vector<std::unique_ptr<MappingTrie>> tries;
+    tries.reserve(n);
+    for (int i = 0; i < n; ++i) {
+      auto &trie = tries.emplace_back(std::make_unique<MappingTrie>());
+      trie->Insert("", new Mapping{i, {}}, i, 0);
+      if (i % 10 == 0) {
+        trie->Insert("static/", new Mapping{i, {}}, i, 7);
+      }
+    }
+    printf("%d hosts: %zu bytes, %zu bytes per host\n", n, heap_in_use() - before, (heap_in_use() - before) / n);
+
+    std::string path = "static/css/site.css";
+    int         i    = 0;
+    BENCHMARK("search " + std::to_string(n) + " hosts")
+    {
+      i = (i + 7919) % n;
+      return tries[i]->Search(path.data(), path.size());
+    };
+  }
+}
+
+// Many path rules under one host, such as a tenant per path prefix.
+TEST_CASE("Trie paths", "[bench][trie]")
+{
+  for (int n : rule_counts()) {
+    size_t      before = heap_in_use();
+    auto        trie   = std::make_unique<MappingTrie>();
+    std::string key;
+    for (int i = 0; i < n; ++i) {
+      key = "tenant" + std::to_string(i) + "/assets/";
+      REQUIRE(trie->Insert(key.data(), new Mapping{i, {}}, i, key.size()));
+    }
+    printf("%d paths: %zu bytes, %zu bytes per path\n", n, heap_in_use() - before, (heap_in_use() - before) / n);
+
+    std::vector<std::string> hits;
+    for (int i = 0; i < 1024; ++i) {
+      hits.push_back("tenant" + std::to_string((i * 7919) % n) + "/assets/img/logo.png");
+    }
+    std::string miss = "tenants/assets/img/logo.png";
+
+    REQUIRE(trie->Search(hits[1].data(), hits[1].size())->id == 7919 % n);
+    REQUIRE(trie->Search(miss.data(), miss.size()) == nullptr);
+
+    int i = 0;
+    BENCHMARK("search hit " + std::to_string(n) + " paths")
+    {
+      auto const &path = hits[i++ & 1023];
+      return trie->Search(path.data(), path.size());
+    };
+    BENCHMARK("search miss " + std::to_string(n) + " paths")
+    {
+      return trie->Search(miss.data(), miss.size());
+    };
+  }
+}